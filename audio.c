@@ -0,0 +1,1196 @@
+/******************************************************************************\
+* Project:  High-Level Emulation of Audio Lists                                *
+* Authors:  agent                                                              *
+* Release:  2026.10.18                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+#include <string.h>
+
+#include "audio.h"
+#include "su.h"
+
+/*
+ * command flags, as <abi.h> in the SDK names them
+ */
+#define A_INIT          0x01
+#define A_LOOP          0x02
+#define A_LEFT          0x02
+#define A_VOL           0x04
+#define A_AUX           0x08
+
+/*
+ * ABI1 buffer addresses are offsets from here.  NAudio has fixed buffers.
+ */
+#define ABI1_DMEM_BASE      0x05C0
+
+#define NAUDIO_COUNT        0x0170 /* bytes per buffer:  184 samples */
+#define NAUDIO_MAIN         0x04F0
+#define NAUDIO_MAIN2        0x0660
+#define NAUDIO_DRY_LEFT     0x09D0
+#define NAUDIO_DRY_RIGHT    0x0B40
+#define NAUDIO_WET_LEFT     0x0CB0
+#define NAUDIO_WET_RIGHT    0x0E20
+
+audio_state RSP_state_audio;
+#define AUDIO                   (*RSP_STATE.audio)
+
+/*
+ * the DMEM the micro-code would have worked in, with the same byte order
+ */
+#define WORK_BYTE(address)      (AUDIO.work[BES((address) & 0xFFF)])
+#define WORK_SAMPLE(address)    (*(pi16)(AUDIO.work + HES((address) & 0xFFE)))
+
+/*
+ * the vector lane which sample `x' of a 4-byte-aligned group of 8 loads to
+ */
+#define LANE(x)                 ((x) ^ (ENDIAN_SWAP_HALF >> 1))
+
+static const i16 resample_filter_start[8] = {
+    0x0C39, 0x66AD, 0x0D46, -0x0021,
+    0x0B39, 0x6696, 0x0E5F, -0x0028,
+};
+
+static INLINE i16 clamp_s16(s32 x)
+{
+    if (x < -32768)
+        return -32768;
+    if (x > +32767)
+        return +32767;
+    return (i16)x;
+}
+
+static int in_RDRAM(u32 address, u32 length)
+{
+    return (length <= RSP_STATE.su_max_address + 1)
+        && (address <= RSP_STATE.su_max_address + 1 - length);
+}
+
+static INLINE i16 RDRAM_half(u32 address)
+{
+    return *(pi16)(RSP_STATE.DRAM + HES(address));
+}
+static INLINE void store_RDRAM_half(u32 address, i16 value)
+{
+    *(pi16)(RSP_STATE.DRAM + HES(address)) = value;
+    return;
+}
+
+/*
+ * RDRAM addresses from the audio list go through the DMA engine, which
+ * ignores the low three bits.
+ */
+#define BAD_ADDRESS     0xFFFFFFFFul
+
+static u32 DMA_address(u32 address, u32 length)
+{
+    address &= 0x00FFFFF8ul;
+    if (in_RDRAM(address, length))
+        return (address);
+    message("Audio list\nRDRAM address out of range.");
+    return (BAD_ADDRESS);
+}
+
+static u32 segmented(u32 so)
+{
+    const unsigned int segment = (so >> 24) & 0x3F;
+
+    if (segment >= 16)
+        return (so & 0x00FFFFFFul);
+    return (AUDIO.alist.segments[segment] + (so & 0x00FFFFFFul));
+}
+
+#ifdef ARCH_MIN_SSE2
+/*
+ * Vectors of samples go straight to and from `work' if they start on a word
+ * (so that lanes hold the same sample pairs) and don't wrap past its end.
+ */
+static INLINE int vector_span(unsigned int address, unsigned int length)
+{
+    return ((address & 3) == 0) && ((address & 0xFFF) + length <= 0x1000);
+}
+static INLINE __m128i * work_vector(unsigned int address)
+{
+    return (__m128i *)(AUDIO.work + (address & 0xFFF));
+}
+static INLINE __m128i swap_pairs(__m128i samples)
+{
+    samples = _mm_shufflelo_epi16(samples, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_shufflehi_epi16(samples, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+/*
+ * clamp(dst + (src * gain >> 15)), lane by lane
+ */
+static INLINE __m128i mix_vector(__m128i dst, __m128i src, __m128i gain)
+{
+    __m128i product_lo, product_hi;
+    __m128i sum_lo, sum_hi;
+
+    product_lo = _mm_mullo_epi16(src, gain);
+    product_hi = _mm_mulhi_epi16(src, gain);
+    sum_lo = _mm_unpacklo_epi16(product_lo, product_hi);
+    sum_hi = _mm_unpackhi_epi16(product_lo, product_hi);
+    sum_lo = _mm_add_epi32(
+        _mm_srai_epi32(sum_lo, 15),
+        _mm_srai_epi32(_mm_unpacklo_epi16(dst, dst), 16)
+    );
+    sum_hi = _mm_add_epi32(
+        _mm_srai_epi32(sum_hi, 15),
+        _mm_srai_epi32(_mm_unpackhi_epi16(dst, dst), 16)
+    );
+    return _mm_packs_epi32(sum_lo, sum_hi);
+}
+#endif
+
+/*
+ * `count' samples, in order, from a plain array into `work'
+ */
+static void store_samples(unsigned int address, const i16* samples, int count)
+{
+    register int i;
+
+#ifdef ARCH_MIN_SSE2
+    if (count % 8 == 0 && vector_span(address, 2 * count)) {
+        for (i = 0; i < count; i += 8)
+            _mm_storeu_si128(
+                work_vector(address + 2*i),
+                swap_pairs(_mm_loadu_si128((const __m128i *)(samples + i)))
+            );
+        return;
+    }
+#endif
+    for (i = 0; i < count; i++)
+        WORK_SAMPLE(address + 2*i) = samples[i];
+    return;
+}
+
+/*
+ * CLEARBUFF, DMEMMOVE, LOADBUFF and SAVEBUFF
+ */
+static void clear_work(unsigned int address, unsigned int count)
+{
+    if (((address | count) & 3) == 0 && (address & 0xFFF) + count <= 0x1000) {
+        memset(AUDIO.work + (address & 0xFFF), 0, count);
+        return;
+    }
+    while (count != 0) {
+        WORK_BYTE(address++) = 0x00;
+        --count;
+    }
+    return;
+}
+
+static void move_work(unsigned int dst, unsigned int src, unsigned int count)
+{
+    dst &= 0xFFF;
+    src &= 0xFFF;
+    if (((dst | src | count) & 3) == 0
+     && dst + count <= 0x1000 && src + count <= 0x1000
+     && (dst <= src || dst >= src + count)) {
+        memmove(AUDIO.work + dst, AUDIO.work + src, count);
+        return;
+    }
+    while (count != 0) { /* byte by byte, forward, as the micro-code does */
+        WORK_BYTE(dst++) = WORK_BYTE(src++);
+        --count;
+    }
+    return;
+}
+
+static void load_work(unsigned int dmem, u32 address, unsigned int count)
+{
+    unsigned int run;
+
+    dmem &= 0xFFC;
+    count = (count + 7) & ~7u;
+    address = DMA_address(address, count);
+    if (address == BAD_ADDRESS)
+        return;
+    while (count != 0) {
+        run = 0x1000 - dmem;
+        if (run > count)
+            run = count;
+        memcpy(AUDIO.work + dmem, RSP_STATE.DRAM + address, run);
+        dmem = (dmem + run) & 0xFFF;
+        address += run;
+        count -= run;
+    }
+    return;
+}
+
+static void save_work(unsigned int dmem, u32 address, unsigned int count)
+{
+    unsigned int run;
+
+    dmem &= 0xFFC;
+    count = (count + 7) & ~7u;
+    address = DMA_address(address, count);
+    if (address == BAD_ADDRESS)
+        return;
+    while (count != 0) {
+        run = 0x1000 - dmem;
+        if (run > count)
+            run = count;
+        memcpy(RSP_STATE.DRAM + address, AUDIO.work + dmem, run);
+        dmem = (dmem + run) & 0xFFF;
+        address += run;
+        count -= run;
+    }
+    return;
+}
+
+/*
+ * MIXER:  dst += src * gain, in Q15 with saturation
+ */
+static void mix(unsigned int dst, unsigned int src, unsigned int count,
+    i16 gain)
+{
+    register unsigned int i;
+
+#ifdef ARCH_MIN_SSE2
+    const unsigned int d = dst & 0xFFF;
+    const unsigned int s = src & 0xFFF;
+
+    if (count % 16 == 0 && vector_span(dst, count) && vector_span(src, count)
+     && (d <= s || d >= s + 16)) { /* reads ahead of, or behind, writes */
+        const __m128i gains = _mm_set1_epi16(gain);
+
+        for (i = 0; i < count; i += 16)
+            _mm_storeu_si128(work_vector(dst + i), mix_vector(
+                _mm_loadu_si128(work_vector(dst + i)),
+                _mm_loadu_si128(work_vector(src + i)),
+                gains
+            ));
+        return;
+    }
+#endif
+    for (i = 0; i < count; i += 2)
+        WORK_SAMPLE(dst + i) = clamp_s16(
+            WORK_SAMPLE(dst + i) + ((WORK_SAMPLE(src + i) * gain) >> 15)
+        );
+    return;
+}
+
+/*
+ * INTERLEAVE:  two channels of `count' bytes each into one stereo buffer
+ */
+static void interleave(
+    unsigned int dst, unsigned int left, unsigned int right, unsigned int count)
+{
+    register unsigned int i;
+
+#ifdef ARCH_MIN_SSE2
+    const unsigned int o = dst & 0xFFF;
+    const unsigned int l = left & 0xFFF;
+    const unsigned int r = right & 0xFFF;
+
+    if (count % 16 == 0
+     && vector_span(dst, 2 * count)
+     && vector_span(left, count) && vector_span(right, count)
+     && (o + 2*count <= l || l + count <= o)
+     && (o + 2*count <= r || r + count <= o)) {
+        __m128i L, R;
+
+        for (i = 0; i < count; i += 16) {
+            L = swap_pairs(_mm_loadu_si128(work_vector(left + i)));
+            R = swap_pairs(_mm_loadu_si128(work_vector(right + i)));
+            _mm_storeu_si128(work_vector(dst + 2*i + 0), /* R0 L0 R1 L1 ... */
+                _mm_unpacklo_epi16(R, L));
+            _mm_storeu_si128(work_vector(dst + 2*i + 16),
+                _mm_unpackhi_epi16(R, L));
+        }
+        return;
+    }
+#endif
+    for (i = 0; i < count; i += 4) { /* two samples of each channel at once */
+        const i16 l0 = WORK_SAMPLE(left + i + 0);
+        const i16 l1 = WORK_SAMPLE(left + i + 2);
+        const i16 r0 = WORK_SAMPLE(right + i + 0);
+        const i16 r1 = WORK_SAMPLE(right + i + 2);
+
+        WORK_SAMPLE(dst + 2*i + 0) = l0;
+        WORK_SAMPLE(dst + 2*i + 2) = r0;
+        WORK_SAMPLE(dst + 2*i + 4) = l1;
+        WORK_SAMPLE(dst + 2*i + 6) = r1;
+    }
+    return;
+}
+
+/*
+ * ENVMIXER:  the input mixed into two or four outputs (dry and wet, left and
+ * right) with volumes ramping a step per sample, 8 samples at a time.
+ */
+typedef struct {
+    s32 value, target, step; /* Q16 */
+} ramp;
+
+static INLINE i16 ramp_step(ramp * r)
+{
+    r -> value += r -> step;
+    if ((r -> step <= 0) ? (r -> value <= r -> target)
+                         : (r -> value >= r -> target)) {
+        r -> value = r -> target;
+        r -> step = 0;
+    }
+    return (i16)(r -> value >> 16);
+}
+
+typedef struct {
+    u16 input;
+    u16 outputs[4];
+    unsigned int n; /* 2:  dry only, 4:  dry and wet */
+    int vectors; /* whether the buffers are far enough apart to vectorize */
+    ALIGNED i16 gains[4][8]; /* by LANE() */
+} envelope;
+
+static void envelope_buffers(envelope * e)
+{
+#ifdef ARCH_MIN_SSE2
+    unsigned int i, j;
+    unsigned int a, b, distance;
+
+    e -> vectors = ((e -> input & 3) == 0);
+    for (i = 0; i < e -> n; i++) {
+        e -> vectors &= ((e -> outputs[i] & 3) == 0);
+        for (j = 0; j <= i; j++) {
+            a = e -> outputs[i] & 0xFFF;
+            b = (j == i) ? e -> input & 0xFFF : e -> outputs[j] & 0xFFF;
+            distance = (a - b) & 0xFFF; /* the same, or 16 bytes apart */
+            if (distance != 0 && (distance < 16 || distance > 0x1000 - 16))
+                e -> vectors = 0;
+        }
+    }
+#else
+    e -> vectors = 0;
+#endif
+    return;
+}
+
+static void envelope_gains(envelope * e, unsigned int x, i16 l, i16 r, i16 dry,
+    i16 wet)
+{
+    e -> gains[0][LANE(x)] = clamp_s16((l * dry + 0x4000) >> 15);
+    e -> gains[1][LANE(x)] = clamp_s16((r * dry + 0x4000) >> 15);
+    e -> gains[2][LANE(x)] = clamp_s16((l * wet + 0x4000) >> 15);
+    e -> gains[3][LANE(x)] = clamp_s16((r * wet + 0x4000) >> 15);
+    return;
+}
+
+static void envelope_mix(const envelope * e, unsigned int offset)
+{
+    const unsigned int input = e -> input + offset;
+    register unsigned int i, x;
+
+#ifdef ARCH_MIN_SSE2
+    int vectors = e -> vectors && (input & 0xFFF) <= 0xFF0;
+
+    for (i = 0; i < e -> n; i++)
+        vectors &= ((e -> outputs[i] + offset) & 0xFFF) <= 0xFF0;
+    if (vectors) {
+        const __m128i src = _mm_loadu_si128(work_vector(input));
+
+        for (i = 0; i < e -> n; i++) {
+            const unsigned int output = e -> outputs[i] + offset;
+
+            _mm_storeu_si128(work_vector(output), mix_vector(
+                _mm_loadu_si128(work_vector(output)),
+                src,
+                _mm_load_si128((const __m128i *)e -> gains[i])
+            ));
+        }
+        return;
+    }
+#endif
+    for (x = 0; x < 8; x++) { /* sample by sample, in all outputs at once */
+        const i16 src = WORK_SAMPLE(input + 2*x);
+
+        for (i = 0; i < e -> n; i++) {
+            const unsigned int output = e -> outputs[i] + offset + 2*x;
+
+            WORK_SAMPLE(output) = clamp_s16(WORK_SAMPLE(output) + (
+                (src * e -> gains[i][LANE(x)]) >> 15
+            ));
+        }
+    }
+    return;
+}
+
+/*
+ * the state ENVMIXER keeps in RDRAM between lists:  ten words, ours to lay out
+ */
+#define ENVMIXER_STATE_SIZE     80
+
+static void ABI1_ENVMIXER(u32 w1, u32 w2)
+{
+    envelope e;
+    ramp ramps[2];
+    s32 exp_seq[2], exp_rate[2];
+    i16 dry, wet;
+    u32 address;
+    register unsigned int i, k, x;
+    const unsigned int flags = (w1 >> 16) & 0xFF;
+
+    address = DMA_address(segmented(w2), ENVMIXER_STATE_SIZE);
+    if (address == BAD_ADDRESS)
+        return;
+
+    dry = AUDIO.alist.dry;
+    wet = AUDIO.alist.wet;
+    if (flags & A_INIT) {
+        for (k = 0; k < 2; k++) {
+            ramps[k].value  = AUDIO.alist.vol[k] * 0x10000;
+            ramps[k].target = AUDIO.alist.target[k] * 0x10000;
+            exp_rate[k] = AUDIO.alist.rate[k];
+            exp_seq[k] = (s32)((s64)AUDIO.alist.vol[k] * AUDIO.alist.rate[k]);
+        }
+    } else {
+        const ps32 state = (ps32)(RSP_STATE.DRAM + address);
+
+        wet = (i16)state[0];
+        dry = (i16)state[1];
+        for (k = 0; k < 2; k++) {
+            ramps[k].target = state[2 + k];
+            exp_rate[k]     = state[4 + k];
+            exp_seq[k]      = state[6 + k];
+            ramps[k].value  = state[8 + k];
+        }
+    }
+    for (k = 0; k < 2; k++) /* nonzero until the ramp reaches its target */
+        ramps[k].step = ramps[k].target - ramps[k].value;
+
+    e.input = AUDIO.alist.in;
+    e.outputs[0] = AUDIO.alist.out;
+    e.outputs[1] = AUDIO.alist.dry_right;
+    e.outputs[2] = AUDIO.alist.wet_left;
+    e.outputs[3] = AUDIO.alist.wet_right;
+    e.n = (flags & A_AUX) ? 4 : 2;
+    envelope_buffers(&e);
+
+    for (i = 0; i < AUDIO.alist.count; i += 16) {
+        for (k = 0; k < 2; k++) {
+            if (ramps[k].step == 0)
+                continue;
+            exp_seq[k] = (s32)(((s64)exp_seq[k] * exp_rate[k]) >> 16);
+            ramps[k].step = (exp_seq[k] - ramps[k].value) >> 3;
+        }
+        for (x = 0; x < 8; x++) {
+            const i16 l = ramp_step(&ramps[0]);
+            const i16 r = ramp_step(&ramps[1]);
+
+            envelope_gains(&e, x, l, r, dry, wet);
+        }
+        envelope_mix(&e, i);
+    }
+
+    {
+        const ps32 state = (ps32)(RSP_STATE.DRAM + address);
+
+        state[0] = wet;
+        state[1] = dry;
+        for (k = 0; k < 2; k++) {
+            state[2 + k] = ramps[k].target;
+            state[4 + k] = exp_rate[k];
+            state[6 + k] = exp_seq[k];
+            state[8 + k] = ramps[k].value;
+        }
+    }
+    return;
+}
+
+static void NAUDIO_ENVMIXER(u32 w1, u32 w2)
+{
+    envelope e;
+    ramp ramps[2];
+    i16 dry, wet;
+    u32 address;
+    register unsigned int i, k, x;
+    const unsigned int flags = (w1 >> 16) & 0xFF;
+
+    AUDIO.alist.vol[1] = (i16)w1;
+    address = DMA_address(w2, ENVMIXER_STATE_SIZE);
+    if (address == BAD_ADDRESS)
+        return;
+
+    dry = AUDIO.alist.dry;
+    wet = AUDIO.alist.wet;
+    if (flags & A_INIT) {
+        for (k = 0; k < 2; k++) {
+            ramps[k].step   = AUDIO.alist.rate[k] / 8;
+            ramps[k].value  = AUDIO.alist.vol[k] * 0x10000;
+            ramps[k].target = AUDIO.alist.target[k] * 0x10000;
+        }
+    } else {
+        const ps32 state = (ps32)(RSP_STATE.DRAM + address);
+
+        wet = (i16)state[0];
+        dry = (i16)state[1];
+        for (k = 0; k < 2; k++) {
+            ramps[k].target = state[2 + k];
+            ramps[k].step   = state[4 + k];
+            ramps[k].value  = state[8 + k];
+        }
+    }
+
+    e.input = NAUDIO_MAIN;
+    e.outputs[0] = NAUDIO_DRY_LEFT;
+    e.outputs[1] = NAUDIO_DRY_RIGHT;
+    e.outputs[2] = NAUDIO_WET_LEFT;
+    e.outputs[3] = NAUDIO_WET_RIGHT;
+    e.n = 4;
+    envelope_buffers(&e);
+
+    for (i = 0; i < NAUDIO_COUNT; i += 16) {
+        for (x = 0; x < 8; x++) {
+            const i16 l = ramp_step(&ramps[0]);
+            const i16 r = ramp_step(&ramps[1]);
+
+            envelope_gains(&e, x, l, r, dry, wet);
+        }
+        envelope_mix(&e, i);
+    }
+
+    {
+        const ps32 state = (ps32)(RSP_STATE.DRAM + address);
+
+        state[0] = wet;
+        state[1] = dry;
+        for (k = 0; k < 2; k++) {
+            state[2 + k] = ramps[k].target;
+            state[4 + k] = ramps[k].step;
+            state[8 + k] = ramps[k].value;
+        }
+    }
+    return;
+}
+
+/*
+ * ADPCM:  frames of a header byte and 8 bytes of 4-bit residuals, decoded
+ * 16 samples at a time by an order-2 predictor from the codebook
+ *
+ *     out[i] = (in[i] << 11 + book[0][i] * out[-2] + book[1][i] * out[-1]
+ *            + sum of book[1][i - 1 - j] * in[j] for j < i) >> 11,
+ *
+ * for i < 8, then again for the second 8 samples.  That is a matrix product
+ * of the 8 inputs and 2 earlier outputs, which we keep per predictor as five
+ * pairs of columns for PMADDWD.
+ */
+#ifdef ARCH_MIN_SSE2
+static i16 ADPCM_coefficient(const i16 * book, unsigned int i, unsigned int j)
+{
+    if (j >= 8) /* the two earlier outputs */
+        return book[(j - 8) * 8 + i];
+    if (j == i)
+        return 2048;
+    return (j < i) ? book[8 + i - 1 - j] : 0;
+}
+
+static void prepare_ADPCM_columns(void)
+{
+    register unsigned int entry, pair, lane;
+
+    for (entry = 0; entry < 16; entry++)
+        for (pair = 0; pair < 5; pair++)
+            for (lane = 0; lane < 8; lane++) {
+                const unsigned int i = lane / 2 % 4;
+                const unsigned int j = 2*pair + lane % 2;
+                const i16 * book = AUDIO.ADPCM_book[entry];
+
+                AUDIO.ADPCM_columns[entry][2*pair + 0][lane] =
+                    ADPCM_coefficient(book, i + 0, j);
+                AUDIO.ADPCM_columns[entry][2*pair + 1][lane] =
+                    ADPCM_coefficient(book, i + 4, j);
+            }
+    AUDIO.ADPCM_columns_ready = 1;
+    return;
+}
+
+static void ADPCM_residuals(pi16 dst, const i16* src, unsigned int entry,
+    i16 l1, i16 l2)
+{
+    const __m128i * columns = (const __m128i *)AUDIO.ADPCM_columns[entry];
+    const __m128i x = _mm_loadu_si128((const __m128i *)src);
+    __m128i pair, lo, hi;
+
+    pair = _mm_shuffle_epi32(x, _MM_SHUFFLE(0, 0, 0, 0));
+    lo = _mm_madd_epi16(columns[0], pair);
+    hi = _mm_madd_epi16(columns[1], pair);
+    pair = _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 1, 1, 1));
+    lo = _mm_add_epi32(lo, _mm_madd_epi16(columns[2], pair));
+    hi = _mm_add_epi32(hi, _mm_madd_epi16(columns[3], pair));
+    pair = _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 2, 2, 2));
+    lo = _mm_add_epi32(lo, _mm_madd_epi16(columns[4], pair));
+    hi = _mm_add_epi32(hi, _mm_madd_epi16(columns[5], pair));
+    pair = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+    lo = _mm_add_epi32(lo, _mm_madd_epi16(columns[6], pair));
+    hi = _mm_add_epi32(hi, _mm_madd_epi16(columns[7], pair));
+    pair = _mm_set1_epi32((int)((u32)(u16)l1 | (u32)(u16)l2 << 16));
+    lo = _mm_add_epi32(lo, _mm_madd_epi16(columns[8], pair));
+    hi = _mm_add_epi32(hi, _mm_madd_epi16(columns[9], pair));
+    _mm_storeu_si128((__m128i *)dst, _mm_packs_epi32(
+        _mm_srai_epi32(lo, 11),
+        _mm_srai_epi32(hi, 11)
+    ));
+    return;
+}
+#else
+static void ADPCM_residuals(pi16 dst, const i16* src, unsigned int entry,
+    i16 l1, i16 l2)
+{
+    const i16 * book1 = &AUDIO.ADPCM_book[entry][0];
+    const i16 * book2 = &AUDIO.ADPCM_book[entry][8];
+    s32 accumulator;
+    register unsigned int i, j;
+
+    for (i = 0; i < 8; i++) {
+        accumulator = src[i] * 2048 + book1[i] * l1 + book2[i] * l2;
+        for (j = 0; j < i; j++)
+            accumulator += book2[i - 1 - j] * src[j];
+        dst[i] = clamp_s16(accumulator >> 11);
+    }
+    return;
+}
+#endif
+
+static void ADPCM(int init, int loop, unsigned int dst, unsigned int src,
+    unsigned int count, u32 loop_address, u32 state_address)
+{
+    ALIGNED i16 last[16];
+    ALIGNED i16 frame[16];
+    register unsigned int i;
+
+    state_address = DMA_address(state_address, 32);
+    if (state_address == BAD_ADDRESS)
+        return;
+    if (init) {
+        memset(last, 0, sizeof(last));
+    } else {
+        const u32 address =
+            loop ? DMA_address(loop_address, 32) : state_address;
+
+        if (address == BAD_ADDRESS)
+            return;
+        for (i = 0; i < 16; i++)
+            last[i] = RDRAM_half(address + 2*i);
+    }
+#ifdef ARCH_MIN_SSE2
+    if (!AUDIO.ADPCM_columns_ready)
+        prepare_ADPCM_columns();
+#endif
+
+    store_samples(dst, last, 16);
+    dst += 32;
+    for (; count >= 32; count -= 32) {
+        const unsigned int code = WORK_BYTE(src++);
+        const unsigned int scale = code >> 4;
+        const unsigned int shift = (scale < 12) ? 12 - scale : 0;
+
+        for (i = 0; i < 16; i += 2) {
+            const unsigned int byte = WORK_BYTE(src++);
+
+            frame[i + 0] = (i16)((byte & 0xF0) << 8) >> shift;
+            frame[i + 1] = (i16)((byte & 0x0F) << 12) >> shift;
+        }
+        ADPCM_residuals(&last[0], &frame[0], code & 0xF, last[14], last[15]);
+        ADPCM_residuals(&last[8], &frame[8], code & 0xF, last[6], last[7]);
+        store_samples(dst, last, 16);
+        dst += 32;
+    }
+
+    for (i = 0; i < 16; i++)
+        store_RDRAM_half(state_address + 2*i, last[i]);
+    return;
+}
+
+static void load_ADPCM_book(u32 address, unsigned int count)
+{
+    pi16 book = &AUDIO.ADPCM_book[0][0];
+    register unsigned int i;
+
+    if (count > sizeof(AUDIO.ADPCM_book) / sizeof(i16))
+        count = sizeof(AUDIO.ADPCM_book) / sizeof(i16);
+    address = DMA_address(address, 2 * count);
+    if (address == BAD_ADDRESS)
+        return;
+    for (i = 0; i < count; i++)
+        book[i] = RDRAM_half(address + 2*i);
+    AUDIO.ADPCM_columns_ready = 0;
+    return;
+}
+
+/*
+ * RESAMPLE:  4-tap filter at a Q16 input position stepping by `pitch' per
+ * output sample, the phase picking one of 64 rows of filter taps
+ */
+#ifdef ARCH_MIN_SSE2
+/*
+ * the four sums of the pairs in `a' then in `b', from PMADDWD
+ */
+static INLINE __m128i add_halves(__m128i a, __m128i b)
+{
+    const __m128 x = _mm_castsi128_ps(a);
+    const __m128 y = _mm_castsi128_ps(b);
+
+    return _mm_add_epi32(
+        _mm_castps_si128(_mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0))),
+        _mm_castps_si128(_mm_shuffle_ps(x, y, _MM_SHUFFLE(3, 1, 3, 1)))
+    );
+}
+#endif
+
+static void resample(int init, unsigned int dst, unsigned int src,
+    unsigned int count, u32 pitch, u32 address)
+{
+    u32 accumulator;
+    unsigned int input, output;
+    register unsigned int i, k;
+
+    address = DMA_address(address, 16);
+    if (address == BAD_ADDRESS)
+        return;
+    input = ((src >> 1) - 4) & 0x7FF; /* starts on the 4 samples saved */
+    output = (dst >> 1) & 0x7FF;
+    count >>= 1;
+
+    if (init) {
+        for (k = 0; k < 4; k++)
+            WORK_SAMPLE(2 * (input + k)) = 0;
+        accumulator = 0;
+    } else {
+        for (k = 0; k < 4; k++)
+            WORK_SAMPLE(2 * (input + k)) = RDRAM_half(address + 2*k);
+        accumulator = (u16)RDRAM_half(address + 8);
+    }
+
+#ifdef ARCH_MIN_SSE2
+    if (count <= 2048 && count % 8 == 0 && vector_span(2 * output, 2 * count)) {
+        const unsigned int first = input;
+        unsigned int span;
+
+        for (i = 0; i < count; i++) {
+            AUDIO.resample_position[i] = (u16)(input - first);
+            AUDIO.resample_phase[i] = (u8)((accumulator & 0xFC00) >> 10);
+            accumulator += pitch;
+            input += accumulator >> 16;
+            accumulator &= 0xFFFF;
+        }
+        span = input + 4 - first;
+        if (span <= 4096
+         && (2*first + 2*span <= 2*output || 2*output + 2*count <= 2*first)
+         && 2*first + 2*span <= 0x1000) {
+            for (k = 0; k < span; k++)
+                AUDIO.resample_input[k] = WORK_SAMPLE(2 * (first + k));
+            for (i = 0; i < count; i += 8) {
+                __m128i dot[4];
+
+                for (k = 0; k < 4; k++) {
+                    const unsigned int j = i + 2*k;
+                    const i16 * x0 =
+                        &AUDIO.resample_input[AUDIO.resample_position[j + 0]];
+                    const i16 * x1 =
+                        &AUDIO.resample_input[AUDIO.resample_position[j + 1]];
+                    const i16 * h0 =
+                        AUDIO.resample_filter[AUDIO.resample_phase[j + 0]];
+                    const i16 * h1 =
+                        AUDIO.resample_filter[AUDIO.resample_phase[j + 1]];
+
+                    dot[k] = _mm_madd_epi16(
+                        _mm_unpacklo_epi64(
+                            _mm_loadl_epi64((const __m128i *)x0),
+                            _mm_loadl_epi64((const __m128i *)x1)
+                        ),
+                        _mm_unpacklo_epi64(
+                            _mm_loadl_epi64((const __m128i *)h0),
+                            _mm_loadl_epi64((const __m128i *)h1)
+                        )
+                    );
+                }
+                dot[0] = add_halves(dot[0], dot[1]);
+                dot[1] = add_halves(dot[2], dot[3]);
+                _mm_storeu_si128(work_vector(2 * (output + i)), swap_pairs(
+                    _mm_packs_epi32(
+                        _mm_srai_epi32(dot[0], 15),
+                        _mm_srai_epi32(dot[1], 15)
+                    )
+                ));
+            }
+            input &= 0x7FF;
+            goto save;
+        }
+        input = first; /* too far apart or overlapping:  start over */
+        accumulator = (init) ? 0 : (u16)RDRAM_half(address + 8);
+    }
+#endif
+    for (i = 0; i < count; i++) {
+        const i16 * taps = AUDIO.resample_filter[(accumulator & 0xFC00) >> 10];
+        s32 sum = 0;
+
+        for (k = 0; k < 4; k++)
+            sum += WORK_SAMPLE(2 * (input + k)) * taps[k];
+        WORK_SAMPLE(2 * (output + i)) = clamp_s16(sum >> 15);
+        accumulator += pitch;
+        input = (input + (accumulator >> 16)) & 0x7FF;
+        accumulator &= 0xFFFF;
+    }
+#ifdef ARCH_MIN_SSE2
+save:
+#endif
+    for (k = 0; k < 4; k++)
+        store_RDRAM_half(address + 2*k, WORK_SAMPLE(2 * (input + k)));
+    store_RDRAM_half(address + 8, (i16)accumulator);
+    return;
+}
+
+/*
+ * the ABI1 command set
+ */
+static void ABI1_SPNOOP(u32 w1, u32 w2)
+{
+    return;
+}
+static void ABI1_ADPCM(u32 w1, u32 w2)
+{
+    const unsigned int flags = (w1 >> 16) & 0xFF;
+
+    ADPCM(flags & A_INIT, flags & A_LOOP, AUDIO.alist.out, AUDIO.alist.in,
+        (AUDIO.alist.count + 31) & ~31, AUDIO.alist.loop, segmented(w2));
+    return;
+}
+static void ABI1_CLEARBUFF(u32 w1, u32 w2)
+{
+    const u16 dmem = (u16)(w1 + ABI1_DMEM_BASE);
+    const unsigned int count = w2 & 0xFFF;
+
+    clear_work(dmem, (count + 15) & ~15u);
+    return;
+}
+static void ABI1_LOADBUFF(u32 w1, u32 w2)
+{
+    if (AUDIO.alist.count != 0)
+        load_work(AUDIO.alist.in, segmented(w2), AUDIO.alist.count);
+    return;
+}
+static void ABI1_RESAMPLE(u32 w1, u32 w2)
+{
+    const unsigned int flags = (w1 >> 16) & 0xFF;
+    const u32 pitch = (w1 & 0xFFFF) << 1;
+
+    resample(flags & A_INIT, AUDIO.alist.out, AUDIO.alist.in,
+        (AUDIO.alist.count + 15) & ~15, pitch, segmented(w2));
+    return;
+}
+static void ABI1_SAVEBUFF(u32 w1, u32 w2)
+{
+    if (AUDIO.alist.count != 0)
+        save_work(AUDIO.alist.out, segmented(w2), AUDIO.alist.count);
+    return;
+}
+static void ABI1_SEGMENT(u32 w1, u32 w2)
+{
+    const unsigned int segment = (w2 >> 24) & 0x3F;
+
+    if (segment < 16)
+        AUDIO.alist.segments[segment] = w2 & 0x00FFFFFFul;
+    return;
+}
+static void ABI1_SETBUFF(u32 w1, u32 w2)
+{
+    const unsigned int flags = (w1 >> 16) & 0xFF;
+
+    if (flags & A_AUX) {
+        AUDIO.alist.dry_right = (u16)(w1 + ABI1_DMEM_BASE);
+        AUDIO.alist.wet_left  = (u16)((w2 >> 16) + ABI1_DMEM_BASE);
+        AUDIO.alist.wet_right = (u16)(w2 + ABI1_DMEM_BASE);
+    } else {
+        AUDIO.alist.in    = (u16)(w1 + ABI1_DMEM_BASE);
+        AUDIO.alist.out   = (u16)((w2 >> 16) + ABI1_DMEM_BASE);
+        AUDIO.alist.count = (u16)w2;
+    }
+    return;
+}
+static void ABI1_SETVOL(u32 w1, u32 w2)
+{
+    const unsigned int flags = (w1 >> 16) & 0xFF;
+    const unsigned int right = (flags & A_LEFT) ? 0 : 1;
+
+    if (flags & A_AUX) {
+        AUDIO.alist.dry = (i16)w1;
+        AUDIO.alist.wet = (i16)w2;
+    } else if (flags & A_VOL) {
+        AUDIO.alist.vol[right] = (i16)w1;
+    } else {
+        AUDIO.alist.target[right] = (i16)w1;
+        AUDIO.alist.rate[right] = (s32)w2;
+    }
+    return;
+}
+static void ABI1_DMEMMOVE(u32 w1, u32 w2)
+{
+    const u16 src = (u16)(w1 + ABI1_DMEM_BASE);
+    const u16 dst = (u16)((w2 >> 16) + ABI1_DMEM_BASE);
+    const unsigned int count = w2 & 0xFFFF;
+
+    move_work(dst, src, (count + 15) & ~15u);
+    return;
+}
+static void ABI1_LOADADPCM(u32 w1, u32 w2)
+{
+    const unsigned int count = w1 & 0xFFFF;
+
+    load_ADPCM_book(segmented(w2), ((count + 7) & ~7u) >> 1);
+    return;
+}
+static void ABI1_MIXER(u32 w1, u32 w2)
+{
+    const u16 src = (u16)((w2 >> 16) + ABI1_DMEM_BASE);
+    const u16 dst = (u16)(w2 + ABI1_DMEM_BASE);
+
+    if (AUDIO.alist.count != 0)
+        mix(dst, src, (AUDIO.alist.count + 31) & ~31u, (i16)w1);
+    return;
+}
+static void ABI1_INTERLEAVE(u32 w1, u32 w2)
+{
+    const u16 left  = (u16)((w2 >> 16) + ABI1_DMEM_BASE);
+    const u16 right = (u16)(w2 + ABI1_DMEM_BASE);
+
+    if (AUDIO.alist.count != 0)
+        interleave(AUDIO.alist.out, left, right,
+            (AUDIO.alist.count + 15) & ~15u);
+    return;
+}
+static void ABI1_SETLOOP(u32 w1, u32 w2)
+{
+    AUDIO.alist.loop = segmented(w2);
+    return;
+}
+
+/*
+ * the NAudio command set:  fixed buffers and no segments
+ */
+static void NAUDIO_ADPCM(u32 w1, u32 w2)
+{
+    const unsigned int flags = w2 >> 28;
+    const unsigned int count = (w2 >> 16) & 0xFFF;
+
+    ADPCM(flags & A_INIT, flags & A_LOOP,
+        (w2 & 0xFFF) + NAUDIO_MAIN, ((w2 >> 12) & 0xF) + NAUDIO_MAIN,
+        (count + 31) & ~31u, AUDIO.alist.loop, w1 & 0x00FFFFFFul);
+    return;
+}
+static void NAUDIO_CLEARBUFF(u32 w1, u32 w2)
+{
+    clear_work((u16)(w1 + NAUDIO_MAIN), w2 & 0xFFF);
+    return;
+}
+static void NAUDIO_LOADBUFF(u32 w1, u32 w2)
+{
+    load_work((w1 & 0xFFF) + NAUDIO_MAIN, w2 & 0x00FFFFFFul,
+        (w1 >> 12) & 0xFFF);
+    return;
+}
+static void NAUDIO_RESAMPLE(u32 w1, u32 w2)
+{
+    const unsigned int flags = w2 >> 30;
+    const u32 pitch = ((w2 >> 14) & 0xFFFF) << 1;
+
+    resample(flags & A_INIT, (w2 & 0x3) ? NAUDIO_MAIN2 : NAUDIO_MAIN,
+        ((w2 >> 2) & 0xFFF) + NAUDIO_MAIN, NAUDIO_COUNT, pitch,
+        w1 & 0x00FFFFFFul);
+    return;
+}
+static void NAUDIO_SAVEBUFF(u32 w1, u32 w2)
+{
+    save_work((w1 & 0xFFF) + NAUDIO_MAIN, w2 & 0x00FFFFFFul,
+        (w1 >> 12) & 0xFFF);
+    return;
+}
+static void NAUDIO_SETVOL(u32 w1, u32 w2)
+{
+    const unsigned int flags = (w1 >> 16) & 0xFF;
+
+    if (!(flags & A_VOL)) {
+        AUDIO.alist.target[0] = (i16)w1;
+        AUDIO.alist.rate[0] = (s32)w2;
+    } else if (flags & A_LEFT) {
+        AUDIO.alist.vol[0] = (i16)w1;
+        AUDIO.alist.dry = (i16)(w2 >> 16);
+        AUDIO.alist.wet = (i16)w2;
+    } else {
+        AUDIO.alist.target[1] = (i16)w1;
+        AUDIO.alist.rate[1] = (s32)w2;
+    }
+    return;
+}
+static void NAUDIO_DMEMMOVE(u32 w1, u32 w2)
+{
+    const u16 src = (u16)(w1 + NAUDIO_MAIN);
+    const u16 dst = (u16)((w2 >> 16) + NAUDIO_MAIN);
+    const unsigned int count = w2 & 0xFFFF;
+
+    move_work(dst, src, (count + 3) & ~3u);
+    return;
+}
+static void NAUDIO_LOADADPCM(u32 w1, u32 w2)
+{
+    load_ADPCM_book(w2 & 0x00FFFFFFul, (w1 & 0xFFFF) >> 1);
+    return;
+}
+static void NAUDIO_MIXER(u32 w1, u32 w2)
+{
+    mix((u16)(w2 + NAUDIO_MAIN), (u16)((w2 >> 16) + NAUDIO_MAIN),
+        NAUDIO_COUNT, (i16)w1);
+    return;
+}
+static void NAUDIO_INTERLEAVE(u32 w1, u32 w2)
+{
+    interleave(NAUDIO_MAIN, NAUDIO_DRY_LEFT, NAUDIO_DRY_RIGHT, NAUDIO_COUNT);
+    return;
+}
+static void NAUDIO_02B0(u32 w1, u32 w2)
+{
+    AUDIO.alist.rate[1] =
+        (s32)(((u32)AUDIO.alist.rate[1] & 0xFFFF0000ul) | (w2 & 0xFFFF));
+    return;
+}
+static void NAUDIO_SETLOOP(u32 w1, u32 w2)
+{
+    AUDIO.alist.loop = w2 & 0x00FFFFFFul;
+    return;
+}
+
+typedef void(*p_acmd)(u32 w1, u32 w2);
+
+static const p_acmd ABI1_commands[16] = {
+    ABI1_SPNOOP,    ABI1_ADPCM,     ABI1_CLEARBUFF, ABI1_ENVMIXER,
+    ABI1_LOADBUFF,  ABI1_RESAMPLE,  ABI1_SAVEBUFF,  ABI1_SEGMENT,
+    ABI1_SETBUFF,   ABI1_SETVOL,    ABI1_DMEMMOVE,  ABI1_LOADADPCM,
+    ABI1_MIXER,     ABI1_INTERLEAVE, NULL /* POLEF */, ABI1_SETLOOP,
+};
+
+static const p_acmd NAUDIO_commands[16] = {
+    ABI1_SPNOOP,      NAUDIO_ADPCM,     NAUDIO_CLEARBUFF, NAUDIO_ENVMIXER,
+    NAUDIO_LOADBUFF,  NAUDIO_RESAMPLE,  NAUDIO_SAVEBUFF,  NULL,
+    NULL,             NAUDIO_SETVOL,    NAUDIO_DMEMMOVE,  NAUDIO_LOADADPCM,
+    NAUDIO_MIXER,     NAUDIO_INTERLEAVE, NAUDIO_02B0,     NAUDIO_SETLOOP,
+};
+
+/*
+ * Whether we can run command (w1, w2) at all.  Commands left NULL above,
+ * and resampling with flag 2, which no known list uses, mean LLE.  So do
+ * NAudio's INTERLEAVE (fixed buffers), 02B0 and SETLOOP with any operand
+ * bits set that we don't read:  We don't know what the micro-code makes of
+ * them.
+ */
+static int emulated(const p_acmd * commands, u32 w1, u32 w2)
+{
+    const unsigned int command = (w1 >> 24) & 0x7F;
+
+    if (command >= 16 || commands[command] == NULL)
+        return 0;
+    if (commands == ABI1_commands && command == 5)
+        return !(w1 & 0x00020000ul);
+    if (commands == NAUDIO_commands)
+        switch (command) {
+        case 5: /* RESAMPLE */
+            return !(w2 & 0x80000000ul);
+        case 13: /* INTERLEAVE */
+            return (w1 & 0x00FFFFFFul) == 0 && w2 == 0;
+        case 14: /* 02B0 */
+            return (w1 & 0x00FFFFFFul) == 0 && (w2 & 0xFFFF0000ul) == 0;
+        case 15: /* SETLOOP */
+            return (w1 & 0x00FFFFFFul) == 0;
+        }
+    return 1;
+}
+
+void classify_audio_ucode(ucode_info * info, u32 data, u32 data_size)
+{
+    register u32 i;
+    register unsigned int k;
+
+    info -> audio_ABI = AUDIO_ABI_NONE;
+    info -> resample_table = 0;
+
+    data &= 0x00FFFFF8ul;
+    if (data_size > 0x1000)
+        data_size = 0x1000;
+    if (data_size < 0x40 || !in_RDRAM(data, data_size))
+        return;
+
+/*
+ * The command jump tables, by the entry points of a few of the commands.
+ */
+    if (*(pu32)(RSP_STATE.DRAM + data) == 0x00000001) {
+        if (*(pu32)(RSP_STATE.DRAM + data + 0x30) == 0xF0000F00ul
+         && *(pu32)(RSP_STATE.DRAM + data + 0x28) == 0x1E24138Cul)
+            info -> audio_ABI = AUDIO_ABI1;
+    } else {
+        if (*(pu32)(RSP_STATE.DRAM + data + 0x10) == 0x0000127Cul)
+            info -> audio_ABI = AUDIO_NAUDIO;
+    }
+    if (info -> audio_ABI == AUDIO_ABI_NONE)
+        return;
+
+    for (i = 0; i + sizeof(AUDIO.resample_filter) <= data_size; i += 8) {
+        for (k = 0; k < 8; k++)
+            if (RDRAM_half(data + i + 2*k) != resample_filter_start[k])
+                break;
+        if (k == 8) {
+            info -> resample_table = data + i;
+            return;
+        }
+    }
+    info -> audio_ABI = AUDIO_ABI_NONE; /* no filter taps:  can't resample */
+    return;
+}
+
+int process_audio_list(void)
+{
+    const p_acmd * commands;
+    u32 list, size;
+    register u32 i;
+
+    switch (RSP_STATE.current_ucode -> audio_ABI) {
+    case AUDIO_ABI1:
+        commands = ABI1_commands;
+        break;
+    case AUDIO_NAUDIO:
+        commands = NAUDIO_commands;
+        break;
+    default:
+        return 0;
+    }
+
+    list = *(pu32)(RSP_STATE.DMEM + OSTASK_DATA_PTR) & 0x00FFFFF8ul;
+    size = *(pu32)(RSP_STATE.DMEM + OSTASK_DATA_SIZE) & ~7ul;
+    if (!in_RDRAM(list, size))
+        return 0;
+    for (i = 0; i < size; i += 8)
+        if (!emulated(commands, *(pu32)(RSP_STATE.DRAM + list + i + 0),
+                                *(pu32)(RSP_STATE.DRAM + list + i + 4)))
+            return 0;
+
+    if (AUDIO.resample_filter_owner != RSP_STATE.current_ucode -> hash) {
+        for (i = 0; i < 64 * 4; i++)
+            AUDIO.resample_filter[i / 4][i % 4] =
+                RDRAM_half(RSP_STATE.current_ucode -> resample_table + 2*i);
+        AUDIO.resample_filter_owner = RSP_STATE.current_ucode -> hash;
+    }
+    memset(AUDIO.alist.segments, 0, sizeof(AUDIO.alist.segments));
+    for (i = 0; i < size; i += 8) {
+        const u32 w1 = *(pu32)(RSP_STATE.DRAM + list + i + 0);
+        const u32 w2 = *(pu32)(RSP_STATE.DRAM + list + i + 4);
+
+        commands[(w1 >> 24) & 0x7F](w1, w2);
+    }
+    return 1;
+}
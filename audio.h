@@ -0,0 +1,91 @@
+/******************************************************************************\
+* Project:  High-Level Emulation of Audio Lists                                *
+* Authors:  agent                                                              *
+* Release:  2026.10.18                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+
+#ifndef _AUDIO_H_
+#define _AUDIO_H_
+
+#include "ucode.h"
+
+/*
+ * With the "BuiltInAudioHLE" setting on, audio tasks whose micro-code we know
+ * have their command lists run here, command by command, on a private copy
+ * of the DMEM work area, instead of having the RSP interpret the micro-code.
+ * Everything else, including any list with a command we don't emulate, is
+ * left to the interpreter (LLE) as before.  `tests/audio.c' checks a list
+ * against LLE, from a dump of its task.
+ */
+typedef enum {
+    AUDIO_ABI_NONE, /* not one we know, ABI2 and MusyX among them:  LLE */
+    AUDIO_ABI1, /* Nintendo's original "aspMain" audio micro-code */
+    AUDIO_NAUDIO, /* the "n_aspMain" micro-code of the newer audio library */
+
+    NUMBER_OF_AUDIO_ABIS
+} audio_ABI;
+
+/*
+ * what each RSP (`RSP_STATE.audio') keeps between and within audio lists
+ */
+typedef struct CACHE_ALIGNED audio_state {
+    ALIGNED u8 work[0x1000]; /* the DMEM the micro-code would have worked in */
+
+/*
+ * what the micro-code keeps in DMEM from one command to the next
+ */
+    struct {
+        u32 segments[16]; /* ABI1 */
+        u16 in, out, count;
+        u16 dry_right, wet_left, wet_right;
+        i16 dry, wet;
+        i16 vol[2], target[2];
+        s32 rate[2];
+        u32 loop;
+    } alist;
+
+    ALIGNED i16 ADPCM_book[16][16]; /* [predictor][order * 8 + tap] */
+    int ADPCM_columns_ready; /* 0:  `ADPCM_book' changed since they were made */
+
+    ALIGNED i16 resample_filter[64][4];
+    u32 resample_filter_owner; /* `hash' of the micro-code it's from */
+
+#ifdef ARCH_MIN_SSE2
+    ALIGNED i16 ADPCM_columns[16][10][8]; /* [predictor][pair][lanes] */
+    ALIGNED i16 resample_input[4096 + 16];
+    u16 resample_position[2048];
+    u8 resample_phase[2048];
+#endif
+} audio_state;
+
+/*
+ * the audio state of `RSP_state' (others have theirs from new_RSP_context())
+ */
+extern audio_state RSP_state_audio;
+
+/*
+ * Works out the command set of an audio micro-code from its data segment,
+ * which starts with the micro-code's command jump table, and finds the
+ * resampling filter table in there as well.  Called by identify_ucode() on
+ * the first task with each micro-code.
+ */
+extern void classify_audio_ucode(ucode_info * info, u32 data, u32 data_size);
+
+/*
+ * Runs the audio list of the OSTask in DMEM for the current micro-code.
+ * Returns zero, having touched nothing, if the micro-code is unknown or the
+ * list has a command we can't emulate; the caller should run the task LLE.
+ */
+extern int process_audio_list(void);
+
+#endif
@@ -0,0 +1,198 @@
+/******************************************************************************\
+* Project:  RSP Machine State Context                                          *
+* Authors:  agent                                                              *
+* Release:  2026.10.18                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+#ifndef _CONTEXT_H_
+#define _CONTEXT_H_
+
+#include "my_types.h"
+
+/*
+ * Define this to keep a pointer to the RSP being emulated per host thread,
+ * so that independent RSPs (one per emulator session) may run side by side
+ * from different threads.  Otherwise there is just the one RSP, and all of
+ * its state is at fixed addresses, as if it were all separate globals.
+ */
+#if (0)
+#define RSP_CONTEXT_PER_THREAD
+#endif
+
+/*
+ * the RSP_INFO (memory and RCP register pointers) of the current RSP
+ */
+#define RSP_INFO_NAME           (RSP_STATE.info)
+#define GET_RSP_INFO(member)    ((RSP_INFO_NAME).member)
+#define GET_RCP_REG(member)     (*(RSP_INFO_NAME).member)
+#include "rsp.h"
+
+#define N       8
+/* N:  number of processor elements in SIMD processor */
+
+/*
+ * Illegal, unaligned LWC2 operations on the RSP may write past the terminal
+ * byte of a vector, while SWC2 operations may have to wrap around stores
+ * from the end to the start of a vector.  Both of these risk out-of-bounds
+ * memory access, but by doubling the number of bytes allocated (shift left)
+ * per each vector register, we could stabilize and probably optimize this.
+ */
+#if 0
+#define VR_STATIC_WRAPAROUND    0
+#else
+#define VR_STATIC_WRAPAROUND    1
+#endif
+
+struct decoded_op;
+struct ucode_info;
+struct ucode_registry;
+struct audio_state;
+
+/*
+ * a block of recompiled code:  returns how many instructions it ran
+ */
+typedef unsigned int(*p_block)(void);
+
+/*
+ * everything one RSP needs to run a task, other than the plug-in settings
+ *
+ * Whatever is touched on every instruction goes first, vectors aligned for
+ * SSE2 loads and the whole thing to a cache line.
+ */
+typedef struct CACHE_ALIGNED {
+    struct decoded_op * IMEM_decoded; /* [4096 / 4], pre-decoded IMEM */
+
+/*
+ * RSP virtual registers (of vector unit)
+ * The most important are the 32 general-purpose vector registers.
+ * The correct way to accurately store these is using big-endian vectors.
+ *
+ * For ?WC2 we may need to do byte-precision access just as directly.
+ * This is amended by using the `VU_S` and `VU_B` macros defined in `rsp.h`.
+ */
+    ALIGNED i16 VR[32][N << VR_STATIC_WRAPAROUND];
+
+/*
+ * The RSP accumulator is a vector of 3 48-bit integers.  Nearly all of the
+ * vector operations access it, but it's for multiply-accumulate operations.
+ *
+ * Access dimensions would be VACC[8][3] but are inverted for SIMD benefits.
+ * With `WIDE_ACCUMULATOR' (vu.h), the high and middle planes hold one i32.
+ */
+    ALIGNED i16 VACC[3][N];
+
+/*
+ * the vector unit flags, one lane mask (0x0000 or 0xFFFF) per element
+ *
+ * Masks, not 0 or 1, so that the compares and selects which make and use
+ * them need no conversions, and CFC2 is just PACKSSWB and PMOVMSKB.  The
+ * five of them are kept together as one aligned 80-byte block.
+ */
+    ALIGNED i16 cf_ne[N]; /* $vco:  high "NOTEQUAL" */
+    ALIGNED i16 cf_co[N]; /* $vco:  low "carry/borrow in/out" */
+    ALIGNED i16 cf_clip[N]; /* $vcc:  high (clip tests:  VCL, VCH, VCR) */
+    ALIGNED i16 cf_comp[N]; /* $vcc:  low (VEQ, VNE, VLT, VGE, VCL, VCH, VCR) */
+    ALIGNED i16 cf_vce[N]; /* $vce:  vector compare extension register */
+
+/*
+ * When compiling without SSE2 or vector extensions (`vu.h'), we need to use
+ * a pointer to a destination vector instead of a vector register in the
+ * return slot of the function.
+ * The vector "result" register will be emulated to serve this pointer
+ * rather than the return slot of a function call.
+ */
+    ALIGNED i16 V_result[N];
+    ALIGNED i16 shuffle_temporary[N];
+
+/*
+ * general-purpose scalar registers
+ *
+ * based on the MIPS instruction set architecture but without most of the
+ * original register names (for example, no kernel-reserved registers)
+ */
+    u32 SR[32];
+    pu32 CR[16]; /* pointers to the RCP registers as system control regs */
+
+/*
+ * We are going to need this for vector operations doing scalar things.
+ * The divides and VSAW need bit-wise information from the instruction word.
+ */
+    u32 inst_word;
+    int temp_PC;
+    int stage; /* only without EMULATE_STATIC_PC */
+
+    s32 DivIn; /* buffered numerator of division read from vector file */
+    s32 DivOut; /* global division result set by VRCP/VRCPL/VRSQ/VRSQL */
+
+/*
+ * Boolean flag:  Double-precision high was the last vector divide op?
+ *
+ * if (lastDivideOp == VRCP, VRCPL, VRSQ, VRSQL)
+ *     DPH = false; // single-precision or double-precision low, not high
+ * else if (lastDivideOp == VRCPH, VRSQH)
+ *     DPH = true; // double-precision high
+ * else if (lastDivideOp == VMOV, VNOP)
+ *     DPH = DPH; // no change--divide-group ops but not real divides
+ */
+    int DPH;
+
+    short MFC0_count[32]; /* C0 MF status read count per scalar register */
+    int MF_SP_STATUS_TIMEOUT;
+
+    RSP_INFO info;
+    pu8 DRAM; /* RDRAM */
+    pu8 DMEM;
+    pu8 IMEM;
+    unsigned long su_max_address; /* RDRAM size - 1 */
+
+    p_block IMEM_blocks[4096 / 4]; /* recompiler */
+    pu8 code_cache;
+    pu8 emit_ptr;
+    unsigned int dead_writes; /* `dead' of the op being compiled */
+
+    void (*GBI_phase)(void); /* RSP_INFO's ProcessRdpList, or no_LLE() */
+
+/*
+ * the micro-codes seen (`ucode.h') and the one the current task runs, and the
+ * state of audio list HLE (`audio.h')
+ */
+    struct ucode_registry * ucodes;
+    const struct ucode_info * current_ucode;
+    struct audio_state * audio;
+
+    void * allocation; /* from malloc(), if made by new_RSP_context() */
+} rsp_context;
+
+/*
+ * All of the above is reached through `RSP_STATE', as in `RSP_STATE.VR[vt]',
+ * whether there is one RSP or one per thread.
+ */
+extern rsp_context RSP_state;
+#ifdef RSP_CONTEXT_PER_THREAD
+extern THREAD_LOCAL rsp_context * current_RSP; /* initially &RSP_state */
+#define RSP_STATE       (*current_RSP)
+#else
+#define RSP_STATE       (RSP_state)
+#endif
+
+#ifdef RSP_CONTEXT_PER_THREAD
+/*
+ * RSPs besides `RSP_state', for running more than one at once.  A thread
+ * selects the RSP it emulates with use_RSP_context(), after which the RSP
+ * is set up the usual way, with InitiateRSP().
+ */
+extern rsp_context * new_RSP_context(void);
+extern void free_RSP_context(rsp_context * RSP);
+extern void use_RSP_context(rsp_context * RSP);
+#endif
+
+#endif
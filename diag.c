@@ -0,0 +1,300 @@
+/******************************************************************************\
+* Project:  Non-Blocking Diagnostic Message Ring                               *
+* Authors:  agent                                                              *
+* Release:  2026.10.18                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <windows.h>
+#endif
+
+#include "diag.h"
+
+/*
+ * message slots in the ring (a power of two), and bytes of text per message
+ */
+#define MESSAGE_RING_SIZE   64
+#define MESSAGE_LENGTH      120
+
+/*
+ * Each call site gets its first `MESSAGE_BURST' messages through, then only
+ * its 8th, 16th, 32nd, ... so that one looping micro-code can't flood us.
+ */
+#define MESSAGE_BURST       4
+#define MESSAGE_SITES       128
+
+typedef struct {
+    u32 sequence; /* which pass through the ring may use the slot next */
+    u32 count; /* the call site's count as of this message */
+    char text[MESSAGE_LENGTH];
+} message_slot;
+
+typedef struct {
+    const char * body; /* the call site, NULL while the entry is unused */
+    u32 count; /* calls to message() from the site */
+    u32 shown; /* `count' as of the last message that made it into the ring */
+} message_site;
+
+static message_slot ring[MESSAGE_RING_SIZE];
+static u32 ring_head; /* next position to claim, by any thread */
+static u32 ring_tail; /* next position to drain */
+static u32 ring_draining;
+
+static message_site sites[MESSAGE_SITES];
+static u32 unlisted_count; /* messages from sites after the table filled */
+static u32 dropped_count; /* messages that found the ring full */
+
+/*
+ * the atomic operations we need, on 32-bit words and pointers
+ */
+#if defined(_MSC_VER)
+static INLINE u32 load_acquire(u32 * word)
+{
+    return (u32)InterlockedOr((volatile LONG *)word, 0);
+}
+static INLINE void store_release(u32 * word, u32 value)
+{
+    InterlockedExchange((volatile LONG *)word, (LONG)value);
+    return;
+}
+static INLINE u32 fetch_add(u32 * word, u32 value)
+{
+    return (u32)InterlockedExchangeAdd((volatile LONG *)word, (LONG)value);
+}
+static INLINE int compare_and_swap(u32 * word, u32 old, u32 value)
+{
+    return (u32)InterlockedCompareExchange(
+        (volatile LONG *)word, (LONG)value, (LONG)old
+    ) == old;
+}
+static INLINE const char * load_pointer(const char ** pointer)
+{
+    return (const char *)InterlockedCompareExchangePointer(
+        (PVOID volatile *)pointer, NULL, NULL
+    );
+}
+static INLINE int claim_pointer(const char ** pointer, const char * value)
+{
+    return InterlockedCompareExchangePointer(
+        (PVOID volatile *)pointer, (PVOID)value, NULL
+    ) == NULL;
+}
+#elif defined(__GNUC__)
+static INLINE u32 load_acquire(u32 * word)
+{
+    return __atomic_load_n(word, __ATOMIC_ACQUIRE);
+}
+static INLINE void store_release(u32 * word, u32 value)
+{
+    __atomic_store_n(word, value, __ATOMIC_RELEASE);
+    return;
+}
+static INLINE u32 fetch_add(u32 * word, u32 value)
+{
+    return __atomic_fetch_add(word, value, __ATOMIC_RELAXED);
+}
+static INLINE int compare_and_swap(u32 * word, u32 old, u32 value)
+{
+    return __atomic_compare_exchange_n(
+        word, &old, value, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED
+    );
+}
+static INLINE const char * load_pointer(const char ** pointer)
+{
+    return __atomic_load_n(pointer, __ATOMIC_ACQUIRE);
+}
+static INLINE int claim_pointer(const char ** pointer, const char * value)
+{
+    const char * unused = NULL;
+
+    return __atomic_compare_exchange_n(
+        pointer, &unused, value, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE
+    );
+}
+#else
+/*
+ * no atomics we know of:  fine so long as only one thread calls message()
+ */
+static INLINE u32 load_acquire(u32 * word)
+{
+    return (*word);
+}
+static INLINE void store_release(u32 * word, u32 value)
+{
+    *word = value;
+    return;
+}
+static INLINE u32 fetch_add(u32 * word, u32 value)
+{
+    *word += value;
+    return (*word - value);
+}
+static INLINE int compare_and_swap(u32 * word, u32 old, u32 value)
+{
+    if (*word != old)
+        return 0;
+    *word = value;
+    return 1;
+}
+static INLINE const char * load_pointer(const char ** pointer)
+{
+    return (*pointer);
+}
+static INLINE int claim_pointer(const char ** pointer, const char * value)
+{
+    if (*pointer != NULL)
+        return 0;
+    *pointer = value;
+    return 1;
+}
+#endif
+
+/*
+ * The slot for ring position `p' is free when its sequence is `p', and full
+ * when it is `p + 1'.  Draining it makes it `p + MESSAGE_RING_SIZE', free
+ * for the next pass.  Sequences are kept less the slot index, so that the
+ * all-zero ring starts out with every slot free for the first pass.
+ */
+#define SLOT_INDEX(position)    ((position) % MESSAGE_RING_SIZE)
+#define SLOT_SEQUENCE(slot, position) \
+    (load_acquire(&(slot) -> sequence) + SLOT_INDEX(position))
+
+static int post_message(const char * body, u32 count)
+{
+    message_slot * slot;
+    u32 position;
+    u32 sequence;
+
+    position = load_acquire(&ring_head);
+    for (;;) {
+        slot = &ring[SLOT_INDEX(position)];
+        sequence = SLOT_SEQUENCE(slot, position);
+        if (sequence == position) {
+            if (compare_and_swap(&ring_head, position, position + 1))
+                break;
+        } else if ((s32)(sequence - position) < 0) {
+            return 0; /* not yet drained from the last pass:  full */
+        }
+        position = load_acquire(&ring_head);
+    }
+
+    slot -> count = count;
+    strncpy(slot -> text, body, MESSAGE_LENGTH - 1);
+    slot -> text[MESSAGE_LENGTH - 1] = '\0';
+    store_release(&slot -> sequence, position + 1 - SLOT_INDEX(position));
+    return 1;
+}
+
+static message_site * find_site(const char * body)
+{
+    const char * listed;
+    register size_t i, n;
+
+    i = ((size_t)body >> 2) % MESSAGE_SITES;
+    for (n = 0; n < MESSAGE_SITES; n++) {
+        listed = load_pointer(&sites[i].body);
+        if (listed == NULL && claim_pointer(&sites[i].body, body))
+            return &sites[i];
+        if (listed == body || load_pointer(&sites[i].body) == body)
+            return &sites[i];
+        i = (i + 1) % MESSAGE_SITES;
+    }
+    return NULL;
+}
+
+NOINLINE void message(const char* body)
+{
+    message_site * site;
+    u32 count;
+
+    site = find_site(body);
+    count = fetch_add((site == NULL) ? &unlisted_count : &site -> count, 1);
+    ++count;
+    if (count > MESSAGE_BURST && (count & (count - 1)) != 0)
+        return;
+    if (!post_message(body, count)) {
+        fetch_add(&dropped_count, 1);
+        return;
+    }
+    if (site != NULL)
+        store_release(&site -> shown, count);
+    return;
+}
+
+void flush_messages(message_sink sink)
+{
+    char text[MESSAGE_LENGTH + 32];
+    message_slot * slot;
+    u32 count;
+
+    slot = &ring[SLOT_INDEX(ring_tail)];
+    if (SLOT_SEQUENCE(slot, ring_tail) != ring_tail + 1)
+        return; /* empty (or being drained) */
+    if (!compare_and_swap(&ring_draining, 0, 1))
+        return;
+
+    for (;;) {
+        slot = &ring[SLOT_INDEX(ring_tail)];
+        if (SLOT_SEQUENCE(slot, ring_tail) != ring_tail + 1)
+            break;
+        count = slot -> count;
+        strcpy(text, slot -> text);
+        store_release(
+            &slot -> sequence,
+            ring_tail + MESSAGE_RING_SIZE - SLOT_INDEX(ring_tail)
+        );
+        ++ring_tail;
+
+        if (count > MESSAGE_BURST)
+            sprintf(text + strlen(text), " (%lu times so far)",
+                (unsigned long)count);
+        sink(text);
+    }
+    store_release(&ring_draining, 0);
+    return;
+}
+
+void summarize_messages(message_sink sink)
+{
+    char text[MESSAGE_LENGTH + 64];
+    register size_t i;
+
+    flush_messages(sink);
+    for (i = 0; i < MESSAGE_SITES; i++) {
+        if (sites[i].body == NULL || sites[i].count == sites[i].shown)
+            continue;
+        strncpy(text, sites[i].body, MESSAGE_LENGTH - 1);
+        text[MESSAGE_LENGTH - 1] = '\0';
+        sprintf(text + strlen(text), (sites[i].shown == 0)
+          ? " (%lu times, none shown)" : " (%lu times in all)",
+            (unsigned long)sites[i].count);
+        sink(text);
+    }
+    if (unlisted_count != 0) {
+        sprintf(text, "%lu messages from call sites past the first %i",
+            (unsigned long)unlisted_count, MESSAGE_SITES);
+        sink(text);
+    }
+    if (dropped_count != 0) {
+        sprintf(text, "%lu messages dropped with the message ring full",
+            (unsigned long)dropped_count);
+        sink(text);
+    }
+
+    memset(sites, 0, sizeof(sites));
+    unlisted_count = dropped_count = 0;
+    return;
+}
@@ -0,0 +1,53 @@
+/******************************************************************************\
+* Project:  Non-Blocking Diagnostic Message Ring                               *
+* Authors:  agent                                                              *
+* Release:  2026.10.18                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+
+#ifndef _DIAG_H_
+#define _DIAG_H_
+
+#include "my_types.h"
+
+/*
+ * message() is called from the middle of emulation, sometimes once per
+ * instruction of a bad micro-code, and from the thread of whichever RSP
+ * (`context.h') is running.  So all it does is count the call against its
+ * call site (the `body' string), and, for the first few calls from that site
+ * and then every power-of-two-th one, copy the text into a lock-free ring.
+ * It never waits, and if the ring is full, the message is counted and
+ * dropped.
+ *
+ * The ring is drained on the emulator's CPU thread, as that calls into the
+ * plug-in:  at the start of DoRspCycles(), and in PluginShutdown() and
+ * RomClosed().  The `message_sink' is the Mupen64Plus debug callback, or
+ * else `rsp_messages.txt' in the plug-in's directory.
+ */
+typedef void(*message_sink)(const char * text);
+
+NOINLINE extern void message(const char* body);
+
+/*
+ * Passes the messages in the ring to `sink', oldest first.  Only one thread
+ * drains the ring at a time; any other caller returns at once.
+ */
+extern void flush_messages(message_sink sink);
+
+/*
+ * flush_messages(), then a count for each call site some of whose messages
+ * were held back, and for any that were dropped.  Starts the counts over.
+ * Call this only with no task running on any other thread.
+ */
+extern void summarize_messages(message_sink sink);
+
+#endif
@@ -0,0 +1,981 @@
+/******************************************************************************\
+* Project:  Basic Block Recompiler for x86-64 Hosts                            *
+* Authors:  agent                                                              *
+* Release:  2026.10.18                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+#include "dynarec.h"
+
+#ifdef HAVE_DYNAREC
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "module.h"
+#include "vu/vu.h"
+
+/*
+ * Every block is a function of its own (`p_block') which returns the number
+ * of RSP instructions it ran.  The block table, `IMEM_blocks', is indexed by
+ * (PC >> 2) just like the predecoded IMEM table it was compiled from.  Both
+ * of them, and the code cache, belong to the RSP's `rsp_context', since the
+ * code compiled for one RSP has the addresses of its registers built in.
+ */
+
+/*
+ * The instruction at the start of this "block" has to be interpreted.
+ */
+static unsigned int no_block(void)
+{
+    return 0;
+}
+
+/*
+ * All blocks live in a single executable buffer which is only ever freed
+ * all at once, when it fills up.  No block can overrun the margin.
+ */
+#define CODE_CACHE_SIZE     (1024 * 1024)
+#define CODE_CACHE_MARGIN   (512 * MAX_BLOCK_LENGTH)
+
+/*
+ * x86-64 general-purpose register numbers
+ *
+ * The base addresses of the RSP state live in callee-saved registers, so
+ * that calls out to the interpreter's op-code handlers do not lose them.
+ */
+enum {
+    RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+    R8 , R9 , R10, R11, R12, R13, R14, R15
+};
+
+#define SR_BASE     RBX
+#define SIGN_BASE   RBP
+#define VR_BASE     R12
+#define ACC_BASE    R13
+#define CO_BASE     R14
+#define NE_BASE     R15
+
+#ifdef _WIN32
+#define ARG1        RCX
+#define ARG2        RDX
+#else
+#define ARG1        RDI
+#define ARG2        RSI
+#endif
+
+/*
+ * PXOR with this flips unsigned 16-bit compares into signed ones.
+ */
+static ALIGNED const i16 sign_bits[N] = {
+    -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768,
+};
+
+/*** instruction encoding ***/
+
+static void emit_8(unsigned int byte)
+{
+    *RSP_STATE.emit_ptr++ = (u8)byte;
+    return;
+}
+static void emit_32(u32 word)
+{
+    memcpy(RSP_STATE.emit_ptr, &word, 4);
+    RSP_STATE.emit_ptr += 4;
+    return;
+}
+static void emit_64(u64 quad)
+{
+    memcpy(RSP_STATE.emit_ptr, &quad, 8);
+    RSP_STATE.emit_ptr += 8;
+    return;
+}
+
+static void emit_rex(unsigned int W, unsigned int reg, unsigned int base)
+{
+    if (W | (reg >> 3) | (base >> 3))
+        emit_8(0x40 | W << 3 | (reg >> 3) << 2 | (base >> 3));
+    return;
+}
+
+/*
+ * ModR/M for [base + disp], with the SIB byte that RSP and R12 need
+ */
+static void emit_mem(unsigned int reg, unsigned int base, s32 disp)
+{
+    const int short_disp = (disp >= -128 && disp <= +127);
+
+    emit_8((short_disp ? 0x40 : 0x80) | (reg & 7) << 3 | (base & 7));
+    if ((base & 7) == RSP)
+        emit_8(0x24);
+    if (short_disp)
+        emit_8(disp & 0xFF);
+    else
+        emit_32(disp);
+    return;
+}
+
+static void emit_mov_imm64(unsigned int reg, u64 imm)
+{
+    emit_rex(1, 0, reg);
+    emit_8(0xB8 + (reg & 7));
+    emit_64(imm);
+    return;
+}
+
+/*
+ * 32-bit ALU op-codes (op r32, r/m32) used against the scalar registers
+ */
+#define X86_ADD     0x03
+#define X86_OR      0x0B
+#define X86_AND     0x23
+#define X86_SUB     0x2B
+#define X86_XOR     0x33
+#define X86_CMP     0x3B
+#define X86_STORE   0x89
+#define X86_LOAD    0x8B
+
+static void emit_SR(unsigned int opcode, unsigned int reg, unsigned int gpr)
+{
+    emit_8(opcode);
+    emit_mem(reg, SR_BASE, 4 * gpr);
+    return;
+}
+
+/*
+ * op EAX, imm32 (short forms:  ADD, OR, AND, XOR, CMP)
+ */
+static void emit_EAX_imm(unsigned int opcode, u32 imm)
+{
+    emit_8(opcode + 0x02);
+    emit_32(imm);
+    return;
+}
+
+/*
+ * shift group /ext on EAX:  by an immediate, or by CL when `sa' is negative
+ */
+#define SHIFT_SLL   4
+#define SHIFT_SRL   5
+#define SHIFT_SRA   7
+
+static void emit_shift(unsigned int ext, int sa)
+{
+    emit_8(sa < 0 ? 0xD3 : 0xC1);
+    emit_8(0xC0 | ext << 3 | RAX);
+    if (sa >= 0)
+        emit_8(sa);
+    return;
+}
+
+/*
+ * SETcc AL and zero-extend it back over EAX
+ */
+#define CC_B        0x2
+#define CC_L        0xC
+
+static void emit_set(unsigned int cc)
+{
+    emit_8(0x0F);
+    emit_8(0x90 | cc);
+    emit_8(0xC0);
+    emit_8(0x0F);
+    emit_8(0xB6);
+    emit_8(0xC0);
+    return;
+}
+
+/*
+ * Only XMM0 through XMM5 are touched:  XMM6 and up are callee-saved on
+ * Win64, and nothing is kept in them across RSP instructions anyway.
+ */
+static void emit_sse(unsigned int prefix, unsigned int op, int dst, int src)
+{
+    emit_8(prefix);
+    emit_8(0x0F);
+    emit_8(op);
+    emit_8(0xC0 | dst << 3 | src);
+    return;
+}
+static void emit_sse_imm(unsigned int prefix, unsigned int op, int reg, int rm,
+    unsigned int imm)
+{
+    emit_sse(prefix, op, reg, rm);
+    emit_8(imm);
+    return;
+}
+static void emit_sse_mem(unsigned int prefix, unsigned int op, int xmm,
+    unsigned int base, s32 disp)
+{
+    emit_8(prefix);
+    emit_rex(0, xmm, base);
+    emit_8(0x0F);
+    emit_8(op);
+    emit_mem(xmm, base, disp);
+    return;
+}
+
+#define MOVDQA(d, s)        emit_sse(0x66, 0x6F, d, s)
+#define PADDW(d, s)         emit_sse(0x66, 0xFD, d, s)
+#define PSUBW(d, s)         emit_sse(0x66, 0xF9, d, s)
+#define PADDSW(d, s)        emit_sse(0x66, 0xED, d, s)
+#define PSUBSW(d, s)        emit_sse(0x66, 0xE9, d, s)
+#define PMULLW(d, s)        emit_sse(0x66, 0xD5, d, s)
+#define PMULHW(d, s)        emit_sse(0x66, 0xE5, d, s)
+#define PMULHUW(d, s)       emit_sse(0x66, 0xE4, d, s)
+#define PMAXSW(d, s)        emit_sse(0x66, 0xEE, d, s)
+#define PMINSW(d, s)        emit_sse(0x66, 0xEA, d, s)
+#define PAND(d, s)          emit_sse(0x66, 0xDB, d, s)
+#define PANDN(d, s)         emit_sse(0x66, 0xDF, d, s)
+#define POR(d, s)           emit_sse(0x66, 0xEB, d, s)
+#define PXOR(d, s)          emit_sse(0x66, 0xEF, d, s)
+#define PCMPEQW(d, s)       emit_sse(0x66, 0x75, d, s)
+#define PCMPGTW(d, s)       emit_sse(0x66, 0x65, d, s)
+#define PUNPCKLWD(d, s)     emit_sse(0x66, 0x61, d, s)
+#define PUNPCKHWD(d, s)     emit_sse(0x66, 0x69, d, s)
+#define PUNPCKLQDQ(d, s)    emit_sse(0x66, 0x6C, d, s)
+#define PUNPCKHQDQ(d, s)    emit_sse(0x66, 0x6D, d, s)
+#define PACKSSDW(d, s)      emit_sse(0x66, 0x6B, d, s)
+
+#define PSRLW(x, imm)       emit_sse_imm(0x66, 0x71, 2, x, imm)
+#define PSRAW(x, imm)       emit_sse_imm(0x66, 0x71, 4, x, imm)
+#define PSLLW(x, imm)       emit_sse_imm(0x66, 0x71, 6, x, imm)
+#define PSHUFLW(x, imm)     emit_sse_imm(0xF2, 0x70, x, x, imm)
+#define PSHUFHW(x, imm)     emit_sse_imm(0xF3, 0x70, x, x, imm)
+
+#define LOAD_VR(x, vr)      emit_sse_mem(0x66, 0x6F, x, VR_BASE, sizeof(RSP_STATE.VR[0]) * (vr))
+#define STORE_VR(x, vr)     emit_sse_mem(0x66, 0x7F, x, VR_BASE, sizeof(RSP_STATE.VR[0]) * (vr))
+#define LOAD_ACC(x, i)      emit_sse_mem(0x66, 0x6F, x, ACC_BASE, sizeof(RSP_STATE.VACC[0]) * (i))
+#define STORE_ACC(x, i)     emit_store_ACC(x, i)
+#define LOAD_SIGN(x)        emit_sse_mem(0x66, 0x6F, x, SIGN_BASE, 0)
+#define PXOR_SIGN(x)        emit_sse_mem(0x66, 0xEF, x, SIGN_BASE, 0)
+
+/*
+ * t = (a < b) ? ~0 : 0, unsigned; clobbers s
+ * This is `_mm_cmplt_epu16' from the vector unit, which SSE2 does not have.
+ */
+static void emit_cmplt_epu16(int t, int a, int b, int s)
+{
+    MOVDQA(s, a);
+    PXOR_SIGN(s);
+    MOVDQA(t, b);
+    PXOR_SIGN(t);
+    PCMPGTW(t, s);
+    return;
+}
+
+/*
+ * XMM0 = signed clamp of the accumulator middle/high words, as 16 bits
+ */
+static void emit_clamp_acc(int md, int hi, int s)
+{
+    MOVDQA(0, md);
+    PUNPCKLWD(0, hi);
+    MOVDQA(s, md);
+    PUNPCKHWD(s, hi);
+    PACKSSDW(0, s);
+    return;
+}
+
+static void emit_store_ACC(int x, int i)
+{
+    if (RSP_STATE.dead_writes & (i == LO ? VU_ACC_L : VU_ACC_HM))
+        return;
+    emit_sse_mem(0x66, 0x7F, x, ACC_BASE, sizeof(RSP_STATE.VACC[0]) * i);
+    return;
+}
+
+/*** vector unit computational operations ***/
+
+/*
+ * Each of these mirrors the SSE2 path of the matching function in the `vu'
+ * directory, to the instruction, with XMM0 = vs and XMM1 = vt (already
+ * broadcast to the element).  The result to write to vd is left in XMM0.
+ */
+static void emit_VMULF(void)
+{
+    MOVDQA(2, 0);
+    PMULLW(2, 1);
+    MOVDQA(3, 0);
+    PMULHW(3, 1);
+    PADDW(3, 3);
+    MOVDQA(4, 2);
+    PSRLW(4, 15);
+    PADDW(3, 4);
+    PADDW(2, 2);
+    MOVDQA(4, 2);
+    PSRLW(4, 15);
+    LOAD_SIGN(5);
+    PXOR(2, 5);
+    STORE_ACC(2, LO);
+    PADDW(3, 4);
+    STORE_ACC(3, MD);
+
+    MOVDQA(4, 3);
+    PSRAW(4, 15);
+    PCMPEQW(0, 5);
+    PCMPEQW(1, 5);
+    PAND(0, 1);
+    PXOR(4, 0);
+    STORE_ACC(4, HI);
+    PADDW(0, 3);
+    return;
+}
+static void emit_VMULU(void)
+{
+    emit_VMULF(); /* same up to the clamp:  XMM3 = prod_hi, XMM4 = negative */
+    MOVDQA(2, 3);
+    PSRAW(2, 15);
+    POR(2, 3);
+    PANDN(4, 2);
+    MOVDQA(0, 4);
+    return;
+}
+static void emit_VMUDL(void)
+{
+    PMULHUW(0, 1);
+    PXOR(1, 1);
+    STORE_ACC(0, LO);
+    STORE_ACC(1, MD);
+    STORE_ACC(1, HI);
+    return;
+}
+static void emit_VMUDM(void)
+{
+    MOVDQA(2, 0);
+    PMULLW(2, 1);
+    MOVDQA(3, 0);
+    PMULHUW(3, 1);
+    PSRAW(0, 15);
+    PAND(1, 0);
+    PSUBW(3, 1);
+    STORE_ACC(2, LO);
+    STORE_ACC(3, MD);
+    MOVDQA(0, 3);
+    PSRAW(3, 15);
+    STORE_ACC(3, HI);
+    return;
+}
+static void emit_VMUDN(void)
+{
+    MOVDQA(2, 0);
+    PMULLW(2, 1);
+    MOVDQA(3, 0);
+    PMULHUW(3, 1);
+    PSRAW(1, 15);
+    PAND(0, 1);
+    PSUBW(3, 0);
+    STORE_ACC(2, LO);
+    STORE_ACC(3, MD);
+    PSRAW(3, 15);
+    STORE_ACC(3, HI);
+    MOVDQA(0, 2);
+    return;
+}
+static void emit_VMUDH(void)
+{
+    MOVDQA(2, 0);
+    PMULHW(2, 1);
+    MOVDQA(4, 0);
+    PMULLW(4, 1);
+    PXOR(3, 3);
+    STORE_ACC(3, LO);
+    STORE_ACC(4, MD);
+    STORE_ACC(2, HI);
+    emit_clamp_acc(4, 2, 5);
+    return;
+}
+
+static void emit_VMACF(void)
+{
+    MOVDQA(3, 0);
+    PMULHW(3, 1);
+    MOVDQA(2, 0);
+    PMULLW(2, 1);
+    MOVDQA(1, 3);
+    PSRLW(1, 15); /* prod_neg */
+    MOVDQA(0, 2);
+    PSRLW(0, 15);
+    PADDW(2, 2);
+    PADDW(3, 3);
+    POR(3, 0);
+
+    LOAD_ACC(4, LO);
+    PADDW(4, 2);
+    STORE_ACC(4, LO);
+    emit_cmplt_epu16(5, 4, 2, 0); /* overflow */
+
+    LOAD_ACC(4, MD);
+    PADDW(4, 3);
+    emit_cmplt_epu16(2, 4, 3, 0); /* overflow_new */
+    PSUBW(4, 5);
+    PXOR(0, 0);
+    PCMPEQW(0, 4);
+    PAND(0, 5); /* carry */
+    STORE_ACC(4, MD);
+    POR(0, 2);
+
+    LOAD_ACC(3, HI);
+    PSUBW(3, 0);
+    PSUBW(3, 1);
+    STORE_ACC(3, HI);
+    emit_clamp_acc(4, 3, 5);
+    return;
+}
+static void emit_VMACU(void)
+{
+    emit_VMACF(); /* XMM4 = accumulator middle */
+    MOVDQA(1, 0);
+    PCMPGTW(1, 4);
+    MOVDQA(2, 0);
+    PSRAW(2, 15);
+    PANDN(2, 0);
+    POR(2, 1);
+    MOVDQA(0, 2);
+    return;
+}
+
+/*
+ * XMM0 = the VMADL/VMADN "sort of" signed clamp of XMM4:XMM2:XMM3 (lo:md:hi)
+ */
+static void emit_clamp_low(void)
+{
+    emit_clamp_acc(2, 3, 1);
+    PCMPEQW(2, 0);
+    PAND(4, 2);
+    PCMPEQW(1, 1);
+    PXOR(2, 1);
+    PAND(0, 2);
+    POR(0, 4);
+    PSLLW(2, 15);
+    PXOR(0, 2);
+    return;
+}
+
+static void emit_VMADL(void)
+{
+    MOVDQA(3, 0);
+    PMULHUW(3, 1);
+    LOAD_ACC(4, LO);
+    PADDW(4, 3);
+    STORE_ACC(4, LO);
+    emit_cmplt_epu16(5, 4, 3, 0);
+    LOAD_ACC(2, MD);
+    PSUBW(2, 5);
+    STORE_ACC(2, MD);
+    PXOR(0, 0);
+    PCMPEQW(0, 2);
+    PAND(5, 0);
+    LOAD_ACC(3, HI);
+    PSUBW(3, 5);
+    STORE_ACC(3, HI);
+    emit_clamp_low();
+    return;
+}
+static void emit_VMADM(void)
+{
+    MOVDQA(2, 0);
+    PMULLW(2, 1);
+    MOVDQA(3, 0);
+    PMULHUW(3, 1);
+    PSRAW(0, 15);
+    PAND(1, 0);
+    PSUBW(3, 1);
+
+    LOAD_ACC(4, LO);
+    PADDW(4, 2);
+    STORE_ACC(4, LO);
+    emit_cmplt_epu16(5, 4, 2, 0);
+    PSUBW(3, 5);
+    LOAD_ACC(4, MD);
+    PADDW(4, 3);
+    STORE_ACC(4, MD);
+    emit_cmplt_epu16(5, 4, 3, 0);
+    PSRAW(3, 15);
+    LOAD_ACC(2, HI);
+    PADDW(2, 3);
+    PSUBW(2, 5);
+    STORE_ACC(2, HI);
+    emit_clamp_acc(4, 2, 1);
+    return;
+}
+static void emit_VMADN(void)
+{
+    MOVDQA(2, 0);
+    PMULLW(2, 1);
+    MOVDQA(3, 0);
+    PMULHUW(3, 1);
+    PSRAW(1, 15);
+    PAND(0, 1);
+    PSUBW(3, 0);
+
+    LOAD_ACC(4, LO);
+    PADDW(4, 2);
+    STORE_ACC(4, LO);
+    emit_cmplt_epu16(5, 4, 2, 0);
+    PSUBW(3, 5);
+    LOAD_ACC(2, MD);
+    PADDW(2, 3);
+    STORE_ACC(2, MD);
+    emit_cmplt_epu16(5, 2, 3, 0);
+    PSRAW(3, 15);
+    LOAD_ACC(0, HI);
+    PADDW(3, 0);
+    PSUBW(3, 5);
+    STORE_ACC(3, HI);
+    emit_clamp_low();
+    return;
+}
+static void emit_VMADH(void)
+{
+    MOVDQA(2, 0);
+    PMULHW(2, 1);
+    MOVDQA(4, 0);
+    PMULLW(4, 1);
+    LOAD_ACC(3, MD);
+    PADDW(4, 3);
+    STORE_ACC(4, MD);
+    LOAD_ACC(1, HI);
+    PADDW(1, 2);
+    emit_cmplt_epu16(5, 4, 3, 0);
+    PSUBW(1, 5);
+    STORE_ACC(1, HI);
+    emit_clamp_acc(4, 1, 5);
+    return;
+}
+
+/*
+ * VADD and VSUB also consume VCO and then clear it (see `clr_ci', `clr_bi').
+ */
+static void emit_clear_VCO(void)
+{
+    if (RSP_STATE.dead_writes & VU_VCO)
+        return;
+    PXOR(5, 5);
+    emit_sse_mem(0x66, 0x7F, 5, CO_BASE, 0);
+    emit_sse_mem(0x66, 0x7F, 5, NE_BASE, 0);
+    return;
+}
+static void emit_VADD(void)
+{
+    emit_sse_mem(0x66, 0x6F, 2, CO_BASE, 0);
+    MOVDQA(3, 0);
+    PADDW(3, 1);
+    PSUBW(3, 2);
+    STORE_ACC(3, LO);
+    MOVDQA(3, 0);
+    PMAXSW(3, 1);
+    PMINSW(0, 1);
+    PSUBSW(0, 2);
+    PADDSW(0, 3);
+    emit_clear_VCO();
+    return;
+}
+static void emit_VSUB(void)
+{
+    emit_sse_mem(0x66, 0x6F, 2, CO_BASE, 0);
+    MOVDQA(3, 0);
+    PSUBW(3, 1);
+    PADDW(3, 2);
+    STORE_ACC(3, LO);
+    MOVDQA(3, 0);
+    PSUBSW(3, 1); /* res */
+    MOVDQA(4, 3);
+    PSUBW(4, 2);
+    PXOR(4, 3);
+    PAND(4, 1); /* dif */
+    MOVDQA(5, 0);
+    PSUBW(5, 1);
+    PANDN(0, 4);
+    PAND(5, 0);
+    PSRAW(5, 15);
+    PANDN(5, 2);
+    PADDSW(3, 5);
+    MOVDQA(0, 3);
+    emit_clear_VCO();
+    return;
+}
+
+/*
+ * Everything else in COP2_C2 is left to the interpreter's own handlers.
+ */
+static void (*const inline_C2[8 * 8])(void) = {
+#ifdef WIDE_ACCUMULATOR /* The emitted multiplies know only the planes. */
+    NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      , /* 000 */
+    NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      , /* 001 */
+#else
+    emit_VMULF,emit_VMULU,NULL      ,NULL      ,emit_VMUDL,emit_VMUDM,emit_VMUDN,emit_VMUDH, /* 000 */
+    emit_VMACF,emit_VMACU,NULL      ,NULL      ,emit_VMADL,emit_VMADM,emit_VMADN,emit_VMADH, /* 001 */
+#endif
+    emit_VADD ,emit_VSUB ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      , /* 010 */
+    NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      , /* 011 */
+    NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      , /* 100 */
+    NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      , /* 101 */
+    NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      , /* 110 */
+    NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      ,NULL      , /* 111 */
+};
+
+/*
+ * XMM1 = VR[vt] with the element selector `e' applied, as in COP2_C2_entries
+ */
+static void emit_element(unsigned int vt, unsigned int e)
+{
+    unsigned int j;
+
+    LOAD_VR(1, vt);
+    switch (e) {
+    case 0x0:
+    case 0x1:
+        break;
+    case 0x2:
+    case 0x3:
+        PSHUFLW(1, e & 1 ? 0xF5 : 0xA0);
+        PSHUFHW(1, e & 1 ? 0xF5 : 0xA0);
+        break;
+    case 0x4:
+    case 0x5:
+    case 0x6:
+    case 0x7:
+        PSHUFLW(1, 0x55 * (e - 0x4));
+        PSHUFHW(1, 0x55 * (e - 0x4));
+        break;
+    default:
+        j = e - 0x8;
+        if (j < 4) {
+            PSHUFLW(1, 0x55 * j);
+            PUNPCKLQDQ(1, 1);
+        } else {
+            PSHUFHW(1, 0x55 * (j - 4));
+            PUNPCKHQDQ(1, 1);
+        }
+    }
+    return;
+}
+
+/*** block compiler ***/
+
+/*
+ * Anything which could leave the straight line:  jumps and branches, BREAK,
+ * and COP0 (which may DMA into IMEM or halt the RSP).
+ */
+static int ends_block(u32 inst)
+{
+    switch (inst >> 26) {
+    case 000: /* SPECIAL */
+        switch (inst % 64) {
+        case 010: /* JR */
+        case 011: /* JALR */
+        case 015: /* BREAK */
+            return 1;
+        }
+        return 0;
+    case 001: /* REGIMM */
+    case 002: /* J */
+    case 003: /* JAL */
+    case 004: /* BEQ */
+    case 005: /* BNE */
+    case 006: /* BLEZ */
+    case 007: /* BGTZ */
+    case 020: /* COP0 */
+        return 1;
+    }
+    return 0;
+}
+
+static void emit_call(const decoded_op * op, unsigned int addr)
+{
+    emit_mov_imm64(ARG1, (size_t)op);
+    emit_8(0xB8 + ARG2); /* MOV r32, imm32 */
+    emit_32(addr + 0x004 - BASE_OFF);
+    emit_mov_imm64(RAX, (size_t)(op -> handler));
+    emit_8(0xFF); /* CALL RAX */
+    emit_8(0xD0);
+    return;
+}
+
+/*
+ * Returns zero for the scalar ops there is nothing to inline for.
+ */
+static int emit_SPECIAL(const decoded_op * op)
+{
+    static const unsigned char ALU_ops[8] = {
+        X86_ADD, X86_ADD, X86_SUB, X86_SUB, X86_AND, X86_OR, X86_XOR, X86_OR,
+    };
+    const u32 inst = op -> word;
+
+    if (op -> rd == 0) /* including the NOP, SLL $0, $0, 0 */
+        return 1;
+    switch (inst % 64) {
+    case 000:
+        emit_SR(X86_LOAD, RAX, op -> rt);
+        emit_shift(SHIFT_SLL, op -> sa);
+        break;
+    case 002:
+        emit_SR(X86_LOAD, RAX, op -> rt);
+        emit_shift(SHIFT_SRL, op -> sa);
+        break;
+    case 003:
+        emit_SR(X86_LOAD, RAX, op -> rt);
+        emit_shift(SHIFT_SRA, op -> sa);
+        break;
+    case 004:
+    case 006:
+    case 007:
+        emit_SR(X86_LOAD, RCX, op -> rs);
+        emit_SR(X86_LOAD, RAX, op -> rt);
+        emit_shift((inst % 64 == 004) ? SHIFT_SLL
+                 : (inst % 64 == 006) ? SHIFT_SRL : SHIFT_SRA, -1);
+        break;
+    case 040: /* ADD */
+    case 041:
+    case 042: /* SUB */
+    case 043:
+    case 044:
+    case 045:
+    case 046:
+    case 047:
+        emit_SR(X86_LOAD, RAX, op -> rs);
+        emit_SR(ALU_ops[inst % 8], RAX, op -> rt);
+        if (inst % 64 == 047) { /* NOR */
+            emit_8(0xF7); /* NOT EAX */
+            emit_8(0xD0);
+        }
+        break;
+    case 052:
+    case 053:
+        emit_SR(X86_LOAD, RAX, op -> rs);
+        emit_SR(X86_CMP, RAX, op -> rt);
+        emit_set(inst % 64 == 052 ? CC_L : CC_B);
+        break;
+    default:
+        return 0;
+    }
+    emit_SR(X86_STORE, RAX, op -> rd);
+    return 1;
+}
+
+static int emit_immediate(const decoded_op * op)
+{
+    const u32 inst = op -> word;
+
+    if (op -> rt == 0)
+        return 1;
+    if (inst >> 26 == 017) { /* LUI */
+        emit_8(0xC7); /* MOV r/m32, imm32 */
+        emit_mem(0, SR_BASE, 4 * op -> rt);
+        emit_32(op -> imm);
+        return 1;
+    }
+    emit_SR(X86_LOAD, RAX, op -> rs);
+    switch (inst >> 26) {
+    case 010: /* ADDI */
+    case 011:
+        emit_EAX_imm(X86_ADD, op -> imm);
+        break;
+    case 012:
+    case 013:
+        emit_EAX_imm(X86_CMP, op -> imm);
+        emit_set(inst >> 26 == 012 ? CC_L : CC_B);
+        break;
+    case 014:
+        emit_EAX_imm(X86_AND, op -> imm);
+        break;
+    case 015:
+        emit_EAX_imm(X86_OR, op -> imm);
+        break;
+    case 016:
+        emit_EAX_imm(X86_XOR, op -> imm);
+        break;
+    }
+    emit_SR(X86_STORE, RAX, op -> rt);
+    return 1;
+}
+
+static int emit_vector(const decoded_op * op)
+{
+    const u32 inst = op -> word;
+
+    if (op -> rs < 020 || inline_C2[inst % 64] == NULL)
+        return 0;
+    LOAD_VR(0, op -> rd);
+    emit_element(op -> rt, op -> rs & 0xF);
+    RSP_STATE.dead_writes = op -> dead;
+    inline_C2[inst % 64]();
+    STORE_VR(0, op -> sa);
+    return 1;
+}
+
+static void flush_blocks(void)
+{
+    register unsigned int i;
+
+    for (i = 0; i < 4096 / 4; i++)
+        RSP_STATE.IMEM_blocks[i] = NULL;
+    RSP_STATE.emit_ptr = RSP_STATE.code_cache;
+    return;
+}
+
+static p_block compile_block(unsigned int start)
+{
+    union {
+        pu8 code;
+        p_block run;
+    } block;
+    register const decoded_op * op;
+    register unsigned int addr;
+    unsigned int count, end;
+    int inlined;
+
+    if (RSP_STATE.code_cache == NULL) {
+#ifdef _WIN32
+        RSP_STATE.code_cache = (pu8)VirtualAlloc(NULL, CODE_CACHE_SIZE,
+            MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#else
+        RSP_STATE.code_cache = (pu8)mmap(NULL, CODE_CACHE_SIZE,
+            PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS,
+            -1, 0);
+        if (RSP_STATE.code_cache == (pu8)MAP_FAILED)
+            RSP_STATE.code_cache = NULL;
+#endif
+        if (RSP_STATE.code_cache == NULL) {
+            message("Failed to allocate recompiler memory.");
+            CFG_DYNAREC = 0;
+            return no_block;
+        }
+        RSP_STATE.emit_ptr = RSP_STATE.code_cache;
+    }
+    if (RSP_STATE.emit_ptr + CODE_CACHE_MARGIN
+      > RSP_STATE.code_cache + CODE_CACHE_SIZE)
+        flush_blocks();
+
+    for (addr = start; addr < 4096; addr += 4) {
+        op = &RSP_STATE.IMEM_decoded[addr >> 2];
+        end = addr + 4;
+        if (op -> kind == OP_COP2_fused)
+            end += op -> imm; /* all of the idiom, or none of it */
+        if (end - start > 4*MAX_BLOCK_LENGTH)
+            break;
+        if (ends_block(op -> word))
+            break;
+    }
+    count = (addr - start) / 4;
+    if (count == 0)
+        return no_block;
+
+    block.code = RSP_STATE.emit_ptr;
+    emit_8(0x53); /* PUSH RBX */
+    emit_8(0x55); /* PUSH RBP */
+    emit_8(0x41); emit_8(0x54); /* PUSH R12 */
+    emit_8(0x41); emit_8(0x55); /* PUSH R13 */
+    emit_8(0x41); emit_8(0x56); /* PUSH R14 */
+    emit_8(0x41); emit_8(0x57); /* PUSH R15 */
+    emit_8(0x48); emit_8(0x83); emit_8(0xEC); emit_8(40); /* SUB RSP, 40 */
+    emit_mov_imm64(SR_BASE, (size_t)RSP_STATE.SR);
+    emit_mov_imm64(SIGN_BASE, (size_t)sign_bits);
+    emit_mov_imm64(VR_BASE, (size_t)RSP_STATE.VR);
+    emit_mov_imm64(ACC_BASE, (size_t)RSP_STATE.VACC);
+    emit_mov_imm64(CO_BASE, (size_t)RSP_STATE.cf_co);
+    emit_mov_imm64(NE_BASE, (size_t)RSP_STATE.cf_ne);
+
+    for (addr = start; addr < start + 4*count; addr += 4) {
+        op = &RSP_STATE.IMEM_decoded[addr >> 2];
+        switch (op -> word >> 26) {
+        case 000: /* SPECIAL */
+            inlined = emit_SPECIAL(op);
+            break;
+        case 010:
+        case 011:
+        case 012:
+        case 013:
+        case 014:
+        case 015:
+        case 016:
+        case 017:
+            inlined = emit_immediate(op);
+            break;
+        case 022: /* COP2 */
+            inlined = emit_vector(op);
+            break;
+        default:
+            inlined = 0;
+        }
+        if (inlined)
+            continue;
+        emit_call(op, addr);
+        if (op -> kind == OP_COP2_fused)
+            addr += op -> imm; /* It did the rest of the idiom, too. */
+    }
+
+    emit_8(0xB8); /* MOV EAX, imm32 */
+    emit_32(count);
+    emit_8(0x48); emit_8(0x83); emit_8(0xC4); emit_8(40); /* ADD RSP, 40 */
+    emit_8(0x41); emit_8(0x5F); /* POP R15 */
+    emit_8(0x41); emit_8(0x5E); /* POP R14 */
+    emit_8(0x41); emit_8(0x5D); /* POP R13 */
+    emit_8(0x41); emit_8(0x5C); /* POP R12 */
+    emit_8(0x5D); /* POP RBP */
+    emit_8(0x5B); /* POP RBX */
+    emit_8(0xC3); /* RET */
+    return (block.run);
+}
+
+unsigned int run_block(u32 PC)
+{
+    register p_block block;
+
+    block = RSP_STATE.IMEM_blocks[FIT_IMEM(PC) >> 2];
+    if (block == NULL) {
+        block = compile_block(FIT_IMEM(PC));
+        RSP_STATE.IMEM_blocks[FIT_IMEM(PC) >> 2] = block;
+    }
+    if (block == no_block)
+        return 0;
+    return block();
+}
+
+void invalidate_blocks(unsigned int addr, unsigned int length)
+{
+    register unsigned int i;
+    unsigned int first;
+
+    if (FIT_IMEM(addr) + length > 4096) { /* wrapped around IMEM */
+        for (i = 0; i < 4096 / 4; i++)
+            RSP_STATE.IMEM_blocks[i] = NULL;
+        return;
+    }
+    first = FIT_IMEM(addr) >> 2;
+    first = (first < MAX_BLOCK_LENGTH) ? 0 : first - (MAX_BLOCK_LENGTH - 1);
+    for (i = first; i < (FIT_IMEM(addr) + length + 3) / 4; i++)
+        RSP_STATE.IMEM_blocks[i] = NULL;
+    return;
+}
+
+void free_code_cache(void)
+{
+    register unsigned int i;
+
+    if (RSP_STATE.code_cache == NULL)
+        return;
+#ifdef _WIN32
+    VirtualFree(RSP_STATE.code_cache, 0, MEM_RELEASE);
+#else
+    munmap(RSP_STATE.code_cache, CODE_CACHE_SIZE);
+#endif
+    for (i = 0; i < 4096 / 4; i++)
+        RSP_STATE.IMEM_blocks[i] = NULL;
+    RSP_STATE.code_cache = RSP_STATE.emit_ptr = NULL;
+    return;
+}
+#endif
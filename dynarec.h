@@ -0,0 +1,65 @@
+/******************************************************************************\
+* Project:  Basic Block Recompiler for x86-64 Hosts                            *
+* Authors:  agent                                                              *
+* Release:  2026.10.18                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+#ifndef _DYNAREC_H_
+#define _DYNAREC_H_
+
+#include "su.h"
+
+/*
+ * The recompiler emits SSE2 code for a 64-bit x86 host and relies on the
+ * static-PC interpreter to run everything that can change the flow of
+ * control, so it only exists when all three of those are in the build.
+ */
+#if defined(ARCH_MIN_SSE2) && defined(EMULATE_STATIC_PC)
+#if defined(__x86_64__) || defined(_M_X64)
+#if !defined(SP_EXECUTE_LOG) && !defined(__ARM_NEON__)
+#define HAVE_DYNAREC
+#endif
+#endif
+#endif
+
+/*
+ * Straight-line runs of IMEM (no jumps, branches, BREAK or COP0 accesses)
+ * are translated into host code the first time the interpreter reaches
+ * them with the "DynamicRecompiler" setting on.  A block may not be longer
+ * than this many instructions, so that re-decoding any one IMEM word only
+ * has to forget the blocks which started up to this far ahead of it.
+ */
+#define MAX_BLOCK_LENGTH    64
+
+#ifdef HAVE_DYNAREC
+/*
+ * Runs the block starting at IMEM offset `PC', compiling it first if this
+ * is the first time we are there.  Returns how many instructions were run
+ * (0 if the instruction at `PC' must be left to the interpreter).
+ */
+extern unsigned int run_block(u32 PC);
+
+/*
+ * Called whenever IMEM words in [addr, addr + length) are (re-)decoded.
+ */
+extern void invalidate_blocks(unsigned int addr, unsigned int length);
+
+/*
+ * Releases the current RSP's code cache, forgetting all its blocks.
+ */
+extern void free_code_cache(void);
+#else
+#define invalidate_blocks(addr, length)     ((void)0)
+#define free_code_cache()                   ((void)0)
+#endif
+
+#endif
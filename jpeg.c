@@ -0,0 +1,513 @@
+/******************************************************************************\
+* Project:  High-Level Emulation of JPEG Tasks                                 *
+* Authors:  agent                                                              *
+* Release:  2026.10.18                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+#include "jpeg.h"
+#include "su.h"
+
+#define SUBBLOCK_SIZE   64
+
+/*
+ * where each coefficient of a subblock, in natural (row-major) order, is in
+ * the zigzag order the task stores them in
+ */
+static const unsigned char zigzag[SUBBLOCK_SIZE] = {
+     0,  1,  5,  6, 14, 15, 27, 28,
+     2,  4,  7, 13, 16, 26, 29, 42,
+     3,  8, 12, 17, 25, 30, 41, 43,
+     9, 11, 18, 24, 31, 40, 44, 53,
+    10, 19, 23, 32, 39, 45, 52, 54,
+    20, 22, 33, 38, 46, 51, 55, 60,
+    21, 34, 37, 47, 50, 56, 59, 61,
+    35, 36, 48, 49, 57, 58, 62, 63,
+};
+
+/*
+ * the 8-point IDCT as a matrix:  [x][u] = C(u)/2 * cos((2x + 1)u * pi/16),
+ * C(0) = 1/sqrt(2) and otherwise 1, in Q15
+ */
+static const i16 IDCT_matrix[8][8] = {
+    { 11585,  16069,  15137,  13623,  11585,   9102,   6270,   3196 },
+    { 11585,  13623,   6270,  -3196, -11585, -16069, -15137,  -9102 },
+    { 11585,   9102,  -6270, -16069, -11585,   3196,  15137,  13623 },
+    { 11585,   3196, -15137,  -9102,  11585,  13623,  -6270, -16069 },
+    { 11585,  -3196, -15137,   9102,  11585, -13623,  -6270,  16069 },
+    { 11585,  -9102,  -6270,  16069, -11585,  -3196,  15137, -13623 },
+    { 11585, -13623,   6270,   3196, -11585,  16069, -15137,   9102 },
+    { 11585, -16069,  15137, -13623,  11585,  -9102,   6270,  -3196 },
+};
+
+/*
+ * YUV to RGB, in Q14:  R = Y + 1.4025 V, G = Y - 0.3443 U - 0.7144 V and
+ * B = Y + 1.7729 U, with Y offset by 2048 (half of the 12-bit range the
+ * IDCT gives).
+ */
+#define RGB_Y           16384
+#define RGB_RV          22979
+#define RGB_GU          -5641
+#define RGB_GV          -11705
+#define RGB_BU          29047
+#define RGB_OFFSET      (2048 << 14)
+
+static int fits_RDRAM(u32 address, u32 length)
+{
+    return (length <= RSP_STATE.su_max_address + 1)
+        && (address <= RSP_STATE.su_max_address + 1 - length);
+}
+
+static INLINE i16 load_half(u32 address)
+{
+    return *(pi16)(RSP_STATE.DRAM + HES(address));
+}
+
+#ifdef ARCH_MIN_SSE2
+/*
+ * the 1-D IDCT down each of the 8 columns of `rows':  a matrix product,
+ * 32-bit sums of pairs by PMADDWD, rounded from Q15 and saturated
+ */
+static void IDCT_columns(__m128i * rows)
+{
+    __m128i lo[4], hi[4], out[8];
+    __m128i sum_lo, sum_hi, pair;
+    register unsigned int k, y;
+
+    for (k = 0; k < 4; k++) {
+        lo[k] = _mm_unpacklo_epi16(rows[2*k + 0], rows[2*k + 1]);
+        hi[k] = _mm_unpackhi_epi16(rows[2*k + 0], rows[2*k + 1]);
+    }
+    for (y = 0; y < 8; y++) {
+        sum_lo = sum_hi = _mm_set1_epi32(0x4000);
+        for (k = 0; k < 4; k++) {
+            pair = _mm_set1_epi32((int)(
+                (u32)(u16)IDCT_matrix[y][2*k + 0] << 0
+              | (u32)(u16)IDCT_matrix[y][2*k + 1] << 16
+            ));
+            sum_lo = _mm_add_epi32(sum_lo, _mm_madd_epi16(lo[k], pair));
+            sum_hi = _mm_add_epi32(sum_hi, _mm_madd_epi16(hi[k], pair));
+        }
+        out[y] = _mm_packs_epi32(
+            _mm_srai_epi32(sum_lo, 15),
+            _mm_srai_epi32(sum_hi, 15)
+        );
+    }
+    for (y = 0; y < 8; y++)
+        rows[y] = out[y];
+    return;
+}
+
+static void transpose(__m128i * rows)
+{
+    __m128i a[8], b[8];
+    register unsigned int i;
+
+    for (i = 0; i < 4; i++) {
+        a[2*i + 0] = _mm_unpacklo_epi16(rows[2*i + 0], rows[2*i + 1]);
+        a[2*i + 1] = _mm_unpackhi_epi16(rows[2*i + 0], rows[2*i + 1]);
+    }
+    for (i = 0; i < 2; i++) { /* 2x2 blocks of 32-bit pairs */
+        b[4*i + 0] = _mm_unpacklo_epi32(a[4*i + 0], a[4*i + 2]);
+        b[4*i + 1] = _mm_unpackhi_epi32(a[4*i + 0], a[4*i + 2]);
+        b[4*i + 2] = _mm_unpacklo_epi32(a[4*i + 1], a[4*i + 3]);
+        b[4*i + 3] = _mm_unpackhi_epi32(a[4*i + 1], a[4*i + 3]);
+    }
+    for (i = 0; i < 4; i++) {
+        rows[2*i + 0] = _mm_unpacklo_epi64(b[i], b[i + 4]);
+        rows[2*i + 1] = _mm_unpackhi_epi64(b[i], b[i + 4]);
+    }
+    return;
+}
+
+/*
+ * dequantization (saturated, then scaled up 4 bits) and the 2-D IDCT of one
+ * subblock, the coefficients and quantizers both in natural order
+ */
+static void decode_subblock(pi16 block, const i16 * coefficients,
+    const i16 * quantizers)
+{
+    __m128i rows[8];
+    __m128i lo, hi;
+    register unsigned int y;
+
+    for (y = 0; y < 8; y++) {
+        const __m128i c = _mm_load_si128((const __m128i *)&coefficients[8*y]);
+        const __m128i q = _mm_load_si128((const __m128i *)&quantizers[8*y]);
+
+        lo = _mm_mullo_epi16(c, q);
+        hi = _mm_mulhi_epi16(c, q);
+        rows[y] = _mm_slli_epi16(_mm_packs_epi32(
+            _mm_unpacklo_epi16(lo, hi),
+            _mm_unpackhi_epi16(lo, hi)
+        ), 4);
+    }
+    IDCT_columns(rows);
+    transpose(rows);
+    IDCT_columns(rows);
+    transpose(rows);
+    for (y = 0; y < 8; y++)
+        _mm_store_si128((__m128i *)&block[8*y], rows[y]);
+    return;
+}
+
+/*
+ * levels for UYVY output:  Y to [16, 235] and U and V to [16, 240]
+ */
+static void rescale_subblock(pi16 block, int chroma)
+{
+    const __m128i low = _mm_set1_epi16(-2048);
+    const __m128i high = _mm_set1_epi16(+2047);
+    __m128i x;
+    register unsigned int i;
+
+    for (i = 0; i < SUBBLOCK_SIZE; i += 8) {
+        x = _mm_load_si128((const __m128i *)&block[i]);
+        x = _mm_min_epi16(_mm_max_epi16(x, low), high);
+        if (chroma)
+            x = _mm_add_epi16(
+                _mm_mulhi_epi16(x, _mm_set1_epi16(0x0E00)),
+                _mm_set1_epi16(0x80)
+            );
+        else
+            x = _mm_add_epi16(_mm_mulhi_epu16(
+                _mm_add_epi16(x, _mm_set1_epi16(0x0800)),
+                _mm_set1_epi16(0x0DB0)
+            ), _mm_set1_epi16(0x10));
+        _mm_store_si128((__m128i *)&block[i], x);
+    }
+    return;
+}
+
+/*
+ * one colour component of 8 pixels:  the Q14 sums in `lo' (pixels 0 to 3)
+ * and `hi', cut to 5 bits of the 12-bit range
+ */
+static INLINE __m128i component5(__m128i lo, __m128i hi)
+{
+    __m128i x;
+
+    x = _mm_packs_epi32(_mm_srai_epi32(lo, 14), _mm_srai_epi32(hi, 14));
+    x = _mm_max_epi16(x, _mm_setzero_si128());
+    x = _mm_min_epi16(x, _mm_set1_epi16(0x0FFF));
+    return _mm_srli_epi16(x, 7);
+}
+
+static void RGBA5551_pixels(pu16 pixels, __m128i Y, __m128i U, __m128i V)
+{
+    const __m128i offset = _mm_set1_epi32(RGB_OFFSET);
+    const __m128i R = _mm_set1_epi32((int)(
+        (u32)(u16)RGB_Y | (u32)(u16)RGB_RV << 16));
+    const __m128i G = _mm_set1_epi32((int)(
+        (u32)(u16)RGB_Y | (u32)(u16)RGB_GU << 16));
+    const __m128i GV = _mm_set1_epi32((int)(u32)(u16)RGB_GV);
+    const __m128i B = _mm_set1_epi32((int)(
+        (u32)(u16)RGB_Y | (u32)(u16)RGB_BU << 16));
+    const __m128i YU_lo = _mm_unpacklo_epi16(Y, U);
+    const __m128i YU_hi = _mm_unpackhi_epi16(Y, U);
+    const __m128i YV_lo = _mm_unpacklo_epi16(Y, V);
+    const __m128i YV_hi = _mm_unpackhi_epi16(Y, V);
+    const __m128i V0_lo = _mm_unpacklo_epi16(V, _mm_setzero_si128());
+    const __m128i V0_hi = _mm_unpackhi_epi16(V, _mm_setzero_si128());
+    __m128i r, g, b;
+
+    r = component5(
+        _mm_add_epi32(_mm_madd_epi16(YV_lo, R), offset),
+        _mm_add_epi32(_mm_madd_epi16(YV_hi, R), offset)
+    );
+    g = component5(
+        _mm_add_epi32(_mm_add_epi32(
+            _mm_madd_epi16(YU_lo, G), _mm_madd_epi16(V0_lo, GV)), offset),
+        _mm_add_epi32(_mm_add_epi32(
+            _mm_madd_epi16(YU_hi, G), _mm_madd_epi16(V0_hi, GV)), offset)
+    );
+    b = component5(
+        _mm_add_epi32(_mm_madd_epi16(YU_lo, B), offset),
+        _mm_add_epi32(_mm_madd_epi16(YU_hi, B), offset)
+    );
+    r = _mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 6));
+    r = _mm_or_si128(r, _mm_slli_epi16(b, 1));
+    r = _mm_or_si128(r, _mm_set1_epi16(1));
+    _mm_storeu_si128((__m128i *)pixels, r);
+    return;
+}
+
+/*
+ * 16 pixels from two luma subblock rows `y' and `y + SUBBLOCK_SIZE' and the
+ * chroma rows `u' and `u + SUBBLOCK_SIZE', each chroma sample for two pixels
+ */
+static void RGBA5551_line(pu16 pixels, const i16 * y, const i16 * u)
+{
+    const __m128i U = _mm_load_si128((const __m128i *)u);
+    const __m128i V = _mm_load_si128((const __m128i *)(u + SUBBLOCK_SIZE));
+
+    RGBA5551_pixels(&pixels[0],
+        _mm_load_si128((const __m128i *)y),
+        _mm_unpacklo_epi16(U, U), _mm_unpacklo_epi16(V, V));
+    RGBA5551_pixels(&pixels[8],
+        _mm_load_si128((const __m128i *)(y + SUBBLOCK_SIZE)),
+        _mm_unpackhi_epi16(U, U), _mm_unpackhi_epi16(V, V));
+    return;
+}
+#else
+static i16 saturate16(s32 x)
+{
+    if (x < -32768)
+        return -32768;
+    if (x > +32767)
+        return +32767;
+    return (i16)x;
+}
+
+static void IDCT_columns(pi16 dst, const i16 * src)
+{
+    u32 sum;
+    register unsigned int x, y, v;
+
+    for (y = 0; y < 8; y++)
+        for (x = 0; x < 8; x++) {
+            sum = 0x4000;
+            for (v = 0; v < 8; v++) /* wrapping, as PADDD does */
+                sum += (u32)(IDCT_matrix[y][v] * src[8*v + x]);
+            dst[8*y + x] = saturate16((s32)sum >> 15);
+        }
+    return;
+}
+
+static void transpose(pi16 dst, const i16 * src)
+{
+    register unsigned int x, y;
+
+    for (y = 0; y < 8; y++)
+        for (x = 0; x < 8; x++)
+            dst[8*x + y] = src[8*y + x];
+    return;
+}
+
+static void decode_subblock(pi16 block, const i16 * coefficients,
+    const i16 * quantizers)
+{
+    i16 a[SUBBLOCK_SIZE], b[SUBBLOCK_SIZE];
+    register unsigned int i;
+
+    for (i = 0; i < SUBBLOCK_SIZE; i++)
+        a[i] = (i16)((u16)saturate16(coefficients[i] * quantizers[i]) << 4);
+    IDCT_columns(b, a);
+    transpose(a, b);
+    IDCT_columns(b, a);
+    transpose(block, b);
+    return;
+}
+
+static void rescale_subblock(pi16 block, int chroma)
+{
+    s32 x;
+    register unsigned int i;
+
+    for (i = 0; i < SUBBLOCK_SIZE; i++) {
+        x = block[i];
+        x = (x < -2048) ? -2048 : (x > +2047) ? +2047 : x;
+        if (chroma)
+            block[i] = (i16)(((x * 0x0E00) >> 16) + 0x80);
+        else
+            block[i] = (i16)((((u32)(x + 0x0800) * 0x0DB0) >> 16) + 0x10);
+    }
+    return;
+}
+
+static u16 component5(s32 x)
+{
+    x >>= 14;
+    x = (x < 0) ? 0 : (x > 0x0FFF) ? 0x0FFF : x;
+    return (u16)(x >> 7);
+}
+
+static void RGBA5551_line(pu16 pixels, const i16 * y, const i16 * u)
+{
+    const i16 * v = u + SUBBLOCK_SIZE;
+    s32 luma;
+    register unsigned int i, j;
+
+    for (i = 0; i < 16; i++) {
+        j = i / 2;
+        luma = RGB_Y * ((i < 8) ? y[i] : y[SUBBLOCK_SIZE + i - 8]) + RGB_OFFSET;
+        pixels[i] = (u16)(1
+          | component5(luma + RGB_RV * v[j]) << 11
+          | component5(luma + RGB_GU * u[j] + RGB_GV * v[j]) << 6
+          | component5(luma + RGB_BU * u[j]) << 1
+        );
+    }
+    return;
+}
+#endif
+
+static INLINE u32 clamp_u8(i16 x)
+{
+    return (x < 0) ? 0x00 : (x > 0xFF) ? 0xFF : (u32)x;
+}
+
+/*
+ * one line of 16 pixels to RDRAM:  8 UYVY words or 16 RGBA 5551 halves
+ */
+static void emit_line(JPEG_format format, u32 address, const i16 * y,
+    const i16 * u)
+{
+    u16 pixels[16];
+    const i16 * v = u + SUBBLOCK_SIZE;
+    register unsigned int i;
+
+    if (format == JPEG_FORMAT_YUV) {
+        for (i = 0; i < 8; i++) {
+            const i16 * Y = (i < 4) ? &y[2*i] : &y[SUBBLOCK_SIZE + 2*i - 8];
+
+            *(pu32)(RSP_STATE.DRAM + address + 4*i) = 0
+              | clamp_u8(u[i]) << 24
+              | clamp_u8(Y[0]) << 16
+              | clamp_u8(v[i]) <<  8
+              | clamp_u8(Y[1]) <<  0
+            ;
+        }
+        return;
+    }
+    RGBA5551_line(pixels, y, u);
+    for (i = 0; i < 16; i++)
+        *(pu16)(RSP_STATE.DRAM + HES(address + 2*i)) = pixels[i];
+    return;
+}
+
+void classify_JPEG_ucode(ucode_info * info)
+{
+    info -> JPEG_format = JPEG_FORMAT_NONE;
+
+/*
+ * Ogre Battle's and Bottom of the 9th's (0x130DE and 0x278B0) decode
+ * differently and are left LLE.
+ */
+    switch (info -> text_sum) {
+    case 0x0002C85Aul:
+        info -> JPEG_format = JPEG_FORMAT_YUV;
+        break;
+    case 0x0002CAA6ul:
+        info -> JPEG_format = JPEG_FORMAT_RGBA;
+        break;
+    }
+    return;
+}
+
+/*
+ * what the OSTask in DMEM asks for:  where the macroblocks are, how many,
+ * the chroma subsampling (mode 0:  two luma subblocks, 16x8 pixels; mode 2:
+ * four, 16x16) and the Y, U and V quantization tables
+ */
+typedef struct {
+    u32 address;
+    u32 count;
+    u32 mode;
+    u32 tables[3];
+    u32 size; /* of each macroblock in RDRAM */
+} JPEG_task;
+
+/*
+ * Reads the task into `task'.  Returns zero if it is one we can't do.
+ */
+static int read_task(JPEG_task * task)
+{
+    u32 pointer;
+    register u32 i;
+
+    if (*(pu32)(RSP_STATE.DMEM + OSTASK_FLAGS) & 0x00000001ul) /* YIELDED */
+        return 0;
+    pointer = *(pu32)(RSP_STATE.DMEM + OSTASK_DATA_PTR) & 0x00FFFFF8ul;
+    if (!fits_RDRAM(pointer, 24))
+        return 0;
+    task -> address = *(pu32)(RSP_STATE.DRAM + pointer + 0) & 0x00FFFFF8ul;
+    task -> count   = *(pu32)(RSP_STATE.DRAM + pointer + 4);
+    task -> mode    = *(pu32)(RSP_STATE.DRAM + pointer + 8);
+    for (i = 0; i < 3; i++)
+        task -> tables[i] = 0x00FFFFF8ul
+          & *(pu32)(RSP_STATE.DRAM + pointer + 12 + 4*i);
+    if (task -> mode != 0 && task -> mode != 2)
+        return 0;
+    task -> size = 2 * SUBBLOCK_SIZE * (task -> mode + 4);
+    if (task -> count > (RSP_STATE.su_max_address + 1) / task -> size
+     || !fits_RDRAM(task -> address, task -> count * task -> size))
+        return 0;
+    for (i = 0; i < 3; i++)
+        if (!fits_RDRAM(task -> tables[i], 2 * SUBBLOCK_SIZE))
+            return 0;
+    return 1;
+}
+
+static void decode_macroblocks(JPEG_format format, const JPEG_task * task)
+{
+    ALIGNED i16 macroblock[6 * SUBBLOCK_SIZE];
+    ALIGNED i16 coefficients[SUBBLOCK_SIZE];
+    ALIGNED i16 quantizers[3][SUBBLOCK_SIZE];
+    u32 address;
+    unsigned int subblocks, chroma, sb;
+    register u32 i, mb;
+
+    for (i = 0; i < 3 * SUBBLOCK_SIZE; i++) /* into natural order */
+        quantizers[i / SUBBLOCK_SIZE][i % SUBBLOCK_SIZE] = load_half(
+            task -> tables[i / SUBBLOCK_SIZE] + 2*zigzag[i % SUBBLOCK_SIZE]
+        );
+    subblocks = task -> mode + 4;
+    address = task -> address;
+    for (mb = 0; mb < task -> count; mb++, address += task -> size) {
+        for (sb = 0; sb < subblocks; sb++) {
+            chroma = (sb + 2 < subblocks) ? 0 : sb + 3 - subblocks; /* Y U V */
+            for (i = 0; i < SUBBLOCK_SIZE; i++)
+                coefficients[i] = load_half(
+                    address + 2*(SUBBLOCK_SIZE*sb + zigzag[i])
+                );
+            decode_subblock(
+                &macroblock[SUBBLOCK_SIZE * sb],
+                coefficients,
+                quantizers[chroma]
+            );
+            if (format == JPEG_FORMAT_YUV)
+                rescale_subblock(&macroblock[SUBBLOCK_SIZE * sb], chroma);
+        }
+
+/*
+ * The pixels go back over the macroblock in RDRAM, 32 bytes a line.  With
+ * mode 2, the top 8 lines are from luma subblocks 0 and 1, the rest from 2
+ * and 3, and each chroma row is for two lines.
+ */
+        for (i = 0; i < 8; i++) {
+            const i16 * u = &macroblock[SUBBLOCK_SIZE*(subblocks - 2) + 8*i];
+
+            if (task -> mode == 0) {
+                emit_line(format, address + 32*i, &macroblock[8*i], u);
+                continue;
+            }
+            emit_line(format, address + 64*i + 0,
+                &macroblock[2*SUBBLOCK_SIZE*(i / 4) + 16*(i % 4) + 0], u);
+            emit_line(format, address + 64*i + 32,
+                &macroblock[2*SUBBLOCK_SIZE*(i / 4) + 16*(i % 4) + 8], u);
+        }
+    }
+    return;
+}
+
+int decode_JPEG_task(void)
+{
+    JPEG_task task;
+    const JPEG_format format =
+        (JPEG_format)RSP_STATE.current_ucode -> JPEG_format;
+
+    if (format == JPEG_FORMAT_NONE)
+        return 0;
+    if (!read_task(&task))
+        return 0;
+    decode_macroblocks(format, &task);
+    return 1;
+}
@@ -0,0 +1,51 @@
+/******************************************************************************\
+* Project:  High-Level Emulation of JPEG Tasks                                 *
+* Authors:  agent                                                              *
+* Release:  2026.10.18                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+#ifndef _JPEG_H_
+#define _JPEG_H_
+
+#include "ucode.h"
+
+/*
+ * With the "BuiltInJPEGHLE" setting on, M_NJPEGTASK tasks whose micro-code
+ * we know have their macroblocks decoded here, in place in RDRAM, instead of
+ * having the RSP interpret the micro-code.  Anything else is LLE as before.
+ *
+ * The setting is off by default:  The decoder has yet to be shown to give
+ * the micro-codes' pixels bit for bit on real tasks.  `tests/jpeg.c' checks
+ * it against LLE on a dump of one.
+ */
+typedef enum {
+    JPEG_FORMAT_NONE, /* not one we know:  always LLE */
+    JPEG_FORMAT_YUV, /* Pokemon Stadium (J):  UYVY pixels, levels rescaled */
+    JPEG_FORMAT_RGBA, /* Zelda, Pokemon Stadium 1 and 2:  RGBA 5551 pixels */
+
+    NUMBER_OF_JPEG_FORMATS
+} JPEG_format;
+
+/*
+ * Works out the output format of a JPEG micro-code from its text sum.  Called
+ * by identify_ucode() on the first task with each micro-code.
+ */
+extern void classify_JPEG_ucode(ucode_info * info);
+
+/*
+ * Decodes the macroblocks of the OSTask in DMEM for the current micro-code.
+ * Returns zero, having touched nothing, if the micro-code is unknown, or the
+ * task is one we can't do (yielded, or in a mode other than 0 or 2).
+ */
+extern int decode_JPEG_task(void);
+
+#endif
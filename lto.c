@@ -26,6 +26,12 @@
 
 #include "module.c"
 #include "su.c"
+#include "dynarec.c"
+#include "ucode.c"
+#include "diag.c"
+#include "audio.c"
+#include "jpeg.c"
+#include "simd.c"
 
 #include "vu/vu.c"
 
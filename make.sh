@@ -7,6 +7,12 @@ obj="$src/obj"
 OBJ_LIST="\
     $obj/module.o \
     $obj/su.o \
+    $obj/dynarec.o \
+    $obj/ucode.o \
+    $obj/diag.o \
+    $obj/audio.o \
+    $obj/jpeg.o \
+    $obj/simd.o \
     $obj/vu/vu.o \
     $obj/vu/multiply.o \
     $obj/vu/add.o \
@@ -22,7 +28,7 @@ FLAGS_x86="\
     -fPIC \
     -DPLUGIN_API_VERSION=0x0101 \
     -DARCH_MIN_SSE2 \
-    -march=native \
+    -msse2 \
     -mstackrealign \
     -Wall \
     -pedantic \
@@ -35,7 +41,7 @@ FLAGS_x86="\
     -masm=intel \
     -DPLUGIN_API_VERSION=0x0101 \
     -DARCH_MIN_SSE2 \
-    -march=native \
+    -msse2 \
     -mstackrealign \
     -Wall \
     -pedantic \
@@ -49,6 +55,12 @@ C_FLAGS=$FLAGS_x86 # default since Intel SIMD was the most tested
 echo Compiling C source code...
 cc -S -Os $C_FLAGS -o $obj/module.s  $src/module.c
 cc -S -O3 $C_FLAGS -o $obj/su.s      $src/su.c
+cc -S -O2 $C_FLAGS -o $obj/dynarec.s $src/dynarec.c
+cc -S -O2 $C_FLAGS -o $obj/ucode.s   $src/ucode.c
+cc -S -O2 $C_FLAGS -o $obj/diag.s    $src/diag.c
+cc -S -O3 $C_FLAGS -o $obj/audio.s   $src/audio.c
+cc -S -O3 $C_FLAGS -o $obj/jpeg.s    $src/jpeg.c
+cc -S -O2 $C_FLAGS -o $obj/simd.s    $src/simd.c
 cc -S -O3 $C_FLAGS -o $obj/vu/vu.s       $src/vu/vu.c
 cc -S -O3 $C_FLAGS -o $obj/vu/multiply.s $src/vu/multiply.c
 cc -S -O3 $C_FLAGS -o $obj/vu/add.s      $src/vu/add.c
@@ -59,6 +71,12 @@ cc -S -O2 $C_FLAGS -o $obj/vu/divide.s   $src/vu/divide.c
 echo Assembling compiled sources...
 as -o $obj/module.o $obj/module.s
 as -o $obj/su.o     $obj/su.s
+as -o $obj/dynarec.o $obj/dynarec.s
+as -o $obj/ucode.o   $obj/ucode.s
+as -o $obj/diag.o    $obj/diag.s
+as -o $obj/audio.o   $obj/audio.s
+as -o $obj/jpeg.o    $obj/jpeg.s
+as -o $obj/simd.o    $obj/simd.s
 as -o $obj/vu/vu.o  $obj/vu/vu.s
 as -o $obj/vu/multiply.o $obj/vu/multiply.s
 as -o $obj/vu/add.o      $obj/vu/add.s
@@ -67,5 +85,5 @@ as -o $obj/vu/logical.o  $obj/vu/logical.s
 as -o $obj/vu/divide.o   $obj/vu/divide.s
 
 echo Linking assembled object files...
-ld --shared -o $obj/rspdebug.so -lc $OBJ_LIST
+ld --shared -o $obj/rspdebug.so -lc -ldl $OBJ_LIST
 strip -o $obj/rsp.so $obj/rspdebug.so --strip-all
@@ -13,6 +13,10 @@
 * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
 \******************************************************************************/
 
+#if !defined(_WIN32) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE /* dladdr() */
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -27,9 +31,18 @@
 
 #include "module.h"
 #include "su.h"
-
-#include <signal.h>
-#include <setjmp.h>
+#include "ucode.h"
+#include "simd.h"
+#include "diag.h"
+#include "audio.h"
+#include "jpeg.h"
+
+#if !defined(_WIN32)
+#include <dlfcn.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #if defined(__GNUC__)
 #define ATTR_FMT(fmtpos, attrpos) __attribute__ ((format (printf, fmtpos, attrpos)))
@@ -37,18 +50,13 @@
 #define ATTR_FMT(fmtpos, attrpos)
 #endif
 
-static jmp_buf CPU_state;
-static void seg_av_handler(int signal_code)
-{
-    longjmp(CPU_state, signal_code);
-}
-static void ISA_op_illegal(int signal_code)
-{
-    message("Plugin built for SIMD extensions this CPU does not support!");
-    raise(signal_code); /* e.g., rsp.dll built with -mssse3; the CPU is SSE2. */
-}
-
-RSP_INFO RSP_INFO_NAME;
+static void show_message(const char * text);
+#if !defined(M64P_PLUGIN_API)
+static void message_box(const char * body);
+#endif
+#ifdef _WIN32
+static HINSTANCE plugin_module; /* from DllMain() */
+#endif
 
 #define RSP_CXD4_VERSION 0x0101
 
@@ -87,6 +95,9 @@ NOINLINE void update_conf(const char* source)
     CFG_HLE_AUD = ConfigGetParamBool(l_ConfigRsp, "AudioListToAudioPlugin");
     CFG_WAIT_FOR_CPU_HOST = ConfigGetParamBool(l_ConfigRsp, "WaitForCPUHost");
     CFG_MEND_SEMAPHORE_LOCK = ConfigGetParamBool(l_ConfigRsp, "SupportCPUSemaphoreLock");
+    CFG_DYNAREC = ConfigGetParamBool(l_ConfigRsp, "DynamicRecompiler");
+    CFG_BUILTIN_AUDIO = ConfigGetParamBool(l_ConfigRsp, "BuiltInAudioHLE");
+    CFG_HLE_JPG = ConfigGetParamBool(l_ConfigRsp, "BuiltInJPEGHLE");
 }
 
 static void DebugMessage(int level, const char *message, ...) ATTR_FMT(2, 3);
@@ -122,6 +133,14 @@ EXPORT m64p_error CALL PluginStartup(m64p_dynlib_handle CoreLibHandle, void *Con
     l_DebugCallback = DebugCallback;
     l_DebugCallContext = Context;
 
+#ifdef HAVE_SIMD_DISPATCH
+    if (detect_SIMD() < SIMD_SSE2)
+    {
+        DebugMessage(M64MSG_ERROR, "Plugin built for SSE2, which this CPU does not support.");
+        return M64ERR_UNSUPPORTED;
+    }
+#endif
+
     /* attach and call the CoreGetAPIVersions function, check Config API version for compatibility */
     CoreAPIVersionFunc = (ptr_CoreGetAPIVersions) osal_dynlib_getproc(CoreLibHandle, "CoreGetAPIVersions");
     if (CoreAPIVersionFunc == NULL)
@@ -191,6 +210,9 @@ EXPORT m64p_error CALL PluginStartup(m64p_dynlib_handle CoreLibHandle, void *Con
     ConfigSetDefaultBool(l_ConfigRsp, "AudioListToAudioPlugin", 0, "Send audio lists to the audio plugin");
     ConfigSetDefaultBool(l_ConfigRsp, "WaitForCPUHost", 0, "Force CPU-RSP signals synchronization");
     ConfigSetDefaultBool(l_ConfigRsp, "SupportCPUSemaphoreLock", 0, "Support CPU-RSP semaphore lock");
+    ConfigSetDefaultBool(l_ConfigRsp, "DynamicRecompiler", 0, "Recompile RSP code to x86-64 instead of interpreting it");
+    ConfigSetDefaultBool(l_ConfigRsp, "BuiltInAudioHLE", 0, "Run audio lists of known micro-codes in the RSP plugin instead of interpreting them");
+    ConfigSetDefaultBool(l_ConfigRsp, "BuiltInJPEGHLE", 0, "Decode JPEG tasks of known micro-codes in the RSP plugin instead of interpreting them");
 
     l_PluginInit = 1;
     return M64ERR_SUCCESS;
@@ -201,6 +223,7 @@ EXPORT m64p_error CALL PluginShutdown(void)
     if (!l_PluginInit)
         return M64ERR_NOT_INIT;
 
+    flush_messages(show_message);
     l_PluginInit = 0;
     return M64ERR_SUCCESS;
 }
@@ -246,13 +269,13 @@ static const char DLL_about[] =
 
 EXPORT void CALL CloseDLL(void)
 {
-    DRAM = NULL; /* so DllTest benchmark doesn't think ROM is still open */
+    RSP_STATE.DRAM = NULL; /* so DllTest benchmark doesn't think ROM is open */
     return;
 }
 
 EXPORT void CALL DllAbout(p_void hParent)
 {
-    message(DLL_about);
+    message_box(DLL_about);
     hParent = NULL;
     if (hParent == NULL)
         return; /* -Wunused-but-set-parameter */
@@ -264,7 +287,8 @@ EXPORT void CALL DllConfig(p_void hParent)
     system("sp_cfgui");
     update_conf(CFG_FILE);
 
-    if (DMEM == IMEM || GET_RCP_REG(SP_PC_REG) % 4096 == 0x00000000)
+    if (RSP_STATE.DMEM == RSP_STATE.IMEM
+     || GET_RCP_REG(SP_PC_REG) % 4096 == 0x00000000)
         return;
     export_SP_memory();
 
@@ -276,13 +300,22 @@ EXPORT void CALL DllConfig(p_void hParent)
 
 #endif
 
+/*
+ * set by InitiateRSP() if this CPU lacks SSE2, which the build requires:
+ * DoRspCycles() then runs nothing
+ */
+static int SSE2_missing;
+
 EXPORT unsigned int CALL DoRspCycles(unsigned int cycles)
 {
-    static char task_debug[] = "unknown task type:  0x????????";
+    char task_debug[] = "unknown task type:  0x????????";
     char* task_debug_type;
     OSTask_type task_type;
     register unsigned int i;
 
+    flush_messages(show_message);
+    if (SSE2_missing)
+        return 0x00000000;
     if (GET_RCP_REG(SP_STATUS_REG) & 0x00000003) {
         message("SP_STATUS_HALT");
         return 0x00000000;
@@ -290,21 +323,22 @@ EXPORT unsigned int CALL DoRspCycles(unsigned int cycles)
     task_debug_type = &task_debug[strlen("unknown task type:  0x")];
 
 #ifdef USE_CLIENT_ENDIAN
-    memcpy(&task_type, DMEM + 0xFC0, 4);
+    memcpy(&task_type, RSP_STATE.DMEM + 0xFC0, 4);
 #else
     task_type = 0x00000000
-      | (u32)(DMEM[0xFC0 ^ 0] & 0xFFu) << 24
-      | (u32)(DMEM[0xFC1 ^ 0] & 0xFFu) << 16
-      | (u32)(DMEM[0xFC2 ^ 0] & 0xFFu) <<  8
-      | (u32)(DMEM[0xFC3 ^ 0] & 0xFFu) <<  0
+      | (u32)(RSP_STATE.DMEM[0xFC0 ^ 0] & 0xFFu) << 24
+      | (u32)(RSP_STATE.DMEM[0xFC1 ^ 0] & 0xFFu) << 16
+      | (u32)(RSP_STATE.DMEM[0xFC2 ^ 0] & 0xFFu) <<  8
+      | (u32)(RSP_STATE.DMEM[0xFC3 ^ 0] & 0xFFu) <<  0
     ;
 #endif
+    identify_ucode(task_type);
     switch (task_type) {
     case M_GFXTASK:
-        if (CFG_HLE_GFX == 0)
+        if (CFG_HLE_GFX == 0 || RSP_STATE.current_ucode -> HLE == 0)
             break;
 
-        if (*(pi32)(DMEM + 0xFF0) == 0x00000000)
+        if (*(pi32)(RSP_STATE.DMEM + 0xFF0) == 0x00000000)
             break; /* Resident Evil 2, null task pointers */
         GET_RCP_REG(SP_STATUS_REG) |=
             SP_STATUS_SIG2 | SP_STATUS_BROKE | SP_STATUS_HALT
@@ -328,20 +362,22 @@ EXPORT unsigned int CALL DoRspCycles(unsigned int cycles)
         GET_RCP_REG(DPC_STATUS_REG) &= ~0x00000002ul; /* DPC_STATUS_FREEZE */
         return 0;
     case M_AUDTASK:
-        if (CFG_HLE_AUD == 0)
-            break;
-
+        if (CFG_HLE_AUD == 0 || RSP_STATE.current_ucode -> HLE == 0) {
+            if (CFG_BUILTIN_AUDIO == 0 || process_audio_list() == 0)
+                break;
+        } else {
 #if defined(M64P_PLUGIN_API)
-        if (GET_RSP_INFO(ProcessAlistList) == NULL)
-            { /* branch */ }
-        else
-            GET_RSP_INFO(ProcessAlistList)();
+            if (GET_RSP_INFO(ProcessAlistList) == NULL)
+                { /* branch */ }
+            else
+                GET_RSP_INFO(ProcessAlistList)();
 #else
-        if (GET_RSP_INFO(ProcessAList) == NULL)
-            { /* branch */ }
-        else
-            GET_RSP_INFO(ProcessAList)();
+            if (GET_RSP_INFO(ProcessAList) == NULL)
+                { /* branch */ }
+            else
+                GET_RSP_INFO(ProcessAList)();
 #endif
+        }
 
         GET_RCP_REG(SP_STATUS_REG) |=
             SP_STATUS_SIG2 | SP_STATUS_BROKE | SP_STATUS_HALT
@@ -354,8 +390,20 @@ EXPORT unsigned int CALL DoRspCycles(unsigned int cycles)
     case M_VIDTASK:
         message("M_VIDTASK");
         break;
-    case M_NJPEGTASK:
-        break; /* Zelda, Pokemon, others */
+    case M_NJPEGTASK: /* Zelda, Pokemon, others */
+        if (CFG_HLE_JPG == 0)
+            break;
+        if (decode_JPEG_task() == 0)
+            break;
+
+        GET_RCP_REG(SP_STATUS_REG) |=
+            SP_STATUS_SIG2 | SP_STATUS_BROKE | SP_STATUS_HALT
+        ;
+        if (GET_RCP_REG(SP_STATUS_REG) & SP_STATUS_INTR_BREAK) {
+            GET_RCP_REG(MI_INTR_REG) |= 0x00000001;
+            GET_RSP_INFO(CheckInterrupts)();
+        }
+        return 0;
     case M_NULTASK:
         message("M_NULTASK");
         break;
@@ -376,8 +424,9 @@ EXPORT unsigned int CALL DoRspCycles(unsigned int cycles)
 
 #ifdef WAIT_FOR_CPU_HOST
     for (i = 0; i < NUMBER_OF_SCALAR_REGISTERS; i++)
-        MFC0_count[i] = 0;
+        RSP_STATE.MFC0_count[i] = 0;
 #endif
+    validate_IMEM(); /* The CPU may have rewritten IMEM since the last task. */
     run_task();
 
 /*
@@ -390,22 +439,22 @@ EXPORT unsigned int CALL DoRspCycles(unsigned int cycles)
     _mm_empty();
 #endif
 
-    if (*CR[0x4] & SP_STATUS_BROKE) /* normal exit, from executing BREAK */
+    if (*RSP_STATE.CR[0x4] & SP_STATUS_BROKE) /* normal exit, from BREAK */
         return (cycles);
     else if (GET_RCP_REG(MI_INTR_REG) & 1) /* interrupt set by MTC0 to break */
         GET_RSP_INFO(CheckInterrupts)();
-    else if (*CR[0x7] != 0x00000000) /* semaphore lock fixes */
+    else if (*RSP_STATE.CR[0x7] != 0x00000000) /* semaphore lock fixes */
         {}
 #ifdef WAIT_FOR_CPU_HOST
-    else
-        MF_SP_STATUS_TIMEOUT = 16; /* From now on, wait 16 times, not 32767. */
+    else /* idle polling loop:  Resume where it left off after the CPU's turn. */
+        {}
 #else
     else { /* ??? unknown, possibly external intervention from CPU memory map */
         message("SP_SET_HALT");
         return (cycles);
     }
 #endif
-    *CR[0x4] &= ~SP_STATUS_HALT; /* CPU restarts with the correct SIGs. */
+    *RSP_STATE.CR[0x4] &= ~SP_STATUS_HALT; /* CPU restarts with correct SIGs. */
     return (cycles);
 }
 
@@ -419,7 +468,6 @@ EXPORT void CALL GetDllInfo(PLUGIN_INFO *PluginInfo)
     return;
 }
 
-p_func GBI_phase;
 void no_LLE(void)
 {
     static int already_warned;
@@ -430,74 +478,178 @@ void no_LLE(void)
     already_warned = TRUE;
     return;
 }
+
+#if defined(__linux__)
+/*
+ * end of the run of readable mappings starting at `address', from the maps
+ * the kernel lists for us in /proc, or 0 if we can't read them
+ */
+static size_t readable_end(size_t address)
+{
+    char line[256];
+    unsigned long low, high;
+    char permissions[8];
+    size_t end;
+    FILE * maps;
+
+    maps = fopen("/proc/self/maps", "r");
+    if (maps == NULL)
+        return 0;
+    end = address;
+    while (fgets(line, sizeof(line), maps) != NULL) {
+        if (sscanf(line, "%lx-%lx %7s", &low, &high, permissions) != 3)
+            continue;
+        if (low <= end && end < high && permissions[0] == 'r')
+            end = high; /* The list is sorted, so this picks up the next. */
+    }
+    fclose(maps);
+    return (end == address ? 0 : end);
+}
+#endif
+
+/*
+ * RDRAM size in bytes, or 0 if we can't tell
+ *
+ * Mupen64Plus says so in its own config:  4 MiB with "DisableExtraMem" on, 8
+ * MiB otherwise.  Without that, we ask the kernel which 2-MiB strides of the
+ * RDRAM block are there to read, where reading them to find out would fault.
+ * Linux lists mappings with their permissions; elsewhere, msync() fails with
+ * ENOMEM on unmapped pages (but not on mapped pages we may not read).
+ */
+static unsigned long RDRAM_size(void)
+{
+#if !defined(_WIN32)
+    size_t address, end;
+    unsigned long page_mask;
+    unsigned long offset;
+    long page_size;
+#endif
+
+#if defined(M64P_PLUGIN_API)
+    m64p_handle core_config;
+    int disable_extra_mem;
+
+    if (l_PluginInit
+     && ConfigOpenSection("Core", &core_config) == M64ERR_SUCCESS
+     && ConfigGetParameter(
+            core_config, "DisableExtraMem", M64TYPE_BOOL,
+            &disable_extra_mem, sizeof(int)
+        ) == M64ERR_SUCCESS)
+        return (disable_extra_mem ? 0x00400000ul : 0x00800000ul);
+#endif
+#if !defined(_WIN32)
+#if defined(__linux__)
+    end = readable_end((size_t)RSP_STATE.DRAM);
+#else
+    end = 0;
+#endif
+    page_size = sysconf(_SC_PAGESIZE);
+    if (end == 0 && page_size <= 0)
+        return 0;
+    page_mask = (unsigned long)page_size - 1;
+    for (offset = 0; offset < 0x80000000ul; offset += 0x200000) {
+        address = (size_t)(RSP_STATE.DRAM + offset);
+        if (end != 0) {
+            if (address >= end)
+                break;
+            continue;
+        }
+        address &= ~(size_t)page_mask;
+        if (msync((void *)address, (size_t)page_size, MS_ASYNC) != 0)
+            return (errno == ENOMEM ? offset : 0);
+    }
+    return (offset);
+#else
+    return 0;
+#endif
+}
+
 EXPORT void CALL InitiateRSP(RSP_INFO Rsp_Info, pu32 CycleCount)
 {
-    int recovered_from_exception;
+    SIMD_level host_SIMD;
+    register unsigned long RDRAM_bytes;
 
     if (CycleCount != NULL) /* cycle-accuracy not doable with today's hosts */
         *CycleCount = 0;
     update_conf(CFG_FILE);
 
     RSP_INFO_NAME = Rsp_Info;
-    DRAM = GET_RSP_INFO(RDRAM);
+    if (RSP_STATE.IMEM_decoded == NULL) { /* `RSP_state' (others have theirs) */
+        RSP_STATE.IMEM_decoded = RSP_state_IMEM_decoded;
+        RSP_STATE.ucodes = &RSP_state_ucodes;
+        RSP_STATE.audio = &RSP_state_audio;
+    }
+    RSP_STATE.su_max_address = 0x007FFFFFul;
+    RSP_STATE.DRAM = GET_RSP_INFO(RDRAM);
     if (Rsp_Info.DMEM == Rsp_Info.IMEM) /* usually dummy RSP data for testing */
         return; /* DMA is not executed just because plugin initiates. */
-    DMEM = GET_RSP_INFO(DMEM);
-    IMEM = GET_RSP_INFO(IMEM);
-
-    CR[0x0] = &GET_RCP_REG(SP_MEM_ADDR_REG);
-    CR[0x1] = &GET_RCP_REG(SP_DRAM_ADDR_REG);
-    CR[0x2] = &GET_RCP_REG(SP_RD_LEN_REG);
-    CR[0x3] = &GET_RCP_REG(SP_WR_LEN_REG);
-    CR[0x4] = &GET_RCP_REG(SP_STATUS_REG);
-    CR[0x5] = &GET_RCP_REG(SP_DMA_FULL_REG);
-    CR[0x6] = &GET_RCP_REG(SP_DMA_BUSY_REG);
-    CR[0x7] = &GET_RCP_REG(SP_SEMAPHORE_REG);
+    RSP_STATE.DMEM = GET_RSP_INFO(DMEM);
+    RSP_STATE.IMEM = GET_RSP_INFO(IMEM);
+
+    RSP_STATE.CR[0x0] = &GET_RCP_REG(SP_MEM_ADDR_REG);
+    RSP_STATE.CR[0x1] = &GET_RCP_REG(SP_DRAM_ADDR_REG);
+    RSP_STATE.CR[0x2] = &GET_RCP_REG(SP_RD_LEN_REG);
+    RSP_STATE.CR[0x3] = &GET_RCP_REG(SP_WR_LEN_REG);
+    RSP_STATE.CR[0x4] = &GET_RCP_REG(SP_STATUS_REG);
+    RSP_STATE.CR[0x5] = &GET_RCP_REG(SP_DMA_FULL_REG);
+    RSP_STATE.CR[0x6] = &GET_RCP_REG(SP_DMA_BUSY_REG);
+    RSP_STATE.CR[0x7] = &GET_RCP_REG(SP_SEMAPHORE_REG);
     *(RSP_INFO_NAME.SP_PC_REG) = 0x04001000;
-    CR[0x8] = &GET_RCP_REG(DPC_START_REG);
-    CR[0x9] = &GET_RCP_REG(DPC_END_REG);
-    CR[0xA] = &GET_RCP_REG(DPC_CURRENT_REG);
-    CR[0xB] = &GET_RCP_REG(DPC_STATUS_REG);
-    CR[0xC] = &GET_RCP_REG(DPC_CLOCK_REG);
-    CR[0xD] = &GET_RCP_REG(DPC_BUFBUSY_REG);
-    CR[0xE] = &GET_RCP_REG(DPC_PIPEBUSY_REG);
-    CR[0xF] = &GET_RCP_REG(DPC_TMEM_REG);
-
-    MF_SP_STATUS_TIMEOUT = 32767;
+    RSP_STATE.CR[0x8] = &GET_RCP_REG(DPC_START_REG);
+    RSP_STATE.CR[0x9] = &GET_RCP_REG(DPC_END_REG);
+    RSP_STATE.CR[0xA] = &GET_RCP_REG(DPC_CURRENT_REG);
+    RSP_STATE.CR[0xB] = &GET_RCP_REG(DPC_STATUS_REG);
+    RSP_STATE.CR[0xC] = &GET_RCP_REG(DPC_CLOCK_REG);
+    RSP_STATE.CR[0xD] = &GET_RCP_REG(DPC_BUFBUSY_REG);
+    RSP_STATE.CR[0xE] = &GET_RCP_REG(DPC_PIPEBUSY_REG);
+    RSP_STATE.CR[0xF] = &GET_RCP_REG(DPC_TMEM_REG);
+
+    RSP_STATE.MF_SP_STATUS_TIMEOUT = MF_SP_STATUS_DEFAULT_TIMEOUT;
+
+    host_SIMD = detect_SIMD();
+#ifdef HAVE_SIMD_DISPATCH
+/*
+ * Even the baseline kernels are SSE2, and there are no C ones built in to
+ * fall back to.  Leave the RSP stopped, rather than crash on the first task.
+ */
+    if (host_SIMD < SIMD_SSE2) {
+        message("Plugin built for SIMD extensions this CPU does not support!");
+        SSE2_missing = 1;
+        return;
+    }
+#endif
+    select_SIMD_kernels(host_SIMD);
+    predecode_IMEM(0x000, 0x1000); /* for the newly selected kernels */
+
 #if 1
     GET_RCP_REG(SP_PC_REG) &= 0x00000FFFu; /* hack to fix Mupen64 */
 #endif
 
-    GBI_phase = GET_RSP_INFO(ProcessRdpList);
-    if (GBI_phase == NULL)
-        GBI_phase = no_LLE;
+    RSP_STATE.GBI_phase = GET_RSP_INFO(ProcessRdpList);
+    if (RSP_STATE.GBI_phase == NULL)
+        RSP_STATE.GBI_phase = no_LLE;
 
-    signal(SIGILL, ISA_op_illegal);
-#ifndef _WIN32
-    signal(SIGSEGV, seg_av_handler);
-    for (SR[ra] = 0; SR[ra] < 0x80000000ul; SR[ra] += 0x200000) {
-        recovered_from_exception = setjmp(CPU_state);
-        if (recovered_from_exception)
-            break;
-        SR[at] += DRAM[SR[ra]];
-    }
-    for (SR[at] = 0; SR[at] < 31; SR[at]++) {
-        SR[ra] = (SR[ra] & ~1) >> 1;
-        if (SR[ra] == 0)
-            break;
-    }
-    su_max_address = (1 << SR[at]) - 1;
-#endif
 
-    if (su_max_address < 0x1FFFFFul)
-        su_max_address = 0x1FFFFFul; /* 2 MiB */
-    if (su_max_address > 0xFFFFFFul)
-        su_max_address = 0xFFFFFFul; /* 16 MiB */
+/*
+ * Round down to a power of two for the address mask.  If we can't tell the
+ * size, the 8-MiB default set above stays.
+ */
+    RDRAM_bytes = RDRAM_size();
+    if (RDRAM_bytes != 0) {
+        while (RDRAM_bytes & (RDRAM_bytes - 1))
+            RDRAM_bytes &= RDRAM_bytes - 1;
+        RSP_STATE.su_max_address = RDRAM_bytes - 1;
+    }
+    if (RSP_STATE.su_max_address < 0x1FFFFFul)
+        RSP_STATE.su_max_address = 0x1FFFFFul; /* 2 MiB */
+    if (RSP_STATE.su_max_address > 0xFFFFFFul)
+        RSP_STATE.su_max_address = 0xFFFFFFul; /* 16 MiB */
     return;
 }
 
 EXPORT void CALL RomClosed(void)
 {
+    summarize_messages(show_message);
     GET_RCP_REG(SP_PC_REG) = 0x04001000;
 
 /*
@@ -514,7 +666,10 @@ EXPORT void CALL RomClosed(void)
 
 #if !defined(M64P_PLUGIN_API)
 
-NOINLINE void message(const char* body)
+/*
+ * for DllAbout:  shows `body' and waits for the user to dismiss it
+ */
+static void message_box(const char * body)
 {
 #ifdef WIN32
     char* argv;
@@ -544,15 +699,56 @@ NOINLINE void message(const char* body)
 #endif
     return;
 }
-#else
-NOINLINE void message(const char* body)
+
+/*
+ * where flush_messages() sends the diagnostics which message() queued up:
+ * LOG_FILE in the directory the plug-in was loaded from, or in the working
+ * directory if we can't tell which that was
+ */
+static FILE * message_log;
+
+static FILE * open_message_log(void)
 {
-#if defined(M64P_PLUGIN_API)
-    DebugMessage(M64MSG_ERROR, "%s", body);
+    char path[4096];
+    size_t length;
+#ifdef _WIN32
+    length = (plugin_module == NULL)
+      ? 0 : GetModuleFileNameA(plugin_module, path, sizeof(path));
+#elif !defined(__GLIBC__) || defined(__USE_GNU) /* _GNU_SOURCE came first */
+    Dl_info module;
+
+    length = 0;
+    if (dladdr(&message_log, &module) != 0 && module.dli_fname != NULL) {
+        length = strlen(module.dli_fname);
+        if (length < sizeof(path))
+            strcpy(path, module.dli_fname);
+    }
 #else
-    printf("%s\n", body);
+    length = 0;
 #endif
+    if (length >= sizeof(path) - sizeof(LOG_FILE))
+        length = 0;
+    while (length != 0 && path[length - 1] != '/' && path[length - 1] != '\\')
+        --length;
+    strcpy(&path[length], LOG_FILE);
+    return fopen(path, "a");
+}
 
+static void show_message(const char * text)
+{
+    if (message_log == NULL)
+        message_log = open_message_log();
+    if (message_log == NULL)
+        return;
+    fprintf(message_log, "%s\n", text);
+    fflush(message_log);
+    return;
+}
+#else
+static void show_message(const char * text)
+{
+    DebugMessage(M64MSG_ERROR, "%s", text);
+    return;
 }
 #endif
 
@@ -615,7 +811,7 @@ NOINLINE void export_data_cache(void)
 
     DMEM_swapped = calloc(4096, 1);
     for (i = 0; i < 4096; i++)
-        DMEM_swapped[i] = DMEM[BES(i)];
+        DMEM_swapped[i] = RSP_STATE.DMEM[BES(i)];
     out = fopen("rcpcache.dhex", "wb");
     fwrite(DMEM_swapped, 16, 4096 / 16, out);
     fclose(out);
@@ -631,7 +827,7 @@ NOINLINE void export_instruction_cache(void)
 
     IMEM_swapped = calloc(4096, 1);
     for (i = 0; i < 4096; i++)
-        IMEM_swapped[i] = IMEM[BES(i)];
+        IMEM_swapped[i] = RSP_STATE.IMEM[BES(i)];
     out = fopen("rcpcache.ihex", "wb");
     fwrite(IMEM_swapped, 16, 4096 / 16, out);
     fclose(out);
@@ -657,9 +853,11 @@ void export_SP_memory(void)
 BOOL WINAPI
 DllMain(HINSTANCE hModule, DWORD ul_reason_for_call, LPVOID lpReserved)
 {
-    hModule = lpReserved = NULL; /* unused */
+    lpReserved = NULL; /* unused */
     switch (ul_reason_for_call) {
     case 1:  /* DLL_PROCESS_ATTACH */
+        plugin_module = hModule;
+        break;
     case 2:  /* DLL_THREAD_ATTACH */
     case 3:  /* DLL_THREAD_DETACH */
     case 0:  /* DLL_PROCESS_DETACH */
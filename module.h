@@ -17,7 +17,7 @@
 #define _MODULE_H_
 
 #include <stdio.h>
-#include "rsp.h"
+#include "context.h"
 
 typedef enum {
     M_GFXTASK   = 1,
@@ -32,6 +32,7 @@ typedef enum {
 } OSTask_type;
 
 #define CFG_FILE    "rsp_conf.bin"
+#define LOG_FILE    "rsp_messages.txt"
 
 /*
  * Most of the point behind this config system is to let users use HLE video
@@ -44,7 +45,7 @@ typedef enum {
 #define CFG_HLE_GFX     (conf[0x00])
 #define CFG_HLE_AUD     (conf[0x01])
 #define CFG_HLE_VID     (conf[0x02]) /* reserved/unused */
-#define CFG_HLE_JPG     (conf[0x03]) /* unused */
+#define CFG_HLE_JPG     (conf[0x03]) /* built in:  `jpeg.h' */
 
 /*
  * Schedule binary dump exports to the DllConfig schedule delay queue.
@@ -66,6 +67,16 @@ typedef enum {
 #define CFG_MEND_SEMAPHORE_LOCK     (*(pi32)(conf + 0x14))
 #define CFG_TRACE_RSP_REGISTERS     (*(pi32)(conf + 0x18))
 
+/*
+ * Translate straight-line runs of IMEM to host code (x86-64 SSE2 builds).
+ */
+#define CFG_DYNAREC                 (conf[0x1C])
+
+/*
+ * Run the audio lists of audio micro-codes we know (`audio.h') ourselves.
+ */
+#define CFG_BUILTIN_AUDIO           (conf[0x1D])
+
 /*
  * Update RSP configuration memory from local file resource.
  */
@@ -76,7 +87,6 @@ typedef enum {
  * When using a graphics plugin from specs version 1.2, LLE is not supported.
  * The behavior of requesting the GBI lists should be adjusted accordingly.
  */
-extern p_func GBI_phase;
 
 NOINLINE extern void update_conf(const char* source);
 
@@ -394,14 +394,20 @@ typedef void(*p_func)(void);
 #define INLINE      __inline
 #define NOINLINE    __declspec(noinline)
 #define ALIGNED     _declspec(align(16))
+#define CACHE_ALIGNED   _declspec(align(64))
+#define THREAD_LOCAL    __declspec(thread)
 #elif defined(__GNUC__)
 #define INLINE      inline
 #define NOINLINE    __attribute__((noinline))
 #define ALIGNED     __attribute__((aligned(16)))
+#define CACHE_ALIGNED   __attribute__((aligned(64)))
+#define THREAD_LOCAL    __thread
 #else
 #define INLINE
 #define NOINLINE
 #define ALIGNED
+#define CACHE_ALIGNED
+#define THREAD_LOCAL
 #endif
 
 /*
@@ -0,0 +1,178 @@
+/******************************************************************************\
+* Project:  Run-Time SIMD Kernel Selection                                     *
+* Authors:  agent                                                              *
+* Release:  2026.10.18                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+#include <string.h>
+
+#include "simd.h"
+#include "vu/add.h"
+
+#ifdef HAVE_SIMD_DISPATCH
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+SIMD_level SIMD_kernels = SIMD_NONE;
+
+#ifdef HAVE_SIMD_DISPATCH
+/*
+ * vector op-code kernels which beat the SSE2 ones, by COP2_C2 index
+ */
+static const struct {
+    SIMD_level level;
+    unsigned int func;
+    p_vector_func kernel;
+    const p_C2_entry * entries; /* the same kernel, per element modifier */
+} C2_kernels[] = {
+    { SIMD_SSE4_1, 040, VLT_SSE4_1 , VLT_SSE4_1_entries  },
+    { SIMD_SSE4_1, 043, VGE_SSE4_1 , VGE_SSE4_1_entries  },
+    { SIMD_SSE4_1, 044, VCL_SSE4_1 , VCL_SSE4_1_entries  },
+    { SIMD_SSE4_1, 045, VCH_SSE4_1 , VCH_SSE4_1_entries  },
+    { SIMD_SSE4_1, 046, VCR_SSE4_1 , VCR_SSE4_1_entries  },
+    { SIMD_SSE4_1, 047, VMRG_SSE4_1, VMRG_SSE4_1_entries },
+    { SIMD_AVX2  , 024, VADDC_AVX2 , VADDC_AVX2_entries  },
+    { SIMD_AVX2  , 025, VSUBC_AVX2 , VSUBC_AVX2_entries  },
+};
+
+/*
+ * vector loads and stores which beat the C ones, by LWC2 or SWC2 index
+ */
+static const struct {
+    SIMD_level level;
+    mwc2_func * table;
+    unsigned int rd;
+    mwc2_func transfer;
+} transfer_kernels[] = {
+    { SIMD_SSSE3, LWC2, 003, LDV_SSSE3 },
+    { SIMD_SSSE3, LWC2, 004, LQV_SSSE3 },
+    { SIMD_SSSE3, LWC2, 005, LRV_SSSE3 },
+    { SIMD_SSSE3, LWC2, 006, LPV_SSSE3 },
+    { SIMD_SSSE3, LWC2, 007, LUV_SSSE3 },
+    { SIMD_SSSE3, LWC2, 010, LHV_SSSE3 },
+    { SIMD_SSSE3, SWC2, 003, SDV_SSSE3 },
+    { SIMD_SSSE3, SWC2, 004, SQV_SSSE3 },
+    { SIMD_SSSE3, SWC2, 005, SRV_SSSE3 },
+    { SIMD_SSSE3, SWC2, 006, SPV_SSSE3 },
+    { SIMD_SSSE3, SWC2, 007, SUV_SSSE3 },
+    { SIMD_SSSE3, SWC2, 010, SHV_SSSE3 },
+    { SIMD_SSSE3, SWC2, 011, SFV_SSSE3 },
+};
+
+static void CPUID(u32 info[4], u32 leaf)
+{
+#ifdef _MSC_VER
+    __cpuidex((int *)info, (int)leaf, 0);
+#else
+    __cpuid_count(leaf, 0, info[0], info[1], info[2], info[3]);
+#endif
+    return;
+}
+
+/*
+ * which register states the OS saves on a context switch (XCR0)
+ */
+static u32 OS_saved_states(void)
+{
+#ifdef _MSC_VER
+    return (u32)_xgetbv(0);
+#else
+    u32 eax, edx;
+
+    __asm__ __volatile__(".byte 0x0F, 0x01, 0xD0" /* XGETBV */
+        : "=a"(eax), "=d"(edx) : "c"(0));
+    return (eax);
+#endif
+}
+#endif
+
+SIMD_level detect_SIMD(void)
+{
+#ifdef HAVE_SIMD_DISPATCH
+    u32 info[4];
+    u32 max_leaf;
+
+#ifdef _MSC_VER
+    CPUID(info, 0);
+    max_leaf = info[0];
+#else
+    max_leaf = __get_cpuid_max(0, NULL); /* 0 if no CPUID instruction at all */
+#endif
+    if (max_leaf < 1)
+        return SIMD_NONE;
+    CPUID(info, 1);
+    if (!(info[3] & 0x04000000ul)) /* EDX[26] */
+        return SIMD_NONE;
+    if (!(info[2] & 0x00000200ul)) /* ECX[9] */
+        return SIMD_SSE2;
+    if (!(info[2] & 0x00080000ul)) /* ECX[19] */
+        return SIMD_SSSE3;
+
+/*
+ * AVX2 also needs the OS to save the YMM registers (OSXSAVE, then XCR0).
+ */
+    if ((info[2] & 0x18000000ul) != 0x18000000ul) /* ECX[27] and ECX[28] */
+        return SIMD_SSE4_1;
+    if ((OS_saved_states() & 0x00000006ul) != 0x00000006ul)
+        return SIMD_SSE4_1;
+    if (max_leaf < 7)
+        return SIMD_SSE4_1;
+    CPUID(info, 7);
+    if (!(info[1] & 0x00000020ul)) /* EBX[5] */
+        return SIMD_SSE4_1;
+    return SIMD_AVX2;
+#else
+    return SIMD_NONE;
+#endif
+}
+
+void select_SIMD_kernels(SIMD_level level)
+{
+    static p_vector_func base_C2[8 * 8];
+    static p_C2_entry base_entries[8 * 8][1 << 4];
+    static mwc2_func base_LWC2[2 * 8*2], base_SWC2[2 * 8*2];
+    static int saved;
+#ifdef HAVE_SIMD_DISPATCH
+    register size_t i;
+#endif
+
+    if (!saved) {
+        memcpy(base_C2, COP2_C2, sizeof(base_C2));
+        memcpy(base_entries, COP2_C2_entries, sizeof(base_entries));
+        memcpy(base_LWC2, LWC2, sizeof(base_LWC2));
+        memcpy(base_SWC2, SWC2, sizeof(base_SWC2));
+        saved = 1;
+    }
+    memcpy(COP2_C2, base_C2, sizeof(base_C2));
+    memcpy(COP2_C2_entries, base_entries, sizeof(base_entries));
+    memcpy(LWC2, base_LWC2, sizeof(base_LWC2));
+    memcpy(SWC2, base_SWC2, sizeof(base_SWC2));
+
+#ifdef HAVE_SIMD_DISPATCH
+    for (i = 0; i < sizeof(C2_kernels) / sizeof(C2_kernels[0]); i++)
+        if (level >= C2_kernels[i].level) {
+            COP2_C2[C2_kernels[i].func] = C2_kernels[i].kernel;
+            memcpy(COP2_C2_entries[C2_kernels[i].func], C2_kernels[i].entries,
+                sizeof(COP2_C2_entries[0]));
+        }
+    for (i = 0; i < sizeof(transfer_kernels) / sizeof(transfer_kernels[0]); i++)
+        if (level >= transfer_kernels[i].level)
+            transfer_kernels[i].table[transfer_kernels[i].rd]
+              = transfer_kernels[i].transfer;
+#endif
+    SIMD_kernels = level;
+    return;
+}
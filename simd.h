@@ -0,0 +1,53 @@
+/******************************************************************************\
+* Project:  Run-Time SIMD Kernel Selection                                     *
+* Authors:  agent                                                              *
+* Release:  2026.10.18                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+#ifndef _SIMD_H_
+#define _SIMD_H_
+
+#include "su.h"
+
+/*
+ * x86 vector extensions, in the order the kernels build upon them
+ */
+typedef enum {
+    SIMD_NONE,
+    SIMD_SSE2,
+    SIMD_SSSE3, /* PSHUFB, PMULHRSW */
+    SIMD_SSE4_1, /* PBLENDVB, PTEST */
+    SIMD_AVX2,
+
+    NUMBER_OF_SIMD_LEVELS
+} SIMD_level;
+
+/*
+ * the extensions the kernels in `COP2_C2' (and the way vector operands are
+ * shuffled for them) were last selected for
+ */
+extern SIMD_level SIMD_kernels;
+
+/*
+ * Asks the CPU (CPUID) which of the above it and its OS support.  Always
+ * SIMD_NONE in builds without HAVE_SIMD_DISPATCH (see vu/vu.h).
+ */
+extern SIMD_level detect_SIMD(void);
+
+/*
+ * Installs the best kernels there are for `level' into the op-code tables
+ * (and the LWC2 and SWC2 tables).
+ * Decoded IMEM holds pointers into those tables, so re-decode after this.
+ */
+extern void select_SIMD_kernels(SIMD_level level);
+
+#endif
@@ -20,19 +20,70 @@
  * Some of the parallel timing features require perfect timing or configs.
  */
 #include "module.h"
+#include "dynarec.h"
+#include "vu/multiply.h"
+#include "vu/divide.h"
 
 /* memcpy() and memset() in SP DMA */
 #include <string.h>
+#ifdef RSP_CONTEXT_PER_THREAD
+#include <stdlib.h>
+#include "audio.h"
+#endif
+
+/*
+ * the RSP (the first one, if there are more)
+ */
+ALIGNED decoded_op RSP_state_IMEM_decoded[4096 / 4];
+rsp_context RSP_state;
+
+#ifdef RSP_CONTEXT_PER_THREAD
+THREAD_LOCAL rsp_context * current_RSP = &RSP_state;
+
+rsp_context * new_RSP_context(void)
+{
+    rsp_context * RSP;
+    void * allocation;
+
+    allocation = calloc(1,
+        64 - 1 + sizeof(rsp_context) + sizeof(audio_state)
+      + sizeof(decoded_op) * (4096 / 4) + sizeof(ucode_registry)
+    );
+    if (allocation == NULL)
+        return NULL;
+    RSP = (rsp_context *)(((size_t)allocation + 64 - 1) & ~(size_t)(64 - 1));
+    RSP -> allocation = allocation;
 
-u32 inst_word;
+/*
+ * The rest of its state follows it, in the same allocation, the audio state
+ * first while it is still aligned to a cache line.
+ */
+    RSP -> audio = (audio_state *)(RSP + 1);
+    RSP -> IMEM_decoded = (decoded_op *)(RSP -> audio + 1);
+    RSP -> ucodes = (ucode_registry *)(RSP -> IMEM_decoded + 4096 / 4);
+    return (RSP);
+}
+
+void free_RSP_context(rsp_context * RSP)
+{
+    rsp_context * previous;
 
-u32 SR[NUMBER_OF_SCALAR_REGISTERS];
-typedef VECTOR_OPERATION(*p_vector_func)(v16, v16);
+    if (RSP == NULL || RSP -> allocation == NULL)
+        return; /* not one from new_RSP_context() */
+    previous = current_RSP;
+    current_RSP = RSP;
+    free_code_cache();
+    current_RSP = (previous == RSP) ? &RSP_state : previous;
+    free(RSP -> allocation);
+    return;
+}
 
-pu8 DRAM;
-pu8 DMEM;
-pu8 IMEM;
-unsigned long su_max_address = 0x007FFFFFul;
+void use_RSP_context(rsp_context * RSP)
+{
+    current_RSP = (RSP == NULL) ? &RSP_state : RSP;
+    return;
+}
+#endif
 
 NOINLINE void res_S(void)
 {
@@ -42,22 +93,19 @@ NOINLINE void res_S(void)
 
 void set_PC(unsigned int address)
 {
-    temp_PC = 0x04001000 + FIT_IMEM(address);
+    RSP_STATE.temp_PC = 0x04001000 + FIT_IMEM(address);
 #ifndef EMULATE_STATIC_PC
-    stage = 1;
+    RSP_STATE.stage = 1;
 #endif
     return;
 }
 
-pu32 CR[NUMBER_OF_CP0_REGISTERS];
 u8 conf[32];
 
-int MF_SP_STATUS_TIMEOUT;
-
 void SP_CP0_MF(unsigned int rt, unsigned int rd)
 {
-    SR[rt] = *(CR[rd %= NUMBER_OF_CP0_REGISTERS]);
-    SR[zero] = 0x00000000;
+    RSP_STATE.SR[rt] = *(RSP_STATE.CR[rd %= NUMBER_OF_CP0_REGISTERS]);
+    RSP_STATE.SR[zero] = 0x00000000;
     if (rd == 0x7) {
         if (CFG_MEND_SEMAPHORE_LOCK == 0)
             return;
@@ -67,8 +115,9 @@ void SP_CP0_MF(unsigned int rt, unsigned int rd)
     }
 #ifdef WAIT_FOR_CPU_HOST
     if (rd == 0x4) {
-        MFC0_count[rt] += 1;
-        GET_RCP_REG(SP_STATUS_REG) |= (MFC0_count[rt] >= MF_SP_STATUS_TIMEOUT);
+        RSP_STATE.MFC0_count[rt] += 1;
+        GET_RCP_REG(SP_STATUS_REG) |=
+            (RSP_STATE.MFC0_count[rt] >= RSP_STATE.MF_SP_STATUS_TIMEOUT);
     }
 #endif
     return;
@@ -76,23 +125,23 @@ void SP_CP0_MF(unsigned int rt, unsigned int rd)
 
 static void MT_DMA_CACHE(unsigned int rt)
 {
-    *CR[0x0] = SR[rt] & 0xFFFFFFF8ul; /* & 0x00001FF8 */
+    *RSP_STATE.CR[0x0] = RSP_STATE.SR[rt] & 0xFFFFFFF8ul; /* & 0x00001FF8 */
     return; /* Reserved upper bits are ignored during DMA R/W. */
 }
 static void MT_DMA_DRAM(unsigned int rt)
 {
-    *CR[0x1] = SR[rt] & 0xFFFFFFF8ul; /* & 0x00FFFFF8 */
+    *RSP_STATE.CR[0x1] = RSP_STATE.SR[rt] & 0xFFFFFFF8ul; /* & 0x00FFFFF8 */
     return; /* Let the reserved bits get sent, but the pointer is 24-bit. */
 }
 static void MT_DMA_READ_LENGTH(unsigned int rt)
 {
-    *CR[0x2] = SR[rt] | 07;
+    *RSP_STATE.CR[0x2] = RSP_STATE.SR[rt] | 07;
     SP_DMA_READ();
     return;
 }
 static void MT_DMA_WRITE_LENGTH(unsigned int rt)
 {
-    *CR[0x3] = SR[rt] | 07;
+    *RSP_STATE.CR[0x3] = RSP_STATE.SR[rt] | 07;
     SP_DMA_WRITE();
     return;
 }
@@ -100,55 +149,58 @@ static void MT_SP_STATUS(unsigned int rt)
 {
     pu32 MI_INTR_REG;
     pu32 SP_STATUS_REG;
+    const u32 source = RSP_STATE.SR[rt];
 
-    if (SR[rt] & 0xFE000040)
+    if (source & 0xFE000040)
         message("MTC0\nSP_STATUS"); /* bits we don't know what to do with */
     SP_STATUS_REG = GET_RSP_INFO(SP_STATUS_REG);
 
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00000001) <<  0);
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00000004) <<  1);
+    *SP_STATUS_REG &= ~(!!(source & 0x00000001) <<  0);
+    *SP_STATUS_REG &= ~(!!(source & 0x00000004) <<  1);
  /* DMA_BUSY, DMA_FULL, IO_FULL:  No feature exists to clear these. */
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00000020) <<  5);
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00000080) <<  6);
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00000200) <<  7);
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00000800) <<  8);
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00002000) <<  9);
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00008000) << 10);
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00020000) << 11);
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00080000) << 12);
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00200000) << 13);
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00800000) << 14);
-
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x00000002) <<  0);
+    *SP_STATUS_REG &= ~(!!(source & 0x00000020) <<  5);
+    *SP_STATUS_REG &= ~(!!(source & 0x00000080) <<  6);
+    *SP_STATUS_REG &= ~(!!(source & 0x00000200) <<  7);
+    *SP_STATUS_REG &= ~(!!(source & 0x00000800) <<  8);
+    *SP_STATUS_REG &= ~(!!(source & 0x00002000) <<  9);
+    *SP_STATUS_REG &= ~(!!(source & 0x00008000) << 10);
+    *SP_STATUS_REG &= ~(!!(source & 0x00020000) << 11);
+    *SP_STATUS_REG &= ~(!!(source & 0x00080000) << 12);
+    *SP_STATUS_REG &= ~(!!(source & 0x00200000) << 13);
+    *SP_STATUS_REG &= ~(!!(source & 0x00800000) << 14);
+
+    *SP_STATUS_REG |=  (!!(source & 0x00000002) <<  0);
  /* No feature exists to set BROKE:  (!!1 << 1) */
  /* DMA_BUSY, DMA_FULL, IO_FULL:  No feature exists to set these. */
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x00000040) <<  5);
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x00000100) <<  6);
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x00000400) <<  7); /* yield request? */
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x00001000) <<  8); /* yielded? */
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x00004000) <<  9); /* task done? */
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x00010000) << 10);
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x00040000) << 11);
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x00100000) << 12);
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x00400000) << 13);
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x01000000) << 14);
+    *SP_STATUS_REG |=  (!!(source & 0x00000040) <<  5);
+    *SP_STATUS_REG |=  (!!(source & 0x00000100) <<  6);
+    *SP_STATUS_REG |=  (!!(source & 0x00000400) <<  7); /* yield request? */
+    *SP_STATUS_REG |=  (!!(source & 0x00001000) <<  8); /* yielded? */
+    *SP_STATUS_REG |=  (!!(source & 0x00004000) <<  9); /* task done? */
+    *SP_STATUS_REG |=  (!!(source & 0x00010000) << 10);
+    *SP_STATUS_REG |=  (!!(source & 0x00040000) << 11);
+    *SP_STATUS_REG |=  (!!(source & 0x00100000) << 12);
+    *SP_STATUS_REG |=  (!!(source & 0x00400000) << 13);
+    *SP_STATUS_REG |=  (!!(source & 0x01000000) << 14);
 
     MI_INTR_REG = GET_RSP_INFO(MI_INTR_REG);
-    *MI_INTR_REG   &= ~((SR[rt] & 0x00000008) >> 3); /* SP_CLR_INTR */
-    *MI_INTR_REG   |=  ((SR[rt] & 0x00000010) >> 4); /* SP_SET_INTR */
-    *SP_STATUS_REG |=   (SR[rt] & 0x00000010) >> 4; /* int set halt */
+    *MI_INTR_REG   &= ~((source & 0x00000008) >> 3); /* SP_CLR_INTR */
+    *MI_INTR_REG   |=  ((source & 0x00000010) >> 4); /* SP_SET_INTR */
+    *SP_STATUS_REG |=   (source & 0x00000010) >> 4; /* int set halt */
     return;
 }
 static void MT_SP_RESERVED(unsigned int rt)
 {
-    const u32 source = SR[rt] & 0x00000000ul; /* forced (zilmar, dox) */
+    const u32 source =
+        RSP_STATE.SR[rt] & 0x00000000ul; /* forced (zilmar, dox) */
 
     GET_RCP_REG(SP_SEMAPHORE_REG) = source;
     return;
 }
 static void MT_CMD_START(unsigned int rt)
 {
-    const u32 source = SR[rt] & 0xFFFFFFF8ul; /* Funnelcube demo by marshallh */
+    const u32 source =
+        RSP_STATE.SR[rt] & 0xFFFFFFF8ul; /* Funnelcube demo by marshallh */
 
     if (GET_RCP_REG(DPC_BUFBUSY_REG)) /* lock hazards not implemented */
         message("MTC0\nCMD_START");
@@ -162,40 +214,41 @@ static void MT_CMD_END(unsigned int rt)
 {
     if (GET_RCP_REG(DPC_BUFBUSY_REG))
         message("MTC0\nCMD_END"); /* This is just CA-related. */
-    GET_RCP_REG(DPC_END_REG) = SR[rt] & 0xFFFFFFF8ul;
-    GBI_phase();
+    GET_RCP_REG(DPC_END_REG) = RSP_STATE.SR[rt] & 0xFFFFFFF8ul;
+    RSP_STATE.GBI_phase();
     return;
 }
 static void MT_CMD_STATUS(unsigned int rt)
 {
     pu32 DPC_STATUS_REG;
+    const u32 source = RSP_STATE.SR[rt];
 
-    if (SR[rt] & 0xFFFFFD80ul) /* unsupported or reserved bits */
+    if (source & 0xFFFFFD80ul) /* unsupported or reserved bits */
         message("MTC0\nCMD_STATUS");
     DPC_STATUS_REG = GET_RSP_INFO(DPC_STATUS_REG);
 
-    *DPC_STATUS_REG &= ~(!!(SR[rt] & 0x00000001) << 0);
-    *DPC_STATUS_REG |=  (!!(SR[rt] & 0x00000002) << 0);
-    *DPC_STATUS_REG &= ~(!!(SR[rt] & 0x00000004) << 1);
-    *DPC_STATUS_REG |=  (!!(SR[rt] & 0x00000008) << 1);
-    *DPC_STATUS_REG &= ~(!!(SR[rt] & 0x00000010) << 2);
-    *DPC_STATUS_REG |=  (!!(SR[rt] & 0x00000020) << 2);
+    *DPC_STATUS_REG &= ~(!!(source & 0x00000001) << 0);
+    *DPC_STATUS_REG |=  (!!(source & 0x00000002) << 0);
+    *DPC_STATUS_REG &= ~(!!(source & 0x00000004) << 1);
+    *DPC_STATUS_REG |=  (!!(source & 0x00000008) << 1);
+    *DPC_STATUS_REG &= ~(!!(source & 0x00000010) << 2);
+    *DPC_STATUS_REG |=  (!!(source & 0x00000020) << 2);
 /* Some NUS-CIC-6105 SP tasks try to clear some DPC cycle timers. */
-    GET_RCP_REG(DPC_TMEM_REG)     &= !(SR[rt] & 0x00000040) ? ~0u : 0u;
- /* GET_RCP_REG(DPC_PIPEBUSY_REG) &= !(SR[rt] & 0x00000080) ? ~0u : 0u; */
- /* GET_RCP_REG(DPC_BUFBUSY_REG)  &= !(SR[rt] & 0x00000100) ? ~0u : 0u; */
-    GET_RCP_REG(DPC_CLOCK_REG)    &= !(SR[rt] & 0x00000200) ? ~0u : 0u;
+    GET_RCP_REG(DPC_TMEM_REG)     &= !(source & 0x00000040) ? ~0u : 0u;
+ /* GET_RCP_REG(DPC_PIPEBUSY_REG) &= !(source & 0x00000080) ? ~0u : 0u; */
+ /* GET_RCP_REG(DPC_BUFBUSY_REG)  &= !(source & 0x00000100) ? ~0u : 0u; */
+    GET_RCP_REG(DPC_CLOCK_REG)    &= !(source & 0x00000200) ? ~0u : 0u;
     return;
 }
 static void MT_CMD_CLOCK(unsigned int rt)
 {
     message("MTC0\nCMD_CLOCK"); /* read-only?? */
-    GET_RCP_REG(DPC_CLOCK_REG) = SR[rt];
+    GET_RCP_REG(DPC_CLOCK_REG) = RSP_STATE.SR[rt];
     return; /* Appendix says this is RW; elsewhere it says R. */
 }
 static void MT_READ_ONLY(unsigned int rt)
 {
-    static char write_to_read_only[] = "Invalid MTC0 from SR[00].";
+    char write_to_read_only[] = "Invalid MTC0 from SR[00].";
 
     write_to_read_only[21] = '0' + (unsigned char)rt/10;
     write_to_read_only[22] = '0' + (unsigned char)rt%10;
@@ -210,9 +263,46 @@ MT_CMD_START       ,MT_CMD_END         ,MT_READ_ONLY       ,MT_CMD_STATUS,
 MT_CMD_CLOCK       ,MT_READ_ONLY       ,MT_READ_ONLY       ,MT_READ_ONLY
 };
 
+/*
+ * Each row of a DMA moves 8 bytes at a time, with both pointers wrapping on
+ * their own:  SP memory at 8 KiB and the RDRAM pointer at 16 MiB.  Between
+ * the wraps, the 8-byte steps are one contiguous run, and a run of RDRAM is
+ * either all in range (up to `su_max_address') or all out of it.
+ *
+ * Returns how many bytes from `offC' and `offD' to move in one go, at most
+ * `left' (what is left of the row).
+ */
+static unsigned int DMA_run(unsigned int offC, u32 offD, unsigned int left)
+{
+    u32 in_range;
+
+    if (left > 0x00002000ul - offC)
+        left = 0x00002000ul - offC;
+    if (left > 0x01000000ul - offD)
+        left = 0x01000000ul - offD;
+    if (offD > RSP_STATE.su_max_address)
+        return (left);
+    in_range = ((RSP_STATE.su_max_address - offD) & ~07ul) + 8; /* <= max */
+    return (left > in_range) ? (unsigned int)in_range : left;
+}
+
+/*
+ * still in 8-byte steps:  Most DMAs are short, and the compiler inlines a
+ * fixed-size copy where it would call out to the library for `run' bytes.
+ */
+static INLINE void copy_run(pu8 dst, const u8 * src, unsigned int run)
+{
+    register unsigned int i;
+
+    for (i = 0; i < run; i += 8)
+        memcpy(dst + i, src + i, 8);
+    return;
+}
+
 void SP_DMA_READ(void)
 {
     unsigned int offC, offD; /* SP cache and dynamic DMA pointers */
+    unsigned int IMEM_low = 0x2000, IMEM_high = 0x0000; /* IMEM written */
     register unsigned int length;
     register unsigned int count;
     register unsigned int skip;
@@ -227,23 +317,32 @@ void SP_DMA_READ(void)
     ++count;
     skip += length;
     do {
-        register unsigned int i;
+        register unsigned int i, run;
 
         i = 0;
         --count;
         do {
-            offC = (count*length + *CR[0x0] + i) & 0x00001FF8ul;
-            offD = (count*skip + *CR[0x1] + i) & 0x00FFFFF8ul;
-            i += 0x008;
-            if (offD > su_max_address) {
-                memset(DMEM + offC, 0x00, 8);
-                continue;
+            offC = (count*length + *RSP_STATE.CR[0x0] + i) & 0x00001FF8ul;
+            offD = (count*skip + *RSP_STATE.CR[0x1] + i) & 0x00FFFFF8ul;
+            run = DMA_run(offC, offD, length - i);
+            i += run;
+            if (offD > RSP_STATE.su_max_address)
+                memset(RSP_STATE.DMEM + offC, 0x00, run);
+            else
+                copy_run(RSP_STATE.DMEM + offC, RSP_STATE.DRAM + offD, run);
+            if (offC + run > 0x1000) { /* IMEM half:  re-decoded below */
+                if (offC < IMEM_low)
+                    IMEM_low = (offC < 0x1000) ? 0x1000 : offC;
+                if (offC + run > IMEM_high)
+                    IMEM_high = offC + run;
             }
-            memcpy(DMEM + offC, DRAM + offD, 8);
         } while (i < length);
     } while (count);
+    if (IMEM_high != 0) /* Keep the predecoded cache in sync. */
+        predecode_IMEM(IMEM_low, IMEM_high - IMEM_low);
 
-    if ((*CR[0x0] & 0x1000) ^ (offC & 0x1000))
+    offC = (*RSP_STATE.CR[0x0] + length - 8) & 0x00001FF8ul; /* last 8 bytes */
+    if ((*RSP_STATE.CR[0x0] & 0x1000) ^ (offC & 0x1000))
         message("DMA over the DMEM-to-IMEM gap.");
     GET_RCP_REG(SP_DMA_BUSY_REG)  =  0x00000000;
     GET_RCP_REG(SP_STATUS_REG)   &= ~SP_STATUS_DMA_BUSY;
@@ -267,21 +366,23 @@ void SP_DMA_WRITE(void)
     ++count;
     skip += length;
     do {
-        register unsigned int i;
+        register unsigned int i, run;
 
         i = 0;
         --count;
         do {
-            offC = (count*length + *CR[0x0] + i) & 0x00001FF8ul;
-            offD = (count*skip + *CR[0x1] + i) & 0x00FFFFF8ul;
-            i += 0x000008;
-            if (offD > su_max_address)
+            offC = (count*length + *RSP_STATE.CR[0x0] + i) & 0x00001FF8ul;
+            offD = (count*skip + *RSP_STATE.CR[0x1] + i) & 0x00FFFFF8ul;
+            run = DMA_run(offC, offD, length - i);
+            i += run;
+            if (offD > RSP_STATE.su_max_address)
                 continue;
-            memcpy(DRAM + offD, DMEM + offC, 8);
+            copy_run(RSP_STATE.DRAM + offD, RSP_STATE.DMEM + offC, run);
         } while (i < length);
     } while (count);
 
-    if ((*CR[0x0] & 0x1000) ^ (offC & 0x1000))
+    offC = (*RSP_STATE.CR[0x0] + length - 8) & 0x00001FF8ul; /* last 8 bytes */
+    if ((*RSP_STATE.CR[0x0] & 0x1000) ^ (offC & 0x1000))
         message("DMA over the DMEM-to-IMEM gap.");
     GET_RCP_REG(SP_DMA_BUSY_REG)  =  0x00000000;
     GET_RCP_REG(SP_STATUS_REG)   &= ~SP_STATUS_DMA_BUSY;
@@ -290,225 +391,191 @@ void SP_DMA_WRITE(void)
 
 /*** scalar, R4000 control flow manipulation ***/
 
-PROFILE_MODE void J(u32 inst)
+PROFILE_MODE int J(const decoded_op * op, u32 PC)
 {
-    set_PC(4 * inst);
+    set_PC(op -> imm);
+    return 1;
 }
-PROFILE_MODE void JAL(u32 inst, u32 PC)
+PROFILE_MODE int JAL(const decoded_op * op, u32 PC)
 {
-    SR[ra] = FIT_IMEM(PC + LINK_OFF);
-    set_PC(4 * inst);
+    RSP_STATE.SR[ra] = FIT_IMEM(PC + LINK_OFF);
+    set_PC(op -> imm);
+    return 1;
 }
 
-PROFILE_MODE int BEQ(u32 inst, u32 PC)
+PROFILE_MODE int BEQ(const decoded_op * op, u32 PC)
 {
-    const unsigned int rs = (inst >> 21) % (1 << 5);
-    const unsigned int rt = (inst >> 16) % (1 << 5);
-
-    if (!(SR[rs] == SR[rt]))
+    if (!(RSP_STATE.SR[op -> rs] == RSP_STATE.SR[op -> rt]))
         return 0;
-    set_PC(PC + 4*inst + SLOT_OFF);
+    set_PC(PC + op -> imm + SLOT_OFF);
     return 1;
 }
-PROFILE_MODE int BNE(u32 inst, u32 PC)
+PROFILE_MODE int BNE(const decoded_op * op, u32 PC)
 {
-    const unsigned int rs = (inst >> 21) % (1 << 5);
-    const unsigned int rt = (inst >> 16) % (1 << 5);
-
-    if (!(SR[rs] != SR[rt]))
+    if (!(RSP_STATE.SR[op -> rs] != RSP_STATE.SR[op -> rt]))
         return 0;
-    set_PC(PC + 4*inst + SLOT_OFF);
+    set_PC(PC + op -> imm + SLOT_OFF);
     return 1;
 }
-PROFILE_MODE int BLEZ(u32 inst, u32 PC)
+PROFILE_MODE int BLEZ(const decoded_op * op, u32 PC)
 {
-    const unsigned int rs = (inst >> 21) % (1 << 5);
-
-    if (!((s32)SR[rs] <= 0))
+    if (!((s32)RSP_STATE.SR[op -> rs] <= 0))
         return 0;
-    set_PC(PC + 4*inst + SLOT_OFF);
+    set_PC(PC + op -> imm + SLOT_OFF);
     return 1;
 }
-PROFILE_MODE int BGTZ(u32 inst, u32 PC)
+PROFILE_MODE int BGTZ(const decoded_op * op, u32 PC)
 {
-    const unsigned int rs = (inst >> 21) % (1 << 5);
-
-    if (!((s32)SR[rs] >  0))
+    if (!((s32)RSP_STATE.SR[op -> rs] >  0))
         return 0;
-    set_PC(PC + 4*inst + SLOT_OFF);
+    set_PC(PC + op -> imm + SLOT_OFF);
     return 1;
 }
 
 /*** scalar, R4000 bit-wise logical operations ***/
 
-PROFILE_MODE void ANDI(u32 inst)
+PROFILE_MODE int ANDI(const decoded_op * op, u32 PC)
 {
-    const u16 immediate = (u16)(inst & 0x0000FFFFu);
-    const unsigned int rs = (inst >> 21) % (1 << 5);
-    const unsigned int rt = (inst >> 16) % (1 << 5);
-
-    SR[rt] = SR[rs] & immediate;
-    SR[zero] = 0x00000000;
+    RSP_STATE.SR[op -> rt] = RSP_STATE.SR[op -> rs] & (u32)(op -> imm);
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
 }
-PROFILE_MODE void ORI(u32 inst)
+PROFILE_MODE int ORI(const decoded_op * op, u32 PC)
 {
-    const u16 immediate = (u16)(inst & 0x0000FFFFu);
-    const unsigned int rs = (inst >> 21) % (1 << 5);
-    const unsigned int rt = (inst >> 16) % (1 << 5);
-
-    SR[rt] = SR[rs] | immediate;
-    SR[zero] = 0x00000000;
+    RSP_STATE.SR[op -> rt] = RSP_STATE.SR[op -> rs] | (u32)(op -> imm);
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
 }
-PROFILE_MODE void XORI(u32 inst)
+PROFILE_MODE int XORI(const decoded_op * op, u32 PC)
 {
-    const u16 immediate = (u16)(inst & 0x0000FFFFu);
-    const unsigned int rs = (inst >> 21) % (1 << 5);
-    const unsigned int rt = (inst >> 16) % (1 << 5);
-
-    SR[rt] = SR[rs] ^ immediate;
-    SR[zero] = 0x00000000;
+    RSP_STATE.SR[op -> rt] = RSP_STATE.SR[op -> rs] ^ (u32)(op -> imm);
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
 }
-PROFILE_MODE void LUI(u32 inst)
+PROFILE_MODE int LUI(const decoded_op * op, u32 PC)
 {
-    const u16 immediate = (u16)(inst & 0x0000FFFFu);
-    const unsigned int rt = (inst >> 16) % (1 << 5);
-
-    SR[rt] = (u32)immediate << 16; /* or:  SR[rt] = 0; SR[rt]31..16 = imm; */
-    SR[zero] = 0x00000000;
+    RSP_STATE.SR[op -> rt] = (u32)(op -> imm); /* already shifted left by 16 */
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
 }
 
 /*** scalar, R4000 arithmetic operations ***/
 
-PROFILE_MODE void ADDIU(u32 inst)
+PROFILE_MODE int ADDIU(const decoded_op * op, u32 PC)
 {
-    const u16 immediate = (u16)(inst & 0x0000FFFFu);
-    const unsigned int rs = (inst >> 21) % (1 << 5);
-    const unsigned int rt = (inst >> 16) % (1 << 5);
-
-    SR[rt] = SR[rs] + (s16)(immediate);
-    SR[zero] = 0x00000000;
+    RSP_STATE.SR[op -> rt] = RSP_STATE.SR[op -> rs] + op -> imm;
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
 }
-PROFILE_MODE void SLTI(u32 inst)
+PROFILE_MODE int SLTI(const decoded_op * op, u32 PC)
 {
-    const u16 immediate = (u16)(inst & 0x0000FFFFu);
-    const unsigned int rs = (inst >> 21) % (1 << 5);
-    const unsigned int rt = (inst >> 16) % (1 << 5);
-
-    SR[rt] = ((s32)(SR[rs]) < (s32)SIGNED_IMM16(immediate)) ? 1 : 0;
-    SR[zero] = 0x00000000;
+    RSP_STATE.SR[op -> rt] =
+        ((s32)(RSP_STATE.SR[op -> rs]) < (s32)(op -> imm)) ? 1 : 0;
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
 }
-PROFILE_MODE void SLTIU(u32 inst)
+PROFILE_MODE int SLTIU(const decoded_op * op, u32 PC)
 {
-    const u16 immediate = (u16)(inst & 0x0000FFFFu);
-    const unsigned int rs = (inst >> 21) % (1 << 5);
-    const unsigned int rt = (inst >> 16) % (1 << 5);
-
-    SR[rt] = ((u32)(SR[rs]) < (u32)SIGNED_IMM16(immediate)) ? 1 : 0;
-    SR[zero] = 0x00000000;
+    RSP_STATE.SR[op -> rt] =
+        ((u32)(RSP_STATE.SR[op -> rs]) < (u32)(op -> imm)) ? 1 : 0;
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
 }
 
 /*** scalar, R4000 memory loads and stores ***/
 
-PROFILE_MODE void LB(u32 inst)
+PROFILE_MODE int LB(const decoded_op * op, u32 PC)
 {
     u32 addr;
-    const s16 offset = (s16)(inst & 0x0000FFFFul);
-    const unsigned int base = (inst >> 21) % (1 << 5);
-    const unsigned int rt   = (inst >> 16) % (1 << 5);
+    const unsigned int rt = op -> rt;
 
-    addr = SR[base] + offset;
-    SR[rt] = DMEM[BES(addr) & 0x00000FFFul];
-    SR[rt] = (s8)SR[rt];
-    SR[zero] = 0x00000000;
+    addr = RSP_STATE.SR[op -> rs] + op -> imm;
+    RSP_STATE.SR[rt] = RSP_STATE.DMEM[BES(addr) & 0x00000FFFul];
+    RSP_STATE.SR[rt] = (s8)RSP_STATE.SR[rt];
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
 }
-PROFILE_MODE void LH(u32 inst)
+PROFILE_MODE int LH(const decoded_op * op, u32 PC)
 {
     u32 addr;
-    const s16 offset = (s16)(inst & 0x0000FFFFul);
-    const unsigned int base = (inst >> 21) % (1 << 5);
-    const unsigned int rt   = (inst >> 16) % (1 << 5);
-
-    addr = SR[base] + offset;
-    SR[rt] = 0x00000000
-      | DMEM[BES(addr + 0) & 0x00000FFFul] <<  8
-      | DMEM[BES(addr + 1) & 0x00000FFFul] <<  0
+    const unsigned int rt = op -> rt;
+
+    addr = RSP_STATE.SR[op -> rs] + op -> imm;
+    RSP_STATE.SR[rt] = 0x00000000
+      | RSP_STATE.DMEM[BES(addr + 0) & 0x00000FFFul] <<  8
+      | RSP_STATE.DMEM[BES(addr + 1) & 0x00000FFFul] <<  0
     ;
-    SR[rt] = (s16)SR[rt];
-    SR[zero] = 0x00000000;
+    RSP_STATE.SR[rt] = (s16)RSP_STATE.SR[rt];
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
 }
-PROFILE_MODE void LW(u32 inst)
+PROFILE_MODE int LW(const decoded_op * op, u32 PC)
 {
     u32 addr;
-    const s16 offset = (s16)(inst & 0x0000FFFFul);
-    const unsigned int base = (inst >> 21) % (1 << 5);
-    const unsigned int rt   = (inst >> 16) % (1 << 5);
-
-    addr = SR[base] + offset;
-    SR_B(rt, 0) = DMEM[BES(addr + 0) & 0x00000FFFul];
-    SR_B(rt, 1) = DMEM[BES(addr + 1) & 0x00000FFFul];
-    SR_B(rt, 2) = DMEM[BES(addr + 2) & 0x00000FFFul];
-    SR_B(rt, 3) = DMEM[BES(addr + 3) & 0x00000FFFul];
-    SR[zero] = 0x00000000;
+    const unsigned int rt = op -> rt;
+
+    addr = RSP_STATE.SR[op -> rs] + op -> imm;
+    SR_B(rt, 0) = RSP_STATE.DMEM[BES(addr + 0) & 0x00000FFFul];
+    SR_B(rt, 1) = RSP_STATE.DMEM[BES(addr + 1) & 0x00000FFFul];
+    SR_B(rt, 2) = RSP_STATE.DMEM[BES(addr + 2) & 0x00000FFFul];
+    SR_B(rt, 3) = RSP_STATE.DMEM[BES(addr + 3) & 0x00000FFFul];
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
 }
-PROFILE_MODE void LBU(u32 inst)
+PROFILE_MODE int LBU(const decoded_op * op, u32 PC)
 {
     u32 addr;
-    const s16 offset = (s16)(inst & 0x0000FFFFul);
-    const unsigned int base = (inst >> 21) % (1 << 5);
-    const unsigned int rt   = (inst >> 16) % (1 << 5);
+    const unsigned int rt = op -> rt;
 
-    addr = SR[base] + offset;
-    SR[rt] = DMEM[BES(addr) & 0x00000FFFul];
-    SR[zero] = 0x00000000;
+    addr = RSP_STATE.SR[op -> rs] + op -> imm;
+    RSP_STATE.SR[rt] = RSP_STATE.DMEM[BES(addr) & 0x00000FFFul];
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
 }
-PROFILE_MODE void LHU(u32 inst)
+PROFILE_MODE int LHU(const decoded_op * op, u32 PC)
 {
     u32 addr;
-    const s16 offset = (s16)(inst & 0x0000FFFFul);
-    const unsigned int base = (inst >> 21) % (1 << 5);
-    const unsigned int rt   = (inst >> 16) % (1 << 5);
-
-    addr = SR[base] + offset;
-    SR[rt] = 0x00000000
-      | DMEM[BES(addr + 0) & 0x00000FFFul] <<  8
-      | DMEM[BES(addr + 1) & 0x00000FFFul] <<  0
+    const unsigned int rt = op -> rt;
+
+    addr = RSP_STATE.SR[op -> rs] + op -> imm;
+    RSP_STATE.SR[rt] = 0x00000000
+      | RSP_STATE.DMEM[BES(addr + 0) & 0x00000FFFul] <<  8
+      | RSP_STATE.DMEM[BES(addr + 1) & 0x00000FFFul] <<  0
     ;
-    SR[zero] = 0x00000000;
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
 }
 
-PROFILE_MODE void SB(u32 inst)
+PROFILE_MODE int SB(const decoded_op * op, u32 PC)
 {
     u32 addr;
-    const s16 offset = (s16)(inst & 0x0000FFFFul);
-    const unsigned int base = (inst >> 21) % (1 << 5);
-    const unsigned int rt   = (inst >> 16) % (1 << 5);
+    const unsigned int rt = op -> rt;
 
-    addr = SR[base] + offset;
-    DMEM[BES(addr) & 0x00000FFFul] = (u8)(SR[rt] & 0xFFu);
+    addr = RSP_STATE.SR[op -> rs] + op -> imm;
+    RSP_STATE.DMEM[BES(addr) & 0x00000FFFul] = (u8)(RSP_STATE.SR[rt] & 0xFFu);
+    return 0;
 }
-PROFILE_MODE void SH(u32 inst)
+PROFILE_MODE int SH(const decoded_op * op, u32 PC)
 {
     u32 addr;
-    const s16 offset = (s16)(inst & 0x0000FFFFul);
-    const unsigned int base = (inst >> 21) % (1 << 5);
-    const unsigned int rt   = (inst >> 16) % (1 << 5);
+    const unsigned int rt = op -> rt;
 
-    addr = SR[base] + offset;
-    DMEM[BES(addr + 0) & 0x00000FFFul] = SR_B(rt, 2);
-    DMEM[BES(addr + 1) & 0x00000FFFul] = SR_B(rt, 3);
+    addr = RSP_STATE.SR[op -> rs] + op -> imm;
+    RSP_STATE.DMEM[BES(addr + 0) & 0x00000FFFul] = SR_B(rt, 2);
+    RSP_STATE.DMEM[BES(addr + 1) & 0x00000FFFul] = SR_B(rt, 3);
+    return 0;
 }
-PROFILE_MODE void SW(u32 inst)
+PROFILE_MODE int SW(const decoded_op * op, u32 PC)
 {
     u32 addr;
-    const s16 offset = (s16)(inst & 0x0000FFFFul);
-    const unsigned int base = (inst >> 21) % (1 << 5);
-    const unsigned int rt   = (inst >> 16) % (1 << 5);
+    const unsigned int rt = op -> rt;
 
-    addr = SR[base] + offset;
-    DMEM[BES(addr + 0) & 0x00000FFFul] = SR_B(rt, 0);
-    DMEM[BES(addr + 1) & 0x00000FFFul] = SR_B(rt, 1);
-    DMEM[BES(addr + 2) & 0x00000FFFul] = SR_B(rt, 2);
-    DMEM[BES(addr + 3) & 0x00000FFFul] = SR_B(rt, 3);
+    addr = RSP_STATE.SR[op -> rs] + op -> imm;
+    RSP_STATE.DMEM[BES(addr + 0) & 0x00000FFFul] = SR_B(rt, 0);
+    RSP_STATE.DMEM[BES(addr + 1) & 0x00000FFFul] = SR_B(rt, 1);
+    RSP_STATE.DMEM[BES(addr + 2) & 0x00000FFFul] = SR_B(rt, 2);
+    RSP_STATE.DMEM[BES(addr + 3) & 0x00000FFFul] = SR_B(rt, 3);
+    return 0;
 }
 
 /*** scalar, coprocessor operations (vector unit) ***/
@@ -526,7 +593,7 @@ void rwW_VCE(u16 vce)
 
     vce = 0x00 | (vce & 0xFF);
     for (i = 0; i < 8; i++)
-        cf_vce[i] = (vce >> i) & 1;
+        RSP_STATE.cf_vce[i] = -((vce >> i) & 1);
     return;
 }
 
@@ -541,8 +608,8 @@ void MFC2(unsigned int rt, unsigned int vs, unsigned int e)
     SR_B(rt, 2) = VR_B(vs, e);
     e = (e + 0x1) & 0xF;
     SR_B(rt, 3) = VR_B(vs, e);
-    SR[rt] = (s16)(SR[rt]);
-    SR[zero] = 0x00000000;
+    RSP_STATE.SR[rt] = (s16)(RSP_STATE.SR[rt]);
+    RSP_STATE.SR[zero] = 0x00000000;
     return;
 }
 void MTC2(unsigned int rt, unsigned int vd, unsigned int e)
@@ -553,13 +620,13 @@ void MTC2(unsigned int rt, unsigned int vd, unsigned int e)
 }
 void CFC2(unsigned int rt, unsigned int rd)
 {
-    SR[rt] = (s16)R_VCF[rd & 3]();
-    SR[zero] = 0x00000000;
+    RSP_STATE.SR[rt] = (s16)R_VCF[rd & 3]();
+    RSP_STATE.SR[zero] = 0x00000000;
     return;
 }
 void CTC2(unsigned int rt, unsigned int rd)
 {
-    W_VCF[rd & 3](SR[rt] & 0x0000FFFF);
+    W_VCF[rd & 3](RSP_STATE.SR[rt] & 0x0000FFFF);
     return;
 }
 
@@ -570,8 +637,8 @@ void LBV(unsigned vt, unsigned element, signed offset, unsigned base)
     register u32 addr;
     const unsigned int e = element;
 
-    addr = (SR[base] + 1*offset) & 0x00000FFF;
-    VR_B(vt, e) = DMEM[BES(addr)];
+    addr = (RSP_STATE.SR[base] + 1*offset) & 0x00000FFF;
+    VR_B(vt, e) = RSP_STATE.DMEM[BES(addr)];
     return;
 }
 void LSV(unsigned vt, unsigned element, signed offset, unsigned base)
@@ -584,14 +651,14 @@ void LSV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("LSV\nIllegal element.");
         return;
     }
-    addr = (SR[base] + 2*offset) & 0x00000FFF;
+    addr = (RSP_STATE.SR[base] + 2*offset) & 0x00000FFF;
     correction = (signed)(addr % 0x004);
     if (correction == 0x003) {
         message("LSV\nWeird addr.");
         return;
     }
     correction = (correction - 1) * HES(0x000);
-    VR_S(vt, e) = *(pi16)(DMEM + addr - correction);
+    VR_S(vt, e) = *(pi16)(RSP_STATE.DMEM + addr - correction);
     return;
 }
 void LLV(unsigned vt, unsigned element, signed offset, unsigned base)
@@ -604,21 +671,21 @@ void LLV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("LLV\nOdd element.");
         return;
     } /* Illegal (but still even) elements are used by Boss Game Studios. */
-    addr = (SR[base] + 4*offset) & 0x00000FFF;
+    addr = (RSP_STATE.SR[base] + 4*offset) & 0x00000FFF;
     if (addr & 0x00000001) {
-        VR_A(vt, e+0x0) = DMEM[BES(addr)];
+        VR_A(vt, e+0x0) = RSP_STATE.DMEM[BES(addr)];
         addr = (addr + 0x00000001) & 0x00000FFF;
-        VR_U(vt, e+0x1) = DMEM[BES(addr)];
+        VR_U(vt, e+0x1) = RSP_STATE.DMEM[BES(addr)];
         addr = (addr + 0x00000001) & 0x00000FFF;
-        VR_A(vt, e+0x2) = DMEM[BES(addr)];
+        VR_A(vt, e+0x2) = RSP_STATE.DMEM[BES(addr)];
         addr = (addr + 0x00000001) & 0x00000FFF;
-        VR_U(vt, e+0x3) = DMEM[BES(addr)];
+        VR_U(vt, e+0x3) = RSP_STATE.DMEM[BES(addr)];
         return;
     } /* branch very unlikely:  "Star Wars:  Battle for Naboo" unaligned addr */
     correction = HES(0x000)*(addr%0x004 - 1);
-    VR_S(vt, e+0x0) = *(pi16)(DMEM + addr - correction);
+    VR_S(vt, e+0x0) = *(pi16)(RSP_STATE.DMEM + addr - correction);
     addr = (addr + 0x00000002) & 0x00000FFF; /* F3DLX 1.23:  addr%4 is 0x002. */
-    VR_S(vt, e+0x2) = *(pi16)(DMEM + addr + correction);
+    VR_S(vt, e+0x2) = *(pi16)(RSP_STATE.DMEM + addr + correction);
     return;
 }
 void LDV(unsigned vt, unsigned element, signed offset, unsigned base)
@@ -630,78 +697,78 @@ void LDV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("LDV\nOdd element.");
         return;
     } /* Illegal (but still even) elements are used by Boss Game Studios. */
-    addr = (SR[base] + 8*offset) & 0x00000FFF;
+    addr = (RSP_STATE.SR[base] + 8*offset) & 0x00000FFF;
 
     switch (addr & 07) {
     case 00:
-        VR_S(vt, e+0x0) = *(pi16)(DMEM + addr + HES(0x000));
-        VR_S(vt, e+0x2) = *(pi16)(DMEM + addr + HES(0x002));
-        VR_S(vt, e+0x4) = *(pi16)(DMEM + addr + HES(0x004));
-        VR_S(vt, e+0x6) = *(pi16)(DMEM + addr + HES(0x006));
+        VR_S(vt, e+0x0) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x000));
+        VR_S(vt, e+0x2) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x002));
+        VR_S(vt, e+0x4) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x004));
+        VR_S(vt, e+0x6) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x006));
         break;
     case 01: /* standard ABI ucodes (unlike e.g. MusyX w/ even addresses) */
-        VR_S(vt, e+0x0) = *(pi16)(DMEM + addr + 0x000);
-        VR_A(vt, e+0x2) = DMEM[addr + 0x002 - BES(0x000)];
-        VR_U(vt, e+0x3) = DMEM[addr + 0x003 + BES(0x000)];
-        VR_S(vt, e+0x4) = *(pi16)(DMEM + addr + 0x004);
-        VR_A(vt, e+0x6) = DMEM[addr + 0x006 - BES(0x000)];
+        VR_S(vt, e+0x0) = *(pi16)(RSP_STATE.DMEM + addr + 0x000);
+        VR_A(vt, e+0x2) = RSP_STATE.DMEM[addr + 0x002 - BES(0x000)];
+        VR_U(vt, e+0x3) = RSP_STATE.DMEM[addr + 0x003 + BES(0x000)];
+        VR_S(vt, e+0x4) = *(pi16)(RSP_STATE.DMEM + addr + 0x004);
+        VR_A(vt, e+0x6) = RSP_STATE.DMEM[addr + 0x006 - BES(0x000)];
         addr += 0x007 + BES(00);
         addr &= 0x00000FFF;
-        VR_U(vt, e+0x7) = DMEM[addr];
+        VR_U(vt, e+0x7) = RSP_STATE.DMEM[addr];
         break;
     case 02:
-        VR_S(vt, e+0x0) = *(pi16)(DMEM + addr + 0x000 - HES(0x000));
-        VR_S(vt, e+0x2) = *(pi16)(DMEM + addr + 0x002 + HES(0x000));
-        VR_S(vt, e+0x4) = *(pi16)(DMEM + addr + 0x004 - HES(0x000));
+        VR_S(vt, e+0x0) = *(pi16)(RSP_STATE.DMEM + addr + 0x000 - HES(0x000));
+        VR_S(vt, e+0x2) = *(pi16)(RSP_STATE.DMEM + addr + 0x002 + HES(0x000));
+        VR_S(vt, e+0x4) = *(pi16)(RSP_STATE.DMEM + addr + 0x004 - HES(0x000));
         addr += 0x006 + HES(00);
         addr &= 0x00000FFF;
-        VR_S(vt, e+0x6) = *(pi16)(DMEM + addr);
+        VR_S(vt, e+0x6) = *(pi16)(RSP_STATE.DMEM + addr);
         break;
     case 03: /* standard ABI ucodes (unlike e.g. MusyX w/ even addresses) */
-        VR_A(vt, e+0x0) = DMEM[addr + 0x000 - BES(0x000)];
-        VR_U(vt, e+0x1) = DMEM[addr + 0x001 + BES(0x000)];
-        VR_S(vt, e+0x2) = *(pi16)(DMEM + addr + 0x002);
-        VR_A(vt, e+0x4) = DMEM[addr + 0x004 - BES(0x000)];
+        VR_A(vt, e+0x0) = RSP_STATE.DMEM[addr + 0x000 - BES(0x000)];
+        VR_U(vt, e+0x1) = RSP_STATE.DMEM[addr + 0x001 + BES(0x000)];
+        VR_S(vt, e+0x2) = *(pi16)(RSP_STATE.DMEM + addr + 0x002);
+        VR_A(vt, e+0x4) = RSP_STATE.DMEM[addr + 0x004 - BES(0x000)];
         addr += 0x005 + BES(00);
         addr &= 0x00000FFF;
-        VR_U(vt, e+0x5) = DMEM[addr];
-        VR_S(vt, e+0x6) = *(pi16)(DMEM + addr + 0x001 - BES(0x000));
+        VR_U(vt, e+0x5) = RSP_STATE.DMEM[addr];
+        VR_S(vt, e+0x6) = *(pi16)(RSP_STATE.DMEM + addr + 0x001 - BES(0x000));
         break;
     case 04:
-        VR_S(vt, e+0x0) = *(pi16)(DMEM + addr + HES(0x000));
-        VR_S(vt, e+0x2) = *(pi16)(DMEM + addr + HES(0x002));
+        VR_S(vt, e+0x0) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x000));
+        VR_S(vt, e+0x2) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x002));
         addr += 0x004 + WES(00);
         addr &= 0x00000FFF;
-        VR_S(vt, e+0x4) = *(pi16)(DMEM + addr + HES(0x000));
-        VR_S(vt, e+0x6) = *(pi16)(DMEM + addr + HES(0x002));
+        VR_S(vt, e+0x4) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x000));
+        VR_S(vt, e+0x6) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x002));
         break;
     case 05: /* standard ABI ucodes (unlike e.g. MusyX w/ even addresses) */
-        VR_S(vt, e+0x0) = *(pi16)(DMEM + addr + 0x000);
-        VR_A(vt, e+0x2) = DMEM[addr + 0x002 - BES(0x000)];
+        VR_S(vt, e+0x0) = *(pi16)(RSP_STATE.DMEM + addr + 0x000);
+        VR_A(vt, e+0x2) = RSP_STATE.DMEM[addr + 0x002 - BES(0x000)];
         addr += 0x003;
         addr &= 0x00000FFF;
-        VR_U(vt, e+0x3) = DMEM[addr + BES(0x000)];
-        VR_S(vt, e+0x4) = *(pi16)(DMEM + addr + 0x001);
-        VR_A(vt, e+0x6) = DMEM[addr + BES(0x003)];
-        VR_U(vt, e+0x7) = DMEM[addr + BES(0x004)];
+        VR_U(vt, e+0x3) = RSP_STATE.DMEM[addr + BES(0x000)];
+        VR_S(vt, e+0x4) = *(pi16)(RSP_STATE.DMEM + addr + 0x001);
+        VR_A(vt, e+0x6) = RSP_STATE.DMEM[addr + BES(0x003)];
+        VR_U(vt, e+0x7) = RSP_STATE.DMEM[addr + BES(0x004)];
         break;
     case 06:
-        VR_S(vt, e+0x0) = *(pi16)(DMEM + addr - HES(0x000));
+        VR_S(vt, e+0x0) = *(pi16)(RSP_STATE.DMEM + addr - HES(0x000));
         addr += 0x002;
         addr &= 0x00000FFF;
-        VR_S(vt, e+0x2) = *(pi16)(DMEM + addr + HES(0x000));
-        VR_S(vt, e+0x4) = *(pi16)(DMEM + addr + HES(0x002));
-        VR_S(vt, e+0x6) = *(pi16)(DMEM + addr + HES(0x004));
+        VR_S(vt, e+0x2) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x000));
+        VR_S(vt, e+0x4) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x002));
+        VR_S(vt, e+0x6) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x004));
         break;
     case 07: /* standard ABI ucodes (unlike e.g. MusyX w/ even addresses) */
-        VR_A(vt, e+0x0) = DMEM[addr - BES(0x000)];
+        VR_A(vt, e+0x0) = RSP_STATE.DMEM[addr - BES(0x000)];
         addr += 0x001;
         addr &= 0x00000FFF;
-        VR_U(vt, e+0x1) = DMEM[addr + BES(0x000)];
-        VR_S(vt, e+0x2) = *(pi16)(DMEM + addr + 0x001);
-        VR_A(vt, e+0x4) = DMEM[addr + BES(0x003)];
-        VR_U(vt, e+0x5) = DMEM[addr + BES(0x004)];
-        VR_S(vt, e+0x6) = *(pi16)(DMEM + addr + 0x005);
+        VR_U(vt, e+0x1) = RSP_STATE.DMEM[addr + BES(0x000)];
+        VR_S(vt, e+0x2) = *(pi16)(RSP_STATE.DMEM + addr + 0x001);
+        VR_A(vt, e+0x4) = RSP_STATE.DMEM[addr + BES(0x003)];
+        VR_U(vt, e+0x5) = RSP_STATE.DMEM[addr + BES(0x004)];
+        VR_S(vt, e+0x6) = *(pi16)(RSP_STATE.DMEM + addr + 0x005);
         break;
     }
     return;
@@ -711,8 +778,8 @@ void SBV(unsigned vt, unsigned element, signed offset, unsigned base)
     register u32 addr;
     const unsigned int e = element;
 
-    addr = (SR[base] + 1*offset) & 0x00000FFF;
-    DMEM[BES(addr)] = VR_B(vt, e);
+    addr = (RSP_STATE.SR[base] + 1*offset) & 0x00000FFF;
+    RSP_STATE.DMEM[BES(addr)] = VR_B(vt, e);
     return;
 }
 void SSV(unsigned vt, unsigned element, signed offset, unsigned base)
@@ -720,10 +787,10 @@ void SSV(unsigned vt, unsigned element, signed offset, unsigned base)
     register u32 addr;
     const unsigned int e = element;
 
-    addr = (SR[base] + 2*offset) & 0x00000FFF;
-    DMEM[BES(addr)] = VR_B(vt, (e + 0x0));
+    addr = (RSP_STATE.SR[base] + 2*offset) & 0x00000FFF;
+    RSP_STATE.DMEM[BES(addr)] = VR_B(vt, (e + 0x0));
     addr = (addr + 0x00000001) & 0x00000FFF;
-    DMEM[BES(addr)] = VR_B(vt, (e + 0x1) & 0xF);
+    RSP_STATE.DMEM[BES(addr)] = VR_B(vt, (e + 0x1) & 0xF);
     return;
 }
 void SLV(unsigned vt, unsigned element, signed offset, unsigned base)
@@ -736,15 +803,15 @@ void SLV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("SLV\nIllegal element.");
         return;
     } /* must support illegal even elements in F3DEX2 */
-    addr = (SR[base] + 4*offset) & 0x00000FFF;
+    addr = (RSP_STATE.SR[base] + 4*offset) & 0x00000FFF;
     if (addr & 0x00000001) {
         message("SLV\nOdd addr.");
         return;
     }
     correction = HES(0x000)*(addr%0x004 - 1);
-    *(pi16)(DMEM + addr - correction) = VR_S(vt, e+0x0);
+    *(pi16)(RSP_STATE.DMEM + addr - correction) = VR_S(vt, e+0x0);
     addr = (addr + 0x00000002) & 0x00000FFF; /* F3DLX 0.95:  "Mario Kart 64" */
-    *(pi16)(DMEM + addr + correction) = VR_S(vt, e+0x2);
+    *(pi16)(RSP_STATE.DMEM + addr + correction) = VR_S(vt, e+0x2);
     return;
 }
 void SDV(unsigned vt, unsigned element, signed offset, unsigned base)
@@ -752,86 +819,86 @@ void SDV(unsigned vt, unsigned element, signed offset, unsigned base)
     register u32 addr;
     const unsigned int e = element;
 
-    addr = (SR[base] + 8*offset) & 0x00000FFF;
+    addr = (RSP_STATE.SR[base] + 8*offset) & 0x00000FFF;
     if (e > 0x8 || (e & 0x1)) {
         register unsigned int i;
 
 #if (VR_STATIC_WRAPAROUND == 1)
-        vector_copy(VR[vt] + N, VR[vt]);
+        vector_copy(RSP_STATE.VR[vt] + N, RSP_STATE.VR[vt]);
         for (i = 0; i < 8; i++)
-            DMEM[BES(addr++ & 0x00000FFF)] = VR_B(vt, e + i);
+            RSP_STATE.DMEM[BES(addr++ & 0x00000FFF)] = VR_B(vt, e + i);
 #else
         for (i = 0; i < 8; i++)
-            DMEM[BES(addr++ & 0x00000FFF)] = VR_B(vt, (e+i)&0xF);
+            RSP_STATE.DMEM[BES(addr++ & 0x00000FFF)] = VR_B(vt, (e+i)&0xF);
 #endif
         return;
     } /* Illegal elements with Boss Game Studios publications. */
     switch (addr & 07) {
     case 00:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR_S(vt, e+0x0);
-        *(pi16)(DMEM + addr + HES(0x002)) = VR_S(vt, e+0x2);
-        *(pi16)(DMEM + addr + HES(0x004)) = VR_S(vt, e+0x4);
-        *(pi16)(DMEM + addr + HES(0x006)) = VR_S(vt, e+0x6);
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x000)) = VR_S(vt, e+0x0);
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x002)) = VR_S(vt, e+0x2);
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x004)) = VR_S(vt, e+0x4);
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x006)) = VR_S(vt, e+0x6);
         break;
     case 01: /* "Tetrisphere" audio ucode */
-        *(pi16)(DMEM + addr + 0x000) = VR_S(vt, e+0x0);
-        DMEM[addr + 0x002 - BES(0x000)] = VR_A(vt, e+0x2);
-        DMEM[addr + 0x003 + BES(0x000)] = VR_U(vt, e+0x3);
-        *(pi16)(DMEM + addr + 0x004) = VR_S(vt, e+0x4);
-        DMEM[addr + 0x006 - BES(0x000)] = VR_A(vt, e+0x6);
+        *(pi16)(RSP_STATE.DMEM + addr + 0x000) = VR_S(vt, e+0x0);
+        RSP_STATE.DMEM[addr + 0x002 - BES(0x000)] = VR_A(vt, e+0x2);
+        RSP_STATE.DMEM[addr + 0x003 + BES(0x000)] = VR_U(vt, e+0x3);
+        *(pi16)(RSP_STATE.DMEM + addr + 0x004) = VR_S(vt, e+0x4);
+        RSP_STATE.DMEM[addr + 0x006 - BES(0x000)] = VR_A(vt, e+0x6);
         addr += 0x007 + BES(0x000);
         addr &= 0x00000FFF;
-        DMEM[addr] = VR_U(vt, e+0x7);
+        RSP_STATE.DMEM[addr] = VR_U(vt, e+0x7);
         break;
     case 02:
-        *(pi16)(DMEM + addr + 0x000 - HES(0x000)) = VR_S(vt, e+0x0);
-        *(pi16)(DMEM + addr + 0x002 + HES(0x000)) = VR_S(vt, e+0x2);
-        *(pi16)(DMEM + addr + 0x004 - HES(0x000)) = VR_S(vt, e+0x4);
+        *(pi16)(RSP_STATE.DMEM + addr + 0x000 - HES(0x000)) = VR_S(vt, e+0x0);
+        *(pi16)(RSP_STATE.DMEM + addr + 0x002 + HES(0x000)) = VR_S(vt, e+0x2);
+        *(pi16)(RSP_STATE.DMEM + addr + 0x004 - HES(0x000)) = VR_S(vt, e+0x4);
         addr += 0x006 + HES(0x000);
         addr &= 0x00000FFF;
-        *(pi16)(DMEM + addr) = VR_S(vt, e+0x6);
+        *(pi16)(RSP_STATE.DMEM + addr) = VR_S(vt, e+0x6);
         break;
     case 03: /* "Tetrisphere" audio ucode */
-        DMEM[addr + 0x000 - BES(0x000)] = VR_A(vt, e+0x0);
-        DMEM[addr + 0x001 + BES(0x000)] = VR_U(vt, e+0x1);
-        *(pi16)(DMEM + addr + 0x002) = VR_S(vt, e+0x2);
-        DMEM[addr + 0x004 - BES(0x000)] = VR_A(vt, e+0x4);
+        RSP_STATE.DMEM[addr + 0x000 - BES(0x000)] = VR_A(vt, e+0x0);
+        RSP_STATE.DMEM[addr + 0x001 + BES(0x000)] = VR_U(vt, e+0x1);
+        *(pi16)(RSP_STATE.DMEM + addr + 0x002) = VR_S(vt, e+0x2);
+        RSP_STATE.DMEM[addr + 0x004 - BES(0x000)] = VR_A(vt, e+0x4);
         addr += 0x005 + BES(0x000);
         addr &= 0x00000FFF;
-        DMEM[addr] = VR_U(vt, e+0x5);
-        *(pi16)(DMEM + addr + 0x001 - BES(0x000)) = VR_S(vt, 0x6);
+        RSP_STATE.DMEM[addr] = VR_U(vt, e+0x5);
+        *(pi16)(RSP_STATE.DMEM + addr + 0x001 - BES(0x000)) = VR_S(vt, e+0x6);
         break;
     case 04:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR_S(vt, e+0x0);
-        *(pi16)(DMEM + addr + HES(0x002)) = VR_S(vt, e+0x2);
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x000)) = VR_S(vt, e+0x0);
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x002)) = VR_S(vt, e+0x2);
         addr = (addr + 0x004) & 0x00000FFF;
-        *(pi16)(DMEM + addr + HES(0x000)) = VR_S(vt, e+0x4);
-        *(pi16)(DMEM + addr + HES(0x002)) = VR_S(vt, e+0x6);
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x000)) = VR_S(vt, e+0x4);
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x002)) = VR_S(vt, e+0x6);
         break;
     case 05: /* "Tetrisphere" audio ucode */
-        *(pi16)(DMEM + addr + 0x000) = VR_S(vt, e+0x0);
-        DMEM[addr + 0x002 - BES(0x000)] = VR_A(vt, e+0x2);
+        *(pi16)(RSP_STATE.DMEM + addr + 0x000) = VR_S(vt, e+0x0);
+        RSP_STATE.DMEM[addr + 0x002 - BES(0x000)] = VR_A(vt, e+0x2);
         addr = (addr + 0x003) & 0x00000FFF;
-        DMEM[addr + BES(0x000)] = VR_U(vt, e+0x3);
-        *(pi16)(DMEM + addr + 0x001) = VR_S(vt, e+0x4);
-        DMEM[addr + BES(0x003)] = VR_A(vt, e+0x6);
-        DMEM[addr + BES(0x004)] = VR_U(vt, e+0x7);
+        RSP_STATE.DMEM[addr + BES(0x000)] = VR_U(vt, e+0x3);
+        *(pi16)(RSP_STATE.DMEM + addr + 0x001) = VR_S(vt, e+0x4);
+        RSP_STATE.DMEM[addr + BES(0x003)] = VR_A(vt, e+0x6);
+        RSP_STATE.DMEM[addr + BES(0x004)] = VR_U(vt, e+0x7);
         break;
     case 06:
-        *(pi16)(DMEM + addr - HES(0x000)) = VR_S(vt, e+0x0);
+        *(pi16)(RSP_STATE.DMEM + addr - HES(0x000)) = VR_S(vt, e+0x0);
         addr = (addr + 0x002) & 0x00000FFF;
-        *(pi16)(DMEM + addr + HES(0x000)) = VR_S(vt, e+0x2);
-        *(pi16)(DMEM + addr + HES(0x002)) = VR_S(vt, e+0x4);
-        *(pi16)(DMEM + addr + HES(0x004)) = VR_S(vt, e+0x6);
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x000)) = VR_S(vt, e+0x2);
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x002)) = VR_S(vt, e+0x4);
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x004)) = VR_S(vt, e+0x6);
         break;
     case 07: /* "Tetrisphere" audio ucode */
-        DMEM[addr - BES(0x000)] = VR_A(vt, e+0x0);
+        RSP_STATE.DMEM[addr - BES(0x000)] = VR_A(vt, e+0x0);
         addr = (addr + 0x001) & 0x00000FFF;
-        DMEM[addr + BES(0x000)] = VR_U(vt, e+0x1);
-        *(pi16)(DMEM + addr + 0x001) = VR_S(vt, e+0x2);
-        DMEM[addr + BES(0x003)] = VR_A(vt, e+0x4);
-        DMEM[addr + BES(0x004)] = VR_U(vt, e+0x5);
-        *(pi16)(DMEM + addr + 0x005) = VR_S(vt, e+0x6);
+        RSP_STATE.DMEM[addr + BES(0x000)] = VR_U(vt, e+0x1);
+        *(pi16)(RSP_STATE.DMEM + addr + 0x001) = VR_S(vt, e+0x2);
+        RSP_STATE.DMEM[addr + BES(0x003)] = VR_A(vt, e+0x4);
+        RSP_STATE.DMEM[addr + BES(0x004)] = VR_U(vt, e+0x5);
+        *(pi16)(RSP_STATE.DMEM + addr + 0x005) = VR_S(vt, e+0x6);
         break;
     }
     return;
@@ -860,103 +927,103 @@ void LPV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("LPV\nIllegal element.");
         return;
     }
-    addr = (SR[base] + 8*offset) & 0x00000FFF;
+    addr = (RSP_STATE.SR[base] + 8*offset) & 0x00000FFF;
     b = addr & 07;
     addr &= ~07;
     switch (b) {
     case 00:
-        VR[vt][07] = DMEM[addr + BES(0x007)] << 8;
-        VR[vt][06] = DMEM[addr + BES(0x006)] << 8;
-        VR[vt][05] = DMEM[addr + BES(0x005)] << 8;
-        VR[vt][04] = DMEM[addr + BES(0x004)] << 8;
-        VR[vt][03] = DMEM[addr + BES(0x003)] << 8;
-        VR[vt][02] = DMEM[addr + BES(0x002)] << 8;
-        VR[vt][01] = DMEM[addr + BES(0x001)] << 8;
-        VR[vt][00] = DMEM[addr + BES(0x000)] << 8;
+        RSP_STATE.VR[vt][07] = RSP_STATE.DMEM[addr + BES(0x007)] << 8;
+        RSP_STATE.VR[vt][06] = RSP_STATE.DMEM[addr + BES(0x006)] << 8;
+        RSP_STATE.VR[vt][05] = RSP_STATE.DMEM[addr + BES(0x005)] << 8;
+        RSP_STATE.VR[vt][04] = RSP_STATE.DMEM[addr + BES(0x004)] << 8;
+        RSP_STATE.VR[vt][03] = RSP_STATE.DMEM[addr + BES(0x003)] << 8;
+        RSP_STATE.VR[vt][02] = RSP_STATE.DMEM[addr + BES(0x002)] << 8;
+        RSP_STATE.VR[vt][01] = RSP_STATE.DMEM[addr + BES(0x001)] << 8;
+        RSP_STATE.VR[vt][00] = RSP_STATE.DMEM[addr + BES(0x000)] << 8;
         break;
     case 01: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        VR[vt][00] = DMEM[addr + BES(0x001)] << 8;
-        VR[vt][01] = DMEM[addr + BES(0x002)] << 8;
-        VR[vt][02] = DMEM[addr + BES(0x003)] << 8;
-        VR[vt][03] = DMEM[addr + BES(0x004)] << 8;
-        VR[vt][04] = DMEM[addr + BES(0x005)] << 8;
-        VR[vt][05] = DMEM[addr + BES(0x006)] << 8;
-        VR[vt][06] = DMEM[addr + BES(0x007)] << 8;
+        RSP_STATE.VR[vt][00] = RSP_STATE.DMEM[addr + BES(0x001)] << 8;
+        RSP_STATE.VR[vt][01] = RSP_STATE.DMEM[addr + BES(0x002)] << 8;
+        RSP_STATE.VR[vt][02] = RSP_STATE.DMEM[addr + BES(0x003)] << 8;
+        RSP_STATE.VR[vt][03] = RSP_STATE.DMEM[addr + BES(0x004)] << 8;
+        RSP_STATE.VR[vt][04] = RSP_STATE.DMEM[addr + BES(0x005)] << 8;
+        RSP_STATE.VR[vt][05] = RSP_STATE.DMEM[addr + BES(0x006)] << 8;
+        RSP_STATE.VR[vt][06] = RSP_STATE.DMEM[addr + BES(0x007)] << 8;
         addr += BES(0x008);
         addr &= 0x00000FFF;
-        VR[vt][07] = DMEM[addr] << 8;
+        RSP_STATE.VR[vt][07] = RSP_STATE.DMEM[addr] << 8;
         break;
     case 02: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        VR[vt][00] = DMEM[addr + BES(0x002)] << 8;
-        VR[vt][01] = DMEM[addr + BES(0x003)] << 8;
-        VR[vt][02] = DMEM[addr + BES(0x004)] << 8;
-        VR[vt][03] = DMEM[addr + BES(0x005)] << 8;
-        VR[vt][04] = DMEM[addr + BES(0x006)] << 8;
-        VR[vt][05] = DMEM[addr + BES(0x007)] << 8;
+        RSP_STATE.VR[vt][00] = RSP_STATE.DMEM[addr + BES(0x002)] << 8;
+        RSP_STATE.VR[vt][01] = RSP_STATE.DMEM[addr + BES(0x003)] << 8;
+        RSP_STATE.VR[vt][02] = RSP_STATE.DMEM[addr + BES(0x004)] << 8;
+        RSP_STATE.VR[vt][03] = RSP_STATE.DMEM[addr + BES(0x005)] << 8;
+        RSP_STATE.VR[vt][04] = RSP_STATE.DMEM[addr + BES(0x006)] << 8;
+        RSP_STATE.VR[vt][05] = RSP_STATE.DMEM[addr + BES(0x007)] << 8;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][06] = DMEM[addr + BES(0x000)] << 8;
-        VR[vt][07] = DMEM[addr + BES(0x001)] << 8;
+        RSP_STATE.VR[vt][06] = RSP_STATE.DMEM[addr + BES(0x000)] << 8;
+        RSP_STATE.VR[vt][07] = RSP_STATE.DMEM[addr + BES(0x001)] << 8;
         break;
     case 03: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        VR[vt][00] = DMEM[addr + BES(0x003)] << 8;
-        VR[vt][01] = DMEM[addr + BES(0x004)] << 8;
-        VR[vt][02] = DMEM[addr + BES(0x005)] << 8;
-        VR[vt][03] = DMEM[addr + BES(0x006)] << 8;
-        VR[vt][04] = DMEM[addr + BES(0x007)] << 8;
+        RSP_STATE.VR[vt][00] = RSP_STATE.DMEM[addr + BES(0x003)] << 8;
+        RSP_STATE.VR[vt][01] = RSP_STATE.DMEM[addr + BES(0x004)] << 8;
+        RSP_STATE.VR[vt][02] = RSP_STATE.DMEM[addr + BES(0x005)] << 8;
+        RSP_STATE.VR[vt][03] = RSP_STATE.DMEM[addr + BES(0x006)] << 8;
+        RSP_STATE.VR[vt][04] = RSP_STATE.DMEM[addr + BES(0x007)] << 8;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][05] = DMEM[addr + BES(0x000)] << 8;
-        VR[vt][06] = DMEM[addr + BES(0x001)] << 8;
-        VR[vt][07] = DMEM[addr + BES(0x002)] << 8;
+        RSP_STATE.VR[vt][05] = RSP_STATE.DMEM[addr + BES(0x000)] << 8;
+        RSP_STATE.VR[vt][06] = RSP_STATE.DMEM[addr + BES(0x001)] << 8;
+        RSP_STATE.VR[vt][07] = RSP_STATE.DMEM[addr + BES(0x002)] << 8;
         break;
     case 04: /* "Resident Evil 2" in-game 3-D, F3DLX 2.08--"WWF No Mercy" */
-        VR[vt][00] = DMEM[addr + BES(0x004)] << 8;
-        VR[vt][01] = DMEM[addr + BES(0x005)] << 8;
-        VR[vt][02] = DMEM[addr + BES(0x006)] << 8;
-        VR[vt][03] = DMEM[addr + BES(0x007)] << 8;
+        RSP_STATE.VR[vt][00] = RSP_STATE.DMEM[addr + BES(0x004)] << 8;
+        RSP_STATE.VR[vt][01] = RSP_STATE.DMEM[addr + BES(0x005)] << 8;
+        RSP_STATE.VR[vt][02] = RSP_STATE.DMEM[addr + BES(0x006)] << 8;
+        RSP_STATE.VR[vt][03] = RSP_STATE.DMEM[addr + BES(0x007)] << 8;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][04] = DMEM[addr + BES(0x000)] << 8;
-        VR[vt][05] = DMEM[addr + BES(0x001)] << 8;
-        VR[vt][06] = DMEM[addr + BES(0x002)] << 8;
-        VR[vt][07] = DMEM[addr + BES(0x003)] << 8;
+        RSP_STATE.VR[vt][04] = RSP_STATE.DMEM[addr + BES(0x000)] << 8;
+        RSP_STATE.VR[vt][05] = RSP_STATE.DMEM[addr + BES(0x001)] << 8;
+        RSP_STATE.VR[vt][06] = RSP_STATE.DMEM[addr + BES(0x002)] << 8;
+        RSP_STATE.VR[vt][07] = RSP_STATE.DMEM[addr + BES(0x003)] << 8;
         break;
     case 05: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        VR[vt][00] = DMEM[addr + BES(0x005)] << 8;
-        VR[vt][01] = DMEM[addr + BES(0x006)] << 8;
-        VR[vt][02] = DMEM[addr + BES(0x007)] << 8;
+        RSP_STATE.VR[vt][00] = RSP_STATE.DMEM[addr + BES(0x005)] << 8;
+        RSP_STATE.VR[vt][01] = RSP_STATE.DMEM[addr + BES(0x006)] << 8;
+        RSP_STATE.VR[vt][02] = RSP_STATE.DMEM[addr + BES(0x007)] << 8;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][03] = DMEM[addr + BES(0x000)] << 8;
-        VR[vt][04] = DMEM[addr + BES(0x001)] << 8;
-        VR[vt][05] = DMEM[addr + BES(0x002)] << 8;
-        VR[vt][06] = DMEM[addr + BES(0x003)] << 8;
-        VR[vt][07] = DMEM[addr + BES(0x004)] << 8;
+        RSP_STATE.VR[vt][03] = RSP_STATE.DMEM[addr + BES(0x000)] << 8;
+        RSP_STATE.VR[vt][04] = RSP_STATE.DMEM[addr + BES(0x001)] << 8;
+        RSP_STATE.VR[vt][05] = RSP_STATE.DMEM[addr + BES(0x002)] << 8;
+        RSP_STATE.VR[vt][06] = RSP_STATE.DMEM[addr + BES(0x003)] << 8;
+        RSP_STATE.VR[vt][07] = RSP_STATE.DMEM[addr + BES(0x004)] << 8;
         break;
     case 06: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        VR[vt][00] = DMEM[addr + BES(0x006)] << 8;
-        VR[vt][01] = DMEM[addr + BES(0x007)] << 8;
+        RSP_STATE.VR[vt][00] = RSP_STATE.DMEM[addr + BES(0x006)] << 8;
+        RSP_STATE.VR[vt][01] = RSP_STATE.DMEM[addr + BES(0x007)] << 8;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][02] = DMEM[addr + BES(0x000)] << 8;
-        VR[vt][03] = DMEM[addr + BES(0x001)] << 8;
-        VR[vt][04] = DMEM[addr + BES(0x002)] << 8;
-        VR[vt][05] = DMEM[addr + BES(0x003)] << 8;
-        VR[vt][06] = DMEM[addr + BES(0x004)] << 8;
-        VR[vt][07] = DMEM[addr + BES(0x005)] << 8;
+        RSP_STATE.VR[vt][02] = RSP_STATE.DMEM[addr + BES(0x000)] << 8;
+        RSP_STATE.VR[vt][03] = RSP_STATE.DMEM[addr + BES(0x001)] << 8;
+        RSP_STATE.VR[vt][04] = RSP_STATE.DMEM[addr + BES(0x002)] << 8;
+        RSP_STATE.VR[vt][05] = RSP_STATE.DMEM[addr + BES(0x003)] << 8;
+        RSP_STATE.VR[vt][06] = RSP_STATE.DMEM[addr + BES(0x004)] << 8;
+        RSP_STATE.VR[vt][07] = RSP_STATE.DMEM[addr + BES(0x005)] << 8;
         break;
     case 07: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        VR[vt][00] = DMEM[addr + BES(0x007)] << 8;
+        RSP_STATE.VR[vt][00] = RSP_STATE.DMEM[addr + BES(0x007)] << 8;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][01] = DMEM[addr + BES(0x000)] << 8;
-        VR[vt][02] = DMEM[addr + BES(0x001)] << 8;
-        VR[vt][03] = DMEM[addr + BES(0x002)] << 8;
-        VR[vt][04] = DMEM[addr + BES(0x003)] << 8;
-        VR[vt][05] = DMEM[addr + BES(0x004)] << 8;
-        VR[vt][06] = DMEM[addr + BES(0x005)] << 8;
-        VR[vt][07] = DMEM[addr + BES(0x006)] << 8;
+        RSP_STATE.VR[vt][01] = RSP_STATE.DMEM[addr + BES(0x000)] << 8;
+        RSP_STATE.VR[vt][02] = RSP_STATE.DMEM[addr + BES(0x001)] << 8;
+        RSP_STATE.VR[vt][03] = RSP_STATE.DMEM[addr + BES(0x002)] << 8;
+        RSP_STATE.VR[vt][04] = RSP_STATE.DMEM[addr + BES(0x003)] << 8;
+        RSP_STATE.VR[vt][05] = RSP_STATE.DMEM[addr + BES(0x004)] << 8;
+        RSP_STATE.VR[vt][06] = RSP_STATE.DMEM[addr + BES(0x005)] << 8;
+        RSP_STATE.VR[vt][07] = RSP_STATE.DMEM[addr + BES(0x006)] << 8;
         break;
     }
     return;
@@ -967,11 +1034,11 @@ void LUV(unsigned vt, unsigned element, signed offset, unsigned base)
     register unsigned int b;
     const unsigned int e = element;
 
-    addr = (SR[base] + 8*offset) & 0x00000FFF;
+    addr = (RSP_STATE.SR[base] + 8*offset) & 0x00000FFF;
     if (e != 0x0) {
         addr += (~e + 0x1) & 0xF;
         for (b = 0; b < 8; b++) {
-            VR[vt][b] = DMEM[BES(addr &= 0x00000FFF)] << 7;
+            RSP_STATE.VR[vt][b] = RSP_STATE.DMEM[BES(addr &= 0x00000FFF)] << 7;
             addr -= 16 * (e - b - 1 == 0x0);
             ++addr;
         }
@@ -981,98 +1048,98 @@ void LUV(unsigned vt, unsigned element, signed offset, unsigned base)
     addr &= ~07;
     switch (b) {
     case 00:
-        VR[vt][07] = DMEM[addr + BES(0x007)] << 7;
-        VR[vt][06] = DMEM[addr + BES(0x006)] << 7;
-        VR[vt][05] = DMEM[addr + BES(0x005)] << 7;
-        VR[vt][04] = DMEM[addr + BES(0x004)] << 7;
-        VR[vt][03] = DMEM[addr + BES(0x003)] << 7;
-        VR[vt][02] = DMEM[addr + BES(0x002)] << 7;
-        VR[vt][01] = DMEM[addr + BES(0x001)] << 7;
-        VR[vt][00] = DMEM[addr + BES(0x000)] << 7;
+        RSP_STATE.VR[vt][07] = RSP_STATE.DMEM[addr + BES(0x007)] << 7;
+        RSP_STATE.VR[vt][06] = RSP_STATE.DMEM[addr + BES(0x006)] << 7;
+        RSP_STATE.VR[vt][05] = RSP_STATE.DMEM[addr + BES(0x005)] << 7;
+        RSP_STATE.VR[vt][04] = RSP_STATE.DMEM[addr + BES(0x004)] << 7;
+        RSP_STATE.VR[vt][03] = RSP_STATE.DMEM[addr + BES(0x003)] << 7;
+        RSP_STATE.VR[vt][02] = RSP_STATE.DMEM[addr + BES(0x002)] << 7;
+        RSP_STATE.VR[vt][01] = RSP_STATE.DMEM[addr + BES(0x001)] << 7;
+        RSP_STATE.VR[vt][00] = RSP_STATE.DMEM[addr + BES(0x000)] << 7;
         break;
     case 01: /* PKMN Puzzle League HVQM decoder */
-        VR[vt][00] = DMEM[addr + BES(0x001)] << 7;
-        VR[vt][01] = DMEM[addr + BES(0x002)] << 7;
-        VR[vt][02] = DMEM[addr + BES(0x003)] << 7;
-        VR[vt][03] = DMEM[addr + BES(0x004)] << 7;
-        VR[vt][04] = DMEM[addr + BES(0x005)] << 7;
-        VR[vt][05] = DMEM[addr + BES(0x006)] << 7;
-        VR[vt][06] = DMEM[addr + BES(0x007)] << 7;
+        RSP_STATE.VR[vt][00] = RSP_STATE.DMEM[addr + BES(0x001)] << 7;
+        RSP_STATE.VR[vt][01] = RSP_STATE.DMEM[addr + BES(0x002)] << 7;
+        RSP_STATE.VR[vt][02] = RSP_STATE.DMEM[addr + BES(0x003)] << 7;
+        RSP_STATE.VR[vt][03] = RSP_STATE.DMEM[addr + BES(0x004)] << 7;
+        RSP_STATE.VR[vt][04] = RSP_STATE.DMEM[addr + BES(0x005)] << 7;
+        RSP_STATE.VR[vt][05] = RSP_STATE.DMEM[addr + BES(0x006)] << 7;
+        RSP_STATE.VR[vt][06] = RSP_STATE.DMEM[addr + BES(0x007)] << 7;
         addr += BES(0x008);
         addr &= 0x00000FFF;
-        VR[vt][07] = DMEM[addr] << 7;
+        RSP_STATE.VR[vt][07] = RSP_STATE.DMEM[addr] << 7;
         break;
     case 02: /* PKMN Puzzle League HVQM decoder */
-        VR[vt][00] = DMEM[addr + BES(0x002)] << 7;
-        VR[vt][01] = DMEM[addr + BES(0x003)] << 7;
-        VR[vt][02] = DMEM[addr + BES(0x004)] << 7;
-        VR[vt][03] = DMEM[addr + BES(0x005)] << 7;
-        VR[vt][04] = DMEM[addr + BES(0x006)] << 7;
-        VR[vt][05] = DMEM[addr + BES(0x007)] << 7;
+        RSP_STATE.VR[vt][00] = RSP_STATE.DMEM[addr + BES(0x002)] << 7;
+        RSP_STATE.VR[vt][01] = RSP_STATE.DMEM[addr + BES(0x003)] << 7;
+        RSP_STATE.VR[vt][02] = RSP_STATE.DMEM[addr + BES(0x004)] << 7;
+        RSP_STATE.VR[vt][03] = RSP_STATE.DMEM[addr + BES(0x005)] << 7;
+        RSP_STATE.VR[vt][04] = RSP_STATE.DMEM[addr + BES(0x006)] << 7;
+        RSP_STATE.VR[vt][05] = RSP_STATE.DMEM[addr + BES(0x007)] << 7;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][06] = DMEM[addr + BES(0x000)] << 7;
-        VR[vt][07] = DMEM[addr + BES(0x001)] << 7;
+        RSP_STATE.VR[vt][06] = RSP_STATE.DMEM[addr + BES(0x000)] << 7;
+        RSP_STATE.VR[vt][07] = RSP_STATE.DMEM[addr + BES(0x001)] << 7;
         break;
     case 03: /* PKMN Puzzle League HVQM decoder */
-        VR[vt][00] = DMEM[addr + BES(0x003)] << 7;
-        VR[vt][01] = DMEM[addr + BES(0x004)] << 7;
-        VR[vt][02] = DMEM[addr + BES(0x005)] << 7;
-        VR[vt][03] = DMEM[addr + BES(0x006)] << 7;
-        VR[vt][04] = DMEM[addr + BES(0x007)] << 7;
+        RSP_STATE.VR[vt][00] = RSP_STATE.DMEM[addr + BES(0x003)] << 7;
+        RSP_STATE.VR[vt][01] = RSP_STATE.DMEM[addr + BES(0x004)] << 7;
+        RSP_STATE.VR[vt][02] = RSP_STATE.DMEM[addr + BES(0x005)] << 7;
+        RSP_STATE.VR[vt][03] = RSP_STATE.DMEM[addr + BES(0x006)] << 7;
+        RSP_STATE.VR[vt][04] = RSP_STATE.DMEM[addr + BES(0x007)] << 7;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][05] = DMEM[addr + BES(0x000)] << 7;
-        VR[vt][06] = DMEM[addr + BES(0x001)] << 7;
-        VR[vt][07] = DMEM[addr + BES(0x002)] << 7;
+        RSP_STATE.VR[vt][05] = RSP_STATE.DMEM[addr + BES(0x000)] << 7;
+        RSP_STATE.VR[vt][06] = RSP_STATE.DMEM[addr + BES(0x001)] << 7;
+        RSP_STATE.VR[vt][07] = RSP_STATE.DMEM[addr + BES(0x002)] << 7;
         break;
     case 04: /* PKMN Puzzle League HVQM decoder */
-        VR[vt][00] = DMEM[addr + BES(0x004)] << 7;
-        VR[vt][01] = DMEM[addr + BES(0x005)] << 7;
-        VR[vt][02] = DMEM[addr + BES(0x006)] << 7;
-        VR[vt][03] = DMEM[addr + BES(0x007)] << 7;
+        RSP_STATE.VR[vt][00] = RSP_STATE.DMEM[addr + BES(0x004)] << 7;
+        RSP_STATE.VR[vt][01] = RSP_STATE.DMEM[addr + BES(0x005)] << 7;
+        RSP_STATE.VR[vt][02] = RSP_STATE.DMEM[addr + BES(0x006)] << 7;
+        RSP_STATE.VR[vt][03] = RSP_STATE.DMEM[addr + BES(0x007)] << 7;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][04] = DMEM[addr + BES(0x000)] << 7;
-        VR[vt][05] = DMEM[addr + BES(0x001)] << 7;
-        VR[vt][06] = DMEM[addr + BES(0x002)] << 7;
-        VR[vt][07] = DMEM[addr + BES(0x003)] << 7;
+        RSP_STATE.VR[vt][04] = RSP_STATE.DMEM[addr + BES(0x000)] << 7;
+        RSP_STATE.VR[vt][05] = RSP_STATE.DMEM[addr + BES(0x001)] << 7;
+        RSP_STATE.VR[vt][06] = RSP_STATE.DMEM[addr + BES(0x002)] << 7;
+        RSP_STATE.VR[vt][07] = RSP_STATE.DMEM[addr + BES(0x003)] << 7;
         break;
     case 05: /* PKMN Puzzle League HVQM decoder */
-        VR[vt][00] = DMEM[addr + BES(0x005)] << 7;
-        VR[vt][01] = DMEM[addr + BES(0x006)] << 7;
-        VR[vt][02] = DMEM[addr + BES(0x007)] << 7;
+        RSP_STATE.VR[vt][00] = RSP_STATE.DMEM[addr + BES(0x005)] << 7;
+        RSP_STATE.VR[vt][01] = RSP_STATE.DMEM[addr + BES(0x006)] << 7;
+        RSP_STATE.VR[vt][02] = RSP_STATE.DMEM[addr + BES(0x007)] << 7;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][03] = DMEM[addr + BES(0x000)] << 7;
-        VR[vt][04] = DMEM[addr + BES(0x001)] << 7;
-        VR[vt][05] = DMEM[addr + BES(0x002)] << 7;
-        VR[vt][06] = DMEM[addr + BES(0x003)] << 7;
-        VR[vt][07] = DMEM[addr + BES(0x004)] << 7;
+        RSP_STATE.VR[vt][03] = RSP_STATE.DMEM[addr + BES(0x000)] << 7;
+        RSP_STATE.VR[vt][04] = RSP_STATE.DMEM[addr + BES(0x001)] << 7;
+        RSP_STATE.VR[vt][05] = RSP_STATE.DMEM[addr + BES(0x002)] << 7;
+        RSP_STATE.VR[vt][06] = RSP_STATE.DMEM[addr + BES(0x003)] << 7;
+        RSP_STATE.VR[vt][07] = RSP_STATE.DMEM[addr + BES(0x004)] << 7;
         break;
     case 06: /* PKMN Puzzle League HVQM decoder */
-        VR[vt][00] = DMEM[addr + BES(0x006)] << 7;
-        VR[vt][01] = DMEM[addr + BES(0x007)] << 7;
+        RSP_STATE.VR[vt][00] = RSP_STATE.DMEM[addr + BES(0x006)] << 7;
+        RSP_STATE.VR[vt][01] = RSP_STATE.DMEM[addr + BES(0x007)] << 7;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][02] = DMEM[addr + BES(0x000)] << 7;
-        VR[vt][03] = DMEM[addr + BES(0x001)] << 7;
-        VR[vt][04] = DMEM[addr + BES(0x002)] << 7;
-        VR[vt][05] = DMEM[addr + BES(0x003)] << 7;
-        VR[vt][06] = DMEM[addr + BES(0x004)] << 7;
-        VR[vt][07] = DMEM[addr + BES(0x005)] << 7;
+        RSP_STATE.VR[vt][02] = RSP_STATE.DMEM[addr + BES(0x000)] << 7;
+        RSP_STATE.VR[vt][03] = RSP_STATE.DMEM[addr + BES(0x001)] << 7;
+        RSP_STATE.VR[vt][04] = RSP_STATE.DMEM[addr + BES(0x002)] << 7;
+        RSP_STATE.VR[vt][05] = RSP_STATE.DMEM[addr + BES(0x003)] << 7;
+        RSP_STATE.VR[vt][06] = RSP_STATE.DMEM[addr + BES(0x004)] << 7;
+        RSP_STATE.VR[vt][07] = RSP_STATE.DMEM[addr + BES(0x005)] << 7;
         break;
     case 07: /* PKMN Puzzle League HVQM decoder */
-        VR[vt][00] = DMEM[addr + BES(0x007)] << 7;
+        RSP_STATE.VR[vt][00] = RSP_STATE.DMEM[addr + BES(0x007)] << 7;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][01] = DMEM[addr + BES(0x000)] << 7;
-        VR[vt][02] = DMEM[addr + BES(0x001)] << 7;
-        VR[vt][03] = DMEM[addr + BES(0x002)] << 7;
-        VR[vt][04] = DMEM[addr + BES(0x003)] << 7;
-        VR[vt][05] = DMEM[addr + BES(0x004)] << 7;
-        VR[vt][06] = DMEM[addr + BES(0x005)] << 7;
-        VR[vt][07] = DMEM[addr + BES(0x006)] << 7;
+        RSP_STATE.VR[vt][01] = RSP_STATE.DMEM[addr + BES(0x000)] << 7;
+        RSP_STATE.VR[vt][02] = RSP_STATE.DMEM[addr + BES(0x001)] << 7;
+        RSP_STATE.VR[vt][03] = RSP_STATE.DMEM[addr + BES(0x002)] << 7;
+        RSP_STATE.VR[vt][04] = RSP_STATE.DMEM[addr + BES(0x003)] << 7;
+        RSP_STATE.VR[vt][05] = RSP_STATE.DMEM[addr + BES(0x004)] << 7;
+        RSP_STATE.VR[vt][06] = RSP_STATE.DMEM[addr + BES(0x005)] << 7;
+        RSP_STATE.VR[vt][07] = RSP_STATE.DMEM[addr + BES(0x006)] << 7;
         break;
     }
     return;
@@ -1087,103 +1154,103 @@ void SPV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("SPV\nIllegal element.");
         return;
     }
-    addr = (SR[base] + 8*offset) & 0x00000FFF;
+    addr = (RSP_STATE.SR[base] + 8*offset) & 0x00000FFF;
     b = addr & 07;
     addr &= ~07;
     switch (b) {
     case 00:
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][07] >> 8);
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][06] >> 8);
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][05] >> 8);
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][04] >> 8);
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][03] >> 8);
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][02] >> 8);
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][01] >> 8);
-        DMEM[addr + BES(0x000)] = (u8)(VR[vt][00] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x007)] = (u8)(RSP_STATE.VR[vt][07] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x006)] = (u8)(RSP_STATE.VR[vt][06] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x005)] = (u8)(RSP_STATE.VR[vt][05] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x004)] = (u8)(RSP_STATE.VR[vt][04] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x003)] = (u8)(RSP_STATE.VR[vt][03] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x002)] = (u8)(RSP_STATE.VR[vt][02] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x001)] = (u8)(RSP_STATE.VR[vt][01] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x000)] = (u8)(RSP_STATE.VR[vt][00] >> 8);
         break;
     case 01: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][00] >> 8);
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][01] >> 8);
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][02] >> 8);
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][03] >> 8);
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][04] >> 8);
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][05] >> 8);
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][06] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x001)] = (u8)(RSP_STATE.VR[vt][00] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x002)] = (u8)(RSP_STATE.VR[vt][01] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x003)] = (u8)(RSP_STATE.VR[vt][02] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x004)] = (u8)(RSP_STATE.VR[vt][03] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x005)] = (u8)(RSP_STATE.VR[vt][04] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x006)] = (u8)(RSP_STATE.VR[vt][05] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x007)] = (u8)(RSP_STATE.VR[vt][06] >> 8);
         addr += BES(0x008);
         addr &= 0x00000FFF;
-        DMEM[addr] = (u8)(VR[vt][07] >> 8);
+        RSP_STATE.DMEM[addr] = (u8)(RSP_STATE.VR[vt][07] >> 8);
         break;
     case 02: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][00] >> 8);
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][01] >> 8);
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][02] >> 8);
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][03] >> 8);
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][04] >> 8);
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][05] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x002)] = (u8)(RSP_STATE.VR[vt][00] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x003)] = (u8)(RSP_STATE.VR[vt][01] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x004)] = (u8)(RSP_STATE.VR[vt][02] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x005)] = (u8)(RSP_STATE.VR[vt][03] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x006)] = (u8)(RSP_STATE.VR[vt][04] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x007)] = (u8)(RSP_STATE.VR[vt][05] >> 8);
         addr += 0x008;
         addr &= 0x00000FFF;
-        DMEM[addr + BES(0x000)] = (u8)(VR[vt][06] >> 8);
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][07] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x000)] = (u8)(RSP_STATE.VR[vt][06] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x001)] = (u8)(RSP_STATE.VR[vt][07] >> 8);
         break;
     case 03: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][00] >> 8);
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][01] >> 8);
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][02] >> 8);
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][03] >> 8);
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][04] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x003)] = (u8)(RSP_STATE.VR[vt][00] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x004)] = (u8)(RSP_STATE.VR[vt][01] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x005)] = (u8)(RSP_STATE.VR[vt][02] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x006)] = (u8)(RSP_STATE.VR[vt][03] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x007)] = (u8)(RSP_STATE.VR[vt][04] >> 8);
         addr += 0x008;
         addr &= 0x00000FFF;
-        DMEM[addr + BES(0x000)] = (u8)(VR[vt][05] >> 8);
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][06] >> 8);
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][07] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x000)] = (u8)(RSP_STATE.VR[vt][05] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x001)] = (u8)(RSP_STATE.VR[vt][06] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x002)] = (u8)(RSP_STATE.VR[vt][07] >> 8);
         break;
     case 04: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][00] >> 8);
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][01] >> 8);
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][02] >> 8);
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][03] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x004)] = (u8)(RSP_STATE.VR[vt][00] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x005)] = (u8)(RSP_STATE.VR[vt][01] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x006)] = (u8)(RSP_STATE.VR[vt][02] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x007)] = (u8)(RSP_STATE.VR[vt][03] >> 8);
         addr += 0x008;
         addr &= 0x00000FFF;
-        DMEM[addr + BES(0x000)] = (u8)(VR[vt][04] >> 8);
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][05] >> 8);
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][06] >> 8);
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][07] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x000)] = (u8)(RSP_STATE.VR[vt][04] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x001)] = (u8)(RSP_STATE.VR[vt][05] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x002)] = (u8)(RSP_STATE.VR[vt][06] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x003)] = (u8)(RSP_STATE.VR[vt][07] >> 8);
         break;
     case 05: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][00] >> 8);
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][01] >> 8);
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][02] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x005)] = (u8)(RSP_STATE.VR[vt][00] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x006)] = (u8)(RSP_STATE.VR[vt][01] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x007)] = (u8)(RSP_STATE.VR[vt][02] >> 8);
         addr += 0x008;
         addr &= 0x00000FFF;
-        DMEM[addr + BES(0x000)] = (u8)(VR[vt][03] >> 8);
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][04] >> 8);
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][05] >> 8);
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][06] >> 8);
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][07] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x000)] = (u8)(RSP_STATE.VR[vt][03] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x001)] = (u8)(RSP_STATE.VR[vt][04] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x002)] = (u8)(RSP_STATE.VR[vt][05] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x003)] = (u8)(RSP_STATE.VR[vt][06] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x004)] = (u8)(RSP_STATE.VR[vt][07] >> 8);
         break;
     case 06: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][00] >> 8);
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][01] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x006)] = (u8)(RSP_STATE.VR[vt][00] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x007)] = (u8)(RSP_STATE.VR[vt][01] >> 8);
         addr += 0x008;
         addr &= 0x00000FFF;
-        DMEM[addr + BES(0x000)] = (u8)(VR[vt][02] >> 8);
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][03] >> 8);
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][04] >> 8);
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][05] >> 8);
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][06] >> 8);
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][07] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x000)] = (u8)(RSP_STATE.VR[vt][02] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x001)] = (u8)(RSP_STATE.VR[vt][03] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x002)] = (u8)(RSP_STATE.VR[vt][04] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x003)] = (u8)(RSP_STATE.VR[vt][05] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x004)] = (u8)(RSP_STATE.VR[vt][06] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x005)] = (u8)(RSP_STATE.VR[vt][07] >> 8);
         break;
     case 07: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][00] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x007)] = (u8)(RSP_STATE.VR[vt][00] >> 8);
         addr += 0x008;
         addr &= 0x00000FFF;
-        DMEM[addr + BES(0x000)] = (u8)(VR[vt][01] >> 8);
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][02] >> 8);
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][03] >> 8);
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][04] >> 8);
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][05] >> 8);
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][06] >> 8);
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][07] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x000)] = (u8)(RSP_STATE.VR[vt][01] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x001)] = (u8)(RSP_STATE.VR[vt][02] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x002)] = (u8)(RSP_STATE.VR[vt][03] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x003)] = (u8)(RSP_STATE.VR[vt][04] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x004)] = (u8)(RSP_STATE.VR[vt][05] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x005)] = (u8)(RSP_STATE.VR[vt][06] >> 8);
+        RSP_STATE.DMEM[addr + BES(0x006)] = (u8)(RSP_STATE.VR[vt][07] >> 8);
         break;
     }
     return;
@@ -1198,31 +1265,31 @@ void SUV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("SUV\nIllegal element.");
         return;
     }
-    addr = (SR[base] + 8*offset) & 0x00000FFF;
+    addr = (RSP_STATE.SR[base] + 8*offset) & 0x00000FFF;
     b = addr & 07;
     addr &= ~07;
     switch (b) {
     case 00:
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][07] >> 7);
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][06] >> 7);
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][05] >> 7);
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][04] >> 7);
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][03] >> 7);
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][02] >> 7);
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][01] >> 7);
-        DMEM[addr + BES(0x000)] = (u8)(VR[vt][00] >> 7);
+        RSP_STATE.DMEM[addr + BES(0x007)] = (u8)(RSP_STATE.VR[vt][07] >> 7);
+        RSP_STATE.DMEM[addr + BES(0x006)] = (u8)(RSP_STATE.VR[vt][06] >> 7);
+        RSP_STATE.DMEM[addr + BES(0x005)] = (u8)(RSP_STATE.VR[vt][05] >> 7);
+        RSP_STATE.DMEM[addr + BES(0x004)] = (u8)(RSP_STATE.VR[vt][04] >> 7);
+        RSP_STATE.DMEM[addr + BES(0x003)] = (u8)(RSP_STATE.VR[vt][03] >> 7);
+        RSP_STATE.DMEM[addr + BES(0x002)] = (u8)(RSP_STATE.VR[vt][02] >> 7);
+        RSP_STATE.DMEM[addr + BES(0x001)] = (u8)(RSP_STATE.VR[vt][01] >> 7);
+        RSP_STATE.DMEM[addr + BES(0x000)] = (u8)(RSP_STATE.VR[vt][00] >> 7);
         break;
     case 04: /* "Indiana Jones and the Infernal Machine" in-game */
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][00] >> 7);
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][01] >> 7);
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][02] >> 7);
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][03] >> 7);
+        RSP_STATE.DMEM[addr + BES(0x004)] = (u8)(RSP_STATE.VR[vt][00] >> 7);
+        RSP_STATE.DMEM[addr + BES(0x005)] = (u8)(RSP_STATE.VR[vt][01] >> 7);
+        RSP_STATE.DMEM[addr + BES(0x006)] = (u8)(RSP_STATE.VR[vt][02] >> 7);
+        RSP_STATE.DMEM[addr + BES(0x007)] = (u8)(RSP_STATE.VR[vt][03] >> 7);
         addr += 0x008;
         addr &= 0x00000FFF;
-        DMEM[addr + BES(0x000)] = (u8)(VR[vt][04] >> 7);
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][05] >> 7);
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][06] >> 7);
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][07] >> 7);
+        RSP_STATE.DMEM[addr + BES(0x000)] = (u8)(RSP_STATE.VR[vt][04] >> 7);
+        RSP_STATE.DMEM[addr + BES(0x001)] = (u8)(RSP_STATE.VR[vt][05] >> 7);
+        RSP_STATE.DMEM[addr + BES(0x002)] = (u8)(RSP_STATE.VR[vt][06] >> 7);
+        RSP_STATE.DMEM[addr + BES(0x003)] = (u8)(RSP_STATE.VR[vt][07] >> 7);
         break;
     default: /* Completely legal, just never seen it be done. */
         message("SUV\nWeird addr.");
@@ -1243,20 +1310,20 @@ void LHV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("LHV\nIllegal element.");
         return;
     }
-    addr = (SR[base] + 16*offset) & 0x00000FFF;
+    addr = (RSP_STATE.SR[base] + 16*offset) & 0x00000FFF;
     if (addr & 0x0000000E) {
         message("LHV\nIllegal addr.");
         return;
     }
     addr ^= MES(00);
-    VR[vt][07] = DMEM[addr + HES(0x00E)] << 7;
-    VR[vt][06] = DMEM[addr + HES(0x00C)] << 7;
-    VR[vt][05] = DMEM[addr + HES(0x00A)] << 7;
-    VR[vt][04] = DMEM[addr + HES(0x008)] << 7;
-    VR[vt][03] = DMEM[addr + HES(0x006)] << 7;
-    VR[vt][02] = DMEM[addr + HES(0x004)] << 7;
-    VR[vt][01] = DMEM[addr + HES(0x002)] << 7;
-    VR[vt][00] = DMEM[addr + HES(0x000)] << 7;
+    RSP_STATE.VR[vt][07] = RSP_STATE.DMEM[addr + HES(0x00E)] << 7;
+    RSP_STATE.VR[vt][06] = RSP_STATE.DMEM[addr + HES(0x00C)] << 7;
+    RSP_STATE.VR[vt][05] = RSP_STATE.DMEM[addr + HES(0x00A)] << 7;
+    RSP_STATE.VR[vt][04] = RSP_STATE.DMEM[addr + HES(0x008)] << 7;
+    RSP_STATE.VR[vt][03] = RSP_STATE.DMEM[addr + HES(0x006)] << 7;
+    RSP_STATE.VR[vt][02] = RSP_STATE.DMEM[addr + HES(0x004)] << 7;
+    RSP_STATE.VR[vt][01] = RSP_STATE.DMEM[addr + HES(0x002)] << 7;
+    RSP_STATE.VR[vt][00] = RSP_STATE.DMEM[addr + HES(0x000)] << 7;
     return;
 }
 void LFV(unsigned vt, unsigned element, signed offset, unsigned base)
@@ -1273,20 +1340,20 @@ void SHV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("SHV\nIllegal element.");
         return;
     }
-    addr = (SR[base] + 16*offset) & 0x00000FFF;
+    addr = (RSP_STATE.SR[base] + 16*offset) & 0x00000FFF;
     if (addr & 0x0000000E) {
         message("SHV\nIllegal addr.");
         return;
     }
     addr ^= MES(00);
-    DMEM[addr + HES(0x00E)] = (u8)(VR[vt][07] >> 7);
-    DMEM[addr + HES(0x00C)] = (u8)(VR[vt][06] >> 7);
-    DMEM[addr + HES(0x00A)] = (u8)(VR[vt][05] >> 7);
-    DMEM[addr + HES(0x008)] = (u8)(VR[vt][04] >> 7);
-    DMEM[addr + HES(0x006)] = (u8)(VR[vt][03] >> 7);
-    DMEM[addr + HES(0x004)] = (u8)(VR[vt][02] >> 7);
-    DMEM[addr + HES(0x002)] = (u8)(VR[vt][01] >> 7);
-    DMEM[addr + HES(0x000)] = (u8)(VR[vt][00] >> 7);
+    RSP_STATE.DMEM[addr + HES(0x00E)] = (u8)(RSP_STATE.VR[vt][07] >> 7);
+    RSP_STATE.DMEM[addr + HES(0x00C)] = (u8)(RSP_STATE.VR[vt][06] >> 7);
+    RSP_STATE.DMEM[addr + HES(0x00A)] = (u8)(RSP_STATE.VR[vt][05] >> 7);
+    RSP_STATE.DMEM[addr + HES(0x008)] = (u8)(RSP_STATE.VR[vt][04] >> 7);
+    RSP_STATE.DMEM[addr + HES(0x006)] = (u8)(RSP_STATE.VR[vt][03] >> 7);
+    RSP_STATE.DMEM[addr + HES(0x004)] = (u8)(RSP_STATE.VR[vt][02] >> 7);
+    RSP_STATE.DMEM[addr + HES(0x002)] = (u8)(RSP_STATE.VR[vt][01] >> 7);
+    RSP_STATE.DMEM[addr + HES(0x000)] = (u8)(RSP_STATE.VR[vt][00] >> 7);
     return;
 }
 void SFV(unsigned vt, unsigned element, signed offset, unsigned base)
@@ -1294,21 +1361,21 @@ void SFV(unsigned vt, unsigned element, signed offset, unsigned base)
     register u32 addr;
     const unsigned int e = element;
 
-    addr = (SR[base] + 16*offset) & 0x00000FFF;
+    addr = (RSP_STATE.SR[base] + 16*offset) & 0x00000FFF;
     addr &= 0x00000FF3;
     addr ^= BES(00);
     switch (e) {
     case 0x0:
-        DMEM[addr + 0x000] = (u8)(VR[vt][00] >> 7);
-        DMEM[addr + 0x004] = (u8)(VR[vt][01] >> 7);
-        DMEM[addr + 0x008] = (u8)(VR[vt][02] >> 7);
-        DMEM[addr + 0x00C] = (u8)(VR[vt][03] >> 7);
+        RSP_STATE.DMEM[addr + 0x000] = (u8)(RSP_STATE.VR[vt][00] >> 7);
+        RSP_STATE.DMEM[addr + 0x004] = (u8)(RSP_STATE.VR[vt][01] >> 7);
+        RSP_STATE.DMEM[addr + 0x008] = (u8)(RSP_STATE.VR[vt][02] >> 7);
+        RSP_STATE.DMEM[addr + 0x00C] = (u8)(RSP_STATE.VR[vt][03] >> 7);
         break;
     case 0x8:
-        DMEM[addr + 0x000] = (u8)(VR[vt][04] >> 7);
-        DMEM[addr + 0x004] = (u8)(VR[vt][05] >> 7);
-        DMEM[addr + 0x008] = (u8)(VR[vt][06] >> 7);
-        DMEM[addr + 0x00C] = (u8)(VR[vt][07] >> 7);
+        RSP_STATE.DMEM[addr + 0x000] = (u8)(RSP_STATE.VR[vt][04] >> 7);
+        RSP_STATE.DMEM[addr + 0x004] = (u8)(RSP_STATE.VR[vt][05] >> 7);
+        RSP_STATE.DMEM[addr + 0x008] = (u8)(RSP_STATE.VR[vt][06] >> 7);
+        RSP_STATE.DMEM[addr + 0x00C] = (u8)(RSP_STATE.VR[vt][07] >> 7);
         break;
     default:
         message("SFV\nIllegal element.");
@@ -1330,7 +1397,7 @@ void LQV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("LQV\nOdd element.");
         return;
     }
-    addr = (SR[base] + 16*offset) & 0x00000FFF;
+    addr = (RSP_STATE.SR[base] + 16*offset) & 0x00000FFF;
     if (addr & 0x00000001) {
         message("LQV\nOdd addr.");
         return;
@@ -1340,56 +1407,56 @@ void LQV(unsigned vt, unsigned element, signed offset, unsigned base)
     addr &= ~0x0000000F;
     switch (b/2) { /* mistake in SGI patent regarding LQV */
     case 0x0/2:
-        VR_S(vt,e+0x0) = *(pi16)(DMEM + addr + HES(0x000));
-        VR_S(vt,e+0x2) = *(pi16)(DMEM + addr + HES(0x002));
-        VR_S(vt,e+0x4) = *(pi16)(DMEM + addr + HES(0x004));
-        VR_S(vt,e+0x6) = *(pi16)(DMEM + addr + HES(0x006));
-        VR_S(vt,e+0x8) = *(pi16)(DMEM + addr + HES(0x008));
-        VR_S(vt,e+0xA) = *(pi16)(DMEM + addr + HES(0x00A));
-        VR_S(vt,e+0xC) = *(pi16)(DMEM + addr + HES(0x00C));
-        VR_S(vt,e+0xE) = *(pi16)(DMEM + addr + HES(0x00E));
+        VR_S(vt,e+0x0) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x000));
+        VR_S(vt,e+0x2) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x002));
+        VR_S(vt,e+0x4) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x004));
+        VR_S(vt,e+0x6) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x006));
+        VR_S(vt,e+0x8) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x008));
+        VR_S(vt,e+0xA) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00A));
+        VR_S(vt,e+0xC) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00C));
+        VR_S(vt,e+0xE) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00E));
         break;
     case 0x2/2:
-        VR_S(vt,e+0x0) = *(pi16)(DMEM + addr + HES(0x002));
-        VR_S(vt,e+0x2) = *(pi16)(DMEM + addr + HES(0x004));
-        VR_S(vt,e+0x4) = *(pi16)(DMEM + addr + HES(0x006));
-        VR_S(vt,e+0x6) = *(pi16)(DMEM + addr + HES(0x008));
-        VR_S(vt,e+0x8) = *(pi16)(DMEM + addr + HES(0x00A));
-        VR_S(vt,e+0xA) = *(pi16)(DMEM + addr + HES(0x00C));
-        VR_S(vt,e+0xC) = *(pi16)(DMEM + addr + HES(0x00E));
+        VR_S(vt,e+0x0) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x002));
+        VR_S(vt,e+0x2) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x004));
+        VR_S(vt,e+0x4) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x006));
+        VR_S(vt,e+0x6) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x008));
+        VR_S(vt,e+0x8) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00A));
+        VR_S(vt,e+0xA) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00C));
+        VR_S(vt,e+0xC) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00E));
         break;
     case 0x4/2:
-        VR_S(vt,e+0x0) = *(pi16)(DMEM + addr + HES(0x004));
-        VR_S(vt,e+0x2) = *(pi16)(DMEM + addr + HES(0x006));
-        VR_S(vt,e+0x4) = *(pi16)(DMEM + addr + HES(0x008));
-        VR_S(vt,e+0x6) = *(pi16)(DMEM + addr + HES(0x00A));
-        VR_S(vt,e+0x8) = *(pi16)(DMEM + addr + HES(0x00C));
-        VR_S(vt,e+0xA) = *(pi16)(DMEM + addr + HES(0x00E));
+        VR_S(vt,e+0x0) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x004));
+        VR_S(vt,e+0x2) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x006));
+        VR_S(vt,e+0x4) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x008));
+        VR_S(vt,e+0x6) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00A));
+        VR_S(vt,e+0x8) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00C));
+        VR_S(vt,e+0xA) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00E));
         break;
     case 0x6/2:
-        VR_S(vt,e+0x0) = *(pi16)(DMEM + addr + HES(0x006));
-        VR_S(vt,e+0x2) = *(pi16)(DMEM + addr + HES(0x008));
-        VR_S(vt,e+0x4) = *(pi16)(DMEM + addr + HES(0x00A));
-        VR_S(vt,e+0x6) = *(pi16)(DMEM + addr + HES(0x00C));
-        VR_S(vt,e+0x8) = *(pi16)(DMEM + addr + HES(0x00E));
+        VR_S(vt,e+0x0) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x006));
+        VR_S(vt,e+0x2) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x008));
+        VR_S(vt,e+0x4) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00A));
+        VR_S(vt,e+0x6) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00C));
+        VR_S(vt,e+0x8) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00E));
         break;
     case 0x8/2: /* "Resident Evil 2" cinematics and Boss Game Studios */
-        VR_S(vt,e+0x0) = *(pi16)(DMEM + addr + HES(0x008));
-        VR_S(vt,e+0x2) = *(pi16)(DMEM + addr + HES(0x00A));
-        VR_S(vt,e+0x4) = *(pi16)(DMEM + addr + HES(0x00C));
-        VR_S(vt,e+0x6) = *(pi16)(DMEM + addr + HES(0x00E));
+        VR_S(vt,e+0x0) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x008));
+        VR_S(vt,e+0x2) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00A));
+        VR_S(vt,e+0x4) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00C));
+        VR_S(vt,e+0x6) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00E));
         break;
     case 0xA/2: /* "Conker's Bad Fur Day" audio microcode by Rareware */
-        VR_S(vt,e+0x0) = *(pi16)(DMEM + addr + HES(0x00A));
-        VR_S(vt,e+0x2) = *(pi16)(DMEM + addr + HES(0x00C));
-        VR_S(vt,e+0x4) = *(pi16)(DMEM + addr + HES(0x00E));
+        VR_S(vt,e+0x0) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00A));
+        VR_S(vt,e+0x2) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00C));
+        VR_S(vt,e+0x4) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00E));
         break;
     case 0xC/2: /* "Conker's Bad Fur Day" audio microcode by Rareware */
-        VR_S(vt,e+0x0) = *(pi16)(DMEM + addr + HES(0x00C));
-        VR_S(vt,e+0x2) = *(pi16)(DMEM + addr + HES(0x00E));
+        VR_S(vt,e+0x0) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00C));
+        VR_S(vt,e+0x2) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00E));
         break;
     case 0xE/2: /* "Conker's Bad Fur Day" audio microcode by Rareware */
-        VR_S(vt,e+0x0) = *(pi16)(DMEM + addr + HES(0x00E));
+        VR_S(vt,e+0x0) = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00E));
         break;
     }
     return;
@@ -1404,7 +1471,7 @@ void LRV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("LRV\nIllegal element.");
         return;
     }
-    addr = (SR[base] + 16*offset) & 0x00000FFF;
+    addr = (RSP_STATE.SR[base] + 16*offset) & 0x00000FFF;
     if (addr & 0x00000001) {
         message("LRV\nOdd addr.");
         return;
@@ -1413,46 +1480,46 @@ void LRV(unsigned vt, unsigned element, signed offset, unsigned base)
     addr &= ~0x0000000F;
     switch (b/2) {
     case 0xE/2:
-        VR[vt][01] = *(pi16)(DMEM + addr + HES(0x000));
-        VR[vt][02] = *(pi16)(DMEM + addr + HES(0x002));
-        VR[vt][03] = *(pi16)(DMEM + addr + HES(0x004));
-        VR[vt][04] = *(pi16)(DMEM + addr + HES(0x006));
-        VR[vt][05] = *(pi16)(DMEM + addr + HES(0x008));
-        VR[vt][06] = *(pi16)(DMEM + addr + HES(0x00A));
-        VR[vt][07] = *(pi16)(DMEM + addr + HES(0x00C));
+        RSP_STATE.VR[vt][01] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x000));
+        RSP_STATE.VR[vt][02] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x002));
+        RSP_STATE.VR[vt][03] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x004));
+        RSP_STATE.VR[vt][04] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x006));
+        RSP_STATE.VR[vt][05] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x008));
+        RSP_STATE.VR[vt][06] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00A));
+        RSP_STATE.VR[vt][07] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00C));
         break;
     case 0xC/2:
-        VR[vt][02] = *(pi16)(DMEM + addr + HES(0x000));
-        VR[vt][03] = *(pi16)(DMEM + addr + HES(0x002));
-        VR[vt][04] = *(pi16)(DMEM + addr + HES(0x004));
-        VR[vt][05] = *(pi16)(DMEM + addr + HES(0x006));
-        VR[vt][06] = *(pi16)(DMEM + addr + HES(0x008));
-        VR[vt][07] = *(pi16)(DMEM + addr + HES(0x00A));
+        RSP_STATE.VR[vt][02] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x000));
+        RSP_STATE.VR[vt][03] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x002));
+        RSP_STATE.VR[vt][04] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x004));
+        RSP_STATE.VR[vt][05] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x006));
+        RSP_STATE.VR[vt][06] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x008));
+        RSP_STATE.VR[vt][07] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x00A));
         break;
     case 0xA/2:
-        VR[vt][03] = *(pi16)(DMEM + addr + HES(0x000));
-        VR[vt][04] = *(pi16)(DMEM + addr + HES(0x002));
-        VR[vt][05] = *(pi16)(DMEM + addr + HES(0x004));
-        VR[vt][06] = *(pi16)(DMEM + addr + HES(0x006));
-        VR[vt][07] = *(pi16)(DMEM + addr + HES(0x008));
+        RSP_STATE.VR[vt][03] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x000));
+        RSP_STATE.VR[vt][04] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x002));
+        RSP_STATE.VR[vt][05] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x004));
+        RSP_STATE.VR[vt][06] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x006));
+        RSP_STATE.VR[vt][07] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x008));
         break;
     case 0x8/2:
-        VR[vt][04] = *(pi16)(DMEM + addr + HES(0x000));
-        VR[vt][05] = *(pi16)(DMEM + addr + HES(0x002));
-        VR[vt][06] = *(pi16)(DMEM + addr + HES(0x004));
-        VR[vt][07] = *(pi16)(DMEM + addr + HES(0x006));
+        RSP_STATE.VR[vt][04] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x000));
+        RSP_STATE.VR[vt][05] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x002));
+        RSP_STATE.VR[vt][06] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x004));
+        RSP_STATE.VR[vt][07] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x006));
         break;
     case 0x6/2:
-        VR[vt][05] = *(pi16)(DMEM + addr + HES(0x000));
-        VR[vt][06] = *(pi16)(DMEM + addr + HES(0x002));
-        VR[vt][07] = *(pi16)(DMEM + addr + HES(0x004));
+        RSP_STATE.VR[vt][05] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x000));
+        RSP_STATE.VR[vt][06] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x002));
+        RSP_STATE.VR[vt][07] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x004));
         break;
     case 0x4/2:
-        VR[vt][06] = *(pi16)(DMEM + addr + HES(0x000));
-        VR[vt][07] = *(pi16)(DMEM + addr + HES(0x002));
+        RSP_STATE.VR[vt][06] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x000));
+        RSP_STATE.VR[vt][07] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x002));
         break;
     case 0x2/2:
-        VR[vt][07] = *(pi16)(DMEM + addr + HES(0x000));
+        RSP_STATE.VR[vt][07] = *(pi16)(RSP_STATE.DMEM + addr + HES(0x000));
         break;
     case 0x0/2:
         break;
@@ -1465,17 +1532,17 @@ void SQV(unsigned vt, unsigned element, signed offset, unsigned base)
     register unsigned int b;
     const unsigned int e = element;
 
-    addr = (SR[base] + 16*offset) & 0x00000FFF;
+    addr = (RSP_STATE.SR[base] + 16*offset) & 0x00000FFF;
     if (e != 0x0) {
         register unsigned int i;
 
 #if (VR_STATIC_WRAPAROUND == 1)
-        vector_copy(VR[vt] + N, VR[vt]);
+        vector_copy(RSP_STATE.VR[vt] + N, RSP_STATE.VR[vt]);
         for (i = 0; i < 16 - addr%16; i++)
-            DMEM[BES((addr + i) & 0xFFF)] = VR_B(vt, e + i);
+            RSP_STATE.DMEM[BES((addr + i) & 0xFFF)] = VR_B(vt, e + i);
 #else
         for (i = 0; i < 16 - addr%16; i++)
-            DMEM[BES((addr + i) & 0xFFF)] = VR_B(vt, (e + i) & 0xF);
+            RSP_STATE.DMEM[BES((addr + i) & 0xFFF)] = VR_B(vt, (e + i) & 0xF);
 #endif
         return;
     } /* illegal SQV, happens with "Mia Hamm Soccer 64" */
@@ -1483,38 +1550,38 @@ void SQV(unsigned vt, unsigned element, signed offset, unsigned base)
     addr &= ~0x0000000F;
     switch (b) {
     case 00:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR[vt][00];
-        *(pi16)(DMEM + addr + HES(0x002)) = VR[vt][01];
-        *(pi16)(DMEM + addr + HES(0x004)) = VR[vt][02];
-        *(pi16)(DMEM + addr + HES(0x006)) = VR[vt][03];
-        *(pi16)(DMEM + addr + HES(0x008)) = VR[vt][04];
-        *(pi16)(DMEM + addr + HES(0x00A)) = VR[vt][05];
-        *(pi16)(DMEM + addr + HES(0x00C)) = VR[vt][06];
-        *(pi16)(DMEM + addr + HES(0x00E)) = VR[vt][07];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x000)) = RSP_STATE.VR[vt][00];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x002)) = RSP_STATE.VR[vt][01];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x004)) = RSP_STATE.VR[vt][02];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x006)) = RSP_STATE.VR[vt][03];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x008)) = RSP_STATE.VR[vt][04];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x00A)) = RSP_STATE.VR[vt][05];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x00C)) = RSP_STATE.VR[vt][06];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x00E)) = RSP_STATE.VR[vt][07];
         break;
     case 02:
-        *(pi16)(DMEM + addr + HES(0x002)) = VR[vt][00];
-        *(pi16)(DMEM + addr + HES(0x004)) = VR[vt][01];
-        *(pi16)(DMEM + addr + HES(0x006)) = VR[vt][02];
-        *(pi16)(DMEM + addr + HES(0x008)) = VR[vt][03];
-        *(pi16)(DMEM + addr + HES(0x00A)) = VR[vt][04];
-        *(pi16)(DMEM + addr + HES(0x00C)) = VR[vt][05];
-        *(pi16)(DMEM + addr + HES(0x00E)) = VR[vt][06];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x002)) = RSP_STATE.VR[vt][00];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x004)) = RSP_STATE.VR[vt][01];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x006)) = RSP_STATE.VR[vt][02];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x008)) = RSP_STATE.VR[vt][03];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x00A)) = RSP_STATE.VR[vt][04];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x00C)) = RSP_STATE.VR[vt][05];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x00E)) = RSP_STATE.VR[vt][06];
         break;
     case 04:
-        *(pi16)(DMEM + addr + HES(0x004)) = VR[vt][00];
-        *(pi16)(DMEM + addr + HES(0x006)) = VR[vt][01];
-        *(pi16)(DMEM + addr + HES(0x008)) = VR[vt][02];
-        *(pi16)(DMEM + addr + HES(0x00A)) = VR[vt][03];
-        *(pi16)(DMEM + addr + HES(0x00C)) = VR[vt][04];
-        *(pi16)(DMEM + addr + HES(0x00E)) = VR[vt][05];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x004)) = RSP_STATE.VR[vt][00];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x006)) = RSP_STATE.VR[vt][01];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x008)) = RSP_STATE.VR[vt][02];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x00A)) = RSP_STATE.VR[vt][03];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x00C)) = RSP_STATE.VR[vt][04];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x00E)) = RSP_STATE.VR[vt][05];
         break;
     case 06:
-        *(pi16)(DMEM + addr + HES(0x006)) = VR[vt][00];
-        *(pi16)(DMEM + addr + HES(0x008)) = VR[vt][01];
-        *(pi16)(DMEM + addr + HES(0x00A)) = VR[vt][02];
-        *(pi16)(DMEM + addr + HES(0x00C)) = VR[vt][03];
-        *(pi16)(DMEM + addr + HES(0x00E)) = VR[vt][04];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x006)) = RSP_STATE.VR[vt][00];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x008)) = RSP_STATE.VR[vt][01];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x00A)) = RSP_STATE.VR[vt][02];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x00C)) = RSP_STATE.VR[vt][03];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x00E)) = RSP_STATE.VR[vt][04];
         break;
     default:
         message("SQV\nWeird addr.");
@@ -1531,7 +1598,7 @@ void SRV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("SRV\nIllegal element.");
         return;
     }
-    addr = (SR[base] + 16*offset) & 0x00000FFF;
+    addr = (RSP_STATE.SR[base] + 16*offset) & 0x00000FFF;
     if (addr & 0x00000001) {
         message("SRV\nOdd addr.");
         return;
@@ -1541,46 +1608,46 @@ void SRV(unsigned vt, unsigned element, signed offset, unsigned base)
     addr &= ~0x0000000F;
     switch (b/2) {
     case 0xE/2:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR[vt][01];
-        *(pi16)(DMEM + addr + HES(0x002)) = VR[vt][02];
-        *(pi16)(DMEM + addr + HES(0x004)) = VR[vt][03];
-        *(pi16)(DMEM + addr + HES(0x006)) = VR[vt][04];
-        *(pi16)(DMEM + addr + HES(0x008)) = VR[vt][05];
-        *(pi16)(DMEM + addr + HES(0x00A)) = VR[vt][06];
-        *(pi16)(DMEM + addr + HES(0x00C)) = VR[vt][07];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x000)) = RSP_STATE.VR[vt][01];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x002)) = RSP_STATE.VR[vt][02];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x004)) = RSP_STATE.VR[vt][03];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x006)) = RSP_STATE.VR[vt][04];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x008)) = RSP_STATE.VR[vt][05];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x00A)) = RSP_STATE.VR[vt][06];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x00C)) = RSP_STATE.VR[vt][07];
         break;
     case 0xC/2:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR[vt][02];
-        *(pi16)(DMEM + addr + HES(0x002)) = VR[vt][03];
-        *(pi16)(DMEM + addr + HES(0x004)) = VR[vt][04];
-        *(pi16)(DMEM + addr + HES(0x006)) = VR[vt][05];
-        *(pi16)(DMEM + addr + HES(0x008)) = VR[vt][06];
-        *(pi16)(DMEM + addr + HES(0x00A)) = VR[vt][07];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x000)) = RSP_STATE.VR[vt][02];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x002)) = RSP_STATE.VR[vt][03];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x004)) = RSP_STATE.VR[vt][04];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x006)) = RSP_STATE.VR[vt][05];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x008)) = RSP_STATE.VR[vt][06];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x00A)) = RSP_STATE.VR[vt][07];
         break;
     case 0xA/2:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR[vt][03];
-        *(pi16)(DMEM + addr + HES(0x002)) = VR[vt][04];
-        *(pi16)(DMEM + addr + HES(0x004)) = VR[vt][05];
-        *(pi16)(DMEM + addr + HES(0x006)) = VR[vt][06];
-        *(pi16)(DMEM + addr + HES(0x008)) = VR[vt][07];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x000)) = RSP_STATE.VR[vt][03];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x002)) = RSP_STATE.VR[vt][04];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x004)) = RSP_STATE.VR[vt][05];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x006)) = RSP_STATE.VR[vt][06];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x008)) = RSP_STATE.VR[vt][07];
         break;
     case 0x8/2:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR[vt][04];
-        *(pi16)(DMEM + addr + HES(0x002)) = VR[vt][05];
-        *(pi16)(DMEM + addr + HES(0x004)) = VR[vt][06];
-        *(pi16)(DMEM + addr + HES(0x006)) = VR[vt][07];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x000)) = RSP_STATE.VR[vt][04];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x002)) = RSP_STATE.VR[vt][05];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x004)) = RSP_STATE.VR[vt][06];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x006)) = RSP_STATE.VR[vt][07];
         break;
     case 0x6/2:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR[vt][05];
-        *(pi16)(DMEM + addr + HES(0x002)) = VR[vt][06];
-        *(pi16)(DMEM + addr + HES(0x004)) = VR[vt][07];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x000)) = RSP_STATE.VR[vt][05];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x002)) = RSP_STATE.VR[vt][06];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x004)) = RSP_STATE.VR[vt][07];
         break;
     case 0x4/2:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR[vt][06];
-        *(pi16)(DMEM + addr + HES(0x002)) = VR[vt][07];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x000)) = RSP_STATE.VR[vt][06];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x002)) = RSP_STATE.VR[vt][07];
         break;
     case 0x2/2:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR[vt][07];
+        *(pi16)(RSP_STATE.DMEM + addr + HES(0x000)) = RSP_STATE.VR[vt][07];
         break;
     case 0x0/2:
         break;
@@ -1588,6 +1655,439 @@ void SRV(unsigned vt, unsigned element, signed offset, unsigned base)
     return;
 }
 
+#ifdef HAVE_SIMD_DISPATCH
+/*
+ * SSSE3 versions of the loads and stores which move up to a whole quadword
+ * at once:  one 16-byte load, one PSHUFB which byte-swaps DMEM's words to
+ * vector order and shifts the bytes into place, and a blend to leave alone
+ * whichever bytes the RSP would not have touched.
+ *
+ * The PSHUFB controls are chosen by the address mod 16 (mod 8 for LDV and
+ * SDV, which use the two doublewords around the address) and the element.
+ * A control byte with the sign bit set (0x80) selects a zero for PSHUFB, and
+ * it also marks the bytes of the destination to keep.  Illegal elements and
+ * addresses are refused the same way as by the C versions above.
+ */
+#define SHUFFLE_ROW(F, b, e) { \
+    F(b, e, 0x0), F(b, e, 0x1), F(b, e, 0x2), F(b, e, 0x3), \
+    F(b, e, 0x4), F(b, e, 0x5), F(b, e, 0x6), F(b, e, 0x7), \
+    F(b, e, 0x8), F(b, e, 0x9), F(b, e, 0xA), F(b, e, 0xB), \
+    F(b, e, 0xC), F(b, e, 0xD), F(b, e, 0xE), F(b, e, 0xF), }
+#define SHUFFLE_ROWS_EVEN(F, b) { \
+    SHUFFLE_ROW(F, b, 0x0), SHUFFLE_ROW(F, b, 0x2), \
+    SHUFFLE_ROW(F, b, 0x4), SHUFFLE_ROW(F, b, 0x6), \
+    SHUFFLE_ROW(F, b, 0x8), SHUFFLE_ROW(F, b, 0xA), \
+    SHUFFLE_ROW(F, b, 0xC), SHUFFLE_ROW(F, b, 0xE), }
+#define SHUFFLE_ROWS(F, b) { \
+    SHUFFLE_ROW(F, b, 0x0), SHUFFLE_ROW(F, b, 0x1), \
+    SHUFFLE_ROW(F, b, 0x2), SHUFFLE_ROW(F, b, 0x3), \
+    SHUFFLE_ROW(F, b, 0x4), SHUFFLE_ROW(F, b, 0x5), \
+    SHUFFLE_ROW(F, b, 0x6), SHUFFLE_ROW(F, b, 0x7), \
+    SHUFFLE_ROW(F, b, 0x8), SHUFFLE_ROW(F, b, 0x9), \
+    SHUFFLE_ROW(F, b, 0xA), SHUFFLE_ROW(F, b, 0xB), \
+    SHUFFLE_ROW(F, b, 0xC), SHUFFLE_ROW(F, b, 0xD), \
+    SHUFFLE_ROW(F, b, 0xE), SHUFFLE_ROW(F, b, 0xF), }
+
+/*
+ * loads:  which DMEM byte goes to host byte `h' of the vector register
+ */
+#define LQV_BYTE(b, e, h) (u8)( \
+    MES(h) >= (e) && MES(h) - (e) + (b) < 16 ? BES((b) + MES(h) - (e)) : 0x80)
+#define LRV_BYTE(b, e, h) (u8)( \
+    MES(h) >= 16 - (b) ? BES(MES(h) + (b) - 16) : 0x80)
+#define LDV_BYTE(b, e, h) (u8)( \
+    MES(h) >= (e) && MES(h) - (e) < 8 ? BES((b) + MES(h) - (e)) : 0x80)
+
+/*
+ * stores:  which vector register byte goes to host byte `h' of DMEM
+ */
+#define SQV_BYTE(b, e, h) (u8)( \
+    BES(h) >= (b) ? MES(((e) + BES(h) - (b)) & 0xF) : 0x80)
+#define SRV_BYTE(b, e, h) (u8)( \
+    BES(h) < (b) ? MES(16 - (b) + BES(h)) : 0x80)
+#define SDV_BYTE(b, e, h) (u8)( \
+    BES(h) >= (b) && BES(h) - (b) < 8 ? MES(((e) + BES(h) - (b)) & 0xF) : 0x80)
+
+static ALIGNED const u8 LQV_shuffles[16 / 2][16 / 2][16] = {
+    SHUFFLE_ROWS_EVEN(LQV_BYTE, 0x0), SHUFFLE_ROWS_EVEN(LQV_BYTE, 0x2),
+    SHUFFLE_ROWS_EVEN(LQV_BYTE, 0x4), SHUFFLE_ROWS_EVEN(LQV_BYTE, 0x6),
+    SHUFFLE_ROWS_EVEN(LQV_BYTE, 0x8), SHUFFLE_ROWS_EVEN(LQV_BYTE, 0xA),
+    SHUFFLE_ROWS_EVEN(LQV_BYTE, 0xC), SHUFFLE_ROWS_EVEN(LQV_BYTE, 0xE),
+};
+static ALIGNED const u8 LRV_shuffles[16 / 2][16] = {
+    SHUFFLE_ROW(LRV_BYTE, 0x0, 0), SHUFFLE_ROW(LRV_BYTE, 0x2, 0),
+    SHUFFLE_ROW(LRV_BYTE, 0x4, 0), SHUFFLE_ROW(LRV_BYTE, 0x6, 0),
+    SHUFFLE_ROW(LRV_BYTE, 0x8, 0), SHUFFLE_ROW(LRV_BYTE, 0xA, 0),
+    SHUFFLE_ROW(LRV_BYTE, 0xC, 0), SHUFFLE_ROW(LRV_BYTE, 0xE, 0),
+};
+static ALIGNED const u8 LDV_shuffles[8][16 / 2][16] = {
+    SHUFFLE_ROWS_EVEN(LDV_BYTE, 0), SHUFFLE_ROWS_EVEN(LDV_BYTE, 1),
+    SHUFFLE_ROWS_EVEN(LDV_BYTE, 2), SHUFFLE_ROWS_EVEN(LDV_BYTE, 3),
+    SHUFFLE_ROWS_EVEN(LDV_BYTE, 4), SHUFFLE_ROWS_EVEN(LDV_BYTE, 5),
+    SHUFFLE_ROWS_EVEN(LDV_BYTE, 6), SHUFFLE_ROWS_EVEN(LDV_BYTE, 7),
+};
+static ALIGNED const u8 SQV_shuffles[16][16][16] = {
+    SHUFFLE_ROWS(SQV_BYTE, 0x0), SHUFFLE_ROWS(SQV_BYTE, 0x1),
+    SHUFFLE_ROWS(SQV_BYTE, 0x2), SHUFFLE_ROWS(SQV_BYTE, 0x3),
+    SHUFFLE_ROWS(SQV_BYTE, 0x4), SHUFFLE_ROWS(SQV_BYTE, 0x5),
+    SHUFFLE_ROWS(SQV_BYTE, 0x6), SHUFFLE_ROWS(SQV_BYTE, 0x7),
+    SHUFFLE_ROWS(SQV_BYTE, 0x8), SHUFFLE_ROWS(SQV_BYTE, 0x9),
+    SHUFFLE_ROWS(SQV_BYTE, 0xA), SHUFFLE_ROWS(SQV_BYTE, 0xB),
+    SHUFFLE_ROWS(SQV_BYTE, 0xC), SHUFFLE_ROWS(SQV_BYTE, 0xD),
+    SHUFFLE_ROWS(SQV_BYTE, 0xE), SHUFFLE_ROWS(SQV_BYTE, 0xF),
+};
+static ALIGNED const u8 SRV_shuffles[16 / 2][16] = {
+    SHUFFLE_ROW(SRV_BYTE, 0x0, 0), SHUFFLE_ROW(SRV_BYTE, 0x2, 0),
+    SHUFFLE_ROW(SRV_BYTE, 0x4, 0), SHUFFLE_ROW(SRV_BYTE, 0x6, 0),
+    SHUFFLE_ROW(SRV_BYTE, 0x8, 0), SHUFFLE_ROW(SRV_BYTE, 0xA, 0),
+    SHUFFLE_ROW(SRV_BYTE, 0xC, 0), SHUFFLE_ROW(SRV_BYTE, 0xE, 0),
+};
+static ALIGNED const u8 SDV_shuffles[8][16][16] = {
+    SHUFFLE_ROWS(SDV_BYTE, 0), SHUFFLE_ROWS(SDV_BYTE, 1),
+    SHUFFLE_ROWS(SDV_BYTE, 2), SHUFFLE_ROWS(SDV_BYTE, 3),
+    SHUFFLE_ROWS(SDV_BYTE, 4), SHUFFLE_ROWS(SDV_BYTE, 5),
+    SHUFFLE_ROWS(SDV_BYTE, 6), SHUFFLE_ROWS(SDV_BYTE, 7),
+};
+
+/*
+ * the bytes of `data' picked by `select', over the bytes of `old' it skips
+ */
+static INLINE TARGET_SSSE3 v16 shuffle_into(v16 old, v16 data, v16 select)
+{
+    data = _mm_shuffle_epi8(data, select);
+    old = _mm_and_si128(old, _mm_cmplt_epi8(select, _mm_setzero_si128()));
+    return _mm_or_si128(old, data);
+}
+
+/*
+ * the two doublewords of DMEM around `addr', wrapping around at 4 KiB
+ */
+static INLINE v16 load_doublewords(u32 addr)
+{
+    v16 lo, hi;
+
+    lo = _mm_loadl_epi64((v16 *)(RSP_STATE.DMEM + (addr & 0x00000FF8)));
+    hi = _mm_loadl_epi64((v16 *)(RSP_STATE.DMEM + ((addr + 8) & 0x00000FF8)));
+    return _mm_unpacklo_epi64(lo, hi);
+}
+static INLINE void store_doublewords(u32 addr, v16 data)
+{
+    _mm_storel_epi64((v16 *)(RSP_STATE.DMEM + (addr & 0x00000FF8)), data);
+    data = _mm_unpackhi_epi64(data, data);
+    _mm_storel_epi64((v16 *)(RSP_STATE.DMEM + ((addr + 8) & 0x00000FF8)), data);
+    return;
+}
+
+TARGET_SSSE3 void
+LDV_SSSE3(unsigned vt, unsigned element, signed offset, unsigned base)
+{
+    register u32 addr;
+    const unsigned int e = element;
+    v16 select;
+
+    if (e & 0x1) {
+        message("LDV\nOdd element.");
+        return;
+    }
+    addr = (RSP_STATE.SR[base] + 8*offset) & 0x00000FFF;
+    select = *(const v16 *)LDV_shuffles[addr % 8][e / 2];
+    *(v16 *)RSP_STATE.VR[vt] = shuffle_into(
+        *(v16 *)RSP_STATE.VR[vt], load_doublewords(addr), select
+    );
+    return;
+}
+TARGET_SSSE3 void
+SDV_SSSE3(unsigned vt, unsigned element, signed offset, unsigned base)
+{
+    register u32 addr;
+    const unsigned int e = element;
+    v16 select;
+
+    addr = (RSP_STATE.SR[base] + 8*offset) & 0x00000FFF;
+    select = *(const v16 *)SDV_shuffles[addr % 8][e];
+    store_doublewords(addr, shuffle_into(
+        load_doublewords(addr), *(v16 *)RSP_STATE.VR[vt], select
+    ));
+    return;
+}
+TARGET_SSSE3 void
+LQV_SSSE3(unsigned vt, unsigned element, signed offset, unsigned base)
+{
+    register u32 addr;
+    const unsigned int e = element;
+    v16 select, quad;
+
+    if (e & 0x1) {
+        message("LQV\nOdd element.");
+        return;
+    }
+    addr = (RSP_STATE.SR[base] + 16*offset) & 0x00000FFF;
+    if (addr & 0x00000001) {
+        message("LQV\nOdd addr.");
+        return;
+    }
+    select = *(const v16 *)LQV_shuffles[addr % 16 / 2][e / 2];
+    quad = _mm_loadu_si128((v16 *)(RSP_STATE.DMEM + addr - addr%16));
+    *(v16 *)RSP_STATE.VR[vt] =
+        shuffle_into(*(v16 *)RSP_STATE.VR[vt], quad, select);
+    return;
+}
+TARGET_SSSE3 void
+LRV_SSSE3(unsigned vt, unsigned element, signed offset, unsigned base)
+{
+    register u32 addr;
+    const unsigned int e = element;
+    v16 select, quad;
+
+    if (e != 0x0) {
+        message("LRV\nIllegal element.");
+        return;
+    }
+    addr = (RSP_STATE.SR[base] + 16*offset) & 0x00000FFF;
+    if (addr & 0x00000001) {
+        message("LRV\nOdd addr.");
+        return;
+    }
+    select = *(const v16 *)LRV_shuffles[addr % 16 / 2];
+    quad = _mm_loadu_si128((v16 *)(RSP_STATE.DMEM + addr - addr%16));
+    *(v16 *)RSP_STATE.VR[vt] =
+        shuffle_into(*(v16 *)RSP_STATE.VR[vt], quad, select);
+    return;
+}
+TARGET_SSSE3 void
+SQV_SSSE3(unsigned vt, unsigned element, signed offset, unsigned base)
+{
+    register u32 addr;
+    const unsigned int e = element;
+    v16 select;
+    pu8 quad;
+
+    addr = (RSP_STATE.SR[base] + 16*offset) & 0x00000FFF;
+    if (e == 0x0 && (addr & 0x00000009)) {
+        message("SQV\nWeird addr.");
+        return;
+    } /* but all addresses go with illegal elements ("Mia Hamm Soccer 64") */
+    select = *(const v16 *)SQV_shuffles[addr % 16][e];
+    quad = RSP_STATE.DMEM + addr - addr%16;
+    _mm_storeu_si128((v16 *)quad, shuffle_into(
+        _mm_loadu_si128((v16 *)quad), *(v16 *)RSP_STATE.VR[vt], select
+    ));
+    return;
+}
+TARGET_SSSE3 void
+SRV_SSSE3(unsigned vt, unsigned element, signed offset, unsigned base)
+{
+    register u32 addr;
+    const unsigned int e = element;
+    v16 select;
+    pu8 quad;
+
+    if (e != 0x0) {
+        message("SRV\nIllegal element.");
+        return;
+    }
+    addr = (RSP_STATE.SR[base] + 16*offset) & 0x00000FFF;
+    if (addr & 0x00000001) {
+        message("SRV\nOdd addr.");
+        return;
+    }
+    select = *(const v16 *)SRV_shuffles[addr % 16 / 2];
+    quad = RSP_STATE.DMEM + addr - addr%16;
+    _mm_storeu_si128((v16 *)quad, shuffle_into(
+        _mm_loadu_si128((v16 *)quad), *(v16 *)RSP_STATE.VR[vt], select
+    ));
+    return;
+}
+
+/*
+ * The packed (PV, UV) and half or fourth (HV, FV) transfers move one byte
+ * per element, to or from the upper byte (PV) or bits 14..7 (UV, HV, FV) of
+ * it, so their shuffles zero or skip the other byte, and the U, H and F ones
+ * shift each element by one bit before storing or after loading.
+ */
+#define LPV_BYTE(b, e, h) (u8)( \
+    MES(h) % 2 == 0 ? BES((b) + MES(h) / 2) : 0x80)
+#define LHV_BYTE(b, e, h) (u8)( \
+    MES(h) % 2 == 0 ? BES((b) + MES(h)) : 0x80)
+#define SPV_BYTE(b, e, h) (u8)( \
+    BES(h) >= (b) && BES(h) - (b) < 8 ? MES(2*(BES(h) - (b))) : 0x80)
+#define SHV_BYTE(b, e, h) (u8)( \
+    BES(h) >= (b) && (BES(h) - (b)) % 2 == 0 ? MES(BES(h) - (b)) : 0x80)
+#define SFV_BYTE(b, e, h) (u8)( \
+    BES(h) >= (b) && (BES(h) - (b)) % 4 == 0 \
+  ? MES(2*(e) + (BES(h) - (b))/2) : 0x80)
+
+static ALIGNED const u8 LPV_shuffles[8][16] = {
+    SHUFFLE_ROW(LPV_BYTE, 0, 0), SHUFFLE_ROW(LPV_BYTE, 1, 0),
+    SHUFFLE_ROW(LPV_BYTE, 2, 0), SHUFFLE_ROW(LPV_BYTE, 3, 0),
+    SHUFFLE_ROW(LPV_BYTE, 4, 0), SHUFFLE_ROW(LPV_BYTE, 5, 0),
+    SHUFFLE_ROW(LPV_BYTE, 6, 0), SHUFFLE_ROW(LPV_BYTE, 7, 0),
+};
+static ALIGNED const u8 SPV_shuffles[8][16] = {
+    SHUFFLE_ROW(SPV_BYTE, 0, 0), SHUFFLE_ROW(SPV_BYTE, 1, 0),
+    SHUFFLE_ROW(SPV_BYTE, 2, 0), SHUFFLE_ROW(SPV_BYTE, 3, 0),
+    SHUFFLE_ROW(SPV_BYTE, 4, 0), SHUFFLE_ROW(SPV_BYTE, 5, 0),
+    SHUFFLE_ROW(SPV_BYTE, 6, 0), SHUFFLE_ROW(SPV_BYTE, 7, 0),
+};
+static ALIGNED const u8 LHV_shuffles[2][16] = {
+    SHUFFLE_ROW(LHV_BYTE, 0, 0), SHUFFLE_ROW(LHV_BYTE, 1, 0),
+};
+static ALIGNED const u8 SHV_shuffles[2][16] = {
+    SHUFFLE_ROW(SHV_BYTE, 0, 0), SHUFFLE_ROW(SHV_BYTE, 1, 0),
+};
+static ALIGNED const u8 SFV_shuffles[4][2][16] = { /* by addr % 4, e / 8 */
+    { SHUFFLE_ROW(SFV_BYTE, 0, 0), SHUFFLE_ROW(SFV_BYTE, 0, 4), },
+    { SHUFFLE_ROW(SFV_BYTE, 1, 0), SHUFFLE_ROW(SFV_BYTE, 1, 4), },
+    { SHUFFLE_ROW(SFV_BYTE, 2, 0), SHUFFLE_ROW(SFV_BYTE, 2, 4), },
+    { SHUFFLE_ROW(SFV_BYTE, 3, 0), SHUFFLE_ROW(SFV_BYTE, 3, 4), },
+};
+
+TARGET_SSSE3 void
+LPV_SSSE3(unsigned vt, unsigned element, signed offset, unsigned base)
+{
+    register u32 addr;
+    const unsigned int e = element;
+    v16 select;
+
+    if (e != 0x0) {
+        message("LPV\nIllegal element.");
+        return;
+    }
+    addr = (RSP_STATE.SR[base] + 8*offset) & 0x00000FFF;
+    select = *(const v16 *)LPV_shuffles[addr % 8];
+    *(v16 *)RSP_STATE.VR[vt] = _mm_shuffle_epi8(load_doublewords(addr), select);
+    return;
+}
+TARGET_SSSE3 void
+LUV_SSSE3(unsigned vt, unsigned element, signed offset, unsigned base)
+{
+    register u32 addr;
+    const unsigned int e = element;
+    v16 select;
+
+    if (e != 0x0) {
+        LUV(vt, element, offset, base);
+        return;
+    } /* "Mia Hamm Soccer 64" wraps around a quadword the C way. */
+    addr = (RSP_STATE.SR[base] + 8*offset) & 0x00000FFF;
+    select = *(const v16 *)LPV_shuffles[addr % 8];
+    *(v16 *)RSP_STATE.VR[vt] = _mm_srli_epi16(
+        _mm_shuffle_epi8(load_doublewords(addr), select), 1
+    );
+    return;
+}
+TARGET_SSSE3 void
+SPV_SSSE3(unsigned vt, unsigned element, signed offset, unsigned base)
+{
+    register u32 addr;
+    const unsigned int e = element;
+    v16 select;
+
+    if (e != 0x0) {
+        message("SPV\nIllegal element.");
+        return;
+    }
+    addr = (RSP_STATE.SR[base] + 8*offset) & 0x00000FFF;
+    select = *(const v16 *)SPV_shuffles[addr % 8];
+    store_doublewords(addr, shuffle_into(
+        load_doublewords(addr), *(v16 *)RSP_STATE.VR[vt], select
+    ));
+    return;
+}
+TARGET_SSSE3 void
+SUV_SSSE3(unsigned vt, unsigned element, signed offset, unsigned base)
+{
+    register u32 addr;
+    const unsigned int e = element;
+    v16 select;
+
+    if (e != 0x0) {
+        message("SUV\nIllegal element.");
+        return;
+    }
+    addr = (RSP_STATE.SR[base] + 8*offset) & 0x00000FFF;
+    if (addr & 03) {
+        message("SUV\nWeird addr.");
+        return;
+    }
+    select = *(const v16 *)SPV_shuffles[addr % 8];
+    store_doublewords(addr, shuffle_into(
+        load_doublewords(addr),
+        _mm_slli_epi16(*(v16 *)RSP_STATE.VR[vt], 1), select
+    ));
+    return;
+}
+TARGET_SSSE3 void
+LHV_SSSE3(unsigned vt, unsigned element, signed offset, unsigned base)
+{
+    register u32 addr;
+    const unsigned int e = element;
+    v16 select, quad;
+
+    if (e != 0x0) {
+        message("LHV\nIllegal element.");
+        return;
+    }
+    addr = (RSP_STATE.SR[base] + 16*offset) & 0x00000FFF;
+    if (addr & 0x0000000E) {
+        message("LHV\nIllegal addr.");
+        return;
+    }
+    select = *(const v16 *)LHV_shuffles[addr % 2];
+    quad = _mm_loadu_si128((v16 *)(RSP_STATE.DMEM + addr - addr%16));
+    *(v16 *)RSP_STATE.VR[vt] =
+        _mm_srli_epi16(_mm_shuffle_epi8(quad, select), 1);
+    return;
+}
+TARGET_SSSE3 void
+SHV_SSSE3(unsigned vt, unsigned element, signed offset, unsigned base)
+{
+    register u32 addr;
+    const unsigned int e = element;
+    v16 select;
+    pu8 quad;
+
+    if (e != 0x0) {
+        message("SHV\nIllegal element.");
+        return;
+    }
+    addr = (RSP_STATE.SR[base] + 16*offset) & 0x00000FFF;
+    if (addr & 0x0000000E) {
+        message("SHV\nIllegal addr.");
+        return;
+    }
+    select = *(const v16 *)SHV_shuffles[addr % 2];
+    quad = RSP_STATE.DMEM + addr - addr%16;
+    _mm_storeu_si128((v16 *)quad, shuffle_into(
+        _mm_loadu_si128((v16 *)quad),
+        _mm_slli_epi16(*(v16 *)RSP_STATE.VR[vt], 1), select
+    ));
+    return;
+}
+TARGET_SSSE3 void
+SFV_SSSE3(unsigned vt, unsigned element, signed offset, unsigned base)
+{
+    register u32 addr;
+    const unsigned int e = element;
+    v16 select;
+    pu8 quad;
+
+    addr = (RSP_STATE.SR[base] + 16*offset) & 0x00000FFF;
+    addr &= 0x00000FF3;
+    if (e != 0x0 && e != 0x8) {
+        message("SFV\nIllegal element.");
+        return;
+    }
+    select = *(const v16 *)SFV_shuffles[addr % 4][e / 8];
+    quad = RSP_STATE.DMEM + addr - addr%16;
+    _mm_storeu_si128((v16 *)quad, shuffle_into(
+        _mm_loadu_si128((v16 *)quad),
+        _mm_slli_epi16(*(v16 *)RSP_STATE.VR[vt], 1), select
+    ));
+    return;
+}
+#endif
+
 /*
  * Group V vector loads and stores
  * TV and SWV (As of RCP implementation, LTWV opcode was undesired.)
@@ -1606,13 +2106,14 @@ void LTV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("LTV\nUncertain case!");
         return; /* For LTV I am not sure; for STV I have an idea. */
     }
-    addr = (SR[base] + 16*offset) & 0x00000FFF;
+    addr = (RSP_STATE.SR[base] + 16*offset) & 0x00000FFF;
     if (addr & 0x0000000F) {
         message("LTV\nIllegal addr.");
         return;
     }
     for (i = 0; i < 8; i++) /* SGI screwed LTV up on N64.  See STV instead. */
-        VR[vt + i][(i - e/2) & 07] = *(pi16)(DMEM + addr + HES(2*i));
+        RSP_STATE.VR[vt + i][(i - e/2) & 07] =
+            *(pi16)(RSP_STATE.DMEM + addr + HES(2*i));
     return;
 }
 void SWV(unsigned vt, unsigned element, signed offset, unsigned base)
@@ -1623,7 +2124,6 @@ void SWV(unsigned vt, unsigned element, signed offset, unsigned base)
 void STV(unsigned vt, unsigned element, signed offset, unsigned base)
 {
     register u32 addr;
-    register unsigned int i;
     const unsigned int e = element;
 
     if (e & 1) {
@@ -1634,20 +2134,33 @@ void STV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("STV\nUncertain case!");
         return; /* vt &= 030; */
     }
-    addr = (SR[base] + 16*offset) & 0x00000FFF;
+    addr = (RSP_STATE.SR[base] + 16*offset) & 0x00000FFF;
     if (addr & 0x0000000F) {
         message("STV\nIllegal addr.");
         return;
     }
-    for (i = 0; i < 8; i++)
-        *(pi16)(DMEM + addr + HES(2*i)) = VR[vt + (e/2 + i)%8][i];
-    return;
-}
+#ifdef ARCH_MIN_SSE2
+    {
+        v16 lanes = _mm_setzero_si128();
+
+#define STV_LANE(i) lanes = _mm_insert_epi16( \
+    lanes, RSP_STATE.VR[vt + (e/2 + i)%8][i], HES(2*i) / 2)
+        STV_LANE(0); STV_LANE(1); STV_LANE(2); STV_LANE(3);
+        STV_LANE(4); STV_LANE(5); STV_LANE(6); STV_LANE(7);
+#undef STV_LANE
+        _mm_storeu_si128((v16 *)(RSP_STATE.DMEM + addr), lanes);
+    } /* one store, so a later LQV of it is forwarded the whole quadword */
+#else
+    {
+        register unsigned int i;
 
-int temp_PC;
-#ifdef WAIT_FOR_CPU_HOST
-short MFC0_count[NUMBER_OF_SCALAR_REGISTERS];
+        for (i = 0; i < 8; i++)
+            *(pi16)(RSP_STATE.DMEM + addr + HES(2*i)) =
+                RSP_STATE.VR[vt + (e/2 + i)%8][i];
+    }
 #endif
+    return;
+}
 
 mwc2_func LWC2[2 * 8*2] = {
     LBV    ,LSV    ,LLV    ,LDV    ,LQV    ,LRV    ,LPV    ,LUV    ,
@@ -1662,7 +2175,6 @@ mwc2_func SWC2[2 * 8*2] = {
     res_lsw,res_lsw,res_lsw,res_lsw,res_lsw,res_lsw,res_lsw,res_lsw,
 };
 
-static ALIGNED i16 shuffle_temporary[N];
 #ifndef ARCH_MIN_SSE2
 static const unsigned char ei[1 << 4][N] = {
     { 00, 01, 02, 03, 04, 05, 06, 07 }, /* none (vector-only operand) */
@@ -1684,429 +2196,1011 @@ static const unsigned char ei[1 << 4][N] = {
 };
 #endif
 
-PROFILE_MODE int SPECIAL(u32 inst, u32 PC)
-{
-    unsigned int rd, rs, rt;
-
-    rd = IW_RD(inst);
-    rt = (inst >> 16) % (1 << 5);
+/*** scalar, R4000 special and register-immediate operations ***/
 
-    switch (inst % 64) {
-    case 000: /* SLL */
-        SR[rd] = SR[rt] << MASK_SA(inst >> 6);
-        SR[zero] = 0x00000000;
-        break;
-    case 002: /* SRL */
-        SR[rd] = (u32)(SR[rt]) >> MASK_SA(inst >> 6);
-        SR[zero] = 0x00000000;
-        break;
-    case 003: /* SRA */
-        SR[rd] = (s32)(SR[rt]) >> MASK_SA(inst >> 6);
-        SR[zero] = 0x00000000;
-        break;
-    case 004: /* SLLV */
-        rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = SR[rt] << MASK_SA(SR[rs]);
-        SR[zero] = 0x00000000;
-        break;
-    case 006: /* SRLV */
-        rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = (u32)(SR[rt]) >> MASK_SA(SR[rs]);
-        SR[zero] = 0x00000000;
-        break;
-    case 007: /* SRAV */
-        rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = (s32)(SR[rt]) >> MASK_SA(SR[rs]);
-        SR[zero] = 0x00000000;
-        break;
-    case 011: /* JALR */
-        SR[rd] = FIT_IMEM(PC + LINK_OFF);
-        SR[zero] = 0x00000000;
-     /* Fall through. */
-    case 010: /* JR */
-        rs = SPECIAL_DECODE_RS(inst);
-        set_PC(SR[rs]);
-        return 1;
-    case 015: /* BREAK */
-        *CR[0x4] |= SP_STATUS_BROKE | SP_STATUS_HALT;
-        if (*CR[0x4] & SP_STATUS_INTR_BREAK) {
-            GET_RCP_REG(MI_INTR_REG) |= 0x00000001;
-            GET_RSP_INFO(CheckInterrupts)();
-        }
-        return -1;
-    case 040: /* ADD */
-    case 041: /* ADDU */
-        rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = SR[rs] + SR[rt];
-        SR[zero] = 0x00000000; /* needed for Rareware micro-codes */
-        break;
-    case 042: /* SUB */
-    case 043: /* SUBU */
-        rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = SR[rs] - SR[rt];
-        SR[zero] = 0x00000000;
-        break;
-    case 044: /* AND */
-        rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = SR[rs] & SR[rt];
-        SR[zero] = 0x00000000; /* needed for Rareware micro-codes */
-        break;
-    case 045: /* OR */
-        rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = SR[rs] | SR[rt];
-        SR[zero] = 0x00000000;
-        break;
-    case 046: /* XOR */
-        rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = SR[rs] ^ SR[rt];
-        SR[zero] = 0x00000000;
-        break;
-    case 047: /* NOR */
-        rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = ~(SR[rs] | SR[rt]);
-        SR[zero] = 0x00000000;
-        break;
-    case 052: /* SLT */
-        rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = ((s32)(SR[rs]) < (s32)(SR[rt]));
-        SR[zero] = 0x00000000;
-        break;
-    case 053: /* SLTU */
-        rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = ((u32)(SR[rs]) < (u32)(SR[rt]));
-        SR[zero] = 0x00000000;
-        break;
-    default:
-        res_S();
+PROFILE_MODE int SLL(const decoded_op * op, u32 PC)
+{
+    RSP_STATE.SR[op -> rd] = RSP_STATE.SR[op -> rt] << op -> sa;
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
+}
+PROFILE_MODE int SRL(const decoded_op * op, u32 PC)
+{
+    RSP_STATE.SR[op -> rd] = (u32)(RSP_STATE.SR[op -> rt]) >> op -> sa;
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
+}
+PROFILE_MODE int SRA(const decoded_op * op, u32 PC)
+{
+    RSP_STATE.SR[op -> rd] = (s32)(RSP_STATE.SR[op -> rt]) >> op -> sa;
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
+}
+PROFILE_MODE int SLLV(const decoded_op * op, u32 PC)
+{
+    RSP_STATE.SR[op -> rd] =
+        RSP_STATE.SR[op -> rt] << MASK_SA(RSP_STATE.SR[op -> rs]);
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
+}
+PROFILE_MODE int SRLV(const decoded_op * op, u32 PC)
+{
+    RSP_STATE.SR[op -> rd] =
+        (u32)(RSP_STATE.SR[op -> rt]) >> MASK_SA(RSP_STATE.SR[op -> rs]);
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
+}
+PROFILE_MODE int SRAV(const decoded_op * op, u32 PC)
+{
+    RSP_STATE.SR[op -> rd] =
+        (s32)(RSP_STATE.SR[op -> rt]) >> MASK_SA(RSP_STATE.SR[op -> rs]);
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
+}
+PROFILE_MODE int JR(const decoded_op * op, u32 PC)
+{
+    set_PC(RSP_STATE.SR[op -> rs]);
+    return 1;
+}
+PROFILE_MODE int JALR(const decoded_op * op, u32 PC)
+{
+    RSP_STATE.SR[op -> rd] = FIT_IMEM(PC + LINK_OFF);
+    RSP_STATE.SR[zero] = 0x00000000;
+    set_PC(RSP_STATE.SR[op -> rs]);
+    return 1;
+}
+PROFILE_MODE int BREAK(const decoded_op * op, u32 PC)
+{
+    *RSP_STATE.CR[0x4] |= SP_STATUS_BROKE | SP_STATUS_HALT;
+    if (*RSP_STATE.CR[0x4] & SP_STATUS_INTR_BREAK) {
+        GET_RCP_REG(MI_INTR_REG) |= 0x00000001;
+        GET_RSP_INFO(CheckInterrupts)();
     }
+    return -1;
+}
+PROFILE_MODE int ADDU(const decoded_op * op, u32 PC)
+{
+    RSP_STATE.SR[op -> rd] = RSP_STATE.SR[op -> rs] + RSP_STATE.SR[op -> rt];
+    RSP_STATE.SR[zero] = 0x00000000; /* needed for Rareware micro-codes */
     return 0;
 }
-
-PROFILE_MODE int REGIMM(u32 inst, u32 PC)
+PROFILE_MODE int SUBU(const decoded_op * op, u32 PC)
+{
+    RSP_STATE.SR[op -> rd] = RSP_STATE.SR[op -> rs] - RSP_STATE.SR[op -> rt];
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
+}
+PROFILE_MODE int SPECIAL_AND(const decoded_op * op, u32 PC)
+{
+    RSP_STATE.SR[op -> rd] = RSP_STATE.SR[op -> rs] & RSP_STATE.SR[op -> rt];
+    RSP_STATE.SR[zero] = 0x00000000; /* needed for Rareware micro-codes */
+    return 0;
+}
+PROFILE_MODE int SPECIAL_OR(const decoded_op * op, u32 PC)
 {
-    const unsigned int base = (inst >> 21) % (1 << 5);
-    const unsigned int rt   = (inst >> 16) % (1 << 5);
+    RSP_STATE.SR[op -> rd] = RSP_STATE.SR[op -> rs] | RSP_STATE.SR[op -> rt];
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
+}
+PROFILE_MODE int SPECIAL_XOR(const decoded_op * op, u32 PC)
+{
+    RSP_STATE.SR[op -> rd] = RSP_STATE.SR[op -> rs] ^ RSP_STATE.SR[op -> rt];
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
+}
+PROFILE_MODE int NOR(const decoded_op * op, u32 PC)
+{
+    RSP_STATE.SR[op -> rd] = ~(RSP_STATE.SR[op -> rs] | RSP_STATE.SR[op -> rt]);
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
+}
+PROFILE_MODE int SLT(const decoded_op * op, u32 PC)
+{
+    RSP_STATE.SR[op -> rd] =
+        ((s32)(RSP_STATE.SR[op -> rs]) < (s32)(RSP_STATE.SR[op -> rt]));
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
+}
+PROFILE_MODE int SLTU(const decoded_op * op, u32 PC)
+{
+    RSP_STATE.SR[op -> rd] =
+        ((u32)(RSP_STATE.SR[op -> rs]) < (u32)(RSP_STATE.SR[op -> rt]));
+    RSP_STATE.SR[zero] = 0x00000000;
+    return 0;
+}
 
-    switch (rt) {
-    case 020: /* BLTZAL */
-        SR[ra] = FIT_IMEM(PC + LINK_OFF);
-     /* Fall through. */
-    case 000: /* BLTZ */
-        if (!((s32)SR[base] < 0))
-            return 0;
-        set_PC(PC + 4*inst + SLOT_OFF);
-        break;
-    case 021: /* BGEZAL */
-        SR[ra] = FIT_IMEM(PC + LINK_OFF);
-     /* Fall through. */
-    case 001: /* BGEZ */
-        if (!((s32)SR[base] >= 0))
-            return 0;
-        set_PC(PC + 4*inst + SLOT_OFF);
-        break;
-    default:
-        res_S();
-    }
+PROFILE_MODE int BLTZ(const decoded_op * op, u32 PC)
+{
+    if (!((s32)RSP_STATE.SR[op -> rs] < 0))
+        return 0;
+    set_PC(PC + op -> imm + SLOT_OFF);
     return 1;
 }
-
-PROFILE_MODE void MWC2_load(u32 inst)
+PROFILE_MODE int BGEZ(const decoded_op * op, u32 PC)
+{
+    if (!((s32)RSP_STATE.SR[op -> rs] >= 0))
+        return 0;
+    set_PC(PC + op -> imm + SLOT_OFF);
+    return 1;
+}
+PROFILE_MODE int BLTZAL(const decoded_op * op, u32 PC)
 {
-    s16 offset;
-    const unsigned int base    = (inst >> 21) % (1 << 5);
-    const unsigned int vt      = (inst >> 16) % (1 << 5);
-    const unsigned int element = (inst >>  7) % (1 << 4);
+    RSP_STATE.SR[ra] = FIT_IMEM(PC + LINK_OFF);
+    return BLTZ(op, PC);
+}
+PROFILE_MODE int BGEZAL(const decoded_op * op, u32 PC)
+{
+    RSP_STATE.SR[ra] = FIT_IMEM(PC + LINK_OFF);
+    return BGEZ(op, PC);
+}
 
-#if defined(ARCH_MIN_SSE2) && !defined(SSE2NEON)
-    offset   = (s16)inst;
-    offset <<= 5 + 4; /* safe on x86, skips 5-bit rd, 4-bit element */
-    offset >>= 5 + 4;
-#else
-    offset = (inst & 64) ? -(s16)(~inst%64 + 1) : (s16)(inst % 64);
-#endif
-    LWC2[IW_RD(inst)](vt, element, offset, base);
+/*
+ * Reserved op-codes in the scalar unit.  The REGIMM class has always been
+ * treated as a taken branch (to whatever target was last scheduled).
+ */
+PROFILE_MODE int res_IW(const decoded_op * op, u32 PC)
+{
+    res_S();
+    return 0;
 }
-PROFILE_MODE void MWC2_store(u32 inst)
+PROFILE_MODE int res_REGIMM(const decoded_op * op, u32 PC)
 {
-    s16 offset;
-    const unsigned int base    = (inst >> 21) % (1 << 5);
-    const unsigned int vt      = (inst >> 16) % (1 << 5);
-    const unsigned int element = (inst >>  7) % (1 << 4);
+    res_S();
+    return 1;
+}
 
-#if defined(ARCH_MIN_SSE2) && !defined(SSE2NEON)
-    offset = (s16)inst;
-    offset <<= 5 + 4; /* safe on x86, skips 5-bit rd, 4-bit element */
-    offset >>= 5 + 4;
-#else
-    offset = (inst & 64) ? -(s16)(~inst%64 + 1) : (s16)(inst % 64);
-#endif
-    SWC2[IW_RD(inst)](vt, element, offset, base);
+/*** scalar, coprocessor operations (system control and vector unit) ***/
+
+PROFILE_MODE int MWC2_load(const decoded_op * op, u32 PC)
+{
+    op -> fn.transfer(op -> rt, op -> sa, op -> imm, op -> rs);
+    return 0;
+}
+PROFILE_MODE int MWC2_store(const decoded_op * op, u32 PC)
+{
+    op -> fn.transfer(op -> rt, op -> sa, op -> imm, op -> rs);
+    return 0;
 }
 
-PROFILE_MODE void COP0(u32 inst)
+#ifdef WAIT_FOR_CPU_HOST
+/*
+ * Micro-code waiting on the CPU host (or on the RDP, which the host only runs
+ * in between our tasks) spins on MFC0 of one of these until it changes--and
+ * during a synchronous `run_task', it never will.
+ */
+static int polled_CP0_register(unsigned int rd)
 {
-    const unsigned int rd = IW_RD(inst);
-    const unsigned int rs = (inst >> 21) % (1 << 5);
-    const unsigned int rt = (inst >> 16) % (1 << 5);
+    return (rd == 0x4 || rd == 0x5 || rd == 0x6 || rd == 0x7 || rd == 0xB);
+}
 
-    switch (rs) {
-    case 000:
-        SP_CP0_MF(rt, rd);
-        break;
-    case 004:
-        SP_CP0_MT[rd % NUMBER_OF_CP0_REGISTERS](rt);
+/*
+ * how many instructions ahead of or behind its MFC0 an idle loop may reach
+ */
+#define IDLE_LOOP_REACH     16
+
+enum {
+    IDLE_NEVER, /* memory, vector unit, COP0 writes, linking jumps, BREAK */
+    IDLE_ALU,
+    IDLE_BRANCH,
+    IDLE_MFC0
+};
+
+/*
+ * Sorts `op' for `idle_loop' and masks which scalar registers it reads from
+ * and writes to (never $zero, which always reads back the same anyway).
+ */
+static int idle_op_class(const decoded_op * op, u32 * reads, u32 * writes)
+{
+    int op_class;
+
+    *reads = *writes = 0x00000000;
+    op_class = IDLE_ALU;
+    switch (op -> kind) {
+    case OP_SLL:
+    case OP_SRL:
+    case OP_SRA:
+        *reads  = 1ul << op -> rt;
+        *writes = 1ul << op -> rd;
+        break;
+    case OP_SLLV: case OP_SRLV: case OP_SRAV:
+    case OP_ADDU: case OP_SUBU:
+    case OP_SPECIAL_AND: case OP_SPECIAL_OR: case OP_SPECIAL_XOR:
+    case OP_NOR:
+    case OP_SLT: case OP_SLTU:
+        *reads  = (1ul << op -> rs) | (1ul << op -> rt);
+        *writes = 1ul << op -> rd;
+        break;
+    case OP_ADDIU: case OP_SLTI: case OP_SLTIU:
+    case OP_ANDI: case OP_ORI: case OP_XORI:
+        *reads  = 1ul << op -> rs;
+        *writes = 1ul << op -> rt;
+        break;
+    case OP_LUI:
+        *writes = 1ul << op -> rt;
+        break;
+    case OP_COP0_MF:
+        *writes = 1ul << op -> rt;
+        op_class = IDLE_MFC0;
+        break;
+    case OP_BEQ:
+    case OP_BNE:
+        *reads  = (1ul << op -> rs) | (1ul << op -> rt);
+        op_class = IDLE_BRANCH;
+        break;
+    case OP_BLTZ: case OP_BGEZ:
+    case OP_BLEZ: case OP_BGTZ:
+        *reads  = 1ul << op -> rs;
+        op_class = IDLE_BRANCH;
+        break;
+    case OP_J:
+        op_class = IDLE_BRANCH;
         break;
     default:
-        res_S();
+        return IDLE_NEVER;
     }
+    *reads  &= ~(1ul << zero);
+    *writes &= ~(1ul << zero);
+    return (op_class);
 }
 
-PROFILE_MODE void COP2(u32 inst)
+/*
+ * Decides whether the MFC0 `op', just executed, is the only I/O in a loop
+ * that will keep going around forever with nothing but that MFC0 to show for
+ * it, until the CPU host is let back in to change the register being polled.
+ *
+ * The loop is the MFC0, straight-line ALU code and branches out of the loop
+ * down to one backwards branch (or J) over the MFC0, its delay slot, and the
+ * rest of the loop from the branch target back up to the MFC0.  Every scalar
+ * register the loop reads must be either left alone by the loop or set by an
+ * earlier instruction of the same pass starting from the MFC0, so that the
+ * MFC0 result and the registers not written determine the whole pass.  Then
+ * one trial pass on the current registers tells us whether it goes around.
+ */
+static NOINLINE int idle_loop(const decoded_op * op, u32 PC)
+{
+    u32 cycle[2*IDLE_LOOP_REACH + 2];
+    u32 saved_SR[NUMBER_OF_SCALAR_REGISTERS];
+    u32 reads, writes, written, loop_writes;
+    u32 MFC0_addr, branch_addr, head;
+    int saved_temp_PC, taken;
+    register unsigned int count, i;
+    register int idle;
+#ifndef EMULATE_STATIC_PC
+    int saved_stage;
+
+    if (RSP_STATE.stage == 2)
+        return 0; /* MFC0 in a delay slot:  wherever it goes, it won't loop */
+#endif
+
+    MFC0_addr = FIT_IMEM(PC - 0x004 + BASE_OFF);
+    if (op != &RSP_STATE.IMEM_decoded[MFC0_addr >> 2])
+        return 0; /* in the delay slot of a branch */
+
+/*
+ * Find the backwards branch around the MFC0.
+ */
+    count = 0;
+    cycle[count++] = MFC0_addr;
+    for (branch_addr = MFC0_addr + 0x004; ; branch_addr += 0x004) {
+        if (count > IDLE_LOOP_REACH || branch_addr >= 0x1000 - 0x004)
+            return 0; /* no room left in IMEM for its delay slot */
+        op = &RSP_STATE.IMEM_decoded[branch_addr >> 2];
+        i = idle_op_class(op, &reads, &writes);
+        if (i == IDLE_NEVER || i == IDLE_MFC0)
+            return 0;
+        cycle[count++] = branch_addr;
+        if (i != IDLE_BRANCH)
+            continue;
+        head = (op -> kind == OP_J)
+          ? FIT_IMEM(op -> imm)
+          : FIT_IMEM(branch_addr + 0x004 + op -> imm);
+        if (head <= MFC0_addr && MFC0_addr - head <= 4*IDLE_LOOP_REACH)
+            break;
+    }
+    op = &RSP_STATE.IMEM_decoded[(branch_addr + 0x004) >> 2];
+    if (idle_op_class(op, &reads, &writes) != IDLE_ALU)
+        return 0;
+    cycle[count++] = branch_addr + 0x004;
+    for (i = head; i < MFC0_addr; i += 0x004)
+        cycle[count++] = i;
+
+/*
+ * Walk the loop starting from the MFC0 for values carried over from the
+ * previous pass.
+ */
+    loop_writes = 0x00000000;
+    for (i = 0; i < count; i++) {
+        op = &RSP_STATE.IMEM_decoded[cycle[i] >> 2];
+        if (idle_op_class(op, &reads, &writes) == IDLE_NEVER)
+            return 0;
+        if (i != 0 && RSP_STATE.IMEM_decoded[cycle[i] >> 2].kind == OP_COP0_MF)
+            return 0;
+        loop_writes |= writes;
+    }
+    written = 0x00000000;
+    for (i = 0; i < count; i++) {
+        idle_op_class(&RSP_STATE.IMEM_decoded[cycle[i] >> 2], &reads, &writes);
+        if (reads & loop_writes & ~written)
+            return 0;
+        written |= writes;
+    }
+
+/*
+ * Trial pass:  Only the backwards branch may be taken, and it must be.
+ */
+    for (i = 0; i < NUMBER_OF_SCALAR_REGISTERS; i++)
+        saved_SR[i] = RSP_STATE.SR[i];
+    saved_temp_PC = RSP_STATE.temp_PC;
+#ifndef EMULATE_STATIC_PC
+    saved_stage = RSP_STATE.stage;
+#endif
+    idle = 1;
+    for (i = 1; i < count; i++) {
+        op = &RSP_STATE.IMEM_decoded[cycle[i] >> 2];
+        taken = op -> handler(op, cycle[i] + 0x004 - BASE_OFF);
+        if (taken != (cycle[i] == branch_addr)) {
+            idle = 0;
+            break;
+        }
+    }
+    for (i = 0; i < NUMBER_OF_SCALAR_REGISTERS; i++)
+        RSP_STATE.SR[i] = saved_SR[i];
+    RSP_STATE.temp_PC = saved_temp_PC;
+#ifndef EMULATE_STATIC_PC
+    RSP_STATE.stage = saved_stage;
+#endif
+    return (idle);
+}
+#endif
+
+PROFILE_MODE int COP0_MF(const decoded_op * op, u32 PC)
 {
-    const unsigned int op = (inst >> 21) % (1 << 5); /* inst.R.rs */
-    const unsigned int vt = (inst >> 16) % (1 << 5); /* inst.R.rt */
-    const unsigned int vs = IW_RD(inst);
-    const unsigned int vd = (inst >>  6) % (1 << 5); /* inst.R.sa */
-    const unsigned int func = inst % (1 << 6);
-#ifndef ARCH_MIN_SSE2
-    const unsigned int e  = op & 0xF; /* With Intel, LEA offsets beat ANDing. */
+    SP_CP0_MF(op -> rt, op -> rd);
+#ifdef WAIT_FOR_CPU_HOST
+    if (polled_CP0_register(op -> rd) && idle_loop(op, PC))
+        GET_RCP_REG(SP_STATUS_REG) |= SP_STATUS_HALT; /* until the CPU's turn */
 #endif
+    return (GET_RCP_REG(SP_STATUS_REG) & SP_STATUS_HALT) ? -1 : 0;
+}
+PROFILE_MODE int COP0_MT(const decoded_op * op, u32 PC)
+{
+    op -> fn.CP0_MT(op -> rt);
+    return (GET_RCP_REG(SP_STATUS_REG) & SP_STATUS_HALT) ? -1 : 0;
+}
+PROFILE_MODE int COP0_res(const decoded_op * op, u32 PC)
+{
+    res_S();
+    return (GET_RCP_REG(SP_STATUS_REG) & SP_STATUS_HALT) ? -1 : 0;
+}
 
-    switch (op) {
-#ifdef ARCH_MIN_SSE2
-        v16 target;
+PROFILE_MODE int COP2_MF(const decoded_op * op, u32 PC)
+{
+    MFC2(op -> rt, op -> rd, op -> sa);
+    return 0;
+}
+PROFILE_MODE int COP2_CF(const decoded_op * op, u32 PC)
+{
+    CFC2(op -> rt, op -> rd);
+    return 0;
+}
+PROFILE_MODE int COP2_MT(const decoded_op * op, u32 PC)
+{
+    MTC2(op -> rt, op -> rd, op -> sa);
+    return 0;
+}
+PROFILE_MODE int COP2_CT(const decoded_op * op, u32 PC)
+{
+    CTC2(op -> rt, op -> rd);
+    return 0;
+}
+
+/*
+ * Computational vector operations:  one call to the entry point for both
+ * the operation and its element modifier on $vt (see `COP2_C2_entries').
+ *
+ * `inst_word' is still published for the few operations (VRCP and friends,
+ * VSAW) which decode their own operand fields.
+ */
+PROFILE_MODE int COP2_V(const decoded_op * op, u32 PC)
+{
+    RSP_STATE.inst_word = op -> word;
+    op -> fn.vector(op -> sa, op -> rd, op -> rt);
+    return 0;
+}
+
+/*
+ * the fused idioms (see `p_C2_fused'), by the `fused' index of the first op
+ */
+enum {
+    NOT_FUSED,
+    FUSED_MULTIPLIES, /* a run of multiplies:  VMUDL, VMADM, VMADN, VMADH */
+    FUSED_RECIPROCAL, /* VRCPH, VRCPL, VRCPH (or VRSQH, VRSQL, VRSQH) */
+    FUSED_SELECT, /* VLT or VGE, then VMRG */
+
+    NUMBER_OF_IDIOMS
+};
+#define MAX_FUSED_OPS   8
+
+static const p_C2_fused fused_kernels[NUMBER_OF_IDIOMS] = {
+    NULL,
+#ifdef HAVE_FUSED_MULTIPLIES
+    VMUL_run,
 #else
-        register unsigned int i;
+    NULL,
+#endif
+    VRCP_double,
+    VCMP_VMRG,
+};
+
+PROFILE_MODE int COP2_fused(const decoded_op * op, u32 PC)
+{
+    u32 IW[MAX_FUSED_OPS];
+    register unsigned int i, count;
+
+#ifndef EMULATE_STATIC_PC
+    if (RSP_STATE.stage == 2) /* in a delay slot after all:  just the one op */
+        return COP2_V(op, PC);
 #endif
+    count = 1 + op -> imm / 4;
+    for (i = 0; i < count; i++)
+        IW[i] = op[i].word;
+    fused_kernels[op -> fused](IW, count);
+    return +2;
+}
 
-    case 000:
-        MFC2(vt, vs, vd >> 1);
+/*** instruction predecoding ***/
+
+/*
+ * IMEM is decoded one word at a time into a table indexed by (PC >> 2).
+ * Every entry keeps its raw instruction word, which doubles as the shadow
+ * copy of IMEM used to notice writes made by the CPU host between tasks.
+ *
+ * The interpreter never decodes anything after this:  only SP DMA into the
+ * IMEM half and host writes to IMEM (see `validate_IMEM') cause re-decodes.
+ * The table is `IMEM_decoded', one per `rsp_context'.
+ */
+
+#define DECODE(name)    (op -> handler = name, op -> kind = OP_##name)
+
+static void predecode(unsigned int addr)
+{
+    register decoded_op * op;
+    u32 inst;
+
+    op = &RSP_STATE.IMEM_decoded[FIT_IMEM(addr) >> 2];
+    inst = *(pu32)(RSP_STATE.IMEM + FIT_IMEM(addr));
+
+    op -> word = inst;
+    op -> rs = (inst >> 21) % (1 << 5);
+    op -> rt = (inst >> 16) % (1 << 5);
+    op -> rd = (inst >> 11) % (1 << 5);
+    op -> sa = (inst >>  6) % (1 << 5);
+    op -> imm = (s16)(inst & 0x0000FFFFu);
+    op -> fn.vector = NULL;
+    op -> dead = 0;
+    op -> fused = NOT_FUSED;
+    DECODE(res_IW);
+
+    switch (inst >> 26) {
+    case 000: /* SPECIAL */
+        switch (inst % 64) {
+        case 000:  DECODE(SLL);     break;
+        case 002:  DECODE(SRL);     break;
+        case 003:  DECODE(SRA);     break;
+        case 004:  DECODE(SLLV);    break;
+        case 006:  DECODE(SRLV);    break;
+        case 007:  DECODE(SRAV);    break;
+        case 010:  DECODE(JR);      break;
+        case 011:  DECODE(JALR);    break;
+        case 015:  DECODE(BREAK);   break;
+        case 040: /* ADD */
+        case 041:  DECODE(ADDU);    break;
+        case 042: /* SUB */
+        case 043:  DECODE(SUBU);    break;
+        case 044:  DECODE(SPECIAL_AND); break;
+        case 045:  DECODE(SPECIAL_OR); break;
+        case 046:  DECODE(SPECIAL_XOR); break;
+        case 047:  DECODE(NOR);     break;
+        case 052:  DECODE(SLT);     break;
+        case 053:  DECODE(SLTU);    break;
+        }
+        break;
+    case 001: /* REGIMM */
+        op -> imm = 4 * op -> imm;
+        switch (op -> rt) {
+        case 000:  DECODE(BLTZ);    break;
+        case 001:  DECODE(BGEZ);    break;
+        case 020:  DECODE(BLTZAL);  break;
+        case 021:  DECODE(BGEZAL);  break;
+        default:   DECODE(res_REGIMM);
+        }
         break;
     case 002:
-        CFC2(vt, vs);
+        op -> imm = FIT_IMEM(4 * inst);
+        DECODE(J);
+        break;
+    case 003:
+        op -> imm = FIT_IMEM(4 * inst);
+        DECODE(JAL);
         break;
     case 004:
-        MTC2(vt, vs, vd >> 1);
+        op -> imm = 4 * op -> imm;
+        DECODE(BEQ);
+        break;
+    case 005:
+        op -> imm = 4 * op -> imm;
+        DECODE(BNE);
         break;
     case 006:
-        CTC2(vt, vs);
+        op -> imm = 4 * op -> imm;
+        DECODE(BLEZ);
         break;
-    case 020:
-    case 021:
-#ifdef ARCH_MIN_SSE2
-        *(v16 *)(VR[vd]) = COP2_C2[func](*(v16 *)VR[vs], *(v16 *)VR[vt]);
-#else
-        COP2_C2[func](&VR[vs][0], &VR[vt][0]);
-        vector_copy(&VR[vd][0], &V_result[0]);
-#endif
+    case 007:
+        op -> imm = 4 * op -> imm;
+        DECODE(BGTZ);
         break;
-    case 022:
-    case 023:
-#ifdef ARCH_MIN_SSE2
-#ifdef __ARM_NEON__
-        target = (v16)vld1q_u16(&VR[vt][0 + op - 0x12]);
-        target = (v16)vshlq_n_u32((uint32x4_t)target, 16);
-        target = (v16)vorrq_u16((uint16x8_t)target,
-                                (uint16x8_t)vshrq_n_u32((uint32x4_t)target, 16));
-#else
-        shuffle_temporary[0] = VR[vt][0 + op - 0x12];
-        shuffle_temporary[2] = VR[vt][2 + op - 0x12];
-        shuffle_temporary[4] = VR[vt][4 + op - 0x12];
-        shuffle_temporary[6] = VR[vt][6 + op - 0x12];
-        target = *(v16 *)(&shuffle_temporary[0]);
-        target = _mm_shufflehi_epi16(target, _MM_SHUFFLE(2, 2, 0, 0));
-        target = _mm_shufflelo_epi16(target, _MM_SHUFFLE(2, 2, 0, 0));
-#endif
-        *(v16 *)(VR[vd]) = COP2_C2[func](*(v16 *)VR[vs], target);
-#else
-        for (i = 0; i < N; i++)
-            shuffle_temporary[i] = VR[vt][(i & 0xE) + (e & 0x1)];
-        COP2_C2[func](&VR[vs][0], &shuffle_temporary[0]);
-        vector_copy(&VR[vd][0], &V_result[0]);
-#endif
+    case 010: /* ADDI:  Traps don't exist on the RCP. */
+    case 011:
+        DECODE(ADDIU);
         break;
-    case 024:
-    case 025:
-    case 026:
-    case 027:
-#ifdef ARCH_MIN_SSE2
-#ifdef __ARM_NEON__
-        target = (v16)vcombine_s16(vdup_n_s16(VR[vt][0 + op - 0x14]),
-                                   vdup_n_s16(VR[vt][4 + op - 0x14]));
-#else
-        target = _mm_setzero_si128();
-        target = _mm_insert_epi16(target, VR[vt][0 + op - 0x14], 0);
-        target = _mm_insert_epi16(target, VR[vt][4 + op - 0x14], 4);
-        target = _mm_shufflehi_epi16(target, _MM_SHUFFLE(0, 0, 0, 0));
-        target = _mm_shufflelo_epi16(target, _MM_SHUFFLE(0, 0, 0, 0));
-#endif
-        *(v16 *)(VR[vd]) = COP2_C2[func](*(v16 *)VR[vs], target);
-#else
-        for (i = 0; i < N; i++)
-            shuffle_temporary[i] = VR[vt][(i & 0xC) + (e & 0x3)];
-        COP2_C2[func](&VR[vs][0], &shuffle_temporary[0]);
-        vector_copy(&VR[vd][0], &V_result[0]);
-#endif
+    case 012:
+        DECODE(SLTI);
         break;
-    case 030:
-    case 031:
-    case 032:
-    case 033:
-    case 034:
-    case 035:
-    case 036:
-    case 037:
-#ifdef ARCH_MIN_SSE2
-        *(v16 *)(VR[vd]) = COP2_C2[func](
-            *(v16 *)VR[vs],
-            _mm_set1_epi16(VR[vt][op - 0x18])
-        );
-#else
-        for (i = 0; i < N; i++)
-            shuffle_temporary[i] = VR[vt][e % N];
-        COP2_C2[func](&VR[vs][0], &shuffle_temporary[0]);
-        vector_copy(&VR[vd][0], &V_result[0]);
-#endif
+    case 013:
+        DECODE(SLTIU);
         break;
-    default:
-        res_S();
+    case 014:
+        op -> imm = (u16)(inst & 0x0000FFFFu);
+        DECODE(ANDI);
+        break;
+    case 015:
+        op -> imm = (u16)(inst & 0x0000FFFFu);
+        DECODE(ORI);
+        break;
+    case 016:
+        op -> imm = (u16)(inst & 0x0000FFFFu);
+        DECODE(XORI);
+        break;
+    case 017:
+        op -> imm = (s32)((inst & 0x0000FFFFu) << 16);
+        DECODE(LUI);
+        break;
+    case 020: /* COP0 */
+        switch (op -> rs) {
+        case 000:
+            DECODE(COP0_MF);
+            break;
+        case 004:
+            op -> fn.CP0_MT = SP_CP0_MT[op -> rd % NUMBER_OF_CP0_REGISTERS];
+            DECODE(COP0_MT);
+            break;
+        default:
+            DECODE(COP0_res);
+        }
+        break;
+    case 022: /* COP2 */
+        switch (op -> rs) {
+        case 000:
+            op -> sa >>= 1;
+            DECODE(COP2_MF);
+            break;
+        case 002:
+            DECODE(COP2_CF);
+            break;
+        case 004:
+            op -> sa >>= 1;
+            DECODE(COP2_MT);
+            break;
+        case 006:
+            DECODE(COP2_CT);
+            break;
+        default:
+            if (op -> rs < 020)
+                break;
+            op -> fn.vector = COP2_C2_entries[inst % (1 << 6)][op -> rs & 0xF];
+            DECODE(COP2_V);
+        }
+        break;
+    case 040:
+        DECODE(LB);
+        break;
+    case 041:
+        DECODE(LH);
+        break;
+    case 043:
+        DECODE(LW);
+        break;
+    case 044:
+        DECODE(LBU);
+        break;
+    case 045:
+        DECODE(LHU);
+        break;
+    case 050:
+        DECODE(SB);
+        break;
+    case 051:
+        DECODE(SH);
+        break;
+    case 053:
+        DECODE(SW);
+        break;
+    case 062: /* LWC2 */
+    case 072: /* SWC2 */
+        op -> sa = (inst >> 7) % (1 << 4); /* element */
+        op -> imm = (inst & 64) ? -(s32)(~inst%64 + 1) : (s32)(inst % 64);
+        if (inst >> 26 == 062) {
+            op -> fn.transfer = LWC2[op -> rd];
+            DECODE(MWC2_load);
+        } else {
+            op -> fn.transfer = SWC2[op -> rd];
+            DECODE(MWC2_store);
+        }
+        break;
+    }
+    return;
+}
+
+/*
+ * Anything which could leave the straight line:  jumps and branches, BREAK,
+ * and COP0 (which may DMA into IMEM or halt the RSP).  As in the recompiler,
+ * what follows one of these might not be what runs next.
+ */
+static int ends_straight_line(const decoded_op * op)
+{
+    switch (op -> kind) {
+    case OP_JR: case OP_JALR: case OP_BREAK:
+    case OP_BLTZ: case OP_BGEZ: case OP_BLTZAL: case OP_BGEZAL:
+    case OP_res_REGIMM:
+    case OP_J: case OP_JAL:
+    case OP_BEQ: case OP_BNE: case OP_BLEZ: case OP_BGTZ:
+    case OP_COP0_MF: case OP_COP0_MT: case OP_COP0_res:
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * the accumulator and flag state (VU_*) read and fully written by `op'
+ */
+static void VU_state_used(const decoded_op * op, u32 * reads, u32 * writes)
+{
+    static const unsigned char CTC2_writes[4] = {
+        VU_VCO, VU_VCC, VU_VCE, VU_VCE,
+    };
+
+    *reads = *writes = 0;
+    switch (op -> kind) {
+    case OP_COP2_V:
+    case OP_COP2_fused:
+        *reads  = C2_reads[op -> word % 64];
+        *writes = C2_writes[op -> word % 64];
+        break;
+    case OP_COP2_CF:
+        *reads  = VU_VCO | VU_VCC | VU_VCE;
+        break;
+    case OP_COP2_CT:
+        *writes = CTC2_writes[op -> rd & 3];
+        break;
+    }
+    return;
+}
+
+/*
+ * Liveness of the accumulator and flags, backwards over all of IMEM:  marks
+ * in `dead' what every vector op writes that nothing reads before it is all
+ * written over again, on the straight line after it.  Ops with nothing but
+ * dead writes go to the result-only entries in `COP2_C2_results'.  At the
+ * end of any straight line (and of IMEM), everything is taken to be live.
+ *
+ * Any op whose `dead' changes has to be recompiled with it.
+ */
+static void mark_dead_writes(void)
+{
+    register decoded_op * op;
+    u32 reads, writes;
+    unsigned int live, dead, func;
+    register int i;
+
+    live = VU_STATE;
+    for (i = 4096/4 - 1; i >= 0; i--) {
+        op = &RSP_STATE.IMEM_decoded[i];
+        if (ends_straight_line(op)
+         || ends_straight_line(&RSP_STATE.IMEM_decoded[(i - 1) & 0x3FF]))
+            live = VU_STATE;
+
+        VU_state_used(op, &reads, &writes);
+        dead = writes & ~live;
+        live = (live & ~writes) | reads;
+
+        if (op -> kind != OP_COP2_V && op -> kind != OP_COP2_fused)
+            continue;
+        func = op -> word % 64;
+        op -> fn.vector = COP2_C2_entries[func][op -> rs & 0xF];
+        if (func < 022 && writes != 0 && dead == writes)
+            op -> fn.vector = COP2_C2_results[func][op -> rs & 0xF];
+        if (op -> dead != dead)
+            invalidate_blocks(4 * i, 4);
+        op -> dead = (unsigned char)dead;
     }
+    return;
+}
+
+static int is_multiply(unsigned int func)
+{
+    return (func < 020 && func % 8 != 2 && func % 8 != 3);
 }
 
+/*
+ * how many ops of which idiom start at IMEM_decoded[i] (0:  none)
+ */
+static unsigned int match_idiom(unsigned int i, unsigned char * idiom)
+{
+    unsigned int func[MAX_FUSED_OPS];
+    const decoded_op * op;
+    register unsigned int count, n;
+
+    *idiom = NOT_FUSED;
+#ifdef SP_EXECUTE_LOG
+    return 0; /* The log is of every op, one at a time. */
+#endif
+    op = &RSP_STATE.IMEM_decoded[i];
+    if (ends_straight_line(&RSP_STATE.IMEM_decoded[(i - 1) & 0x3FF]))
+        return 0; /* in a delay slot:  What runs next is somewhere else. */
+    for (count = 0; count < MAX_FUSED_OPS && i + count < 4096 / 4; count++) {
+        if (op[count].kind != OP_COP2_V && op[count].kind != OP_COP2_fused)
+            break;
+        func[count] = op[count].word % 64;
+    }
+    if (count < 2)
+        return 0;
+
+    if (fused_kernels[FUSED_MULTIPLIES] != NULL && is_multiply(func[0])) {
+        for (n = 1; n < count && is_multiply(func[n]); n++)
+            ;
+        if (n >= 2) {
+            *idiom = FUSED_MULTIPLIES;
+            return (n);
+        }
+    }
+    if (count >= 3 && (func[1] == 061 || func[1] == 065)
+     && func[0] == func[1] + 1 && func[2] == func[1] + 1) {
+        *idiom = FUSED_RECIPROCAL;
+        return 3;
+    }
+    if ((func[0] == 040 || func[0] == 043) && func[1] == 047) {
+        *idiom = FUSED_SELECT;
+        return 2;
+    }
+    return 0;
+}
+
+/*
+ * Finds the idioms in all of IMEM and sends the first op of each through
+ * `COP2_fused', which then does the whole idiom.  The ops after it are left
+ * as they are, for when something jumps into the middle of one.
+ */
+static void fuse_idioms(void)
+{
+    register decoded_op * op;
+    unsigned char idiom;
+    unsigned int count;
+    register unsigned int i;
+
+    for (i = 0; i < 4096 / 4; i++) {
+        op = &RSP_STATE.IMEM_decoded[i];
+        if (op -> kind != OP_COP2_V && op -> kind != OP_COP2_fused)
+            continue;
+        count = match_idiom(i, &idiom);
+        if (idiom == op -> fused
+         && (idiom == NOT_FUSED || op -> imm == 4 * (s32)(count - 1)))
+            continue; /* no change */
+        invalidate_blocks(4 * i, 4);
+        op -> fused = idiom;
+        if (idiom == NOT_FUSED) {
+            op -> imm = (s16)(op -> word & 0x0000FFFFu);
+            DECODE(COP2_V);
+        } else {
+            op -> imm = 4 * (count - 1);
+            DECODE(COP2_fused);
+        }
+    }
+    return;
+}
+
+void predecode_IMEM(unsigned int start, unsigned int length)
+{
+    register unsigned int addr;
+
+    for (addr = start & ~3u; addr < start + length; addr += 4)
+        predecode(addr);
+    invalidate_blocks(start, length);
+    mark_dead_writes();
+    fuse_idioms();
+    return;
+}
+
+void validate_IMEM(void)
+{
+    register unsigned int i;
+    int changed;
+
+    changed = 0;
+    for (i = 0; i < 4096 / 4; i++)
+        if (RSP_STATE.IMEM_decoded[i].word != *(pu32)(RSP_STATE.IMEM + 4*i)
+         || RSP_STATE.IMEM_decoded[i].handler == NULL) {
+            predecode(4 * i);
+            invalidate_blocks(4 * i, 4);
+            changed = 1;
+        }
+    if (changed) {
+        mark_dead_writes();
+        fuse_idioms();
+    }
+    return;
+}
+
+#ifdef THREADED_DISPATCH
+/*
+ * Labels-as-values are a GNU extension, which -pedantic would warn about.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+
+#define NEXT_OP { \
+    op = &RSP_STATE.IMEM_decoded[FIT_IMEM(PC) >> 2]; \
+    PC = (PC + 0x004); \
+    goto *dispatch[op -> kind]; }
+
+#define THREAD(name) \
+    do_##name: name(op, PC); NEXT_OP
+#define THREAD_JUMP(name) \
+    do_##name: if (name(op, PC) != 0) goto threaded_branch; NEXT_OP
+#define THREAD_HALT(name) \
+    do_##name: if (name(op, PC) < 0) goto RSP_halted_CPU_exit_point; NEXT_OP
+#define THREAD_FUSED(name) \
+    do_##name: name(op, PC); PC += op -> imm; NEXT_OP
+#endif
+
 NOINLINE void run_task(void)
 {
+    register const decoded_op * op;
     register u32 PC;
+#ifdef THREADED_DISPATCH
+    static const void * const dispatch[NUMBER_OF_OP_KINDS] = {
+        &&do_res_IW,
+        &&do_SLL, &&do_SRL, &&do_SRA, &&do_SLLV, &&do_SRLV, &&do_SRAV,
+        &&do_JR, &&do_JALR, &&do_BREAK,
+        &&do_ADDU, &&do_SUBU,
+        &&do_SPECIAL_AND, &&do_SPECIAL_OR, &&do_SPECIAL_XOR, &&do_NOR,
+        &&do_SLT, &&do_SLTU,
+        &&do_BLTZ, &&do_BGEZ, &&do_BLTZAL, &&do_BGEZAL, &&do_res_REGIMM,
+        &&do_J, &&do_JAL, &&do_BEQ, &&do_BNE, &&do_BLEZ, &&do_BGTZ,
+        &&do_ADDIU, &&do_SLTI, &&do_SLTIU,
+        &&do_ANDI, &&do_ORI, &&do_XORI, &&do_LUI,
+        &&do_COP0_MF, &&do_COP0_MT, &&do_COP0_res,
+        &&do_COP2_MF, &&do_COP2_CF, &&do_COP2_MT, &&do_COP2_CT,
+        &&do_COP2_V, &&do_COP2_fused,
+        &&do_LB, &&do_LH, &&do_LW, &&do_LBU, &&do_LHU,
+        &&do_SB, &&do_SH, &&do_SW,
+        &&do_MWC2_load, &&do_MWC2_store,
+    };
+#endif
 
     PC = FIT_IMEM(GET_RCP_REG(SP_PC_REG));
+#ifdef THREADED_DISPATCH
+#ifdef HAVE_DYNAREC
+    if (CFG_DYNAREC == 0) /* The recompiler hooks into the loop below. */
+#endif
+    {
+        NEXT_OP;
+
+        THREAD(res_IW);
+        THREAD(SLL);
+        THREAD(SRL);
+        THREAD(SRA);
+        THREAD(SLLV);
+        THREAD(SRLV);
+        THREAD(SRAV);
+        THREAD_JUMP(JR);
+        THREAD_JUMP(JALR);
+        THREAD_HALT(BREAK);
+        THREAD(ADDU);
+        THREAD(SUBU);
+        THREAD(SPECIAL_AND);
+        THREAD(SPECIAL_OR);
+        THREAD(SPECIAL_XOR);
+        THREAD(NOR);
+        THREAD(SLT);
+        THREAD(SLTU);
+        THREAD_JUMP(BLTZ);
+        THREAD_JUMP(BGEZ);
+        THREAD_JUMP(BLTZAL);
+        THREAD_JUMP(BGEZAL);
+        THREAD_JUMP(res_REGIMM);
+        THREAD_JUMP(J);
+        THREAD_JUMP(JAL);
+        THREAD_JUMP(BEQ);
+        THREAD_JUMP(BNE);
+        THREAD_JUMP(BLEZ);
+        THREAD_JUMP(BGTZ);
+        THREAD(ADDIU);
+        THREAD(SLTI);
+        THREAD(SLTIU);
+        THREAD(ANDI);
+        THREAD(ORI);
+        THREAD(XORI);
+        THREAD(LUI);
+        THREAD_HALT(COP0_MF);
+        THREAD_HALT(COP0_MT);
+        THREAD_HALT(COP0_res);
+        THREAD(COP2_MF);
+        THREAD(COP2_CF);
+        THREAD(COP2_MT);
+        THREAD(COP2_CT);
+        THREAD(COP2_V);
+        THREAD_FUSED(COP2_fused);
+        THREAD(LB);
+        THREAD(LH);
+        THREAD(LW);
+        THREAD(LBU);
+        THREAD(LHU);
+        THREAD(SB);
+        THREAD(SH);
+        THREAD(SW);
+        THREAD(MWC2_load);
+        THREAD(MWC2_store);
+
+threaded_branch: /* same delay-slot trick as `set_branch_delay' */
+        op = &RSP_STATE.IMEM_decoded[FIT_IMEM(PC) >> 2];
+        PC = FIT_IMEM(RSP_STATE.temp_PC);
+        goto *dispatch[op -> kind];
+    }
+#endif
     for (;;) {
-        inst_word = *(pi32)(IMEM + FIT_IMEM(PC));
+#ifdef HAVE_DYNAREC
+        if (CFG_DYNAREC)
+            PC += 4 * run_block(PC); /* straight-line code up to the next jump */
+#endif
+        op = &RSP_STATE.IMEM_decoded[FIT_IMEM(PC) >> 2];
 #ifdef EMULATE_STATIC_PC
         PC = (PC + 0x004);
 EX:
 #endif
 #ifdef SP_EXECUTE_LOG
-        step_SP_commands(inst_word);
+        step_SP_commands(op -> word);
 #endif
 
 #if (0 != 0)
         if (GET_RCP_REG(SP_STATUS_REG) & SP_STATUS_HALT)
             goto RSP_halted_CPU_exit_point; /* Only BREAK and COP0 set this. */
-        SR[zero] = 0x00000000; /* already handled on per-instruction basis */
+        RSP_STATE.SR[zero] = 0x00000000; /* already handled per instruction */
 #endif
-        switch (inst_word >> 26) {
-        case 000: /* SPECIAL */
-            switch (SPECIAL(inst_word, PC)) {
-            case -1: /* BREAK */
-                goto RSP_halted_CPU_exit_point;
-            case +1: /* JR and JALR */
-                JUMP;
-            }
-            break;
-        case 001: /* REGIMM */
-            if (REGIMM(inst_word, PC) != 0)
-                JUMP;
-            break;
-        case 002:
-            J(inst_word);
-            JUMP;
-        case 003:
-            JAL(inst_word, PC);
+        switch (op -> handler(op, PC)) {
+        case -1: /* BREAK, or COP0 which set the HALT status */
+            goto RSP_halted_CPU_exit_point;
+        case +1: /* jumps and taken branches */
             JUMP;
-        case 004:
-            if (BEQ(inst_word, PC) != 0)
-                JUMP;
-            break;
-        case 005:
-            if (BNE(inst_word, PC) != 0)
-                JUMP;
-            break;
-        case 006:
-            if (BLEZ(inst_word, PC) != 0)
-                JUMP;
-            break;
-        case 007:
-            if (BGTZ(inst_word, PC) != 0)
-                JUMP;
+        case +2: /* fused idioms:  The ops after this one are done, too. */
+            PC = PC + op -> imm;
             break;
-        case 010: /* ADDI:  Traps don't exist on the RCP. */
-        case 011:
-            ADDIU(inst_word);
-            break;
-        case 012:
-            SLTI(inst_word);
-            break;
-        case 013:
-            SLTIU(inst_word);
-            break;
-        case 014:
-            ANDI(inst_word);
-            break;
-        case 015:
-            ORI(inst_word);
-            break;
-        case 016:
-            XORI(inst_word);
-            break;
-        case 017:
-            LUI(inst_word);
-            break;
-        case 020:
-            COP0(inst_word);
-            if (GET_RCP_REG(SP_STATUS_REG) & SP_STATUS_HALT)
-                goto RSP_halted_CPU_exit_point;
-            break;
-        case 022:
-            COP2(inst_word);
-            break;
-        case 040:
-            LB(inst_word);
-            break;
-        case 041:
-            LH(inst_word);
-            break;
-        case 043:
-            LW(inst_word);
-            break;
-        case 044:
-            LBU(inst_word);
-            break;
-        case 045:
-            LHU(inst_word);
-            break;
-        case 050:
-            SB(inst_word);
-            break;
-        case 051:
-            SH(inst_word);
-            break;
-        case 053:
-            SW(inst_word);
-            break;
-        case 062: /* LWC2 */
-            MWC2_load(inst_word);
-            break;
-        case 072: /* SWC2 */
-            MWC2_store(inst_word);
-            break;
-        default:
-            res_S();
         }
 
 #ifndef EMULATE_STATIC_PC
-        if (stage == 2) { /* branch phase of scheduler */
-            stage = 0*stage;
-            PC = FIT_IMEM(temp_PC);
-            GET_RCP_REG(SP_PC_REG) = temp_PC;
+        if (RSP_STATE.stage == 2) { /* branch phase of scheduler */
+            RSP_STATE.stage = 0*RSP_STATE.stage;
+            PC = FIT_IMEM(RSP_STATE.temp_PC);
+            GET_RCP_REG(SP_PC_REG) = RSP_STATE.temp_PC;
         } else {
-            stage = 2*stage; /* next IW in branch delay slot? */
+            RSP_STATE.stage = 2*RSP_STATE.stage; /* next IW in delay slot? */
             PC = FIT_IMEM(PC + 0x004);
             GET_RCP_REG(SP_PC_REG) = 0x04001000 + PC;
         }
 #else
         continue;
 set_branch_delay:
-        inst_word = *(pi32)(IMEM + FIT_IMEM(PC));
-        PC = FIT_IMEM(temp_PC);
+        op = &RSP_STATE.IMEM_decoded[FIT_IMEM(PC) >> 2];
+        PC = FIT_IMEM(RSP_STATE.temp_PC);
         goto EX;
 #endif
     }
@@ -2115,3 +3209,7 @@ RSP_halted_CPU_exit_point:
 
     return;
 }
+
+#ifdef THREADED_DISPATCH
+#pragma GCC diagnostic pop
+#endif
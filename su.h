@@ -20,7 +20,7 @@
 #include <stdio.h>
 
 #include "my_types.h"
-#include "rsp.h"
+#include "context.h"
 
 #define SEMAPHORE_LOCK_CORRECTIONS
 #define WAIT_FOR_CPU_HOST
@@ -34,8 +34,8 @@
  * Currently, the plugin system this module is written for doesn't notify us
  * of how much RDRAM is installed to the system, so we'll use signal handlers
  * to catch memory segment access faults in the trial search to find it out.
+ * That is `su_max_address' (in `rsp_context', as is all of the RSP's state).
  */
-extern unsigned long su_max_address;
 
 /*
  * Interact with memory using server-side byte order (MIPS big-endian) or
@@ -69,6 +69,16 @@ extern unsigned long su_max_address;
 #define EMULATE_STATIC_PC
 #endif
 
+/*
+ * With GCC or Clang, thread the interpreter through labels-as-values:  each
+ * op-code ends with its own indirect jump to the next op-code's code, so
+ * the host CPU predicts each of those jumps separately instead of all of
+ * them sharing the one jump of a `switch'.  Other compilers use the loop.
+ */
+#if defined(__GNUC__) && defined(EMULATE_STATIC_PC) && !defined(SP_EXECUTE_LOG)
+#define THREADED_DISPATCH
+#endif
+
 #if (0 != 0)
 #define PROFILE_MODE    static NOINLINE
 #else
@@ -122,21 +132,8 @@ typedef enum {
     S8 = fp /* older name for GPR $fp as of the R4000 ISA */
 } GPR_specifier;
 
-extern RSP_INFO RSP_INFO_NAME;
-extern pu8 DRAM;
-extern pu8 DMEM;
-extern pu8 IMEM;
-
 extern u8 conf[];
 
-/*
- * general-purpose scalar registers
- *
- * based on the MIPS instruction set architecture but without most of the
- * original register names (for example, no kernel-reserved registers)
- */
-extern u32 SR[];
-
 #define FIT_IMEM(PC)    ((PC) & 0xFFFu & 0xFFCu)
 
 #ifdef EMULATE_STATIC_PC
@@ -151,24 +148,14 @@ extern u32 SR[];
 #define BASE_OFF    0x004
 #endif
 
-#ifndef EMULATE_STATIC_PC
-int stage;
-#endif
-
-extern int temp_PC;
-#ifdef WAIT_FOR_CPU_HOST
-extern short MFC0_count[];
-/* Keep one C0 MF status read count for each scalar register. */
-#endif
-
 /*
  * The number of times to tolerate executing `MFC0    $at, $c4`.
  * Replace $at with any register--the timeout limit is per each.
  *
- * Set to a higher value to avoid prematurely quitting the interpreter.
- * Set to a lower value for speed...you could get away with 10 sometimes.
+ * Polling loops simple enough to prove idle halt on their first pass (see
+ * `COP0_MF'), so this is just the backstop for the ones which are not.
  */
-extern int MF_SP_STATUS_TIMEOUT;
+#define MF_SP_STATUS_DEFAULT_TIMEOUT    32767
 
 #define SLOT_OFF    ((BASE_OFF) + 0x000)
 #define LINK_OFF    ((BASE_OFF) + 0x004)
@@ -218,7 +205,8 @@ extern void set_PC(unsigned int address);
  * RSP general-purpose registers (GPRs) are always 32-bit scalars (SRs).
  * SR_B(gpr, 0) is SR[gpr]31..24, and SR_B(gpr, 3) is SR[gpr]7..0.
  */
-#define SR_B(scalar, i)         *((unsigned char *)&(SR[scalar]) + BES(i))
+#define SR_B(scalar, i) \
+    *((unsigned char *)&(RSP_STATE.SR[scalar]) + BES(i))
 
 /*
  * Universal byte-access macro for 8-element vectors of 16-bit halfwords.
@@ -231,7 +219,8 @@ extern void set_PC(unsigned int address);
  * Either method--dynamic union reads or special aliasing--is undefined
  * behavior and will not truly be portable code anyway, so it hardly matters.
  */
-#define VR_B(vt, element)       *((unsigned char *)&(VR[vt][0]) + MES(element))
+#define VR_B(vt, element) \
+    *((unsigned char *)&(RSP_STATE.VR[vt][0]) + MES(element))
 
 /*
  * Optimized byte-access macros for the vector registers.
@@ -240,8 +229,10 @@ extern void set_PC(unsigned int address);
  * They are faster because LEA PTR [offset +/- 1] means fewer CPU
  * instructions generated than (offset ^ 1) does, in most cases.
  */
-#define VR_A(vt, e)             *((unsigned char *)&(VR[vt][0]) + e + MES(0))
-#define VR_U(vt, e)             *((unsigned char *)&(VR[vt][0]) + e - MES(0))
+#define VR_A(vt, e) \
+    *((unsigned char *)&(RSP_STATE.VR[vt][0]) + e + MES(0))
+#define VR_U(vt, e) \
+    *((unsigned char *)&(RSP_STATE.VR[vt][0]) + e - MES(0))
 
 /*
  * Use this ONLY if you know the element is even, not odd.
@@ -249,7 +240,8 @@ extern void set_PC(unsigned int address);
  * This is only provided for purposes of consistency with VR_B() and friends.
  * Saying `VR[vt][1] = x;` instead of `VR_S(vt, 2) = x` works as well.
  */
-#define VR_S(vt, element)       *(pi16)((unsigned char *)&(VR[vt][0]) + element)
+#define VR_S(vt, element) \
+    *(pi16)((unsigned char *)&(RSP_STATE.VR[vt][0]) + element)
 
 /*** Scalar, Coprocessor Operations (system control) ***/
 #define SP_STATUS_HALT          (0x00000001ul <<  0)
@@ -268,7 +260,7 @@ extern void set_PC(unsigned int address);
 #define SP_STATUS_SIG6          (0x00000001ul << 13)
 #define SP_STATUS_SIG7          (0x00000001ul << 14)
 
-enum {
+typedef enum {
     RCP_SP_MEM_ADDR_REG,
     RCP_SP_DRAM_ADDR_REG,
     RCP_SP_RD_LEN_REG,
@@ -289,7 +281,6 @@ enum {
 
     NUMBER_OF_CP0_REGISTERS
 } CPR_specifier;
-extern pu32 CR[];
 
 extern void SP_DMA_READ(void);
 extern void SP_DMA_WRITE(void);
@@ -337,6 +328,109 @@ typedef void(*mwc2_func)(
 extern mwc2_func LWC2[2 * 8*2];
 extern mwc2_func SWC2[2 * 8*2];
 
+typedef VECTOR_OPERATION(*p_vector_func)(v16, v16);
+
+/*
+ * which handler an instruction was decoded to, for threaded dispatch
+ */
+typedef enum {
+    OP_res_IW,
+    OP_SLL,
+    OP_SRL,
+    OP_SRA,
+    OP_SLLV,
+    OP_SRLV,
+    OP_SRAV,
+    OP_JR,
+    OP_JALR,
+    OP_BREAK,
+    OP_ADDU,
+    OP_SUBU,
+    OP_SPECIAL_AND,
+    OP_SPECIAL_OR,
+    OP_SPECIAL_XOR,
+    OP_NOR,
+    OP_SLT,
+    OP_SLTU,
+    OP_BLTZ,
+    OP_BGEZ,
+    OP_BLTZAL,
+    OP_BGEZAL,
+    OP_res_REGIMM,
+    OP_J,
+    OP_JAL,
+    OP_BEQ,
+    OP_BNE,
+    OP_BLEZ,
+    OP_BGTZ,
+    OP_ADDIU,
+    OP_SLTI,
+    OP_SLTIU,
+    OP_ANDI,
+    OP_ORI,
+    OP_XORI,
+    OP_LUI,
+    OP_COP0_MF,
+    OP_COP0_MT,
+    OP_COP0_res,
+    OP_COP2_MF,
+    OP_COP2_CF,
+    OP_COP2_MT,
+    OP_COP2_CT,
+    OP_COP2_V,
+    OP_COP2_fused,
+    OP_LB,
+    OP_LH,
+    OP_LW,
+    OP_LBU,
+    OP_LHU,
+    OP_SB,
+    OP_SH,
+    OP_SW,
+    OP_MWC2_load,
+    OP_MWC2_store,
+
+    NUMBER_OF_OP_KINDS
+} op_kind;
+
+/*
+ * one instruction word from IMEM, decoded ahead of time for the interpreter
+ *
+ * The handler returns 0 to step to the next instruction, +1 when it has
+ * scheduled a jump (taken branch) with `set_PC', or -1 to halt the RSP.
+ * The first op of a fused idiom returns +2, having done the `imm / 4' ops
+ * after it as well, for the interpreter to step over.
+ */
+typedef struct decoded_op decoded_op;
+typedef int(*op_handler)(const decoded_op * op, u32 PC);
+struct decoded_op {
+    op_handler handler;
+    union {
+        p_C2_entry vector; /* COP2 computational operation (by func, element) */
+        mwc2_func transfer; /* LWC2 or SWC2 operation (by rd) */
+        void (*CP0_MT)(unsigned int rt); /* MTC0 to the register at rd */
+    } fn;
+    u32 word; /* raw instruction word, as last seen in IMEM */
+    s32 imm; /* extended immediate, or pre-scaled branch/jump/MWC2 offset */
+    unsigned char rs, rt, rd, sa; /* MWC2 and C2 moves keep `element' in sa */
+    unsigned char kind; /* op_kind of `handler' */
+    unsigned char dead; /* VU_* state written here, then unread (vector ops) */
+    unsigned char fused; /* idiom starting here, for `COP2_fused' (or 0) */
+};
+
+/*
+ * the decoded IMEM of `RSP_state', which InitiateRSP() points it to
+ */
+extern decoded_op RSP_state_IMEM_decoded[4096 / 4];
+
+/*
+ * The decoded-instruction cache must be kept coherent with IMEM:
+ * predecode_IMEM() after any write we do to IMEM ourselves (SP DMA), and
+ * validate_IMEM() before running a task the CPU host might have changed.
+ */
+extern void predecode_IMEM(unsigned int start, unsigned int length);
+extern void validate_IMEM(void);
+
 extern void res_lsw(
     unsigned int vt,
     unsigned int element,
@@ -381,6 +475,26 @@ extern void LRV(unsigned vt, unsigned element, signed offset, unsigned base);
 extern void SQV(unsigned vt, unsigned element, signed offset, unsigned base);
 extern void SRV(unsigned vt, unsigned element, signed offset, unsigned base);
 
+#ifdef HAVE_SIMD_DISPATCH
+/*
+ * the same with SSSE3 byte shuffles, and LDV, SDV and the Group II and III
+ * transfers (but LFV, which is not implemented) too
+ */
+extern void LDV_SSSE3(unsigned vt, unsigned e, signed offset, unsigned base);
+extern void SDV_SSSE3(unsigned vt, unsigned e, signed offset, unsigned base);
+extern void LQV_SSSE3(unsigned vt, unsigned e, signed offset, unsigned base);
+extern void LRV_SSSE3(unsigned vt, unsigned e, signed offset, unsigned base);
+extern void SQV_SSSE3(unsigned vt, unsigned e, signed offset, unsigned base);
+extern void SRV_SSSE3(unsigned vt, unsigned e, signed offset, unsigned base);
+extern void LPV_SSSE3(unsigned vt, unsigned e, signed offset, unsigned base);
+extern void LUV_SSSE3(unsigned vt, unsigned e, signed offset, unsigned base);
+extern void SPV_SSSE3(unsigned vt, unsigned e, signed offset, unsigned base);
+extern void SUV_SSSE3(unsigned vt, unsigned e, signed offset, unsigned base);
+extern void LHV_SSSE3(unsigned vt, unsigned e, signed offset, unsigned base);
+extern void SHV_SSSE3(unsigned vt, unsigned e, signed offset, unsigned base);
+extern void SFV_SSSE3(unsigned vt, unsigned e, signed offset, unsigned base);
+#endif
+
 /*
  * Group V vector loads and stores
  * TV and SWV (As of RCP implementation, LTWV opcode was undesired.)
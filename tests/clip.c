@@ -0,0 +1,275 @@
+/******************************************************************************\
+* Project:  Equivalence Test of the Clip Tests (VCL, VCH, VCR)                 *
+* Authors:  agent                                                              *
+* Release:  2026.10.18                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+/*
+ * Runs the scalar clip tests (do_cl, do_ch, do_cr) and, in SSE2 builds, the
+ * SSE2 and SSE4.1 kernels against a model written one element at a time
+ * from the RSP's documented behavior, on random operands (weighted toward
+ * the edge values) and random $vco, $vcc and $vce.  The result, VACC_L and
+ * all five flag registers have to match the model's.
+ *
+ * From the top of the source tree:
+ *   $ cc -O2 -msse2 -DARCH_MIN_SSE2 -o clip tests/clip.c
+ *   $ ./clip
+ *
+ * The exit status is the number of versions with any mismatch.
+ */
+
+#include "../lto.c"
+
+#define ROUNDS          1000000
+
+static u32 seed = 1;
+
+static u16 random_half(void)
+{
+    static const u16 edges[] = {
+        0x0000, 0x0001, 0x0002, 0x7FFE, 0x7FFF, 0x8000, 0x8001, 0xFFFE, 0xFFFF
+    };
+
+    seed = 1103515245 * seed + 12345;
+    if ((seed >> 28) < 4)
+        return edges[(seed >> 16) % (sizeof(edges) / sizeof(edges[0]))];
+    seed = 1103515245 * seed + 12345;
+    return (u16)(seed >> 15);
+}
+
+/*
+ * the flags as booleans, in the order of `flag_registers' below
+ */
+enum { FLAG_NE, FLAG_CO, FLAG_CLIP, FLAG_COMP, FLAG_VCE, NUMBER_OF_FLAGS };
+
+typedef struct {
+    i16 vd[N];
+    i16 acc[N];
+    int flags[NUMBER_OF_FLAGS][N];
+} clip_state;
+
+static void model_VCL(clip_state * out, const i16 * vs, const i16 * vt)
+{
+    register unsigned int i;
+
+    for (i = 0; i < N; i++) {
+        const u16 s = (u16)vs[i], t = (u16)vt[i];
+        const int ne = out -> flags[FLAG_NE][i];
+        const int vce = out -> flags[FLAG_VCE][i];
+
+        if (out -> flags[FLAG_CO][i]) {
+            if (ne == 0) {
+                const u32 sum = (u32)s + (u32)t;
+                const int zero = (sum & 0xFFFF) == 0, carry = (sum > 0xFFFF);
+
+                out -> flags[FLAG_COMP][i] = vce ? (zero || !carry)
+                                            : (zero && !carry);
+            }
+            out -> acc[i] = out -> flags[FLAG_COMP][i] ? (i16)-t : (i16)s;
+        } else {
+            if (ne == 0)
+                out -> flags[FLAG_CLIP][i] = ((s32)s - (s32)t >= 0);
+            out -> acc[i] = out -> flags[FLAG_CLIP][i] ? (i16)t : (i16)s;
+        }
+        out -> flags[FLAG_NE][i] = 0;
+        out -> flags[FLAG_CO][i] = 0;
+        out -> flags[FLAG_VCE][i] = 0;
+        out -> vd[i] = out -> acc[i];
+    }
+}
+
+static void model_VCH(clip_state * out, const i16 * vs, const i16 * vt)
+{
+    register unsigned int i;
+
+    for (i = 0; i < N; i++) {
+        const s32 s = vs[i], t = vt[i];
+        const int ne = ((u16)s != ((u16)t ^ 0xFFFF));
+
+        if ((s ^ t) < 0) {
+            const s32 sum = s + t;
+
+            out -> flags[FLAG_COMP][i] = (sum <= 0);
+            out -> flags[FLAG_CLIP][i] = (t < 0);
+            out -> flags[FLAG_CO][i] = 1;
+            out -> flags[FLAG_NE][i] = (sum != 0 && ne);
+            out -> flags[FLAG_VCE][i] = (sum == -1);
+            out -> acc[i] = (sum <= 0) ? (i16)-t : (i16)s;
+        } else {
+            const s32 diff = s - t;
+
+            out -> flags[FLAG_COMP][i] = (t < 0);
+            out -> flags[FLAG_CLIP][i] = (diff >= 0);
+            out -> flags[FLAG_CO][i] = 0;
+            out -> flags[FLAG_NE][i] = (diff != 0 && ne);
+            out -> flags[FLAG_VCE][i] = 0;
+            out -> acc[i] = (diff >= 0) ? (i16)t : (i16)s;
+        }
+        out -> vd[i] = out -> acc[i];
+    }
+}
+
+static void model_VCR(clip_state * out, const i16 * vs, const i16 * vt)
+{
+    register unsigned int i;
+
+    for (i = 0; i < N; i++) {
+        const s32 s = vs[i], t = vt[i];
+
+        if ((s ^ t) < 0) {
+            out -> flags[FLAG_COMP][i] = (s + t + 1 <= 0);
+            out -> flags[FLAG_CLIP][i] = (t < 0);
+            out -> acc[i] = out -> flags[FLAG_COMP][i] ? (i16)~t : (i16)s;
+        } else {
+            out -> flags[FLAG_COMP][i] = (t < 0);
+            out -> flags[FLAG_CLIP][i] = (s - t >= 0);
+            out -> acc[i] = out -> flags[FLAG_CLIP][i] ? (i16)t : (i16)s;
+        }
+        out -> flags[FLAG_NE][i] = 0;
+        out -> flags[FLAG_CO][i] = 0;
+        out -> flags[FLAG_VCE][i] = 0;
+        out -> vd[i] = out -> acc[i];
+    }
+}
+
+typedef void(*p_model)(clip_state * out, const i16 * vs, const i16 * vt);
+static const p_model models[3] = { model_VCL, model_VCH, model_VCR };
+static const char * const names[3] = { "VCL", "VCH", "VCR" };
+
+static void set_flags(const clip_state * in)
+{
+    pi16 flag_registers[NUMBER_OF_FLAGS];
+    register unsigned int f, i;
+
+    flag_registers[FLAG_NE] = RSP_STATE.cf_ne;
+    flag_registers[FLAG_CO] = RSP_STATE.cf_co;
+    flag_registers[FLAG_CLIP] = RSP_STATE.cf_clip;
+    flag_registers[FLAG_COMP] = RSP_STATE.cf_comp;
+    flag_registers[FLAG_VCE] = RSP_STATE.cf_vce;
+    for (f = 0; f < NUMBER_OF_FLAGS; f++)
+        for (i = 0; i < N; i++)
+            flag_registers[f][i] = in -> flags[f][i] ? ~0 : 0;
+    for (i = 0; i < N; i++)
+        VACC_L[i] = 0x5555; /* to catch an op that does not write VACC_L */
+}
+
+static int same_as_model(const clip_state * model, const i16 * vd)
+{
+    pi16 flag_registers[NUMBER_OF_FLAGS];
+    register unsigned int f, i;
+
+    flag_registers[FLAG_NE] = RSP_STATE.cf_ne;
+    flag_registers[FLAG_CO] = RSP_STATE.cf_co;
+    flag_registers[FLAG_CLIP] = RSP_STATE.cf_clip;
+    flag_registers[FLAG_COMP] = RSP_STATE.cf_comp;
+    flag_registers[FLAG_VCE] = RSP_STATE.cf_vce;
+    for (i = 0; i < N; i++) {
+        if (vd[i] != model -> vd[i] || VACC_L[i] != model -> acc[i])
+            return 0;
+        for (f = 0; f < NUMBER_OF_FLAGS; f++)
+            if (flag_registers[f][i] != (model -> flags[f][i] ? ~0 : 0))
+                return 0;
+    }
+    return 1;
+}
+
+/*
+ * the versions under test:  0 for the scalar ones, 1 for SSE2, 2 for SSE4.1
+ */
+#define VERSIONS        3
+static const char * const versions[VERSIONS] = { "C", "SSE2", "SSE4.1" };
+
+static void run_version(int version, int op, pi16 vd, pi16 vs, pi16 vt)
+{
+    switch (version) {
+    case 0:
+        switch (op) {
+        case 0:  do_cl(vd, vs, vt); break;
+        case 1:  do_ch(vd, vs, vt); break;
+        default: do_cr(vd, vs, vt); break;
+        }
+        return;
+#ifdef ARCH_MIN_SSE2
+    case 1:
+        switch (op) {
+        case 0:  *(v16 *)vd = VCL(*(v16 *)vs, *(v16 *)vt); break;
+        case 1:  *(v16 *)vd = VCH(*(v16 *)vs, *(v16 *)vt); break;
+        default: *(v16 *)vd = VCR(*(v16 *)vs, *(v16 *)vt); break;
+        }
+        return;
+#endif
+#ifdef HAVE_SIMD_DISPATCH
+    case 2:
+        switch (op) {
+        case 0:  *(v16 *)vd = VCL_SSE4_1(*(v16 *)vs, *(v16 *)vt); break;
+        case 1:  *(v16 *)vd = VCH_SSE4_1(*(v16 *)vs, *(v16 *)vt); break;
+        default: *(v16 *)vd = VCR_SSE4_1(*(v16 *)vs, *(v16 *)vt); break;
+        }
+        return;
+#endif
+    }
+}
+
+int main(void)
+{
+    ALIGNED i16 vs[N], vt[N], vd[N];
+    clip_state before, model;
+    long mismatches[VERSIONS][3];
+    int available[VERSIONS];
+    register unsigned int f, i;
+    long round;
+    int version, op, failures;
+
+    available[0] = 1;
+#ifdef ARCH_MIN_SSE2
+    available[1] = 1;
+#else
+    available[1] = 0;
+#endif
+    available[2] = (detect_SIMD() >= SIMD_SSE4_1);
+    memset(mismatches, 0, sizeof(mismatches));
+
+    for (round = 0; round < ROUNDS; round++) {
+        for (i = 0; i < N; i++) {
+            vs[i] = (i16)random_half();
+            vt[i] = (i16)random_half();
+            for (f = 0; f < NUMBER_OF_FLAGS; f++)
+                before.flags[f][i] = random_half() & 1;
+        }
+        for (op = 0; op < 3; op++) {
+            model = before;
+            models[op](&model, vs, vt);
+            for (version = 0; version < VERSIONS; version++) {
+                if (!available[version])
+                    continue;
+                set_flags(&before);
+                run_version(version, op, vd, vs, vt);
+                if (same_as_model(&model, vd))
+                    continue;
+                if (mismatches[version][op]++ < 4)
+                    fprintf(stderr, "%s (%s):  round %li\n",
+                        names[op], versions[version], round);
+            }
+        }
+    }
+
+    failures = 0;
+    for (version = 0; version < VERSIONS; version++)
+        for (op = 0; op < 3; op++) {
+            if (!available[version])
+                continue;
+            printf("%s (%s):  %s\n", names[op], versions[version],
+                mismatches[version][op] ? "MISMATCH" : "ok");
+            failures += (mismatches[version][op] != 0);
+        }
+    return (failures);
+}
@@ -0,0 +1,196 @@
+/******************************************************************************\
+* Project:  Differential Test of the JPEG Task HLE                             *
+* Authors:  agent                                                              *
+* Release:  2026.10.18                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+/*
+ * Runs one real M_NJPEGTASK twice from the same state:  once on the RSP, its
+ * micro-code interpreted through DoRspCycles() the way LLE always does, and
+ * once through the decoder in `jpeg.c'.  The macroblocks the task names have
+ * to come out the same, byte for byte.
+ *
+ * The state is two dumps taken as the CPU starts the task, both in the N64's
+ * byte order:  all of RDRAM (4 or 8 MiB), and DMEM with the OSTask at 0xFC0
+ * (what DllConfig() exports as `rcpcache.dhex').  IMEM is loaded with the
+ * task's boot code, from the OSTask, as the CPU would have.
+ *
+ * From the top of the source tree:
+ *   $ cc -O2 -msse2 -DARCH_MIN_SSE2 -o jpeg tests/jpeg.c
+ *   $ ./jpeg rdram.bin rcpcache.dhex
+ *
+ * The exit status is 0 if the two agree, 1 if they don't, and 2 if the task
+ * could not be run both ways.
+ */
+
+#include "../lto.c"
+
+static u32 registers[18];
+static u8 DMEM_image[4096];
+static pu8 RDRAM_image;
+static pu8 RDRAM_after_LLE;
+static u32 RDRAM_bytes;
+
+static void no_RCP(void)
+{
+    return;
+}
+
+static u32 read_dump(const char * name, pu8 * dump, u32 limit)
+{
+    FILE * stream;
+    long length;
+
+    stream = fopen(name, "rb");
+    if (stream == NULL)
+        return 0;
+    fseek(stream, 0, SEEK_END);
+    length = ftell(stream);
+    fseek(stream, 0, SEEK_SET);
+    if (length <= 0 || (unsigned long)length > limit) {
+        fclose(stream);
+        return 0;
+    }
+    if (*dump == NULL)
+        *dump = malloc((size_t)length);
+    if (*dump == NULL)
+        length = 0;
+    else if (fread(*dump, 1, (size_t)length, stream) != (size_t)length)
+        length = 0;
+    fclose(stream);
+    return (u32)length;
+}
+
+/*
+ * RDRAM and DMEM as in the dumps, IMEM as the CPU would have loaded it for
+ * the task, and the SP registers as the CPU leaves them to start it
+ */
+static void load_state(void)
+{
+    u32 boot, boot_size;
+    register u32 i;
+
+    for (i = 0; i < RDRAM_bytes; i++)
+        RSP_STATE.DRAM[BES(i)] = RDRAM_image[i];
+    for (i = 0; i < 4096; i++)
+        RSP_STATE.DMEM[BES(i)] = DMEM_image[i];
+
+    boot      = *(pu32)(RSP_STATE.DMEM + OSTASK_UCODE_BOOT) & 0x00FFFFFFul;
+    boot_size = *(pu32)(RSP_STATE.DMEM + OSTASK_UCODE_BOOT_SIZE);
+    if (boot_size > 4096)
+        boot_size = 4096;
+    memset(RSP_STATE.IMEM, 0, 4096);
+    for (i = 0; i < boot_size && boot + i < RDRAM_bytes; i++)
+        RSP_STATE.IMEM[BES(i)] = RDRAM_image[boot + i];
+
+    memset(registers, 0, sizeof(registers));
+    return;
+}
+
+int main(int argc, char ** argv)
+{
+    RSP_INFO info;
+    JPEG_task task;
+    static ALIGNED u8 SP_memory[2][4096];
+    pu8 image;
+    u32 end, first, mismatches;
+    register u32 i;
+    JPEG_format format;
+
+    if (argc < 3) {
+        fprintf(stderr, "usage:  %s RDRAM-dump DMEM-dump\n", argv[0]);
+        return 2;
+    }
+    RDRAM_bytes = read_dump(argv[1], &RDRAM_image, 0x00800000ul);
+    image = DMEM_image;
+    if (RDRAM_bytes == 0 || read_dump(argv[2], &image, 4096) != 4096) {
+        fprintf(stderr, "Could not read the RDRAM and DMEM dumps.\n");
+        return 2;
+    }
+    if (RDRAM_bytes & (RDRAM_bytes - 1)) {
+        fprintf(stderr, "RDRAM dump is %lu bytes, not 4 or 8 MiB.\n",
+            (unsigned long)RDRAM_bytes);
+        return 2;
+    }
+
+    memset(&info, 0, sizeof(info));
+    info.RDRAM = calloc(RDRAM_bytes, 1);
+    RDRAM_after_LLE = malloc(RDRAM_bytes);
+    if (info.RDRAM == NULL || RDRAM_after_LLE == NULL)
+        return 2;
+    info.DMEM = SP_memory[0];
+    info.IMEM = SP_memory[1];
+    for (i = 0; i < 18; i++) /* MI_INTR_REG, the SP and then the DP ones */
+        (&info.MI_INTR_REG)[i] = &registers[i];
+    info.CheckInterrupts = no_RCP;
+    info.ProcessRdpList = no_RCP;
+    InitiateRSP(info, NULL);
+    RSP_STATE.su_max_address = RDRAM_bytes - 1;
+
+    load_state();
+    if (*(pu32)(RSP_STATE.DMEM + OSTASK_TYPE) != M_NJPEGTASK) {
+        fprintf(stderr, "The OSTask in DMEM is not a JPEG task.\n");
+        return 2;
+    }
+    identify_ucode(M_NJPEGTASK);
+    format = (JPEG_format)RSP_STATE.current_ucode -> JPEG_format;
+    if (format == JPEG_FORMAT_NONE || !read_task(&task)) {
+        fprintf(stderr, "No HLE for this task (micro-code text sum %05lX).\n",
+            (unsigned long)RSP_STATE.current_ucode -> text_sum);
+        return 2;
+    }
+
+    CFG_HLE_JPG = 0;
+    DoRspCycles(0xFFFFFFFFul);
+    if (!(*info.SP_STATUS_REG & SP_STATUS_BROKE)) {
+        fprintf(stderr, "The micro-code did not run to BREAK.\n");
+        return 2;
+    }
+    memcpy(RDRAM_after_LLE, RSP_STATE.DRAM, RDRAM_bytes);
+
+    load_state();
+    decode_macroblocks(format, &task);
+
+    end = task.address + task.count * task.size;
+    first = end;
+    mismatches = 0;
+    for (i = task.address; i < end; i++) {
+        if (RSP_STATE.DRAM[i] == RDRAM_after_LLE[i])
+            continue;
+        if (first == end)
+            first = i;
+        ++mismatches;
+    }
+    printf("%lu macroblocks in %s mode %lu at 0x%06lX:  ",
+        (unsigned long)task.count,
+        (format == JPEG_FORMAT_YUV) ? "UYVY" : "RGBA 5551",
+        (unsigned long)task.mode, (unsigned long)task.address);
+    if (mismatches == 0) {
+        printf("bit-exact\n");
+        return 0;
+    }
+    printf("%lu bytes differ, the first in macroblock %lu\n",
+        (unsigned long)mismatches,
+        (unsigned long)((first - task.address) / task.size));
+    first = (first - task.address) & ~0x1Ful;
+    printf("LLE:  ");
+    for (i = 0; i < 32; i += 2)
+        printf("%04X%c",
+            *(pu16)(RDRAM_after_LLE + HES(task.address + first + i)),
+            (i == 30) ? '\n' : ' ');
+    printf("HLE:  ");
+    for (i = 0; i < 32; i += 2)
+        printf("%04X%c",
+            *(pu16)(RSP_STATE.DRAM + HES(task.address + first + i)),
+            (i == 30) ? '\n' : ' ');
+    return 1;
+}
@@ -0,0 +1,179 @@
+/******************************************************************************\
+* Project:  Benchmark of the Vector Op Kernels by SIMD Level                   *
+* Authors:  agent                                                              *
+* Release:  2026.10.18                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+/*
+ * Times the multiplies, the multiply-accumulates and the adds, each through
+ * `COP2_C2_entries' the way the interpreter calls them, with the kernels
+ * select_SIMD_kernels() installs for every SIMD level up to what this CPU
+ * has.  A kernel goes in `C2_kernels' (simd.c) only if it beats the SSE2
+ * one here; where a level adds no kernel for an op, its column shows the
+ * same code as the level before.
+ *
+ * Each level must also leave the same vector registers, accumulator and
+ * flags as the first, from the same random start.
+ *
+ * From the top of the source tree:
+ *   $ cc -O2 -msse2 -DARCH_MIN_SSE2 -o kernels tests/kernels.c
+ *   $ ./kernels
+ *
+ * It prints nanoseconds per op, the best of four runs.  The exit status is
+ * the number of levels whose results differ from the first's.
+ */
+
+#include <time.h>
+
+#include "../lto.c"
+
+#define CALLS           2000000ul
+#define RUNS            4
+
+static const struct {
+    const char * name;
+    unsigned int func;
+} ops[] = {
+    { "VMULF", 000 }, { "VMUDL", 004 }, { "VMUDM", 005 },
+    { "VMUDN", 006 }, { "VMUDH", 007 },
+    { "VMACF", 010 }, { "VMADL", 014 }, { "VMADM", 015 },
+    { "VMADN", 016 }, { "VMADH", 017 },
+    { "VADD",  020 }, { "VSUB",  021 }, { "VADDC", 024 }, { "VSUBC", 025 },
+};
+#define NUMBER_OF_OPS   (sizeof(ops) / sizeof(ops[0]))
+
+static const char * const level_names[NUMBER_OF_SIMD_LEVELS] = {
+    "base", "SSE2", "SSSE3", "SSE4.1", "AVX2" /* "base":  no dispatch */
+};
+
+static u32 seed;
+
+static void random_state(void)
+{
+    register unsigned int i, j;
+
+    seed = 1;
+    for (i = 0; i < 32; i++)
+        for (j = 0; j < N; j++) {
+            seed = 1103515245 * seed + 12345;
+            RSP_STATE.VR[i][j] = (i16)(seed >> 15);
+        }
+    for (j = 0; j < N; j++) {
+        VACC_L[j] = 0;
+        VACC_M[j] = 0;
+        VACC_H[j] = 0;
+        RSP_STATE.cf_ne[j] = RSP_STATE.cf_co[j] = 0;
+    }
+}
+
+/*
+ * $v3 = op($v1, $v2), then $v1 = op($v3, $v2):  Each call waits on the one
+ * before, through $v1 and $v3 and, for the accumulating ops, VACC.
+ */
+static double time_op(unsigned int func)
+{
+    const p_C2_entry entry = COP2_C2_entries[func][0];
+    double best, seconds;
+    clock_t start;
+    register unsigned long i;
+    register unsigned int run;
+
+    best = 0;
+    for (run = 0; run < RUNS; run++) {
+        random_state();
+        start = clock();
+        for (i = 0; i < CALLS / 2; i++) {
+            entry(3, 1, 2);
+            entry(1, 3, 2);
+        }
+        seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        if (run == 0 || seconds < best)
+            best = seconds;
+    }
+    return (best * 1e9 / CALLS);
+}
+
+/*
+ * a few thousand of every op in turn, for comparing the levels' results
+ */
+static void mix_ops(void)
+{
+    register unsigned int i, k;
+
+    random_state();
+    for (i = 0; i < 4096; i++)
+        for (k = 0; k < NUMBER_OF_OPS; k++)
+            COP2_C2_entries[ops[k].func][i % 16](
+                (i + k) % 32, (i + 3*k + 1) % 32, (i + 5*k + 2) % 32);
+}
+
+typedef struct {
+    i16 VR[32][N];
+    i16 VACC[3][N];
+    i16 cf_ne[N], cf_co[N];
+} vector_state;
+
+static void save_state(vector_state * state)
+{
+    register unsigned int i, j;
+
+    for (i = 0; i < 32; i++)
+        for (j = 0; j < N; j++)
+            state -> VR[i][j] = RSP_STATE.VR[i][j];
+    for (j = 0; j < N; j++) {
+        state -> VACC[0][j] = VACC_L[j];
+        state -> VACC[1][j] = VACC_M[j];
+        state -> VACC[2][j] = VACC_H[j];
+        state -> cf_ne[j] = RSP_STATE.cf_ne[j];
+        state -> cf_co[j] = RSP_STATE.cf_co[j];
+    }
+}
+
+int main(void)
+{
+    static double ns[NUMBER_OF_SIMD_LEVELS][NUMBER_OF_OPS];
+    static vector_state first, state;
+    SIMD_level host, lowest, level;
+    unsigned int failures;
+    register unsigned int k;
+
+    host = detect_SIMD();
+    lowest = (host == SIMD_NONE) ? SIMD_NONE : SIMD_SSE2;
+    failures = 0;
+    for (level = lowest; level <= host; level++) {
+        select_SIMD_kernels(level);
+        for (k = 0; k < NUMBER_OF_OPS; k++)
+            ns[level][k] = time_op(ops[k].func);
+
+        mix_ops();
+        save_state(&state);
+        if (level == lowest)
+            first = state;
+        else if (memcmp(&state, &first, sizeof(state)) != 0) {
+            printf("%s kernels differ from %s in their results.\n",
+                level_names[level], level_names[lowest]);
+            ++failures;
+        }
+    }
+
+    printf("op    ");
+    for (level = lowest; level <= host; level++)
+        printf("%8s", level_names[level]);
+    printf("  (ns)\n");
+    for (k = 0; k < NUMBER_OF_OPS; k++) {
+        printf("%-6s", ops[k].name);
+        for (level = lowest; level <= host; level++)
+            printf("%8.2f", ns[level][k]);
+        printf("\n");
+    }
+    return (failures);
+}
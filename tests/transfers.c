@@ -0,0 +1,167 @@
+/******************************************************************************\
+* Project:  Equivalence Test of the SIMD Vector Transfers                      *
+* Authors:  agent                                                              *
+* Release:  2026.10.18                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+/*
+ * Runs every SSSE3 LWC2/SWC2 kernel and the SSE2 STV next to the plain C
+ * transfer it replaces, for every DMEM address and every element, from the
+ * same random VR file and DMEM, with DMEM both 16-byte aligned and not, and
+ * compares the whole VR file and DMEM afterwards.
+ *
+ * From the top of the source tree, on an x86 host:
+ *   $ cc -O2 -msse2 -DARCH_MIN_SSE2 -o transfers tests/transfers.c
+ *   $ ./transfers
+ *
+ * The exit status is the number of kernels with any mismatch.
+ */
+
+#include "../lto.c"
+
+#ifdef HAVE_SIMD_DISPATCH
+static u32 seed = 1;
+
+static u8 random_byte(void)
+{
+    seed = 1103515245 * seed + 12345;
+    return (u8)(seed >> 16);
+}
+
+/*
+ * STV before it gathered its halfwords in a register (the #else case of it)
+ */
+static void STV_C(unsigned vt, unsigned element, signed offset, unsigned base)
+{
+    register u32 addr;
+    register unsigned int i;
+    const unsigned int e = element;
+
+    if (e & 1)
+        return;
+    if (vt & 07)
+        return;
+    addr = (RSP_STATE.SR[base] + 16*offset) & 0x00000FFF;
+    if (addr & 0x0000000F)
+        return;
+    for (i = 0; i < 8; i++)
+        *(pi16)(RSP_STATE.DMEM + addr + HES(2*i)) =
+            RSP_STATE.VR[vt + (e/2 + i) % 8][i];
+    return;
+}
+
+static const struct {
+    const char * name;
+    mwc2_func C, SIMD;
+} transfers[] = {
+    { "LDV", LDV, LDV_SSSE3 },
+    { "SDV", SDV, SDV_SSSE3 },
+    { "LQV", LQV, LQV_SSSE3 },
+    { "LRV", LRV, LRV_SSSE3 },
+    { "SQV", SQV, SQV_SSSE3 },
+    { "SRV", SRV, SRV_SSSE3 },
+    { "LPV", LPV, LPV_SSSE3 },
+    { "LUV", LUV, LUV_SSSE3 },
+    { "SPV", SPV, SPV_SSSE3 },
+    { "SUV", SUV, SUV_SSSE3 },
+    { "LHV", LHV, LHV_SSSE3 },
+    { "SHV", SHV, SHV_SSSE3 },
+    { "SFV", SFV, SFV_SSSE3 },
+    { "STV", STV_C, STV },
+};
+
+static ALIGNED u8 DMEM_space[4096 + 16];
+static u8 DMEM_before[4096], DMEM_after_C[4096];
+static ALIGNED i16 VR_before[32][N << VR_STATIC_WRAPAROUND];
+static ALIGNED i16 VR_after_C[32][N << VR_STATIC_WRAPAROUND];
+
+/*
+ * With VR_STATIC_WRAPAROUND, a load past the end of a vector register may
+ * leave bytes in the spare half after it, which the stores overwrite before
+ * they read it.
+ */
+static int same_vectors(void)
+{
+    register unsigned int i;
+
+    for (i = 0; i < 32; i++)
+        if (memcmp(RSP_STATE.VR[i], VR_after_C[i], N * sizeof(i16)) != 0)
+            return 0;
+    return 1;
+}
+
+static int test_transfer(unsigned int t, unsigned int misalignment)
+{
+    register unsigned int addr, e, i;
+    unsigned int vt;
+    long mismatches;
+
+    RSP_STATE.DMEM = DMEM_space + misalignment;
+    mismatches = 0;
+    for (addr = 0; addr < 4096; addr++) {
+        for (i = 0; i < 4096; i++)
+            DMEM_before[i] = random_byte();
+        for (e = 0; e < 16; e++) {
+            for (i = 0; i < sizeof(VR_before); i++)
+                ((u8 *)VR_before)[i] = random_byte();
+            vt = random_byte() % 32;
+            if (transfers[t].SIMD == STV)
+                vt &= 030; /* or nothing to compare */
+
+            RSP_STATE.SR[1] = addr;
+            memcpy(RSP_STATE.DMEM, DMEM_before, 4096);
+            memcpy(RSP_STATE.VR, VR_before, sizeof(RSP_STATE.VR));
+            transfers[t].C(vt, e, 0, 1);
+            memcpy(DMEM_after_C, RSP_STATE.DMEM, 4096);
+            memcpy(VR_after_C, RSP_STATE.VR, sizeof(RSP_STATE.VR));
+
+            memcpy(RSP_STATE.DMEM, DMEM_before, 4096);
+            memcpy(RSP_STATE.VR, VR_before, sizeof(RSP_STATE.VR));
+            transfers[t].SIMD(vt, e, 0, 1);
+            if (memcmp(RSP_STATE.DMEM, DMEM_after_C, 4096) == 0)
+                if (same_vectors())
+                    continue;
+            if (mismatches++ < 4)
+                fprintf(stderr, "%s:  $v%u[%u], 0x%03X (DMEM + %u)\n",
+                    transfers[t].name, vt, e, addr, misalignment);
+        }
+    }
+    return (mismatches != 0);
+}
+
+int main(void)
+{
+    unsigned int t;
+    int failures;
+
+    if (detect_SIMD() < SIMD_SSSE3) {
+        printf("This CPU does not have SSSE3; nothing to test.\n");
+        return 0;
+    }
+    failures = 0;
+    for (t = 0; t < sizeof(transfers) / sizeof(transfers[0]); t++) {
+        int failed;
+
+        failed  = test_transfer(t, 0);
+        failed |= test_transfer(t, 4);
+        printf("%s:  %s\n", transfers[t].name, failed ? "MISMATCH" : "ok");
+        failures += failed;
+    }
+    return (failures);
+}
+#else
+int main(void)
+{
+    printf("Build with -DARCH_MIN_SSE2 for x86 to test the SSSE3 kernels.\n");
+    return 0;
+}
+#endif
@@ -0,0 +1,156 @@
+/******************************************************************************\
+* Project:  Test of Predecoding across the End of IMEM                         *
+* Authors:  agent                                                              *
+* Release:  2026.10.18                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+/*
+ * IMEM wraps:  the delay slot of a branch or jump at 0xFFC is the op at 0x000.
+ * Each case here is a small program with a jump at 0xFFC, which predecode has
+ * to see as the end of the straight line through 0x000.  It is run through
+ * DoRspCycles() to its BREAK, with the interpreter and (where it is built)
+ * the recompiler, and must leave the expected quadword at DMEM 0x000.
+ *
+ * From the top of the source tree:
+ *   $ cc -O2 -msse2 -DARCH_MIN_SSE2 -o wrap tests/wrap.c
+ *   $ ./wrap
+ *
+ * The exit status is the number of runs with the wrong result.
+ */
+
+#include "../lto.c"
+
+#define J(target)       (0x08000000ul | ((target) >> 2))
+#define BREAK           0x0000000Dul
+#define LQV(vt, offset) (0xC8002000ul | (vt) << 16 | (offset))
+#define SQV(vt, offset) (0xE8002000ul | (vt) << 16 | (offset))
+#define VOP(func, vd, vs, vt, e) \
+    (0x4A000000ul | (e) << 21 | (vt) << 16 | (vs) << 11 | (vd) << 6 | (func))
+
+typedef struct {
+    const char * name;
+    u32 code[16][2]; /* IMEM address and word, through a 0 word */
+    u16 data[8][8]; /* DMEM quadwords from 0x000, loaded to $v0 to $v7 */
+    u16 expected[8]; /* DMEM quadword at 0x000 after the BREAK */
+} wrap_case;
+
+static const wrap_case cases[] = {
+/*
+ * VLT in the delay slot, then VMRG:  not a select idiom, for the VMRG runs
+ * only if something jumps to 0x004.  Fused, it overwrites $v4 and runs on to
+ * the BREAK at 0x008.
+ */
+    { "VLT in the delay slot at 0x000, VMRG at 0x004", {
+        { 0xFE0, LQV(2, 2) }, { 0xFE4, LQV(3, 3) },
+        { 0xFE8, LQV(4, 4) }, { 0xFEC, LQV(5, 5) },
+        { 0xFF0, LQV(6, 6) }, { 0xFFC, J(0x100) },
+        { 0x000, VOP(040, 1, 2, 3, 0) }, /* VLT  $v1, $v2, $v3 */
+        { 0x004, VOP(047, 4, 5, 6, 0) }, /* VMRG $v4, $v5, $v6 */
+        { 0x008, BREAK },
+        { 0x100, SQV(4, 0) }, { 0x104, BREAK }, { 0, 0 } }, {
+        { 0 }, { 0 },
+        { 1, 2, 3, 4, 5, 6, 7, 8 }, { 8, 7, 6, 5, 4, 3, 2, 1 },
+        { 0x4444, 0x4444, 0x4444, 0x4444, 0x4444, 0x4444, 0x4444, 0x4444 },
+        { 0x5555, 0x5555, 0x5555, 0x5555, 0x5555, 0x5555, 0x5555, 0x5555 },
+        { 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666 } },
+      { 0x4444, 0x4444, 0x4444, 0x4444, 0x4444, 0x4444, 0x4444, 0x4444 } },
+/*
+ * VMUDN in the delay slot, with another at 0x008 writing over all that it
+ * does to the accumulator:  the one at 0x000 is still live, for the jump
+ * goes to a VSAR.  Taken for dead, it leaves the 0x7777 of the VMUDN before.
+ */
+    { "VMUDN in the delay slot at 0x000, VMUDN at 0x008", {
+        { 0xFE0, LQV(2, 2) }, { 0xFE4, LQV(3, 3) },
+        { 0xFE8, LQV(4, 4) }, { 0xFEC, LQV(5, 5) },
+        { 0xFF0, VOP(006, 7, 4, 5, 0) }, /* VMUDN $v7, $v4, $v5 */
+        { 0xFFC, J(0x100) },
+        { 0x000, VOP(006, 7, 2, 3, 0) }, /* VMUDN $v7, $v2, $v3 */
+        { 0x008, VOP(006, 7, 4, 5, 0) },
+        { 0x00C, BREAK },
+        { 0x100, VOP(035, 8, 0, 0, 10) }, /* VSAR $v8, $v0, $v0[10] */
+        { 0x104, SQV(8, 0) }, { 0x108, BREAK }, { 0, 0 } }, {
+        { 0 }, { 0 },
+        { 4, 4, 4, 4, 4, 4, 4, 4 }, { 7, 7, 7, 7, 7, 7, 7, 7 },
+        { 0x7777, 0x7777, 0x7777, 0x7777, 0x7777, 0x7777, 0x7777, 0x7777 },
+        { 1, 1, 1, 1, 1, 1, 1, 1 } },
+      { 0x001C, 0x001C, 0x001C, 0x001C, 0x001C, 0x001C, 0x001C, 0x001C } },
+};
+
+static u32 registers[18];
+
+static void no_RCP(void)
+{
+    return;
+}
+
+static int run_case(const wrap_case * test)
+{
+    register unsigned int i, j;
+
+    memset(RSP_STATE.DMEM, 0, 4096);
+    memset(RSP_STATE.IMEM, 0, 4096);
+    for (i = 0; test -> code[i][1] != 0; i++)
+        *(pu32)(RSP_STATE.IMEM + test -> code[i][0]) = test -> code[i][1];
+    for (i = 0; i < 8; i++)
+        for (j = 0; j < 8; j++)
+            *(pu16)(RSP_STATE.DMEM + HES(16*i + 2*j)) = test -> data[i][j];
+    *(pu32)(RSP_STATE.DMEM + OSTASK_TYPE) = M_GFXTASK; /* no HLE:  quiet LLE */
+
+    memset(registers, 0, sizeof(registers));
+    GET_RCP_REG(SP_PC_REG) = 0x04001FE0;
+    DoRspCycles(0xFFFFFFFFul);
+
+    if (!(GET_RCP_REG(SP_STATUS_REG) & SP_STATUS_BROKE))
+        return 1;
+    for (j = 0; j < 8; j++)
+        if (*(pu16)(RSP_STATE.DMEM + HES(2*j)) != test -> expected[j])
+            return 1;
+    return 0;
+}
+
+int main(void)
+{
+    RSP_INFO info;
+    static ALIGNED u8 SP_memory[2][4096];
+    static u8 RDRAM[0x00400000];
+    unsigned int failures, recompiled, wrong;
+    register unsigned int i;
+
+    memset(&info, 0, sizeof(info));
+    info.RDRAM = RDRAM;
+    info.DMEM = SP_memory[0];
+    info.IMEM = SP_memory[1];
+    for (i = 0; i < 18; i++) /* MI_INTR_REG, the SP and then the DP ones */
+        (&info.MI_INTR_REG)[i] = &registers[i];
+    info.CheckInterrupts = no_RCP;
+    info.ProcessRdpList = no_RCP;
+    InitiateRSP(info, NULL);
+    RSP_STATE.su_max_address = sizeof(RDRAM) - 1;
+    CFG_HLE_GFX = 0;
+
+    failures = 0;
+    for (recompiled = 0; recompiled < 2; recompiled++) {
+#ifndef HAVE_DYNAREC
+        if (recompiled)
+            break;
+#endif
+        CFG_DYNAREC = recompiled;
+        for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+            wrong = run_case(&cases[i]);
+            printf("%s, %s:  %s\n", cases[i].name,
+                recompiled ? "recompiled" : "interpreted",
+                wrong ? "FAILED" : "ok");
+            failures += wrong;
+        }
+    }
+    return (failures);
+}
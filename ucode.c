@@ -0,0 +1,280 @@
+/******************************************************************************\
+* Project:  Microcode Identification by Fingerprint                            *
+* Authors:  agent                                                              *
+* Release:  2026.10.18                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+#include <string.h>
+
+#include "ucode.h"
+#include "audio.h"
+#include "jpeg.h"
+#include "su.h"
+
+/*
+ * IMEM holds at most 4 KiB of text, and no micro-code data segment has its
+ * ID string nearly as far in as 2 KiB, so that is all we need to hash.
+ */
+#define UCODE_TEXT_LIMIT    0x1000
+#define UCODE_DATA_LIMIT    0x0800
+
+ucode_registry RSP_state_ucodes;
+
+/*
+ * tuning defaults for each class of micro-code, by `ucode_class'
+ */
+static const ucode_info family_defaults[NUMBER_OF_UCODE_CLASSES] = {
+    { 0, 0, UCODE_UNKNOWN, "unknown",  0, 0, 0, 0, { 0, 0, 0, 0 } },
+    { 0, 0, UCODE_GFX,     "graphics", 1, 0, 0, 0, { 0, 0, 0, 0 } },
+    { 0, 0, UCODE_SPRITE,  "S2DEX",    1, 0, 0, 0, { 0, 0, 0, 0 } },
+    { 0, 0, UCODE_AUDIO,   "audio",    1, 0, 0, 0, { 0, 0, 0, 0 } },
+    { 0, 0, UCODE_JPEG,    "JPEG",     0, 0, 0, 0, { 0, 0, 0, 0 } },
+    { 0, 0, UCODE_HVQM,    "HVQM",     0, 0, 0, 0, { 0, 0, 0, 0 } },
+};
+
+/*
+ * Micro-codes known ahead of time, by family and by the byte sum of the
+ * first half of their text--the fingerprint other HLE plug-ins go by, so
+ * what they have learned about a micro-code carries over to this table.
+ * Whatever an entry sets here goes over its family's defaults above.
+ */
+#define KEEP    -1
+
+typedef struct {
+    ucode_class family;
+    u32 text_sum;
+    const char * name; /* if the micro-code has no ID string of its own */
+
+    signed char HLE; /* KEEP:  keep the family's */
+} known_ucode;
+
+static const known_ucode known_ucodes[] = {
+/*
+ * Twintris sends this as a graphics task, but it is not a display list
+ * micro-code, and no video plug-in can do anything with it.
+ */
+    { UCODE_GFX,  0x000212EEul, "Twintris",                   0    },
+
+    { UCODE_JPEG, 0x0002C85Aul, "Pokemon Stadium (J) JPEG",   KEEP },
+    { UCODE_JPEG, 0x0002CAA6ul, "Zelda / Pokemon JPEG",       KEEP },
+    { UCODE_JPEG, 0x000130DEul, "Ogre Battle JPEG",           KEEP },
+    { UCODE_JPEG, 0x000278B0ul, "Bottom of the 9th JPEG",     KEEP },
+};
+
+/*
+ * Nintendo's graphics micro-codes name themselves in their data segments:
+ *     "RSP Gfx ucode F3DEX       fifo 2.08  Yoshitaka Yasumoto 1999 Nintendo."
+ *     "RSP SW Version: 2.0D, 04-01-96" (the original Fast3D)
+ */
+static const char * ID_tags[] = {
+    "RSP Gfx ucode ",
+    "RSP SW Version: ",
+};
+
+/*
+ * FNV-1a, one 32-bit RDRAM word at a time
+ */
+static u32 hash_RDRAM(u32 hash, u32 address, u32 length, u32 limit)
+{
+    register u32 i;
+
+    address &= 0x00FFFFFCul;
+    if (length > limit)
+        length = limit;
+    if (length == 0 || address + length - 1 > RSP_STATE.su_max_address)
+        return (hash);
+    for (i = 0; i < length; i += 4) {
+        hash ^= *(pu32)(RSP_STATE.DRAM + address + i);
+        hash *= 16777619;
+    }
+    return (hash);
+}
+
+/*
+ * the byte sum of the first half of the text, of at most 0xF80 bytes
+ */
+static u32 sum_text(u32 address, u32 length)
+{
+    u32 sum;
+    register u32 i;
+
+    address &= 0x00FFFFFCul;
+    if (length > 0xF80)
+        length = 0xF80;
+    length /= 2;
+    if (length == 0 || address + length - 1 > RSP_STATE.su_max_address)
+        return 0;
+    sum = 0;
+    for (i = 0; i < length; i++)
+        sum += RSP_STATE.DRAM[BES(address + i)];
+    return (sum);
+}
+
+static void apply_known_ucode(ucode_info * info)
+{
+    const known_ucode * known;
+    register size_t i;
+
+    for (i = 0; i < sizeof(known_ucodes) / sizeof(known_ucodes[0]); i++) {
+        known = &known_ucodes[i];
+        if (known -> family != info -> family)
+            continue;
+        if (known -> text_sum != info -> text_sum)
+            continue;
+        if (strcmp(info -> name, family_defaults[info -> family].name) == 0)
+            strcpy(info -> name, known -> name);
+        if (known -> HLE != KEEP)
+            info -> HLE = (unsigned char)known -> HLE;
+        return;
+    }
+    return;
+}
+
+static int match_RDRAM(u32 address, const char * text)
+{
+    register size_t i;
+
+    for (i = 0; text[i] != '\0'; i++)
+        if (RSP_STATE.DRAM[BES(address + i)] != (u8)text[i])
+            return 0;
+    return 1;
+}
+
+/*
+ * Copies the rest of the ID string after any of `ID_tags', squeezing runs of
+ * spaces, into `name'.  Returns zero if there is no ID string.
+ */
+static int read_ID_string(char * name, u32 address, u32 length)
+{
+    register u32 i, j;
+    register size_t tag, count;
+    u8 c;
+
+    address &= 0x00FFFFFCul;
+    if (length > UCODE_DATA_LIMIT)
+        length = UCODE_DATA_LIMIT;
+    if (length < 32 || address + length - 1 > RSP_STATE.su_max_address)
+        return 0;
+
+    for (i = 0; i < length - 32; i++)
+        for (tag = 0; tag < sizeof(ID_tags) / sizeof(ID_tags[0]); tag++) {
+            if (!match_RDRAM(address + i, ID_tags[tag]))
+                continue;
+            count = 0;
+            j = i + (u32)strlen(ID_tags[tag]);
+            while (j < length && count < UCODE_NAME_LENGTH - 1) {
+                c = RSP_STATE.DRAM[BES(address + j++)];
+                if (c < ' ' || c > '~')
+                    break;
+                if (c == ' ' && count != 0 && name[count - 1] == ' ')
+                    continue;
+                name[count++] = (char)c;
+            }
+            while (count != 0 && name[count - 1] == ' ')
+                --count;
+            name[count] = '\0';
+            return (count != 0);
+        }
+    return 0;
+}
+
+const ucode_info * identify_ucode(OSTask_type task_type)
+{
+    char name[UCODE_NAME_LENGTH];
+    ucode_registry * const known = RSP_STATE.ucodes;
+    ucode_info * info;
+    ucode_class family;
+    u32 text, text_size, data, data_size;
+    u32 hash;
+    register unsigned int i;
+
+    switch (task_type) {
+    case M_GFXTASK:
+        family = UCODE_GFX;
+        break;
+    case M_AUDTASK:
+        family = UCODE_AUDIO;
+        break;
+    case M_NJPEGTASK:
+        family = UCODE_JPEG;
+        break;
+    case M_HVQMTASK:
+        family = UCODE_HVQM;
+        break;
+    default: /* boot code, or nothing we know how to fingerprint */
+        RSP_STATE.current_ucode = &family_defaults[UCODE_UNKNOWN];
+        return (RSP_STATE.current_ucode);
+    }
+
+    text      = *(pu32)(RSP_STATE.DMEM + OSTASK_UCODE);
+    text_size = *(pu32)(RSP_STATE.DMEM + OSTASK_UCODE_SIZE);
+    data      = *(pu32)(RSP_STATE.DMEM + OSTASK_UCODE_DATA);
+    data_size = *(pu32)(RSP_STATE.DMEM + OSTASK_UCODE_DATA_SIZE);
+
+    for (i = 0; i < known -> count; i++) {
+        info = &known -> entries[i];
+        if (info -> task.type == (u32)task_type
+         && info -> task.text == text
+         && info -> task.text_size == text_size
+         && info -> task.data == data) {
+            RSP_STATE.current_ucode = info;
+            return (RSP_STATE.current_ucode);
+        }
+    }
+
+/*
+ * Somewhere else in RDRAM, it may still be one we know, loaded again.
+ */
+    hash = 2166136261ul ^ (u32)task_type;
+    hash = hash_RDRAM(hash, text, text_size, UCODE_TEXT_LIMIT);
+    hash = hash_RDRAM(hash, data, data_size, UCODE_DATA_LIMIT);
+    for (i = 0; i < known -> count; i++) {
+        info = &known -> entries[i];
+        if (info -> hash == hash) {
+            info -> task.type = (u32)task_type;
+            info -> task.text = text;
+            info -> task.text_size = text_size;
+            info -> task.data = data;
+            RSP_STATE.current_ucode = info;
+            return (RSP_STATE.current_ucode);
+        }
+    }
+
+/*
+ * first task with this micro-code:  classify it
+ */
+    if (!read_ID_string(name, data, data_size))
+        name[0] = '\0';
+    else if (family == UCODE_GFX && strncmp(name, "S2DEX", 5) == 0)
+        family = UCODE_SPRITE;
+
+    if (known -> count < MAX_KNOWN_UCODES)
+        info = &known -> entries[known -> count++];
+    else
+        info = &known -> overflow;
+    *info = family_defaults[family];
+    if (name[0] != '\0')
+        strcpy(info -> name, name);
+    info -> hash = hash;
+    info -> task.type = (u32)task_type;
+    info -> task.text = text;
+    info -> task.text_size = text_size;
+    info -> task.data = data;
+    info -> text_sum = sum_text(text, text_size);
+    apply_known_ucode(info);
+    if (family == UCODE_AUDIO)
+        classify_audio_ucode(info, data, data_size);
+    if (family == UCODE_JPEG)
+        classify_JPEG_ucode(info);
+    RSP_STATE.current_ucode = info;
+    return (RSP_STATE.current_ucode);
+}
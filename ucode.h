@@ -0,0 +1,100 @@
+/******************************************************************************\
+* Project:  Microcode Identification by Fingerprint                            *
+* Authors:  agent                                                              *
+* Release:  2026.10.18                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+#ifndef _UCODE_H_
+#define _UCODE_H_
+
+#include "module.h"
+
+/*
+ * OSTask header fields, as DMEM offsets, for the task about to be started
+ */
+#define OSTASK_TYPE             0xFC0
+#define OSTASK_FLAGS            0xFC4
+#define OSTASK_UCODE_BOOT       0xFC8
+#define OSTASK_UCODE_BOOT_SIZE  0xFCC
+#define OSTASK_UCODE            0xFD0
+#define OSTASK_UCODE_SIZE       0xFD4
+#define OSTASK_UCODE_DATA       0xFD8
+#define OSTASK_UCODE_DATA_SIZE  0xFDC
+#define OSTASK_DATA_PTR         0xFF0
+#define OSTASK_DATA_SIZE        0xFF4
+
+typedef enum {
+    UCODE_UNKNOWN,
+    UCODE_GFX,
+    UCODE_SPRITE, /* S2DEX */
+    UCODE_AUDIO,
+    UCODE_JPEG,
+    UCODE_HVQM,
+
+    NUMBER_OF_UCODE_CLASSES
+} ucode_class;
+
+#define UCODE_NAME_LENGTH       40
+
+typedef struct ucode_info {
+    u32 hash; /* fingerprint of the micro-code text and data in RDRAM */
+    u32 text_sum; /* byte sum of the first half of the text (`known_ucodes') */
+    ucode_class family;
+    char name[UCODE_NAME_LENGTH]; /* from its ID string, if it has one */
+
+    unsigned char HLE; /* safe to send to the graphics or audio plug-in */
+
+    unsigned char audio_ABI; /* `audio_ABI' (audio.h) of audio micro-codes */
+    u32 resample_table; /* RDRAM address of its resampling filter, or 0 */
+    unsigned char JPEG_format; /* `JPEG_format' (jpeg.h) of JPEG micro-codes */
+
+/*
+ * the OSTask header fields of the last task to run it, so that the next task
+ * which gives the same ones need not hash it again
+ */
+    struct {
+        u32 type, text, text_size, data;
+    } task;
+} ucode_info;
+
+/*
+ * Micro-codes an RSP has seen so far (`RSP_STATE.ucodes').  A game seldom
+ * uses more than four or five.  The one of the task `DoRspCycles' is running
+ * is `RSP_STATE.current_ucode'.
+ */
+#define MAX_KNOWN_UCODES    64
+
+typedef struct ucode_registry {
+    ucode_info entries[MAX_KNOWN_UCODES];
+    unsigned int count;
+
+/*
+ * Once `entries' is full, any micro-code not in it is classified here, again
+ * on every task, so that no entry is ever written over.
+ */
+    ucode_info overflow;
+} ucode_registry;
+
+/*
+ * the micro-codes of `RSP_state' (others have theirs from new_RSP_context())
+ */
+extern ucode_registry RSP_state_ucodes;
+
+/*
+ * Fingerprints the micro-code of the OSTask in DMEM and returns what we know
+ * about it.  The first task to use any one micro-code classifies it (from the
+ * task type and its data segment); after that it is just a table look-up, by
+ * the micro-code's RDRAM addresses or else by its hash.
+ */
+extern const ucode_info * identify_ucode(OSTask_type task_type);
+
+#endif
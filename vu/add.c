@@ -23,7 +23,7 @@ static INLINE void SIGNED_CLAMP_ADD(pi16 VD, pi16 VS, pi16 VT)
 
     src = _mm_load_si128((v16 *)VS);
     dst = _mm_load_si128((v16 *)VT);
-    vco = _mm_load_si128((v16 *)cf_co);
+    vco = _mm_load_si128((v16 *)RSP_STATE.cf_co);
 
 /*
  * Due to premature clamping in between adds, sometimes we need to add the
@@ -33,7 +33,7 @@ static INLINE void SIGNED_CLAMP_ADD(pi16 VD, pi16 VS, pi16 VT)
     max = _mm_max_epi16(dst, src);
     min = _mm_min_epi16(dst, src);
 
-    min = _mm_adds_epi16(min, vco);
+    min = _mm_subs_epi16(min, vco); /* VCO lanes are 0 or -1. */
     max = _mm_adds_epi16(max, min);
     _mm_store_si128((v16 *)VD, max);
     return;
@@ -45,7 +45,7 @@ static INLINE void SIGNED_CLAMP_SUB(pi16 VD, pi16 VS, pi16 VT)
 
     src = _mm_load_si128((v16 *)VS);
     dst = _mm_load_si128((v16 *)VT);
-    vco = _mm_load_si128((v16 *)cf_co);
+    vco = _mm_load_si128((v16 *)RSP_STATE.cf_co);
 
     res = _mm_subs_epi16(src, dst);
 
@@ -54,16 +54,16 @@ static INLINE void SIGNED_CLAMP_SUB(pi16 VD, pi16 VS, pi16 VT)
  * we must be careful not to offset the result accidentally when subtracting
  * the corresponding VCO flag AFTER the saturation from doing (VS - VT).
  */
-    dif = _mm_add_epi16(res, vco);
+    dif = _mm_sub_epi16(res, vco);
     dif = _mm_xor_si128(dif, res); /* Adding one suddenly inverts the sign? */
     dif = _mm_and_si128(dif, dst); /* Sign change due to subtracting a neg. */
     xmm = _mm_sub_epi16(src, dst);
     src = _mm_andnot_si128(src, dif); /* VS must be >= 0x0000 for overflow. */
     xmm = _mm_and_si128(xmm, src); /* VS + VT != INT16_MIN; VS + VT >= +32768 */
-    xmm = _mm_srli_epi16(xmm, 15); /* src = (INT16_MAX + 1 === INT16_MIN) ? */
+    xmm = _mm_srai_epi16(xmm, 15); /* src = (INT16_MAX + 1 === INT16_MIN) ? */
 
     xmm = _mm_andnot_si128(xmm, vco); /* If it's NOT overflow, keep flag. */
-    res = _mm_subs_epi16(res, xmm);
+    res = _mm_adds_epi16(res, xmm);
     _mm_store_si128((v16 *)VD, res);
     return;
 }
@@ -75,7 +75,7 @@ static INLINE void SIGNED_CLAMP_ADD(pi16 VD, pi16 VS, pi16 VT)
     register unsigned int i;
 
     for (i = 0; i < N; i++)
-        sum[i] = VS[i] + VT[i] + cf_co[i];
+        sum[i] = VS[i] + VT[i] - RSP_STATE.cf_co[i];
     for (i = 0; i < N; i++)
         lo[i] = (sum[i] + 0x8000) >> 31;
     for (i = 0; i < N; i++)
@@ -96,7 +96,7 @@ static INLINE void SIGNED_CLAMP_SUB(pi16 VD, pi16 VS, pi16 VT)
     register unsigned int i;
 
     for (i = 0; i < N; i++)
-        dif[i] = VS[i] - VT[i] - cf_co[i];
+        dif[i] = VS[i] - VT[i] + RSP_STATE.cf_co[i];
     for (i = 0; i < N; i++)
         lo[i] = (dif[i] + 0x8000) >> 31;
     for (i = 0; i < N; i++)
@@ -117,12 +117,12 @@ INLINE static void clr_ci(pi16 VD, pi16 VS, pi16 VT)
     register unsigned int i;
 
     for (i = 0; i < N; i++)
-        VACC_L[i] = VS[i] + VT[i] + cf_co[i];
+        VACC_L[i] = VS[i] + VT[i] - RSP_STATE.cf_co[i];
     SIGNED_CLAMP_ADD(VD, VS, VT);
 
  /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
-    vector_wipe(cf_ne);
-    vector_wipe(cf_co);
+    vector_wipe(RSP_STATE.cf_ne);
+    vector_wipe(RSP_STATE.cf_co);
     return;
 }
 
@@ -131,12 +131,12 @@ INLINE static void clr_bi(pi16 VD, pi16 VS, pi16 VT)
     register unsigned int i;
 
     for (i = 0; i < N; i++)
-        VACC_L[i] = VS[i] - VT[i] - cf_co[i];
+        VACC_L[i] = VS[i] - VT[i] + RSP_STATE.cf_co[i];
     SIGNED_CLAMP_SUB(VD, VS, VT);
 
  /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
-    vector_wipe(cf_ne);
-    vector_wipe(cf_co);
+    vector_wipe(RSP_STATE.cf_ne);
+    vector_wipe(RSP_STATE.cf_co);
     return;
 }
 
@@ -188,9 +188,9 @@ INLINE static void set_co(pi16 VD, pi16 VS, pi16 VT)
         VACC_L[i] = VS[i] + VT[i];
     vector_copy(VD, VACC_L);
 
-    vector_wipe(cf_ne);
+    vector_wipe(RSP_STATE.cf_ne);
     for (i = 0; i < N; i++)
-        cf_co[i] = sum[i] >> 16; /* native:  (sum[i] > +65535) */
+        RSP_STATE.cf_co[i] = -(sum[i] >> 16); /* native:  (sum[i] > +65535) */
     return;
 }
 
@@ -204,9 +204,9 @@ INLINE static void set_bo(pi16 VD, pi16 VS, pi16 VT)
     for (i = 0; i < N; i++)
         VACC_L[i] = VS[i] - VT[i];
     for (i = 0; i < N; i++)
-        cf_ne[i] = (VS[i] != VT[i]);
+        RSP_STATE.cf_ne[i] = -(VS[i] != VT[i]);
     for (i = 0; i < N; i++)
-        cf_co[i] = (dif[i] < 0);
+        RSP_STATE.cf_co[i] = -(dif[i] < 0);
     vector_copy(VD, VACC_L);
     return;
 }
@@ -214,7 +214,7 @@ INLINE static void set_bo(pi16 VD, pi16 VS, pi16 VT)
 VECTOR_OPERATION VADD(v16 vs, v16 vt)
 {
     ALIGNED i16 VD[N];
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     ALIGNED i16 VS[N], VT[N];
 
     *(v16 *)VS = vs;
@@ -226,12 +226,12 @@ VECTOR_OPERATION VADD(v16 vs, v16 vt)
     VT = vt;
 #endif
     clr_ci(VD, VS, VT);
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     COMPILER_FENCE();
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(RSP_STATE.V_result, VD);
     return;
 #endif
 }
@@ -239,7 +239,7 @@ VECTOR_OPERATION VADD(v16 vs, v16 vt)
 VECTOR_OPERATION VSUB(v16 vs, v16 vt)
 {
     ALIGNED i16 VD[N];
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     ALIGNED i16 VS[N], VT[N];
 
     *(v16 *)VS = vs;
@@ -251,12 +251,12 @@ VECTOR_OPERATION VSUB(v16 vs, v16 vt)
     VT = vt;
 #endif
     clr_bi(VD, VS, VT);
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     COMPILER_FENCE();
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(RSP_STATE.V_result, VD);
     return;
 #endif
 }
@@ -264,7 +264,7 @@ VECTOR_OPERATION VSUB(v16 vs, v16 vt)
 VECTOR_OPERATION VABS(v16 vs, v16 vt)
 {
     ALIGNED i16 VD[N];
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     ALIGNED i16 VS[N], VT[N];
 
     *(v16 *)VS = vs;
@@ -276,12 +276,12 @@ VECTOR_OPERATION VABS(v16 vs, v16 vt)
     VT = vt;
 #endif
     do_abs(VD, VS, VT);
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     COMPILER_FENCE();
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(RSP_STATE.V_result, VD);
     return;
 #endif
 }
@@ -289,7 +289,7 @@ VECTOR_OPERATION VABS(v16 vs, v16 vt)
 VECTOR_OPERATION VADDC(v16 vs, v16 vt)
 {
     ALIGNED i16 VD[N];
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     ALIGNED i16 VS[N], VT[N];
 
     *(v16 *)VS = vs;
@@ -301,12 +301,12 @@ VECTOR_OPERATION VADDC(v16 vs, v16 vt)
     VT = vt;
 #endif
     set_co(VD, VS, VT);
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     COMPILER_FENCE();
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(RSP_STATE.V_result, VD);
     return;
 #endif
 }
@@ -314,7 +314,7 @@ VECTOR_OPERATION VADDC(v16 vs, v16 vt)
 VECTOR_OPERATION VSUBC(v16 vs, v16 vt)
 {
     ALIGNED i16 VD[N];
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     ALIGNED i16 VS[N], VT[N];
 
     *(v16 *)VS = vs;
@@ -326,12 +326,12 @@ VECTOR_OPERATION VSUBC(v16 vs, v16 vt)
     VT = vt;
 #endif
     set_bo(VD, VS, VT);
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     COMPILER_FENCE();
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(RSP_STATE.V_result, VD);
     return;
 #endif
 }
@@ -340,24 +340,26 @@ VECTOR_OPERATION VSAW(v16 vs, v16 vt)
 {
     unsigned int element;
 
-    element  = 0xF & (inst_word >> 21);
+    element  = 0xF & (RSP_STATE.inst_word >> 21);
     element ^= 0x8; /* Convert scalar whole elements 8:F to 0:7. */
 
     if (element > 0x2) {
         message("VSAW\nIllegal mask.");
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
         vector_wipe(vs);
 #else
-        vector_wipe(V_result);
+        vector_wipe(RSP_STATE.V_result);
 #endif
     } else {
-#ifdef ARCH_MIN_SSE2
-        vs = *(v16 *)VACC[element];
+#if defined(WIDE_ACCUMULATOR)
+        vs = VACC_plane(element);
+#elif defined(HAVE_VECTOR_VALUES)
+        vs = *(v16 *)RSP_STATE.VACC[element];
 #else
-        vector_copy(V_result, VACC[element]);
+        vector_copy(RSP_STATE.V_result, RSP_STATE.VACC[element]);
 #endif
     }
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     return (vt = vs);
 #else
     if (vt == vs)
@@ -365,3 +367,81 @@ VECTOR_OPERATION VSAW(v16 vs, v16 vt)
     return;
 #endif
 }
+
+#ifdef ARCH_MIN_SSE2
+/*
+ * VADD and VSUB for when nothing reads VACC_L or VCO before they are written
+ * again (see `predecode_IMEM'):  just the clamped sum, with the carry in.
+ * Only SSE2 has these, since the other SIGNED_CLAMP_* clamp from VACC_L.
+ */
+VECTOR_OPERATION VADD_R(v16 vs, v16 vt)
+{
+    ALIGNED i16 VD[N], VS[N], VT[N];
+
+    *(v16 *)VS = vs;
+    *(v16 *)VT = vt;
+    SIGNED_CLAMP_ADD(VD, VS, VT);
+    COMPILER_FENCE();
+    vs = *(v16 *)VD;
+    return (vs);
+}
+
+VECTOR_OPERATION VSUB_R(v16 vs, v16 vt)
+{
+    ALIGNED i16 VD[N], VS[N], VT[N];
+
+    *(v16 *)VS = vs;
+    *(v16 *)VT = vt;
+    SIGNED_CLAMP_SUB(VD, VS, VT);
+    COMPILER_FENCE();
+    vs = *(v16 *)VD;
+    return (vs);
+}
+#endif
+
+#ifdef HAVE_SIMD_DISPATCH
+/*
+ * AVX2 kernels:  The unsigned sum or difference is exact in 32-bit lanes,
+ * so the carry or borrow out is just the bit above the low 16, and the
+ * flags are narrowed back to lane masks with signed saturation.
+ */
+static INLINE TARGET_AVX2 v16 packs_lanes(__m256i lanes)
+{
+    return _mm_packs_epi32(
+        _mm256_castsi256_si128(lanes), _mm256_extracti128_si256(lanes, 1)
+    );
+}
+
+TARGET_AVX2 v16 VADDC_AVX2(v16 vs, v16 vt)
+{
+    __m256i sum;
+
+    sum = _mm256_add_epi32(
+        _mm256_cvtepu16_epi32(vs), _mm256_cvtepu16_epi32(vt)
+    );
+    sum = _mm256_slli_epi32(sum, 15); /* bit 16, the carry, to the sign */
+    sum = _mm256_srai_epi32(sum, 31);
+    *(v16 *)VACC_L = _mm_add_epi16(vs, vt);
+
+    *(v16 *)RSP_STATE.cf_ne = _mm_setzero_si128();
+    *(v16 *)RSP_STATE.cf_co = packs_lanes(sum);
+    return *(v16 *)VACC_L;
+}
+
+TARGET_AVX2 v16 VSUBC_AVX2(v16 vs, v16 vt)
+{
+    __m256i dif;
+
+    dif = _mm256_sub_epi32(
+        _mm256_cvtepu16_epi32(vs), _mm256_cvtepu16_epi32(vt)
+    );
+    dif = _mm256_srai_epi32(dif, 31); /* -(dif < 0) */
+    *(v16 *)VACC_L = _mm_sub_epi16(vs, vt);
+
+    *(v16 *)RSP_STATE.cf_ne = _mm_xor_si128(
+        _mm_cmpeq_epi16(vs, vt), _mm_set1_epi16(-1)
+    );
+    *(v16 *)RSP_STATE.cf_co = packs_lanes(dif);
+    return *(v16 *)VACC_L;
+}
+#endif
@@ -31,4 +31,22 @@ VECTOR_EXTERN
 VECTOR_EXTERN
     VSAW   (v16 vs, v16 vt);
 
+/*
+ * VADD and VSUB without writing VACC_L or clearing VCO (SSE2 only)
+ */
+#ifdef ARCH_MIN_SSE2
+VECTOR_EXTERN
+    VADD_R (v16 vs, v16 vt);
+VECTOR_EXTERN
+    VSUB_R (v16 vs, v16 vt);
+#endif
+
+#ifdef HAVE_SIMD_DISPATCH
+extern v16 VADDC_AVX2(v16 vs, v16 vt);
+extern v16 VSUBC_AVX2(v16 vs, v16 vt);
+
+extern const p_C2_entry VADDC_AVX2_entries[1 << 4];
+extern const p_C2_entry VSUBC_AVX2_entries[1 << 4];
+#endif
+
 #endif
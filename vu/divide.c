@@ -15,23 +15,16 @@
 
 #include "divide.h"
 
-static s32 DivIn = 0; /* buffered numerator of division read from vector file */
-static s32 DivOut = 0; /* global division result set by VRCP/VRCPL/VRSQ/VRSQL */
-#if (0 != 0)
-static s32 MovIn; /* We do not emulate this register (obsolete, for VMOV). */
+#ifdef _MSC_VER
+#include <intrin.h>
 #endif
 
 /*
- * Boolean flag:  Double-precision high was the last vector divide op?
- *
- * if (lastDivideOp == VRCP, VRCPL, VRSQ, VRSQL)
- *     DPH = false; // single-precision or double-precision low, not high
- * else if (lastDivideOp == VRCPH, VRSQH)
- *     DPH = true; // double-precision high
- * else if (lastDivideOp == VMOV, VNOP)
- *     DPH = DPH; // no change--divide-group ops but not real divides
+ * DivIn, DivOut and the DPH flag are per-RSP state, kept in `rsp_context'.
  */
-static int DPH = 0;
+#if (0 != 0)
+static s32 MovIn; /* We do not emulate this register (obsolete, for VMOV). */
+#endif
 
 /*
  * 11-bit vector divide result look-up table
@@ -1074,6 +1067,27 @@ enum {
 /*, SP_DIV_PRECISION_CURRENT */
 };
 
+/*
+ * the left shift which normalizes a nonzero `x' (as MIPS CLZ, or BSR ^ 31)
+ */
+static INLINE int leading_zeros(u32 x)
+{
+#if defined(__GNUC__)
+    return __builtin_clz(x);
+#elif defined(_MSC_VER)
+    unsigned long index;
+
+    _BitScanReverse(&index, x);
+    return (int)(index ^ 31);
+#else
+    register int shift;
+
+    for (shift = 0; (x & 0x80000000ul) == 0; x <<= 1, shift++)
+        ;
+    return (shift);
+#endif
+}
+
 NOINLINE static void do_div(i32 data, int sqrt, int precision)
 {
     i32 addr;
@@ -1096,13 +1110,12 @@ NOINLINE static void do_div(i32 data, int sqrt, int precision)
  * Note, from the code just above, that data cannot be negative.
  * (data >= 0) is unconditionally forced by the above algorithm.
  */
-    addr = data;
     if (data == 0x00000000) {
         shift = (precision == SP_DIV_PRECISION_SINGLE) ? 16 : 0;
-        addr = addr << shift;
+        addr = 0x00000000;
     } else {
-        for (shift = 0; addr >= 0x00000000; addr <<= 1, shift++)
-            ;
+        shift = leading_zeros(data);
+        addr = (i32)((u32)data << shift);
     }
     addr = (addr >> 22) & 0x000001FF;
 
@@ -1112,212 +1125,290 @@ NOINLINE static void do_div(i32 data, int sqrt, int precision)
     }
     shift ^= 31; /* flipping shift direction from left- to right- */
     shift >>= (sqrt == SP_DIV_SQRT_YES);
-    DivOut = (0x40000000UL | ((u32)div_ROM[addr] << 14)) >> shift;
-    if (DivIn == 0) /* corner case:  overflow via division by zero */
-        DivOut = +0x7FFFFFFFl;
-    else if (DivIn == -32768) /* corner case:  signed underflow barrier */
-        DivOut = -0x00010000l;
+    RSP_STATE.DivOut = (0x40000000UL | ((u32)div_ROM[addr] << 14)) >> shift;
+    if (RSP_STATE.DivIn == 0) /* corner case:  overflow via division by zero */
+        RSP_STATE.DivOut = +0x7FFFFFFFl;
+    else if (RSP_STATE.DivIn == -32768) /* corner case:  signed underflow */
+        RSP_STATE.DivOut = -0x00010000l;
     else
-        DivOut ^= (DivIn < 0) ? ~0 : 0;
+        RSP_STATE.DivOut ^= (RSP_STATE.DivIn < 0) ? ~0 : 0;
     return;
 }
 
-VECTOR_OPERATION VRCP(v16 vs, v16 vt)
+#ifdef HAVE_VECTOR_VALUES
+/*
+ * VR[result] with one element replaced, merged in a register and stored
+ * whole:  Storing just the element and loading the row right back would
+ * stall the load on the narrower store still in flight.
+ */
+static INLINE v16 write_element(pi16 row, unsigned int element, i16 value)
 {
-    const int result = (inst_word & 0x000007FF) >>  6;
-    const int source = (inst_word & 0x0000FFFF) >> 11;
-    const int target = (inst_word >> 16) & 31;
-    const unsigned int element = (inst_word >> 21) & 0x7;
+    static const ALIGNED i16 lanes[N][N] = {
+        { -1, 0, 0, 0, 0, 0, 0, 0 },
+        { 0, -1, 0, 0, 0, 0, 0, 0 },
+        { 0, 0, -1, 0, 0, 0, 0, 0 },
+        { 0, 0, 0, -1, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, -1, 0, 0, 0 },
+        { 0, 0, 0, 0, 0, -1, 0, 0 },
+        { 0, 0, 0, 0, 0, 0, -1, 0 },
+        { 0, 0, 0, 0, 0, 0, 0, -1 },
+    };
+    const v16 mask = *(const v16 *)lanes[element];
+    v16 vd;
 
-    DivIn = (i32)VR[target][element];
-    do_div(DivIn, SP_DIV_SQRT_NO, SP_DIV_PRECISION_SINGLE);
+    vd = *(v16 *)row;
 #ifdef ARCH_MIN_SSE2
+    vd = _mm_andnot_si128(mask, vd);
+    vd = _mm_or_si128(vd, _mm_and_si128(mask, _mm_set1_epi16(value)));
+#else
+    vd = (vd & ~mask) | (mask & value);
+#endif
+    *(v16 *)row = vd;
+    return (vd);
+}
+#endif
+
+VECTOR_OPERATION VRCP(v16 vs, v16 vt)
+{
+    const int result = (RSP_STATE.inst_word & 0x000007FF) >>  6;
+    const int source = (RSP_STATE.inst_word & 0x0000FFFF) >> 11;
+    const int target = (RSP_STATE.inst_word >> 16) & 31;
+    const unsigned int element = (RSP_STATE.inst_word >> 21) & 0x7;
+
+    RSP_STATE.DivIn = (i32)RSP_STATE.VR[target][element];
+    do_div(RSP_STATE.DivIn, SP_DIV_SQRT_NO, SP_DIV_PRECISION_SINGLE);
+#ifdef HAVE_VECTOR_VALUES
     *(v16 *)VACC_L = vt;
 #else
     vector_copy(VACC_L, vt);
 #endif
-    VR[result][source & 07] = (i16)DivOut;
-    DPH = SP_DIV_PRECISION_SINGLE;
-#ifdef ARCH_MIN_SSE2
-    COMPILER_FENCE();
-    vs = *(v16 *)VR[result];
+    RSP_STATE.DPH = SP_DIV_PRECISION_SINGLE;
+#ifdef HAVE_VECTOR_VALUES
+    vs = write_element(
+        RSP_STATE.VR[result], source & 07, (i16)RSP_STATE.DivOut);
     return (vs);
 #else
-    vector_copy(V_result, VR[result]);
-    vs = vt; /* unused */
+    RSP_STATE.VR[result][source & 07] = (i16)RSP_STATE.DivOut;
+    vector_copy(RSP_STATE.V_result, RSP_STATE.VR[result]);
+    if (vt == vs)
+        return; /* -Wunused-but-set-parameter */
     return;
 #endif
 }
 
 VECTOR_OPERATION VRCPL(v16 vs, v16 vt)
 {
-    const int result = (inst_word & 0x000007FF) >>  6;
-    const int source = (inst_word & 0x0000FFFF) >> 11;
-    const int target = (inst_word >> 16) & 31;
-    const unsigned int element = (inst_word >> 21) & 0x7;
+    const int result = (RSP_STATE.inst_word & 0x000007FF) >>  6;
+    const int source = (RSP_STATE.inst_word & 0x0000FFFF) >> 11;
+    const int target = (RSP_STATE.inst_word >> 16) & 31;
+    const unsigned int element = (RSP_STATE.inst_word >> 21) & 0x7;
 
-    DivIn &= DPH;
-    DivIn |= (u16)VR[target][element];
-    do_div(DivIn, SP_DIV_SQRT_NO, DPH);
-#ifdef ARCH_MIN_SSE2
+    RSP_STATE.DivIn &= RSP_STATE.DPH;
+    RSP_STATE.DivIn |= (u16)RSP_STATE.VR[target][element];
+    do_div(RSP_STATE.DivIn, SP_DIV_SQRT_NO, RSP_STATE.DPH);
+#ifdef HAVE_VECTOR_VALUES
     *(v16 *)VACC_L = vt;
 #else
     vector_copy(VACC_L, vt);
 #endif
-    VR[result][source & 07] = (i16)DivOut;
-    DPH = SP_DIV_PRECISION_SINGLE;
-#ifdef ARCH_MIN_SSE2
-    COMPILER_FENCE();
-    vs = *(v16 *)VR[result];
+    RSP_STATE.DPH = SP_DIV_PRECISION_SINGLE;
+#ifdef HAVE_VECTOR_VALUES
+    vs = write_element(
+        RSP_STATE.VR[result], source & 07, (i16)RSP_STATE.DivOut);
     return (vs);
 #else
-    vector_copy(V_result, VR[result]);
-    vs = vt; /* unused */
+    RSP_STATE.VR[result][source & 07] = (i16)RSP_STATE.DivOut;
+    vector_copy(RSP_STATE.V_result, RSP_STATE.VR[result]);
+    if (vt == vs)
+        return; /* -Wunused-but-set-parameter */
     return;
 #endif
 }
 
 VECTOR_OPERATION VRCPH(v16 vs, v16 vt)
 {
-    const int result = (inst_word & 0x000007FF) >>  6;
-    const int source = (inst_word & 0x0000FFFF) >> 11;
-    const int target = (inst_word >> 16) & 31;
-    const unsigned int element = (inst_word >> 21) & 0x7;
+    const int result = (RSP_STATE.inst_word & 0x000007FF) >>  6;
+    const int source = (RSP_STATE.inst_word & 0x0000FFFF) >> 11;
+    const int target = (RSP_STATE.inst_word >> 16) & 31;
+    const unsigned int element = (RSP_STATE.inst_word >> 21) & 0x7;
 
-    DivIn = VR[target][element] << 16;
-#ifdef ARCH_MIN_SSE2
+    RSP_STATE.DivIn = RSP_STATE.VR[target][element] << 16;
+#ifdef HAVE_VECTOR_VALUES
     *(v16 *)VACC_L = vt;
 #else
     vector_copy(VACC_L, vt);
 #endif
-    VR[result][source & 07] = DivOut >> 16;
-    DPH = SP_DIV_PRECISION_DOUBLE;
-#ifdef ARCH_MIN_SSE2
-    COMPILER_FENCE();
-    vs = *(v16 *)VR[result];
+    RSP_STATE.DPH = SP_DIV_PRECISION_DOUBLE;
+#ifdef HAVE_VECTOR_VALUES
+    vs = write_element(
+        RSP_STATE.VR[result], source & 07, (i16)(RSP_STATE.DivOut >> 16));
     return (vs);
 #else
-    vector_copy(V_result, VR[result]);
-    vs = vt; /* unused */
+    RSP_STATE.VR[result][source & 07] = RSP_STATE.DivOut >> 16;
+    vector_copy(RSP_STATE.V_result, RSP_STATE.VR[result]);
+    if (vt == vs)
+        return; /* -Wunused-but-set-parameter */
     return;
 #endif
 }
 
 VECTOR_OPERATION VMOV(v16 vs, v16 vt)
 {
-    const int result = (inst_word & 0x000007FF) >>  6;
-    const int source = (inst_word & 0x0000FFFF) >> 11;
-    const unsigned int element = (inst_word >> 21) & 0x7;
+    const int result = (RSP_STATE.inst_word & 0x000007FF) >>  6;
+    const int source = (RSP_STATE.inst_word & 0x0000FFFF) >> 11;
+    const unsigned int element = (RSP_STATE.inst_word >> 21) & 0x7;
 
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     *(v16 *)VACC_L = vt;
 #else
     vector_copy(VACC_L, vt);
 #endif
-    VR[result][source & 07] = VACC_L[element];
-#ifdef ARCH_MIN_SSE2
-    COMPILER_FENCE();
-    vs = *(v16 *)VR[result];
+#ifdef HAVE_VECTOR_VALUES
+    vs = write_element(RSP_STATE.VR[result], source & 07, VACC_L[element]);
     return (vs);
 #else
-    vector_copy(V_result, VR[result]);
-    vs = vt; /* unused */
+    RSP_STATE.VR[result][source & 07] = VACC_L[element];
+    vector_copy(RSP_STATE.V_result, RSP_STATE.VR[result]);
+    if (vt == vs)
+        return; /* -Wunused-but-set-parameter */
     return;
 #endif
 }
 
 VECTOR_OPERATION VRSQ(v16 vs, v16 vt)
 {
-    const int result = (inst_word & 0x000007FF) >>  6;
-    const int source = (inst_word & 0x0000FFFF) >> 11;
-    const int target = (inst_word >> 16) & 31;
-    const unsigned int element = (inst_word >> 21) & 0x7;
+    const int result = (RSP_STATE.inst_word & 0x000007FF) >>  6;
+    const int source = (RSP_STATE.inst_word & 0x0000FFFF) >> 11;
+    const int target = (RSP_STATE.inst_word >> 16) & 31;
+    const unsigned int element = (RSP_STATE.inst_word >> 21) & 0x7;
 
-    DivIn = (i32)VR[target][element];
-    do_div(DivIn, SP_DIV_SQRT_YES, SP_DIV_PRECISION_SINGLE);
-#ifdef ARCH_MIN_SSE2
+    RSP_STATE.DivIn = (i32)RSP_STATE.VR[target][element];
+    do_div(RSP_STATE.DivIn, SP_DIV_SQRT_YES, SP_DIV_PRECISION_SINGLE);
+#ifdef HAVE_VECTOR_VALUES
     *(v16 *)VACC_L = vt;
 #else
     vector_copy(VACC_L, vt);
 #endif
-    VR[result][source & 07] = (i16)DivOut;
-    DPH = SP_DIV_PRECISION_SINGLE;
-#ifdef ARCH_MIN_SSE2
-    COMPILER_FENCE();
-    vs = *(v16 *)VR[result];
+    RSP_STATE.DPH = SP_DIV_PRECISION_SINGLE;
+#ifdef HAVE_VECTOR_VALUES
+    vs = write_element(
+        RSP_STATE.VR[result], source & 07, (i16)RSP_STATE.DivOut);
     return (vs);
 #else
-    vector_copy(V_result, VR[result]);
-    vs = vt; /* unused */
+    RSP_STATE.VR[result][source & 07] = (i16)RSP_STATE.DivOut;
+    vector_copy(RSP_STATE.V_result, RSP_STATE.VR[result]);
+    if (vt == vs)
+        return; /* -Wunused-but-set-parameter */
     return;
 #endif
 }
 
 VECTOR_OPERATION VRSQL(v16 vs, v16 vt)
 {
-    const int result = (inst_word & 0x000007FF) >>  6;
-    const int source = (inst_word & 0x0000FFFF) >> 11;
-    const int target = (inst_word >> 16) & 31;
-    const unsigned int element = (inst_word >> 21) & 0x7;
+    const int result = (RSP_STATE.inst_word & 0x000007FF) >>  6;
+    const int source = (RSP_STATE.inst_word & 0x0000FFFF) >> 11;
+    const int target = (RSP_STATE.inst_word >> 16) & 31;
+    const unsigned int element = (RSP_STATE.inst_word >> 21) & 0x7;
 
-    DivIn &= DPH;
-    DivIn |= (u16)VR[target][element];
-    do_div(DivIn, SP_DIV_SQRT_YES, DPH);
-#ifdef ARCH_MIN_SSE2
+    RSP_STATE.DivIn &= RSP_STATE.DPH;
+    RSP_STATE.DivIn |= (u16)RSP_STATE.VR[target][element];
+    do_div(RSP_STATE.DivIn, SP_DIV_SQRT_YES, RSP_STATE.DPH);
+#ifdef HAVE_VECTOR_VALUES
     *(v16 *)VACC_L = vt;
 #else
     vector_copy(VACC_L, vt);
 #endif
-    VR[result][source & 07] = (i16)DivOut;
-    DPH = SP_DIV_PRECISION_SINGLE;
-#ifdef ARCH_MIN_SSE2
-    COMPILER_FENCE();
-    vs = *(v16 *)VR[result];
+    RSP_STATE.DPH = SP_DIV_PRECISION_SINGLE;
+#ifdef HAVE_VECTOR_VALUES
+    vs = write_element(
+        RSP_STATE.VR[result], source & 07, (i16)RSP_STATE.DivOut);
     return (vs);
 #else
-    vector_copy(V_result, VR[result]);
-    vs = vt; /* unused */
+    RSP_STATE.VR[result][source & 07] = (i16)RSP_STATE.DivOut;
+    vector_copy(RSP_STATE.V_result, RSP_STATE.VR[result]);
+    if (vt == vs)
+        return; /* -Wunused-but-set-parameter */
     return;
 #endif
 }
 
 VECTOR_OPERATION VRSQH(v16 vs, v16 vt)
 {
-    const int result = (inst_word & 0x000007FF) >>  6;
-    const int source = (inst_word & 0x0000FFFF) >> 11;
-    const int target = (inst_word >> 16) & 31;
-    const unsigned int element = (inst_word >> 21) & 0x7;
+    const int result = (RSP_STATE.inst_word & 0x000007FF) >>  6;
+    const int source = (RSP_STATE.inst_word & 0x0000FFFF) >> 11;
+    const int target = (RSP_STATE.inst_word >> 16) & 31;
+    const unsigned int element = (RSP_STATE.inst_word >> 21) & 0x7;
 
-    DivIn = VR[target][element] << 16;
-#ifdef ARCH_MIN_SSE2
+    RSP_STATE.DivIn = RSP_STATE.VR[target][element] << 16;
+#ifdef HAVE_VECTOR_VALUES
     *(v16 *)VACC_L = vt;
 #else
     vector_copy(VACC_L, vt);
 #endif
-    VR[result][source & 07] = DivOut >> 16;
-    DPH = SP_DIV_PRECISION_DOUBLE;
-#ifdef ARCH_MIN_SSE2
-    COMPILER_FENCE();
-    vs = *(v16 *)VR[result];
+    RSP_STATE.DPH = SP_DIV_PRECISION_DOUBLE;
+#ifdef HAVE_VECTOR_VALUES
+    vs = write_element(
+        RSP_STATE.VR[result], source & 07, (i16)(RSP_STATE.DivOut >> 16));
     return (vs);
 #else
-    vector_copy(V_result, VR[result]);
-    vs = vt; /* unused */
+    RSP_STATE.VR[result][source & 07] = RSP_STATE.DivOut >> 16;
+    vector_copy(RSP_STATE.V_result, RSP_STATE.VR[result]);
+    if (vt == vs)
+        return; /* -Wunused-but-set-parameter */
     return;
 #endif
 }
 
 VECTOR_OPERATION VNOP(v16 vs, v16 vt)
 {
-    const int result = (inst_word & 0x000007FF) >>  6;
+    const int result = (RSP_STATE.inst_word & 0x000007FF) >>  6;
 
-#ifdef ARCH_MIN_SSE2
-    vs = *(v16 *)VR[result];
+#ifdef HAVE_VECTOR_VALUES
+    vs = *(v16 *)RSP_STATE.VR[result];
     return (vt = vs); /* -Wunused-but-set-parameter */
 #else
-    vector_copy(V_result, VR[result]);
+    vector_copy(RSP_STATE.V_result, RSP_STATE.VR[result]);
     if (vt == vs)
         return; /* -Wunused-but-set-parameter */
     return;
 #endif
 }
+
+/*
+ * VRCPH, VRCPL, VRCPH (or VRSQH, VRSQL, VRSQH) as one fused idiom:  the
+ * double-precision reciprocal of the first two sources, and the high half of
+ * the next one's source loaded by the last op.  Of the three VACC_L writes,
+ * only the last one is left to be seen, so that is the only one done.
+ */
+void VRCP_double(const u32 * IW, unsigned int count)
+{
+    const int sqrt = (IW[1] % 64 == 065) ? SP_DIV_SQRT_YES : SP_DIV_SQRT_NO;
+    unsigned int result, source, target, element;
+    register unsigned int i;
+
+    for (i = 0; i < count; i++) {
+        result  = (IW[i] & 0x000007FF) >>  6;
+        source  = (IW[i] & 0x0000FFFF) >> 11;
+        target  = (IW[i] >> 16) & 31;
+        element = (IW[i] >> 21) & 0x7;
+        if (i == 1) { /* VRCPL */
+            RSP_STATE.DivIn |= (u16)RSP_STATE.VR[target][element];
+            do_div(RSP_STATE.DivIn, sqrt, SP_DIV_PRECISION_DOUBLE);
+            RSP_STATE.VR[result][source & 07] = (i16)RSP_STATE.DivOut;
+            continue;
+        }
+        if (i == count - 1) {
+#ifdef HAVE_VECTOR_VALUES
+            *(v16 *)VACC_L =
+                broadcast(*(v16 *)RSP_STATE.VR[target], IW[i] >> 21 & 0xF);
+#else
+            vector_copy(VACC_L,
+                broadcast(RSP_STATE.VR[target], IW[i] >> 21 & 0xF));
+#endif
+        }
+        RSP_STATE.DivIn = RSP_STATE.VR[target][element] << 16; /* VRCPH */
+        RSP_STATE.VR[result][source & 07] = RSP_STATE.DivOut >> 16;
+    }
+    RSP_STATE.DPH = SP_DIV_PRECISION_DOUBLE;
+    return;
+}
@@ -35,4 +35,9 @@ VECTOR_EXTERN
 VECTOR_EXTERN
     VNOP   (v16 vs, v16 vt);
 
+/*
+ * VRCPH, VRCPL, VRCPH and VRSQH, VRSQL, VRSQH, fused (see `p_C2_fused')
+ */
+extern void VRCP_double(const u32 * IW, unsigned int count);
+
 #endif
@@ -17,21 +17,21 @@
 
 VECTOR_OPERATION VAND(v16 vs, v16 vt)
 {
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     vector_and(vs, vt);
     *(v16 *)VACC_L = vs;
     return (vs);
 #else
     vector_copy(VACC_L, vt);
     vector_and(VACC_L, vs);
-    vector_copy(V_result, VACC_L);
+    vector_copy(RSP_STATE.V_result, VACC_L);
     return;
 #endif
 }
 
 VECTOR_OPERATION VNAND(v16 vs, v16 vt)
 {
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     vector_and(vt, vs);
     vector_fill(vs);
     vector_xor(vs, vt);
@@ -40,30 +40,30 @@ VECTOR_OPERATION VNAND(v16 vs, v16 vt)
 #else
     vector_copy(VACC_L, vt);
     vector_and(VACC_L, vs);
-    vector_fill(V_result);
-    vector_xor(VACC_L, V_result);
-    vector_copy(V_result, VACC_L);
+    vector_fill(RSP_STATE.V_result);
+    vector_xor(VACC_L, RSP_STATE.V_result);
+    vector_copy(RSP_STATE.V_result, VACC_L);
     return;
 #endif
 }
 
 VECTOR_OPERATION VOR(v16 vs, v16 vt)
 {
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     vector_or(vs, vt);
     *(v16 *)VACC_L = vs;
     return (vs);
 #else
     vector_copy(VACC_L, vt);
     vector_or(VACC_L, vs);
-    vector_copy(V_result, VACC_L);
+    vector_copy(RSP_STATE.V_result, VACC_L);
     return;
 #endif
 }
 
 VECTOR_OPERATION VNOR(v16 vs, v16 vt)
 {
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     vector_or(vt, vs);
     vector_fill(vs);
     vector_xor(vs, vt);
@@ -72,30 +72,30 @@ VECTOR_OPERATION VNOR(v16 vs, v16 vt)
 #else
     vector_copy(VACC_L, vt);
     vector_or(VACC_L, vs);
-    vector_fill(V_result);
-    vector_xor(VACC_L, V_result);
-    vector_copy(V_result, VACC_L);
+    vector_fill(RSP_STATE.V_result);
+    vector_xor(VACC_L, RSP_STATE.V_result);
+    vector_copy(RSP_STATE.V_result, VACC_L);
     return;
 #endif
 }
 
 VECTOR_OPERATION VXOR(v16 vs, v16 vt)
 {
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     vector_xor(vs, vt);
     *(v16 *)VACC_L = vs;
     return (vs);
 #else
     vector_copy(VACC_L, vt);
     vector_xor(VACC_L, vs);
-    vector_copy(V_result, VACC_L);
+    vector_copy(RSP_STATE.V_result, VACC_L);
     return;
 #endif
 }
 
 VECTOR_OPERATION VNXOR(v16 vs, v16 vt)
 {
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     vector_xor(vt, vs);
     vector_fill(vs);
     vector_xor(vs, vt);
@@ -104,9 +104,9 @@ VECTOR_OPERATION VNXOR(v16 vs, v16 vt)
 #else
     vector_copy(VACC_L, vt);
     vector_xor(VACC_L, vs);
-    vector_fill(V_result);
-    vector_xor(VACC_L, V_result);
-    vector_copy(V_result, VACC_L);
+    vector_fill(RSP_STATE.V_result);
+    vector_xor(VACC_L, RSP_STATE.V_result);
+    vector_copy(RSP_STATE.V_result, VACC_L);
     return;
 #endif
 }
@@ -15,9 +15,397 @@
 
 #include "multiply.h"
 
+#ifdef WIDE_ACCUMULATOR
+/*
+ * VACC_W[0..3] and VACC_W[4..7], as the two XMM words we add products to
+ */
+#define ACC_W_LO    (*(v16 *)VACC_H)
+#define ACC_W_HI    (*(v16 *)VACC_M)
+
+/*
+ * VM?DM, VM?DH, VMACF:  signed clamp of acc_47..16
+ */
+static INLINE v16 clamp_mid(v16 acc_lo4, v16 acc_hi4)
+{
+    return _mm_packs_epi32(acc_lo4, acc_hi4);
+}
+
+/*
+ * VM?DL, VM?DN:  acc_15..0 if acc_47..16 fits in 16 bits, else 0x0000 if it
+ * is negative or 0xFFFF if it is positive (signed clamp, then ^ 0x8000)
+ */
+static INLINE v16 clamp_low(v16 acc_lo4, v16 acc_hi4, v16 acc_lo)
+{
+    v16 fits_lo, fits_hi;
+    v16 clamped;
+
+    fits_lo = _mm_srai_epi32(_mm_slli_epi32(acc_lo4, 16), 16);
+    fits_hi = _mm_srai_epi32(_mm_slli_epi32(acc_hi4, 16), 16);
+    fits_lo = _mm_cmpeq_epi32(fits_lo, acc_lo4);
+    fits_hi = _mm_cmpeq_epi32(fits_hi, acc_hi4);
+    fits_lo = _mm_packs_epi32(fits_lo, fits_hi);
+
+    clamped = _mm_packs_epi32(acc_lo4, acc_hi4);
+    clamped = _mm_srai_epi16(clamped, 15);
+    clamped = _mm_xor_si128(clamped, _mm_cmpeq_epi16(clamped, clamped));
+    acc_lo = _mm_and_si128(acc_lo, fits_lo);
+    clamped = _mm_andnot_si128(fits_lo, clamped);
+    return _mm_or_si128(acc_lo, clamped);
+}
+
+/*
+ * VMULU, VMACU:  0x0000 if acc_47..16 is negative, 0xFFFF if it is more than
+ * +32767, else acc_31..16
+ */
+static INLINE v16 clamp_unsigned(v16 acc_lo4, v16 acc_hi4)
+{
+    v16 overflow_lo, overflow_hi;
+    v16 clamped;
+
+    overflow_lo = _mm_cmpgt_epi32(acc_lo4, _mm_set1_epi32(+32767));
+    overflow_hi = _mm_cmpgt_epi32(acc_hi4, _mm_set1_epi32(+32767));
+    overflow_lo = _mm_packs_epi32(overflow_lo, overflow_hi);
+
+    clamped = _mm_packs_epi32(acc_lo4, acc_hi4);
+    clamped = _mm_andnot_si128(_mm_srai_epi16(clamped, 15), clamped);
+    return _mm_or_si128(clamped, overflow_lo);
+}
+
+v16 VACC_plane(unsigned int plane)
+{
+    v16 acc_lo4, acc_hi4;
+
+    acc_lo4 = ACC_W_LO;
+    acc_hi4 = ACC_W_HI;
+    switch (plane) {
+    case HI:
+        acc_lo4 = _mm_srai_epi32(acc_lo4, 16);
+        acc_hi4 = _mm_srai_epi32(acc_hi4, 16);
+        return _mm_packs_epi32(acc_lo4, acc_hi4);
+    case MD:
+        acc_lo4 = _mm_srai_epi32(_mm_slli_epi32(acc_lo4, 16), 16);
+        acc_hi4 = _mm_srai_epi32(_mm_slli_epi32(acc_hi4, 16), 16);
+        return _mm_packs_epi32(acc_lo4, acc_hi4);
+    default:
+        return *(v16 *)VACC_L;
+    }
+}
+
 VECTOR_OPERATION VMULF(v16 vs, v16 vt)
 {
+    v16 prod_hi, prod_lo;
+    v16 acc_lo4, acc_hi4;
+    v16 round;
+
+    prod_lo = _mm_mullo_epi16(vs, vt);
+    prod_hi = _mm_mulhi_epi16(vs, vt);
+    round = _mm_cmpeq_epi16(vs, vs);
+    round = _mm_slli_epi16(round, 15);
+    *(v16 *)VACC_L = _mm_xor_si128(_mm_add_epi16(prod_lo, prod_lo), round);
+
+/*
+ * acc_47..16 = (2*s*t + 32768) >> 16, which we get as (s*t + 16384) >> 15
+ * so that -32768 * -32768 does not overflow the 32-bit product first.
+ */
+    round = _mm_set1_epi32(0x00004000);
+    acc_lo4 = _mm_unpacklo_epi16(prod_lo, prod_hi);
+    acc_hi4 = _mm_unpackhi_epi16(prod_lo, prod_hi);
+    acc_lo4 = _mm_srai_epi32(_mm_add_epi32(acc_lo4, round), 15);
+    acc_hi4 = _mm_srai_epi32(_mm_add_epi32(acc_hi4, round), 15);
+    ACC_W_LO = acc_lo4;
+    ACC_W_HI = acc_hi4;
+    return clamp_mid(acc_lo4, acc_hi4);
+}
+
+VECTOR_OPERATION VMULU(v16 vs, v16 vt)
+{
+    v16 prod_hi, prod_lo;
+    v16 acc_lo4, acc_hi4;
+    v16 round;
+
+    prod_lo = _mm_mullo_epi16(vs, vt);
+    prod_hi = _mm_mulhi_epi16(vs, vt);
+    round = _mm_cmpeq_epi16(vs, vs);
+    round = _mm_slli_epi16(round, 15);
+    *(v16 *)VACC_L = _mm_xor_si128(_mm_add_epi16(prod_lo, prod_lo), round);
+
+    round = _mm_set1_epi32(0x00004000);
+    acc_lo4 = _mm_unpacklo_epi16(prod_lo, prod_hi);
+    acc_hi4 = _mm_unpackhi_epi16(prod_lo, prod_hi);
+    acc_lo4 = _mm_srai_epi32(_mm_add_epi32(acc_lo4, round), 15);
+    acc_hi4 = _mm_srai_epi32(_mm_add_epi32(acc_hi4, round), 15);
+    ACC_W_LO = acc_lo4;
+    ACC_W_HI = acc_hi4;
+    return clamp_unsigned(acc_lo4, acc_hi4);
+}
+
+VECTOR_OPERATION VMUDL(v16 vs, v16 vt)
+{
+    vs = _mm_mulhi_epu16(vs, vt);
+    vector_wipe(vt);
+    *(v16 *)VACC_L = vs;
+    ACC_W_LO = vt;
+    ACC_W_HI = vt;
+    return (vs);
+}
+
+VECTOR_OPERATION VMUDM(v16 vs, v16 vt)
+{
+    v16 prod_hi, prod_lo;
+    v16 sign;
+
+    prod_lo = _mm_mullo_epi16(vs, vt);
+    prod_hi = _mm_mulhi_epu16(vs, vt);
+    vs = _mm_srai_epi16(vs, 15);
+    vt = _mm_and_si128(vt, vs);
+    prod_hi = _mm_sub_epi16(prod_hi, vt); /* as in the planar VMUDM */
+
+    *(v16 *)VACC_L = prod_lo;
+    sign = _mm_srai_epi16(prod_hi, 15);
+    ACC_W_LO = _mm_unpacklo_epi16(prod_hi, sign);
+    ACC_W_HI = _mm_unpackhi_epi16(prod_hi, sign);
+    return (prod_hi);
+}
+
+VECTOR_OPERATION VMUDN(v16 vs, v16 vt)
+{
+    v16 prod_hi, prod_lo;
+    v16 sign;
+
+    prod_lo = _mm_mullo_epi16(vs, vt);
+    prod_hi = _mm_mulhi_epu16(vs, vt);
+    vt = _mm_srai_epi16(vt, 15);
+    vs = _mm_and_si128(vs, vt);
+    prod_hi = _mm_sub_epi16(prod_hi, vs); /* as in the planar VMUDN */
+
+    *(v16 *)VACC_L = prod_lo;
+    sign = _mm_srai_epi16(prod_hi, 15);
+    ACC_W_LO = _mm_unpacklo_epi16(prod_hi, sign);
+    ACC_W_HI = _mm_unpackhi_epi16(prod_hi, sign);
+    return (prod_lo);
+}
+
+VECTOR_OPERATION VMUDH(v16 vs, v16 vt)
+{
+    v16 prod_hi, prod_lo;
+    v16 acc_lo4, acc_hi4;
+
+    prod_lo = _mm_mullo_epi16(vs, vt);
+    prod_hi = _mm_mulhi_epi16(vs, vt);
+    *(v16 *)VACC_L = _mm_setzero_si128();
+    acc_lo4 = _mm_unpacklo_epi16(prod_lo, prod_hi);
+    acc_hi4 = _mm_unpackhi_epi16(prod_lo, prod_hi);
+    ACC_W_LO = acc_lo4;
+    ACC_W_HI = acc_hi4;
+    return clamp_mid(acc_lo4, acc_hi4);
+}
+
+/*
+ * The accumulating ones add the low 16 bits of the product to VACC_L, then
+ * everything above that, plus the carry out of VACC_L, to VACC_W.
+ */
+VECTOR_OPERATION VMACF(v16 vs, v16 vt)
+{
+    v16 prod_hi, prod_lo;
+    v16 acc_lo, acc_lo4, acc_hi4;
+    v16 carry;
+
+    prod_lo = _mm_mullo_epi16(vs, vt);
+    prod_hi = _mm_mulhi_epi16(vs, vt);
+    acc_lo4 = _mm_unpacklo_epi16(prod_lo, prod_hi);
+    acc_hi4 = _mm_unpackhi_epi16(prod_lo, prod_hi);
+    acc_lo4 = _mm_srai_epi32(acc_lo4, 15); /* (2*s*t) >> 16 */
+    acc_hi4 = _mm_srai_epi32(acc_hi4, 15);
+
+    prod_lo = _mm_add_epi16(prod_lo, prod_lo);
+    acc_lo = _mm_add_epi16(*(v16 *)VACC_L, prod_lo);
+    *(v16 *)VACC_L = acc_lo;
+    carry = _mm_cmplt_epu16(acc_lo, prod_lo);
+    acc_lo4 = _mm_sub_epi32(acc_lo4, _mm_unpacklo_epi16(carry, carry));
+    acc_hi4 = _mm_sub_epi32(acc_hi4, _mm_unpackhi_epi16(carry, carry));
+
+    acc_lo4 = _mm_add_epi32(acc_lo4, ACC_W_LO);
+    acc_hi4 = _mm_add_epi32(acc_hi4, ACC_W_HI);
+    ACC_W_LO = acc_lo4;
+    ACC_W_HI = acc_hi4;
+    return clamp_mid(acc_lo4, acc_hi4);
+}
+
+VECTOR_OPERATION VMACU(v16 vs, v16 vt)
+{
+    v16 prod_hi, prod_lo;
+    v16 acc_lo, acc_lo4, acc_hi4;
+    v16 carry;
+
+    prod_lo = _mm_mullo_epi16(vs, vt);
+    prod_hi = _mm_mulhi_epi16(vs, vt);
+    acc_lo4 = _mm_unpacklo_epi16(prod_lo, prod_hi);
+    acc_hi4 = _mm_unpackhi_epi16(prod_lo, prod_hi);
+    acc_lo4 = _mm_srai_epi32(acc_lo4, 15);
+    acc_hi4 = _mm_srai_epi32(acc_hi4, 15);
+
+    prod_lo = _mm_add_epi16(prod_lo, prod_lo);
+    acc_lo = _mm_add_epi16(*(v16 *)VACC_L, prod_lo);
+    *(v16 *)VACC_L = acc_lo;
+    carry = _mm_cmplt_epu16(acc_lo, prod_lo);
+    acc_lo4 = _mm_sub_epi32(acc_lo4, _mm_unpacklo_epi16(carry, carry));
+    acc_hi4 = _mm_sub_epi32(acc_hi4, _mm_unpackhi_epi16(carry, carry));
+
+    acc_lo4 = _mm_add_epi32(acc_lo4, ACC_W_LO);
+    acc_hi4 = _mm_add_epi32(acc_hi4, ACC_W_HI);
+    ACC_W_LO = acc_lo4;
+    ACC_W_HI = acc_hi4;
+    return clamp_unsigned(acc_lo4, acc_hi4);
+}
+
+VECTOR_OPERATION VMADL(v16 vs, v16 vt)
+{
+    v16 acc_lo, acc_lo4, acc_hi4;
+    v16 carry;
+
+    vs = _mm_mulhi_epu16(vs, vt);
+    acc_lo = _mm_add_epi16(*(v16 *)VACC_L, vs);
+    *(v16 *)VACC_L = acc_lo;
+    carry = _mm_cmplt_epu16(acc_lo, vs);
+
+    acc_lo4 = _mm_sub_epi32(ACC_W_LO, _mm_unpacklo_epi16(carry, carry));
+    acc_hi4 = _mm_sub_epi32(ACC_W_HI, _mm_unpackhi_epi16(carry, carry));
+    ACC_W_LO = acc_lo4;
+    ACC_W_HI = acc_hi4;
+    return clamp_low(acc_lo4, acc_hi4, acc_lo);
+}
+
+VECTOR_OPERATION VMADM(v16 vs, v16 vt)
+{
+    v16 prod_hi, prod_lo;
+    v16 acc_lo, acc_lo4, acc_hi4;
+    v16 sign;
+
+    prod_lo = _mm_mullo_epi16(vs, vt);
+    prod_hi = _mm_mulhi_epu16(vs, vt);
+    vs = _mm_srai_epi16(vs, 15);
+    vt = _mm_and_si128(vt, vs);
+    prod_hi = _mm_sub_epi16(prod_hi, vt);
+
+/*
+ * (s16 * u16) >> 16 is never more than +32766, so the carry out of VACC_L
+ * can go into the product's high half before it is sign-extended.
+ */
+    acc_lo = _mm_add_epi16(*(v16 *)VACC_L, prod_lo);
+    *(v16 *)VACC_L = acc_lo;
+    prod_hi = _mm_sub_epi16(prod_hi, _mm_cmplt_epu16(acc_lo, prod_lo));
+    sign = _mm_srai_epi16(prod_hi, 15);
+
+    acc_lo4 = _mm_add_epi32(ACC_W_LO, _mm_unpacklo_epi16(prod_hi, sign));
+    acc_hi4 = _mm_add_epi32(ACC_W_HI, _mm_unpackhi_epi16(prod_hi, sign));
+    ACC_W_LO = acc_lo4;
+    ACC_W_HI = acc_hi4;
+    return clamp_mid(acc_lo4, acc_hi4);
+}
+
+VECTOR_OPERATION VMADN(v16 vs, v16 vt)
+{
+    v16 prod_hi, prod_lo;
+    v16 acc_lo, acc_lo4, acc_hi4;
+    v16 sign;
+
+    prod_lo = _mm_mullo_epi16(vs, vt);
+    prod_hi = _mm_mulhi_epu16(vs, vt);
+    vt = _mm_srai_epi16(vt, 15);
+    vs = _mm_and_si128(vs, vt);
+    prod_hi = _mm_sub_epi16(prod_hi, vs);
+
+    acc_lo = _mm_add_epi16(*(v16 *)VACC_L, prod_lo);
+    *(v16 *)VACC_L = acc_lo;
+    prod_hi = _mm_sub_epi16(prod_hi, _mm_cmplt_epu16(acc_lo, prod_lo));
+    sign = _mm_srai_epi16(prod_hi, 15);
+
+    acc_lo4 = _mm_add_epi32(ACC_W_LO, _mm_unpacklo_epi16(prod_hi, sign));
+    acc_hi4 = _mm_add_epi32(ACC_W_HI, _mm_unpackhi_epi16(prod_hi, sign));
+    ACC_W_LO = acc_lo4;
+    ACC_W_HI = acc_hi4;
+    return clamp_low(acc_lo4, acc_hi4, acc_lo);
+}
+
+VECTOR_OPERATION VMADH(v16 vs, v16 vt)
+{
+    v16 prod_hi, prod_lo;
+    v16 acc_lo4, acc_hi4;
+
+    prod_lo = _mm_mullo_epi16(vs, vt);
+    prod_hi = _mm_mulhi_epi16(vs, vt);
+    acc_lo4 = _mm_add_epi32(ACC_W_LO, _mm_unpacklo_epi16(prod_lo, prod_hi));
+    acc_hi4 = _mm_add_epi32(ACC_W_HI, _mm_unpackhi_epi16(prod_lo, prod_hi));
+    ACC_W_LO = acc_lo4;
+    ACC_W_HI = acc_hi4;
+    return clamp_mid(acc_lo4, acc_hi4);
+}
+#else
+
+#ifndef ARCH_MIN_SSE2
+/*
+ * the 16-bit results of the multiplies, from the accumulator:
+ *     SIGNED_CLAMP_AM:  acc_31..16, signed clamp of acc_47..16
+ *     SIGNED_CLAMP_AL:  acc_15..0 if acc_47..16 fits in 16 bits, else 0x0000
+ *         if it is negative or 0xFFFF if it is positive
+ *     UNSIGNED_CLAMP:  0x0000 if acc_47..16 is negative, 0xFFFF if it is more
+ *         than +32767, else acc_31..16
+ */
+static INLINE void SIGNED_CLAMP_AM(pi16 VD)
+{
+    i16 hi[N], lo[N];
+    register unsigned int i;
+
+    for (i = 0; i < N; i++)
+        lo[i] = -((VACC_H[i] < ~0) | ((VACC_H[i] == ~0) & (VACC_M[i] >= 0)));
+    for (i = 0; i < N; i++)
+        hi[i] = -((VACC_H[i] >  0) | ((VACC_H[i] ==  0) & (VACC_M[i] <  0)));
+    vector_copy(VD, VACC_M);
+    for (i = 0; i < N; i++)
+        VD[i] &= ~lo[i];
+    for (i = 0; i < N; i++)
+        VD[i] |=  hi[i];
+    for (i = 0; i < N; i++)
+        VD[i] ^= 0x8000 & (hi[i] | lo[i]);
+    return;
+}
+static INLINE void SIGNED_CLAMP_AL(pi16 VD)
+{
+    i16 hi[N], lo[N];
+    register unsigned int i;
+
+    for (i = 0; i < N; i++)
+        lo[i] = -((VACC_H[i] < ~0) | ((VACC_H[i] == ~0) & (VACC_M[i] >= 0)));
+    for (i = 0; i < N; i++)
+        hi[i] = -((VACC_H[i] >  0) | ((VACC_H[i] ==  0) & (VACC_M[i] <  0)));
+    vector_copy(VD, VACC_L);
+    for (i = 0; i < N; i++)
+        VD[i] &= ~lo[i];
+    for (i = 0; i < N; i++)
+        VD[i] |=  hi[i];
+    return;
+}
+static INLINE void UNSIGNED_CLAMP(pi16 VD)
+{
+    i16 hi[N], lo[N];
+    register unsigned int i;
+
+    for (i = 0; i < N; i++)
+        lo[i] = -(VACC_H[i] < 0);
+    for (i = 0; i < N; i++)
+        hi[i] = -((VACC_H[i] >  0) | ((VACC_H[i] ==  0) & (VACC_M[i] <  0)));
+    vector_copy(VD, VACC_M);
+    for (i = 0; i < N; i++)
+        VD[i] &= ~lo[i];
+    for (i = 0; i < N; i++)
+        VD[i] |=  hi[i];
+    return;
+}
+#endif
+
 #ifdef ARCH_MIN_SSE2
+static INLINE v16 do_mulf(v16 vs, v16 vt, v16 * acc)
+{
     v16 negative;
     v16 round;
     v16 prod_hi, prod_lo;
@@ -47,9 +435,9 @@ VECTOR_OPERATION VMULF(v16 vs, v16 vt)
     round = _mm_slli_epi16(round, 15);
 
     prod_lo = _mm_xor_si128(prod_lo, round); /* Or += 32768 works also. */
-    *(v16 *)VACC_L = prod_lo;
+    acc[LO] = prod_lo;
     prod_hi = _mm_add_epi16(prod_hi, negative);
-    *(v16 *)VACC_M = prod_hi;
+    acc[MD] = prod_hi;
 
 /*
  * VMULF does signed clamping.  However, in VMULF's case, the only possible
@@ -63,9 +451,17 @@ VECTOR_OPERATION VMULF(v16 vs, v16 vt)
     vs = _mm_and_si128(vs, vt); /* vs == vt == -32768:  corner case confirmed */
 
     negative = _mm_xor_si128(negative, vs);
-    *(v16 *)VACC_H = negative; /* 2*i16*i16 only fills L/M; VACC_H = 0 or ~0. */
+    acc[HI] = negative; /* 2*i16*i16 only fills L/M; VACC_H = 0 or ~0. */
     return _mm_add_epi16(vs, prod_hi); /* prod_hi must be -32768; - 1 = +32767 */
+}
+#endif
+
+VECTOR_OPERATION VMULF(v16 vs, v16 vt)
+{
+#ifdef ARCH_MIN_SSE2
+    return do_mulf(vs, vt, (v16 *)RSP_STATE.VACC);
 #else
+    ALIGNED i16 VD[N];
     word_64 product[N]; /* (-32768 * -32768)<<1 + 32768 confuses 32-bit type. */
     register unsigned int i;
 
@@ -81,13 +477,20 @@ VECTOR_OPERATION VMULF(v16 vs, v16 vt)
         VACC_M[i] = (product[i].UW & 0x0000FFFF0000) >> 16;
     for (i = 0; i < N; i++)
         VACC_H[i] = -(product[i].SW < 0); /* product>>32 & 0xFFFF */
-    SIGNED_CLAMP_AM(V_result);
+    SIGNED_CLAMP_AM(VD);
+#ifdef ARCH_VECTOR_EXTENSIONS
+    COMPILER_FENCE();
+    vs = *(v16 *)VD;
+    return (vs);
+#else
+    vector_copy(RSP_STATE.V_result, VD);
+#endif
 #endif
 }
 
-VECTOR_OPERATION VMULU(v16 vs, v16 vt)
-{
 #ifdef ARCH_MIN_SSE2
+static INLINE v16 do_mulu(v16 vs, v16 vt, v16 * acc)
+{
     v16 negative;
     v16 round;
     v16 prod_hi, prod_lo;
@@ -109,9 +512,9 @@ VECTOR_OPERATION VMULU(v16 vs, v16 vt)
     round = _mm_slli_epi16(round, 15);
 
     prod_lo = _mm_xor_si128(prod_lo, round);
-    *(v16 *)VACC_L = prod_lo;
+    acc[LO] = prod_lo;
     prod_hi = _mm_add_epi16(prod_hi, negative);
-    *(v16 *)VACC_M = prod_hi;
+    acc[MD] = prod_hi;
 
 /*
  * VMULU does unsigned clamping.  However, in VMULU's case, the only possible
@@ -122,12 +525,20 @@ VECTOR_OPERATION VMULU(v16 vs, v16 vt)
     vt = _mm_cmpeq_epi16(vt, round); /* vt == -32768 ? ~0 : 0 */
     vs = _mm_and_si128(vs, vt); /* vs == vt == -32768:  corner case confirmed */
     negative = _mm_xor_si128(negative, vs);
-    *(v16 *)VACC_H = negative; /* 2*i16*i16 only fills L/M; VACC_H = 0 or ~0. */
+    acc[HI] = negative; /* 2*i16*i16 only fills L/M; VACC_H = 0 or ~0. */
 
     prod_lo = _mm_srai_epi16(prod_hi, 15); /* unsigned overflow mask */
     vs = _mm_or_si128(prod_hi, prod_lo);
     return _mm_andnot_si128(negative, vs); /* unsigned underflow mask */
+}
+#endif
+
+VECTOR_OPERATION VMULU(v16 vs, v16 vt)
+{
+#ifdef ARCH_MIN_SSE2
+    return do_mulu(vs, vt, (v16 *)RSP_STATE.VACC);
 #else
+    ALIGNED i16 VD[N];
     word_64 product[N]; /* (-32768 * -32768)<<1 + 32768 confuses 32-bit type. */
     register unsigned int i;
 
@@ -143,19 +554,33 @@ VECTOR_OPERATION VMULU(v16 vs, v16 vt)
         VACC_M[i] = (product[i].UW & 0x0000FFFF0000) >> 16;
     for (i = 0; i < N; i++)
         VACC_H[i] = -(product[i].SW < 0); /* product>>32 & 0xFFFF */
-    UNSIGNED_CLAMP(V_result);
+    UNSIGNED_CLAMP(VD);
+#ifdef ARCH_VECTOR_EXTENSIONS
+    COMPILER_FENCE();
+    vs = *(v16 *)VD;
+    return (vs);
+#else
+    vector_copy(RSP_STATE.V_result, VD);
+#endif
 #endif
 }
 
-VECTOR_OPERATION VMUDL(v16 vs, v16 vt)
-{
 #ifdef ARCH_MIN_SSE2
+static INLINE v16 do_mudl(v16 vs, v16 vt, v16 * acc)
+{
     vs = _mm_mulhi_epu16(vs, vt);
     vector_wipe(vt); /* (UINT16_MAX * UINT16_MAX) >> 16 too small for MD/HI */
-    *(v16 *)VACC_L = vs;
-    *(v16 *)VACC_M = vt;
-    *(v16 *)VACC_H = vt;
+    acc[LO] = vs;
+    acc[MD] = vt;
+    acc[HI] = vt;
     return (vs); /* no possibilities to clamp */
+}
+#endif
+
+VECTOR_OPERATION VMUDL(v16 vs, v16 vt)
+{
+#ifdef ARCH_MIN_SSE2
+    return do_mudl(vs, vt, (v16 *)RSP_STATE.VACC);
 #else
     word_32 product[N];
     register unsigned int i;
@@ -164,15 +589,20 @@ VECTOR_OPERATION VMUDL(v16 vs, v16 vt)
         product[i].UW = (u16)vs[i] * (u16)vt[i];
     for (i = 0; i < N; i++)
         VACC_L[i] = product[i].UW >> 16; /* product[i].H[HES(0) >> 1] */
-    vector_copy(V_result, VACC_L);
     vector_wipe(VACC_M);
     vector_wipe(VACC_H);
+#ifdef ARCH_VECTOR_EXTENSIONS
+    vs = *(v16 *)VACC_L;
+    return (vs);
+#else
+    vector_copy(RSP_STATE.V_result, VACC_L);
+#endif
 #endif
 }
 
-VECTOR_OPERATION VMUDM(v16 vs, v16 vt)
-{
 #ifdef ARCH_MIN_SSE2
+static INLINE v16 do_mudm(v16 vs, v16 vt, v16 * acc)
+{
     v16 prod_hi, prod_lo;
 
     prod_lo = _mm_mullo_epi16(vs, vt);
@@ -186,12 +616,19 @@ VECTOR_OPERATION VMUDM(v16 vs, v16 vt)
     vt = _mm_and_si128(vt, vs);
     prod_hi = _mm_sub_epi16(prod_hi, vt);
 
-    *(v16 *)VACC_L = prod_lo;
-    *(v16 *)VACC_M = prod_hi;
+    acc[LO] = prod_lo;
+    acc[MD] = prod_hi;
     vs = prod_hi;
     prod_hi = _mm_srai_epi16(prod_hi, 15);
-    *(v16 *)VACC_H = prod_hi;
+    acc[HI] = prod_hi;
     return (vs);
+}
+#endif
+
+VECTOR_OPERATION VMUDM(v16 vs, v16 vt)
+{
+#ifdef ARCH_MIN_SSE2
+    return do_mudm(vs, vt, (v16 *)RSP_STATE.VACC);
 #else
     word_32 product[N];
     register unsigned int i;
@@ -204,13 +641,18 @@ VECTOR_OPERATION VMUDM(v16 vs, v16 vt)
         VACC_M[i] = (product[i].W & 0x0000FFFF0000) >> 16;
     for (i = 0; i < N; i++)
         VACC_H[i] = -(VACC_M[i] < 0);
-    vector_copy(V_result, VACC_M);
+#ifdef ARCH_VECTOR_EXTENSIONS
+    vs = *(v16 *)VACC_M;
+    return (vs);
+#else
+    vector_copy(RSP_STATE.V_result, VACC_M);
+#endif
 #endif
 }
 
-VECTOR_OPERATION VMUDN(v16 vs, v16 vt)
-{
 #ifdef ARCH_MIN_SSE2
+static INLINE v16 do_mudn(v16 vs, v16 vt, v16 * acc)
+{
     v16 prod_hi, prod_lo;
 
     prod_lo = _mm_mullo_epi16(vs, vt);
@@ -224,11 +666,18 @@ VECTOR_OPERATION VMUDN(v16 vs, v16 vt)
     vs = _mm_and_si128(vs, vt);
     prod_hi = _mm_sub_epi16(prod_hi, vs);
 
-    *(v16 *)VACC_L = prod_lo;
-    *(v16 *)VACC_M = prod_hi;
+    acc[LO] = prod_lo;
+    acc[MD] = prod_hi;
     prod_hi = _mm_srai_epi16(prod_hi, 15);
-    *(v16 *)VACC_H = prod_hi;
+    acc[HI] = prod_hi;
     return (prod_lo);
+}
+#endif
+
+VECTOR_OPERATION VMUDN(v16 vs, v16 vt)
+{
+#ifdef ARCH_MIN_SSE2
+    return do_mudn(vs, vt, (v16 *)RSP_STATE.VACC);
 #else
     word_32 product[N];
     register unsigned int i;
@@ -241,21 +690,26 @@ VECTOR_OPERATION VMUDN(v16 vs, v16 vt)
         VACC_M[i] = (product[i].W & 0x0000FFFF0000) >> 16;
     for (i = 0; i < N; i++)
         VACC_H[i] = -(VACC_M[i] < 0);
-    vector_copy(V_result, VACC_L);
+#ifdef ARCH_VECTOR_EXTENSIONS
+    vs = *(v16 *)VACC_L;
+    return (vs);
+#else
+    vector_copy(RSP_STATE.V_result, VACC_L);
+#endif
 #endif
 }
 
-VECTOR_OPERATION VMUDH(v16 vs, v16 vt)
-{
 #ifdef ARCH_MIN_SSE2
+static INLINE v16 do_mudh(v16 vs, v16 vt, v16 * acc)
+{
     v16 prod_high;
 
     prod_high = _mm_mulhi_epi16(vs, vt);
     vs        = _mm_mullo_epi16(vs, vt);
 
-    *(v16 *)VACC_L = _mm_setzero_si128();
-    *(v16 *)VACC_M = vs; /* acc 31..16 storing (VS*VT)15..0 */
-    *(v16 *)VACC_H = prod_high; /* acc 47..32 storing (VS*VT)31..16 */
+    acc[LO] = _mm_setzero_si128();
+    acc[MD] = vs; /* acc 31..16 storing (VS*VT)15..0 */
+    acc[HI] = prod_high; /* acc 47..32 storing (VS*VT)31..16 */
 
 /*
  * "Unpack" the low 16 bits and the high 16 bits of each 32-bit product to a
@@ -269,7 +723,15 @@ VECTOR_OPERATION VMUDH(v16 vs, v16 vt)
  * signed saturation:  prod < -32768 to -32768 and prod > +32767 to +32767.
  */
     return _mm_packs_epi32(vs, vt);
+}
+#endif
+
+VECTOR_OPERATION VMUDH(v16 vs, v16 vt)
+{
+#ifdef ARCH_MIN_SSE2
+    return do_mudh(vs, vt, (v16 *)RSP_STATE.VACC);
 #else
+    ALIGNED i16 VD[N];
     word_32 product[N];
     register unsigned int i;
 
@@ -280,13 +742,20 @@ VECTOR_OPERATION VMUDH(v16 vs, v16 vt)
         VACC_M[i] = (s16)(product[i].W >>  0); /* product[i].HW[HES(0) >> 1] */
     for (i = 0; i < N; i++)
         VACC_H[i] = (s16)(product[i].W >> 16); /* product[i].HW[HES(2) >> 1] */
-    SIGNED_CLAMP_AM(V_result);
+    SIGNED_CLAMP_AM(VD);
+#ifdef ARCH_VECTOR_EXTENSIONS
+    COMPILER_FENCE();
+    vs = *(v16 *)VD;
+    return (vs);
+#else
+    vector_copy(RSP_STATE.V_result, VD);
+#endif
 #endif
 }
 
-VECTOR_OPERATION VMACF(v16 vs, v16 vt)
-{
 #ifdef ARCH_MIN_SSE2
+static INLINE v16 do_macf(v16 vs, v16 vt, v16 * acc)
+{
     v16 acc_hi, acc_md, acc_lo;
     v16 prod_hi, prod_lo;
     v16 overflow, overflow_new;
@@ -302,12 +771,12 @@ VECTOR_OPERATION VMACF(v16 vs, v16 vt)
     prod_hi = _mm_add_epi16(prod_hi, prod_hi);
     prod_hi = _mm_or_si128(prod_hi, overflow); /* Carry lo's MSB to hi's LSB. */
 
-    acc_lo = *(v16 *)VACC_L;
-    acc_md = *(v16 *)VACC_M;
-    acc_hi = *(v16 *)VACC_H;
+    acc_lo = acc[LO];
+    acc_md = acc[MD];
+    acc_hi = acc[HI];
 
     acc_lo = _mm_add_epi16(acc_lo, prod_lo);
-    *(v16 *)VACC_L = acc_lo;
+    acc[LO] = acc_lo;
     overflow = _mm_cmplt_epu16(acc_lo, prod_lo); /* a + b < a + 0 ? ~0 : 0 */
 
     acc_md = _mm_add_epi16(acc_md, prod_hi);
@@ -315,17 +784,25 @@ VECTOR_OPERATION VMACF(v16 vs, v16 vt)
     acc_md = _mm_sub_epi16(acc_md, overflow); /* m - (overflow = ~0) == m + 1 */
     carry = _mm_cmpeq_epi16(acc_md, _mm_setzero_si128());
     carry = _mm_and_si128(carry, overflow); /* ~0 - (-1) == 0 && (-1) != 0 */
-    *(v16 *)VACC_M = acc_md;
+    acc[MD] = acc_md;
     overflow = _mm_or_si128(carry, overflow_new);
 
     acc_hi = _mm_sub_epi16(acc_hi, overflow);
     acc_hi = _mm_sub_epi16(acc_hi, prod_neg);
-    *(v16 *)VACC_H = acc_hi;
+    acc[HI] = acc_hi;
 
     vt = _mm_unpackhi_epi16(acc_md, acc_hi);
     vs = _mm_unpacklo_epi16(acc_md, acc_hi);
     return _mm_packs_epi32(vs, vt);
+}
+#endif
+
+VECTOR_OPERATION VMACF(v16 vs, v16 vt)
+{
+#ifdef ARCH_MIN_SSE2
+    return do_macf(vs, vt, (v16 *)RSP_STATE.VACC);
 #else
+    ALIGNED i16 VD[N];
     word_32 product[N], addend[N];
     register unsigned int i;
 
@@ -347,13 +824,20 @@ VECTOR_OPERATION VMACF(v16 vs, v16 vt)
         VACC_H[i] -= (product[i].SW < 0);
     for (i = 0; i < N; i++)
         VACC_H[i] += addend[i].UW >> 16;
-    SIGNED_CLAMP_AM(V_result);
+    SIGNED_CLAMP_AM(VD);
+#ifdef ARCH_VECTOR_EXTENSIONS
+    COMPILER_FENCE();
+    vs = *(v16 *)VD;
+    return (vs);
+#else
+    vector_copy(RSP_STATE.V_result, VD);
+#endif
 #endif
 }
 
-VECTOR_OPERATION VMACU(v16 vs, v16 vt)
-{
 #ifdef ARCH_MIN_SSE2
+static INLINE v16 do_macu(v16 vs, v16 vt, v16 * acc)
+{
     v16 acc_hi, acc_md, acc_lo;
     v16 prod_hi, prod_lo;
     v16 overflow, overflow_new;
@@ -369,12 +853,12 @@ VECTOR_OPERATION VMACU(v16 vs, v16 vt)
     prod_hi = _mm_add_epi16(prod_hi, prod_hi);
     prod_hi = _mm_or_si128(prod_hi, overflow); /* Carry lo's MSB to hi's LSB. */
 
-    acc_lo = *(v16 *)VACC_L;
-    acc_md = *(v16 *)VACC_M;
-    acc_hi = *(v16 *)VACC_H;
+    acc_lo = acc[LO];
+    acc_md = acc[MD];
+    acc_hi = acc[HI];
 
     acc_lo = _mm_add_epi16(acc_lo, prod_lo);
-    *(v16 *)VACC_L = acc_lo;
+    acc[LO] = acc_lo;
     overflow = _mm_cmplt_epu16(acc_lo, prod_lo); /* a + b < a + 0 ? ~0 : 0 */
 
     acc_md = _mm_add_epi16(acc_md, prod_hi);
@@ -382,12 +866,12 @@ VECTOR_OPERATION VMACU(v16 vs, v16 vt)
     acc_md = _mm_sub_epi16(acc_md, overflow); /* m - (overflow = ~0) == m + 1 */
     carry = _mm_cmpeq_epi16(acc_md, _mm_setzero_si128());
     carry = _mm_and_si128(carry, overflow); /* ~0 - (-1) == 0 && (-1) != 0 */
-    *(v16 *)VACC_M = acc_md;
+    acc[MD] = acc_md;
     overflow = _mm_or_si128(carry, overflow_new);
 
     acc_hi = _mm_sub_epi16(acc_hi, overflow);
     acc_hi = _mm_sub_epi16(acc_hi, prod_neg);
-    *(v16 *)VACC_H = acc_hi;
+    acc[HI] = acc_hi;
 
     vt = _mm_unpackhi_epi16(acc_md, acc_hi);
     vs = _mm_unpacklo_epi16(acc_md, acc_hi);
@@ -395,7 +879,15 @@ VECTOR_OPERATION VMACU(v16 vs, v16 vt)
     overflow = _mm_cmplt_epi16(acc_md, vs);
     vs = _mm_andnot_si128(_mm_srai_epi16(vs, 15), vs);
     return _mm_or_si128(vs, overflow);
+}
+#endif
+
+VECTOR_OPERATION VMACU(v16 vs, v16 vt)
+{
+#ifdef ARCH_MIN_SSE2
+    return do_macu(vs, vt, (v16 *)RSP_STATE.VACC);
 #else
+    ALIGNED i16 VD[N];
     word_32 product[N], addend[N];
     register unsigned int i;
 
@@ -417,13 +909,20 @@ VECTOR_OPERATION VMACU(v16 vs, v16 vt)
         VACC_H[i] -= (product[i].SW < 0);
     for (i = 0; i < N; i++)
         VACC_H[i] += addend[i].UW >> 16;
-    UNSIGNED_CLAMP(V_result);
+    UNSIGNED_CLAMP(VD);
+#ifdef ARCH_VECTOR_EXTENSIONS
+    COMPILER_FENCE();
+    vs = *(v16 *)VD;
+    return (vs);
+#else
+    vector_copy(RSP_STATE.V_result, VD);
+#endif
 #endif
 }
 
-VECTOR_OPERATION VMADL(v16 vs, v16 vt)
-{
 #ifdef ARCH_MIN_SSE2
+static INLINE v16 do_madl(v16 vs, v16 vt, v16 * acc)
+{
     v16 acc_hi, acc_md, acc_lo;
     v16 prod_hi;
     v16 overflow, overflow_new;
@@ -431,16 +930,16 @@ VECTOR_OPERATION VMADL(v16 vs, v16 vt)
  /* prod_lo = _mm_mullo_epi16(vs, vt); */
     prod_hi = _mm_mulhi_epu16(vs, vt);
 
-    acc_lo = *(v16 *)VACC_L;
-    acc_md = *(v16 *)VACC_M;
-    acc_hi = *(v16 *)VACC_H;
+    acc_lo = acc[LO];
+    acc_md = acc[MD];
+    acc_hi = acc[HI];
 
     acc_lo = _mm_add_epi16(acc_lo, prod_hi);
-    *(v16 *)VACC_L = acc_lo;
+    acc[LO] = acc_lo;
 
     overflow = _mm_cmplt_epu16(acc_lo, prod_hi); /* overflow:  (x + y < y) */
     acc_md = _mm_sub_epi16(acc_md, overflow);
-    *(v16 *)VACC_M = acc_md;
+    acc[MD] = acc_md;
 
 /*
  * Luckily for us, taking unsigned * unsigned always evaluates to something
@@ -449,7 +948,7 @@ VECTOR_OPERATION VMADL(v16 vs, v16 vt)
     overflow_new = _mm_cmpeq_epi16(acc_md, _mm_setzero_si128());
     overflow = _mm_and_si128(overflow, overflow_new);
     acc_hi = _mm_sub_epi16(acc_hi, overflow);
-    *(v16 *)VACC_H = acc_hi;
+    acc[HI] = acc_hi;
 
 /*
  * Do a signed clamp...sort of (VM?DM, VM?DH:  middle; VM?DL, VM?DN:  low).
@@ -472,7 +971,15 @@ VECTOR_OPERATION VMADL(v16 vs, v16 vt)
     vs = _mm_or_si128(vs, acc_lo); /*                   : acc_lo */
     acc_md = _mm_slli_epi16(acc_md, 15); /* ... ? ^ 0x8000 : ^ 0x0000 */
     return _mm_xor_si128(vs, acc_md); /* stupid unsigned-clamp-ish adjustment */
+}
+#endif
+
+VECTOR_OPERATION VMADL(v16 vs, v16 vt)
+{
+#ifdef ARCH_MIN_SSE2
+    return do_madl(vs, vt, (v16 *)RSP_STATE.VACC);
 #else
+    ALIGNED i16 VD[N];
     word_32 product[N], addend[N];
     register unsigned int i;
 
@@ -490,13 +997,20 @@ VECTOR_OPERATION VMADL(v16 vs, v16 vt)
         VACC_M[i] = addend[i].UW & 0x0000FFFF;
     for (i = 0; i < N; i++)
         VACC_H[i] += addend[i].UW >> 16;
-    SIGNED_CLAMP_AL(V_result);
+    SIGNED_CLAMP_AL(VD);
+#ifdef ARCH_VECTOR_EXTENSIONS
+    COMPILER_FENCE();
+    vs = *(v16 *)VD;
+    return (vs);
+#else
+    vector_copy(RSP_STATE.V_result, VD);
+#endif
 #endif
 }
 
-VECTOR_OPERATION VMADM(v16 vs, v16 vt)
-{
 #ifdef ARCH_MIN_SSE2
+static INLINE v16 do_madm(v16 vs, v16 vt, v16 * acc)
+{
     v16 acc_hi, acc_md, acc_lo;
     v16 prod_hi, prod_lo;
     v16 overflow;
@@ -512,28 +1026,36 @@ VECTOR_OPERATION VMADM(v16 vs, v16 vt)
  * Writeback phase to the accumulator.
  * VMADM stores accumulator += the product achieved by VMUDM.
  */
-    acc_lo = *(v16 *)VACC_L;
-    acc_md = *(v16 *)VACC_M;
-    acc_hi = *(v16 *)VACC_H;
+    acc_lo = acc[LO];
+    acc_md = acc[MD];
+    acc_hi = acc[HI];
 
     acc_lo = _mm_add_epi16(acc_lo, prod_lo);
-    *(v16 *)VACC_L = acc_lo;
+    acc[LO] = acc_lo;
 
     overflow = _mm_cmplt_epu16(acc_lo, prod_lo); /* overflow:  (x + y < y) */
     prod_hi = _mm_sub_epi16(prod_hi, overflow);
     acc_md = _mm_add_epi16(acc_md, prod_hi);
-    *(v16 *)VACC_M = acc_md;
+    acc[MD] = acc_md;
 
     overflow = _mm_cmplt_epu16(acc_md, prod_hi);
     prod_hi = _mm_srai_epi16(prod_hi, 15);
     acc_hi = _mm_add_epi16(acc_hi, prod_hi);
     acc_hi = _mm_sub_epi16(acc_hi, overflow);
-    *(v16 *)VACC_H = acc_hi;
+    acc[HI] = acc_hi;
 
     vt = _mm_unpackhi_epi16(acc_md, acc_hi);
     vs = _mm_unpacklo_epi16(acc_md, acc_hi);
     return _mm_packs_epi32(vs, vt);
+}
+#endif
+
+VECTOR_OPERATION VMADM(v16 vs, v16 vt)
+{
+#ifdef ARCH_MIN_SSE2
+    return do_madm(vs, vt, (v16 *)RSP_STATE.VACC);
 #else
+    ALIGNED i16 VD[N];
     word_32 product[N], addend[N];
     register unsigned int i;
 
@@ -551,13 +1073,20 @@ VECTOR_OPERATION VMADM(v16 vs, v16 vt)
         VACC_M[i] = addend[i].UW & 0x0000FFFF;
     for (i = 0; i < N; i++)
         VACC_H[i] += addend[i].UW >> 16;
-    SIGNED_CLAMP_AM(V_result);
+    SIGNED_CLAMP_AM(VD);
+#ifdef ARCH_VECTOR_EXTENSIONS
+    COMPILER_FENCE();
+    vs = *(v16 *)VD;
+    return (vs);
+#else
+    vector_copy(RSP_STATE.V_result, VD);
+#endif
 #endif
 }
 
-VECTOR_OPERATION VMADN(v16 vs, v16 vt)
-{
 #ifdef ARCH_MIN_SSE2
+static INLINE v16 do_madn(v16 vs, v16 vt, v16 * acc)
+{
     v16 acc_hi, acc_md, acc_lo;
     v16 prod_hi, prod_lo;
     v16 overflow;
@@ -573,23 +1102,23 @@ VECTOR_OPERATION VMADN(v16 vs, v16 vt)
  * Writeback phase to the accumulator.
  * VMADN stores accumulator += the product achieved by VMUDN.
  */
-    acc_lo = *(v16 *)VACC_L;
-    acc_md = *(v16 *)VACC_M;
-    acc_hi = *(v16 *)VACC_H;
+    acc_lo = acc[LO];
+    acc_md = acc[MD];
+    acc_hi = acc[HI];
 
     acc_lo = _mm_add_epi16(acc_lo, prod_lo);
-    *(v16 *)VACC_L = acc_lo;
+    acc[LO] = acc_lo;
 
     overflow = _mm_cmplt_epu16(acc_lo, prod_lo); /* overflow:  (x + y < y) */
     prod_hi = _mm_sub_epi16(prod_hi, overflow);
     acc_md = _mm_add_epi16(acc_md, prod_hi);
-    *(v16 *)VACC_M = acc_md;
+    acc[MD] = acc_md;
 
     overflow = _mm_cmplt_epu16(acc_md, prod_hi);
     prod_hi = _mm_srai_epi16(prod_hi, 15);
     acc_hi = _mm_add_epi16(acc_hi, prod_hi);
     acc_hi = _mm_sub_epi16(acc_hi, overflow);
-    *(v16 *)VACC_H = acc_hi;
+    acc[HI] = acc_hi;
 
 /*
  * Do a signed clamp...sort of (VM?DM, VM?DH:  middle; VM?DL, VM?DN:  low).
@@ -612,7 +1141,15 @@ VECTOR_OPERATION VMADN(v16 vs, v16 vt)
     vs = _mm_or_si128(vs, acc_lo); /*                   : acc_lo */
     acc_md = _mm_slli_epi16(acc_md, 15); /* ... ? ^ 0x8000 : ^ 0x0000 */
     return _mm_xor_si128(vs, acc_md); /* stupid unsigned-clamp-ish adjustment */
+}
+#endif
+
+VECTOR_OPERATION VMADN(v16 vs, v16 vt)
+{
+#ifdef ARCH_MIN_SSE2
+    return do_madn(vs, vt, (v16 *)RSP_STATE.VACC);
 #else
+    ALIGNED i16 VD[N];
     word_32 product[N], addend[N];
     register unsigned int i;
 
@@ -630,13 +1167,20 @@ VECTOR_OPERATION VMADN(v16 vs, v16 vt)
         VACC_M[i] = addend[i].UW & 0x0000FFFF;
     for (i = 0; i < N; i++)
         VACC_H[i] += addend[i].UW >> 16;
-    SIGNED_CLAMP_AL(V_result);
+    SIGNED_CLAMP_AL(VD);
+#ifdef ARCH_VECTOR_EXTENSIONS
+    COMPILER_FENCE();
+    vs = *(v16 *)VD;
+    return (vs);
+#else
+    vector_copy(RSP_STATE.V_result, VD);
+#endif
 #endif
 }
 
-VECTOR_OPERATION VMADH(v16 vs, v16 vt)
-{
 #ifdef ARCH_MIN_SSE2
+static INLINE v16 do_madh(v16 vs, v16 vt, v16 * acc)
+{
     v16 acc_mid;
     v16 prod_high;
 
@@ -647,10 +1191,10 @@ VECTOR_OPERATION VMADH(v16 vs, v16 vt)
  * We're required to load the source product from the accumulator to add to.
  * While we're at it, conveniently sneak in a acc[31..16] += (vs*vt)[15..0].
  */
-    acc_mid = *(v16 *)VACC_M;
+    acc_mid = acc[MD];
     vs = _mm_add_epi16(vs, acc_mid);
-    *(v16 *)VACC_M = vs;
-    vt = *(v16 *)VACC_H;
+    acc[MD] = vs;
+    vt = acc[HI];
 
 /*
  * While accumulating base_lo + product_lo is easy, getting the correct data
@@ -661,15 +1205,22 @@ VECTOR_OPERATION VMADH(v16 vs, v16 vt)
  * MMX-based instruction sets define unsigned comparison ops FOR us, so...
  */
     vt = _mm_add_epi16(vt, prod_high);
-    vs = _mm_cmplt_epu16(vs, acc_mid); /* acc.mid + prod.low < acc.mid */
-    vt = _mm_sub_epi16(vt, vs); /* += 1 if overflow, by doing -= ~0 */
-    *(v16 *)VACC_H = vt;
+    acc_mid = _mm_cmplt_epu16(vs, acc_mid); /* acc.mid + prod.low < acc.mid */
+    vt = _mm_sub_epi16(vt, acc_mid); /* += 1 if overflow, by doing -= ~0 */
+    acc[HI] = vt;
 
-    vs = *(v16 *)VACC_M;
     prod_high = _mm_unpackhi_epi16(vs, vt);
     vs        = _mm_unpacklo_epi16(vs, vt);
     return _mm_packs_epi32(vs, prod_high);
+}
+#endif
+
+VECTOR_OPERATION VMADH(v16 vs, v16 vt)
+{
+#ifdef ARCH_MIN_SSE2
+    return do_madh(vs, vt, (v16 *)RSP_STATE.VACC);
 #else
+    ALIGNED i16 VD[N];
     word_32 product[N], addend[N];
     register unsigned int i;
 
@@ -681,6 +1232,84 @@ VECTOR_OPERATION VMADH(v16 vs, v16 vt)
         VACC_M[i] += (i16)product[i].SW;
     for (i = 0; i < N; i++)
         VACC_H[i] += (addend[i].UW >> 16) + (product[i].SW >> 16);
-    SIGNED_CLAMP_AM(V_result);
+    SIGNED_CLAMP_AM(VD);
+#ifdef ARCH_VECTOR_EXTENSIONS
+    COMPILER_FENCE();
+    vs = *(v16 *)VD;
+    return (vs);
+#else
+    vector_copy(RSP_STATE.V_result, VD);
 #endif
+#endif
+}
+
+#ifdef ARCH_MIN_SSE2
+/*
+ * Result-only multiplies, for when no op reads what these would write to the
+ * accumulator before it is all written again (see `predecode_IMEM').  The
+ * stores to `dead' are dead stores, which the compiler drops.
+ */
+#define RESULT_ONLY(name, kernel) \
+VECTOR_OPERATION name(v16 vs, v16 vt) \
+{ \
+    v16 dead[3]; \
+\
+    dead[LO] = *(v16 *)VACC_L; \
+    dead[MD] = *(v16 *)VACC_M; \
+    dead[HI] = *(v16 *)VACC_H; \
+    return kernel(vs, vt, dead); \
 }
+
+RESULT_ONLY(VMULF_R, do_mulf)
+RESULT_ONLY(VMULU_R, do_mulu)
+RESULT_ONLY(VMUDL_R, do_mudl)
+RESULT_ONLY(VMUDM_R, do_mudm)
+RESULT_ONLY(VMUDN_R, do_mudn)
+RESULT_ONLY(VMUDH_R, do_mudh)
+RESULT_ONLY(VMACF_R, do_macf)
+RESULT_ONLY(VMACU_R, do_macu)
+RESULT_ONLY(VMADL_R, do_madl)
+RESULT_ONLY(VMADM_R, do_madm)
+RESULT_ONLY(VMADN_R, do_madn)
+RESULT_ONLY(VMADH_R, do_madh)
+
+/*
+ * a run of multiplies, with the accumulator kept in registers from the first
+ * to the last of them (see `fuse_idioms'):  the same as doing them one at a
+ * time, even where one of them reads what an earlier one wrote to VR
+ */
+void VMUL_run(const u32 * IW, unsigned int count)
+{
+    v16 acc[3];
+    v16 vs, vt;
+    register unsigned int i;
+
+    acc[LO] = *(v16 *)VACC_L;
+    acc[MD] = *(v16 *)VACC_M;
+    acc[HI] = *(v16 *)VACC_H;
+    for (i = 0; i < count; i++) {
+        vs = *(v16 *)RSP_STATE.VR[IW_VS(IW[i])];
+        vt = broadcast(*(v16 *)RSP_STATE.VR[IW_VT(IW[i])], IW_E(IW[i]));
+        switch (IW[i] % 64) {
+        case 000:  vs = do_mulf(vs, vt, acc);  break;
+        case 001:  vs = do_mulu(vs, vt, acc);  break;
+        case 004:  vs = do_mudl(vs, vt, acc);  break;
+        case 005:  vs = do_mudm(vs, vt, acc);  break;
+        case 006:  vs = do_mudn(vs, vt, acc);  break;
+        case 007:  vs = do_mudh(vs, vt, acc);  break;
+        case 010:  vs = do_macf(vs, vt, acc);  break;
+        case 011:  vs = do_macu(vs, vt, acc);  break;
+        case 014:  vs = do_madl(vs, vt, acc);  break;
+        case 015:  vs = do_madm(vs, vt, acc);  break;
+        case 016:  vs = do_madn(vs, vt, acc);  break;
+        case 017:  vs = do_madh(vs, vt, acc);  break;
+        }
+        *(v16 *)RSP_STATE.VR[IW_VD(IW[i])] = vs;
+    }
+    *(v16 *)VACC_L = acc[LO];
+    *(v16 *)VACC_M = acc[MD];
+    *(v16 *)VACC_H = acc[HI];
+    return;
+}
+#endif
+#endif
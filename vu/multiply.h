@@ -66,6 +66,43 @@ VECTOR_EXTERN
 VECTOR_EXTERN
     VMADH  (v16 vs, v16 vt);
 
+/*
+ * the same, but without writing the accumulator (SSE2, planar VACC only)
+ */
+#if defined(ARCH_MIN_SSE2) && !defined(WIDE_ACCUMULATOR)
+#define HAVE_RESULT_ONLY_MULTIPLIES
+VECTOR_EXTERN
+    VMULF_R(v16 vs, v16 vt);
+VECTOR_EXTERN
+    VMULU_R(v16 vs, v16 vt);
+VECTOR_EXTERN
+    VMUDL_R(v16 vs, v16 vt);
+VECTOR_EXTERN
+    VMUDM_R(v16 vs, v16 vt);
+VECTOR_EXTERN
+    VMUDN_R(v16 vs, v16 vt);
+VECTOR_EXTERN
+    VMUDH_R(v16 vs, v16 vt);
+VECTOR_EXTERN
+    VMACF_R(v16 vs, v16 vt);
+VECTOR_EXTERN
+    VMACU_R(v16 vs, v16 vt);
+VECTOR_EXTERN
+    VMADL_R(v16 vs, v16 vt);
+VECTOR_EXTERN
+    VMADM_R(v16 vs, v16 vt);
+VECTOR_EXTERN
+    VMADN_R(v16 vs, v16 vt);
+VECTOR_EXTERN
+    VMADH_R(v16 vs, v16 vt);
+
+/*
+ * any run of the multiplies above, as one fused idiom (see `p_C2_fused')
+ */
+#define HAVE_FUSED_MULTIPLIES
+extern void VMUL_run(const u32 * IW, unsigned int count);
+#endif
+
 /*
  * an useful idea I thought of for the single-precision multiplies
  * VMULF and VMULU
@@ -38,9 +38,9 @@ static void merge(pi16 VD, pi16 cmp, pi16 pass, pi16 fail)
     i16 diff[N];
 
     for (i = 0; i < N; i++)
-        diff[i] = pass[i] - fail[i];
+        diff[i] = pass[i] ^ fail[i];
     for (i = 0; i < N; i++)
-        VD[i] = fail[i] + cmp[i]*diff[i]; /* actually `(cmp[i] != 0)*diff[i]` */
+        VD[i] = fail[i] ^ (cmp[i] & diff[i]); /* `cmp' is a lane mask. */
 #endif
     return;
 }
@@ -52,24 +52,24 @@ INLINE static void do_lt(pi16 VD, pi16 VS, pi16 VT)
     register unsigned int i;
 
     for (i = 0; i < N; i++)
-        eq[i] = (VS[i] == VT[i]);
+        eq[i] = -(VS[i] == VT[i]);
     for (i = 0; i < N; i++)
-        cn[i] = cf_ne[i] & cf_co[i];
+        cn[i] = RSP_STATE.cf_ne[i] & RSP_STATE.cf_co[i];
     for (i = 0; i < N; i++)
         eq[i] = eq[i] & cn[i];
     for (i = 0; i < N; i++)
-        cf_comp[i] = (VS[i] < VT[i]); /* less than */
+        RSP_STATE.cf_comp[i] = -(VS[i] < VT[i]); /* less than */
     for (i = 0; i < N; i++)
-        cf_comp[i] = cf_comp[i] | eq[i]; /* ... or equal (uncommonly) */
+        RSP_STATE.cf_comp[i] |= eq[i]; /* ... or equal (uncommonly) */
 
-    merge(VACC_L, cf_comp, VS, VT);
+    merge(VACC_L, RSP_STATE.cf_comp, VS, VT);
     vector_copy(VD, VACC_L);
 
  /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
-    vector_wipe(cf_ne);
-    vector_wipe(cf_co);
+    vector_wipe(RSP_STATE.cf_ne);
+    vector_wipe(RSP_STATE.cf_co);
 
-    vector_wipe(cf_clip);
+    vector_wipe(RSP_STATE.cf_clip);
     return;
 }
 
@@ -78,21 +78,21 @@ INLINE static void do_eq(pi16 VD, pi16 VS, pi16 VT)
     register unsigned int i;
 
     for (i = 0; i < N; i++)
-        cf_comp[i] = (VS[i] == VT[i]);
+        RSP_STATE.cf_comp[i] = -(VS[i] == VT[i]);
     for (i = 0; i < N; i++)
-        cf_comp[i] = cf_comp[i] & (cf_ne[i] ^ 1);
+        RSP_STATE.cf_comp[i] = RSP_STATE.cf_comp[i] & ~RSP_STATE.cf_ne[i];
 #if (0)
-    merge(VACC_L, cf_comp, VS, VT); /* correct but redundant */
+    merge(VACC_L, RSP_STATE.cf_comp, VS, VT); /* correct but redundant */
 #else
     vector_copy(VACC_L, VT);
 #endif
     vector_copy(VD, VACC_L);
 
  /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
-    vector_wipe(cf_ne);
-    vector_wipe(cf_co);
+    vector_wipe(RSP_STATE.cf_ne);
+    vector_wipe(RSP_STATE.cf_co);
 
-    vector_wipe(cf_clip);
+    vector_wipe(RSP_STATE.cf_clip);
     return;
 }
 
@@ -101,21 +101,21 @@ INLINE static void do_ne(pi16 VD, pi16 VS, pi16 VT)
     register unsigned int i;
 
     for (i = 0; i < N; i++)
-        cf_comp[i] = (VS[i] != VT[i]);
+        RSP_STATE.cf_comp[i] = -(VS[i] != VT[i]);
     for (i = 0; i < N; i++)
-        cf_comp[i] = cf_comp[i] | cf_ne[i];
+        RSP_STATE.cf_comp[i] = RSP_STATE.cf_comp[i] | RSP_STATE.cf_ne[i];
 #if (0)
-    merge(VACC_L, cf_comp, VS, VT); /* correct but redundant */
+    merge(VACC_L, RSP_STATE.cf_comp, VS, VT); /* correct but redundant */
 #else
     vector_copy(VACC_L, VS);
 #endif
     vector_copy(VD, VACC_L);
 
  /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
-    vector_wipe(cf_ne);
-    vector_wipe(cf_co);
+    vector_wipe(RSP_STATE.cf_ne);
+    vector_wipe(RSP_STATE.cf_co);
 
-    vector_wipe(cf_clip);
+    vector_wipe(RSP_STATE.cf_clip);
     return;
 }
 
@@ -126,24 +126,24 @@ INLINE static void do_ge(pi16 VD, pi16 VS, pi16 VT)
     register unsigned int i;
 
     for (i = 0; i < N; i++)
-        eq[i] = (VS[i] == VT[i]);
+        eq[i] = -(VS[i] == VT[i]);
     for (i = 0; i < N; i++)
-        ce[i] = (cf_ne[i] & cf_co[i]) ^ 1;
+        ce[i] = ~(RSP_STATE.cf_ne[i] & RSP_STATE.cf_co[i]);
     for (i = 0; i < N; i++)
         eq[i] = eq[i] & ce[i];
     for (i = 0; i < N; i++)
-        cf_comp[i] = (VS[i] > VT[i]); /* greater than */
+        RSP_STATE.cf_comp[i] = -(VS[i] > VT[i]); /* greater than */
     for (i = 0; i < N; i++)
-        cf_comp[i] = cf_comp[i] | eq[i]; /* ... or equal (commonly) */
+        RSP_STATE.cf_comp[i] |= eq[i]; /* ... or equal (commonly) */
 
-    merge(VACC_L, cf_comp, VS, VT);
+    merge(VACC_L, RSP_STATE.cf_comp, VS, VT);
     vector_copy(VD, VACC_L);
 
  /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
-    vector_wipe(cf_ne);
-    vector_wipe(cf_co);
+    vector_wipe(RSP_STATE.cf_ne);
+    vector_wipe(RSP_STATE.cf_co);
 
-    vector_wipe(cf_clip);
+    vector_wipe(RSP_STATE.cf_clip);
     return;
 }
 
@@ -166,8 +166,8 @@ INLINE static void do_cl(pi16 VD, pi16 VS, pi16 VT)
         le[i] = cf_comp[i];
 */
     for (i = 0; i < N; i++)
-        eq[i] = cf_ne[i] ^ 1;
-    vector_copy(sn, cf_co);
+        eq[i] = ~RSP_STATE.cf_ne[i];
+    vector_copy(sn, RSP_STATE.cf_co);
 
 /*
  * Now that we have extracted all the flags, we will essentially be masking
@@ -175,49 +175,49 @@ INLINE static void do_cl(pi16 VD, pi16 VS, pi16 VT)
  * NOTEQUAL bit from VCO upper was not set....
  */
     for (i = 0; i < N; i++)
-        VC[i] = VC[i] ^ -sn[i];
+        VC[i] = VC[i] ^ sn[i];
     for (i = 0; i < N; i++)
-        VC[i] = VC[i] + sn[i]; /* conditional negation, if sn */
+        VC[i] = VC[i] - sn[i]; /* conditional negation, if sn */
     for (i = 0; i < N; i++)
         diff[i] = VB[i] - VC[i];
     for (i = 0; i < N; i++)
         uz[i] = (VB[i] + (u16)VT[i] - 65536) >> 31;
     for (i = 0; i < N; i++)
-        lz[i] = (diff[i] == 0x0000);
+        lz[i] = -(diff[i] == 0x0000);
     for (i = 0; i < N; i++)
         gen[i] = lz[i] | uz[i];
     for (i = 0; i < N; i++)
         len[i] = lz[i] & uz[i];
     for (i = 0; i < N; i++)
-        gen[i] = gen[i] & cf_vce[i];
+        gen[i] = gen[i] & RSP_STATE.cf_vce[i];
     for (i = 0; i < N; i++)
-        len[i] = len[i] & (cf_vce[i] ^ 1);
+        len[i] = len[i] & ~RSP_STATE.cf_vce[i];
     for (i = 0; i < N; i++)
         len[i] = len[i] | gen[i];
     for (i = 0; i < N; i++)
-        gen[i] = (VB[i] >= VC[i]);
+        gen[i] = -(VB[i] >= VC[i]);
 
     for (i = 0; i < N; i++)
         cmp[i] = eq[i] & sn[i];
-    merge(le, cmp, len, cf_comp);
+    merge(le, cmp, len, RSP_STATE.cf_comp);
 
     for (i = 0; i < N; i++)
-        cmp[i] = eq[i] & (sn[i] ^ 1);
-    merge(ge, cmp, gen, cf_clip);
+        cmp[i] = eq[i] & ~sn[i];
+    merge(ge, cmp, gen, RSP_STATE.cf_clip);
 
     merge(cmp, sn, le, ge);
     merge(VACC_L, cmp, (pi16)VC, VS);
     vector_copy(VD, VACC_L);
 
  /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
-    vector_wipe(cf_ne);
-    vector_wipe(cf_co);
+    vector_wipe(RSP_STATE.cf_ne);
+    vector_wipe(RSP_STATE.cf_co);
 
-    vector_copy(cf_clip, ge);
-    vector_copy(cf_comp, le);
+    vector_copy(RSP_STATE.cf_clip, ge);
+    vector_copy(RSP_STATE.cf_comp, le);
 
  /* CTC2    $0, $vce # zeroing RSP flags VCF[2] */
-    vector_wipe(cf_vce);
+    vector_wipe(RSP_STATE.cf_vce);
     return;
 }
 
@@ -226,69 +226,52 @@ INLINE static void do_ch(pi16 VD, pi16 VS, pi16 VT)
     ALIGNED i16 VC[N];
     ALIGNED i16 eq[N], ge[N], le[N];
     ALIGNED i16 sn[N];
-#ifndef _DEBUG
     i16 diff[N];
-#endif
-    i16 cch[N]; /* corner case hack:  -(-32768) with undefined sign */
     register unsigned int i;
 
-    for (i = 0; i < N; i++)
-        cch[i] = (VT[i] == -32768) ? ~0 : 0; /* -(-32768) might not be >= 0. */
-    vector_copy(VC, VT);
     for (i = 0; i < N; i++)
         sn[i] = VS[i] ^ VT[i];
     for (i = 0; i < N; i++)
         sn[i] = (sn[i] < 0) ? ~0 :  0; /* signed SRA (sn), 15 */
     for (i = 0; i < N; i++)
-        VC[i] ^= sn[i]; /* if (sn == ~0) {VT = ~VT;} else {VT =  VT;} */
-    for (i = 0; i < N; i++)
-        cf_vce[i]  = (VS[i] == VC[i]); /* 2's complement:  VC = -VT - 1 = ~VT */
-    for (i = 0; i < N; i++)
-        cf_vce[i] &= sn[i];
-    for (i = 0; i < N; i++)
-        VC[i] -= sn[i] & cch[i]; /* converts ~(VT) into -(VT) if (sign) */
-    for (i = 0; i < N; i++)
-        eq[i]  = (VS[i] == VC[i]) & ~cch[i]; /* (VS == +32768) is never true. */
+        VC[i] = VT[i] ^ sn[i]; /* if (sn == ~0) {VT = ~VT;} else {VT =  VT;} */
     for (i = 0; i < N; i++)
-        eq[i] |= cf_vce[i];
+        VC[i] -= sn[i]; /* converts ~(VT) into -(VT) if (sign) */
 
-#ifdef _DEBUG
-    for (i = 0; i < N; i++)
-        le[i] = sn[i] ? (VS[i] <= VC[i]) : (VC[i] < 0);
-    for (i = 0; i < N; i++)
-        ge[i] = sn[i] ? (VC[i] > 0x0000) : (VS[i] >= VC[i]);
-#elif (0)
+/*
+ * VS - VC is VS + VT with the signs different and VS - VT with them the
+ * same, so it never overflows 16 bits:  not even with -(-32768) wrapping
+ * back to -32768, as it does on the RSP.
+ */
     for (i = 0; i < N; i++)
-        le[i] = sn[i] ? (VT[i] <= -VS[i]) : (VT[i] <= ~0x0000);
+        diff[i] = VS[i] - VC[i];
     for (i = 0; i < N; i++)
-        ge[i] = sn[i] ? (~0x0000 >= VT[i]) : (VS[i] >= VT[i]);
-#else
+        RSP_STATE.cf_vce[i]  = -(diff[i] == -1); /* VS = -VT - 1 = ~VT */
     for (i = 0; i < N; i++)
-        diff[i] = sn[i] | VS[i];
+        RSP_STATE.cf_vce[i] &= sn[i];
     for (i = 0; i < N; i++)
-        ge[i] = (diff[i] >= VT[i]);
-
+        eq[i]  = -(diff[i] == 0);
     for (i = 0; i < N; i++)
-        sn[i] = (u16)(sn[i]) >> 15; /* ~0 to 1, 0 to 0 */
+        eq[i] |= RSP_STATE.cf_vce[i];
 
     for (i = 0; i < N; i++)
-        diff[i] = VC[i] - VS[i];
+        ge[i] = -(diff[i] >= 0);
     for (i = 0; i < N; i++)
-        diff[i] = (diff[i] >= 0);
+        le[i] = -(VT[i] < 0);
+    merge(ge, sn, le, ge);
     for (i = 0; i < N; i++)
-        le[i] = (VT[i] < 0);
+        diff[i] = -(diff[i] <= 0);
     merge(le, sn, diff, le);
-#endif
 
-    merge(cf_comp, sn, le, ge);
-    merge(VACC_L, cf_comp, VC, VS);
+    merge(RSP_STATE.cf_comp, sn, le, ge);
+    merge(VACC_L, RSP_STATE.cf_comp, VC, VS);
     vector_copy(VD, VACC_L);
 
-    vector_copy(cf_clip, ge);
-    vector_copy(cf_comp, le);
+    vector_copy(RSP_STATE.cf_clip, ge);
+    vector_copy(RSP_STATE.cf_comp, le);
     for (i = 0; i < N; i++)
-        cf_ne[i] = eq[i] ^ 1;
-    vector_copy(cf_co, sn);
+        RSP_STATE.cf_ne[i] = ~eq[i];
+    vector_copy(RSP_STATE.cf_co, sn);
     return;
 }
 
@@ -306,18 +289,18 @@ INLINE static void do_cr(pi16 VD, pi16 VS, pi16 VT)
         sn[i] = (sn[i] < 0) ? ~0 : 0;
 #ifdef _DEBUG
     for (i = 0; i < N; i++)
-        le[i] = sn[i] ? (VT[i] <= ~VS[i]) : (VT[i] <= ~0x0000);
+        le[i] = -(sn[i] ? (VT[i] <= ~VS[i]) : (VT[i] <= ~0x0000));
     for (i = 0; i < N; i++)
-        ge[i] = sn[i] ? (~0x0000 >= VT[i]) : (VS[i] >= VT[i]);
+        ge[i] = -(sn[i] ? (~0x0000 >= VT[i]) : (VS[i] >= VT[i]));
 #else
     for (i = 0; i < N; i++)
         cmp[i] = ~(VS[i] & sn[i]);
     for (i = 0; i < N; i++)
-        le[i] = (VT[i] <= cmp[i]);
+        le[i] = -(VT[i] <= cmp[i]);
     for (i = 0; i < N; i++)
         cmp[i] =  (VS[i] | sn[i]);
     for (i = 0; i < N; i++)
-        ge[i] = (cmp[i] >= VT[i]);
+        ge[i] = -(cmp[i] >= VT[i]);
 #endif
     for (i = 0; i < N; i++)
         VC[i] ^= sn[i]; /* if (sn == ~0) {VT = ~VT;} else {VT =  VT;} */
@@ -326,28 +309,129 @@ INLINE static void do_cr(pi16 VD, pi16 VS, pi16 VT)
     vector_copy(VD, VACC_L);
 
  /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
-    vector_wipe(cf_ne);
-    vector_wipe(cf_co);
+    vector_wipe(RSP_STATE.cf_ne);
+    vector_wipe(RSP_STATE.cf_co);
 
-    vector_copy(cf_clip, ge);
-    vector_copy(cf_comp, le);
+    vector_copy(RSP_STATE.cf_clip, ge);
+    vector_copy(RSP_STATE.cf_comp, le);
 
  /* CTC2    $0, $vce # zeroing RSP flags VCF[2] */
-    vector_wipe(cf_vce);
+    vector_wipe(RSP_STATE.cf_vce);
     return;
 }
 
 INLINE static void do_mrg(pi16 VD, pi16 VS, pi16 VT)
 {
-    merge(VACC_L, cf_comp, VS, VT);
+    merge(VACC_L, RSP_STATE.cf_comp, VS, VT);
     vector_copy(VD, VACC_L);
     return;
 }
 
+#ifdef ARCH_MIN_SSE2
+/*
+ * The clip tests, all in XMM registers:  Flags are read in once and written
+ * back once, at the end.
+ *
+ * `merge_mask' is the vector form of `merge' above; SSE4.1 has it as one
+ * instruction, so each clip test is written once, to take it as a helper.
+ */
+typedef v16(*p_merge)(v16 cmp, v16 pass, v16 fail);
+
+static INLINE v16 merge_SSE2(v16 cmp, v16 pass, v16 fail)
+{
+    pass = _mm_and_si128(cmp, pass);
+    fail = _mm_andnot_si128(cmp, fail);
+    return _mm_or_si128(pass, fail);
+}
+
+static INLINE v16 clip_low(v16 vs, v16 vt, p_merge merge_mask)
+{
+    const v16 zeros = _mm_setzero_si128();
+    const v16 ones = _mm_cmpeq_epi16(zeros, zeros);
+    v16 eq, sn, vce, vc, lz, uz, gen, len, ge, le, vd;
+
+    eq  = _mm_xor_si128(*(v16 *)RSP_STATE.cf_ne, ones);
+    sn  = *(v16 *)RSP_STATE.cf_co;
+    vce = *(v16 *)RSP_STATE.cf_vce;
+
+    vc = _mm_sub_epi16(_mm_xor_si128(vt, sn), sn); /* conditional negation */
+    lz = _mm_cmpeq_epi16(vs, vc);
+    uz = _mm_subs_epu16(vs, _mm_xor_si128(vt, ones));
+    uz = _mm_cmpeq_epi16(uz, zeros); /* no carry out of (u16)VS + (u16)VT */
+
+    gen = _mm_and_si128(_mm_or_si128(lz, uz), vce);
+    len = _mm_andnot_si128(vce, _mm_and_si128(lz, uz));
+    len = _mm_or_si128(len, gen);
+    gen = _mm_cmpeq_epi16(_mm_subs_epu16(vc, vs), zeros); /* (u16)VS >= VC */
+
+    le = merge_mask(_mm_and_si128(eq, sn), len, *(v16 *)RSP_STATE.cf_comp);
+    ge = merge_mask(_mm_andnot_si128(sn, eq), gen, *(v16 *)RSP_STATE.cf_clip);
+    vd = merge_mask(merge_mask(sn, le, ge), vc, vs);
+
+    *(v16 *)VACC_L = vd;
+    *(v16 *)RSP_STATE.cf_ne = zeros;
+    *(v16 *)RSP_STATE.cf_co = zeros;
+    *(v16 *)RSP_STATE.cf_clip = ge;
+    *(v16 *)RSP_STATE.cf_comp = le;
+    *(v16 *)RSP_STATE.cf_vce = zeros;
+    return (vd);
+}
+
+static INLINE v16 clip_high(v16 vs, v16 vt, p_merge merge_mask)
+{
+    const v16 zeros = _mm_setzero_si128();
+    const v16 ones = _mm_cmpeq_epi16(zeros, zeros);
+    v16 sn, vce, vc, eq, ge, le, diff, vt_neg, vd;
+
+    sn = _mm_srai_epi16(_mm_xor_si128(vs, vt), 15);
+    vc = _mm_sub_epi16(_mm_xor_si128(vt, sn), sn); /* if (sn) {VT = -VT;} */
+    diff = _mm_sub_epi16(vs, vc); /* VS + VT or VS - VT, never overflowing */
+    vce = _mm_and_si128(_mm_cmpeq_epi16(diff, sn), sn);
+    eq = _mm_or_si128(_mm_cmpeq_epi16(diff, zeros), vce);
+
+    vt_neg = _mm_srai_epi16(vt, 15);
+    ge = _mm_xor_si128(_mm_srai_epi16(diff, 15), ones); /* diff >= 0 */
+    ge = merge_mask(sn, vt_neg, ge);
+    le = _mm_xor_si128(_mm_cmpgt_epi16(diff, zeros), ones); /* diff <= 0 */
+    le = merge_mask(sn, le, vt_neg);
+    vd = merge_mask(merge_mask(sn, le, ge), vc, vs);
+
+    *(v16 *)VACC_L = vd;
+    *(v16 *)RSP_STATE.cf_ne = _mm_xor_si128(eq, ones);
+    *(v16 *)RSP_STATE.cf_co = sn;
+    *(v16 *)RSP_STATE.cf_clip = ge;
+    *(v16 *)RSP_STATE.cf_comp = le;
+    *(v16 *)RSP_STATE.cf_vce = vce;
+    return (vd);
+}
+
+static INLINE v16 clip_reverse(v16 vs, v16 vt, p_merge merge_mask)
+{
+    const v16 zeros = _mm_setzero_si128();
+    const v16 ones = _mm_cmpeq_epi16(zeros, zeros);
+    v16 sn, ge, le, vd;
+
+    sn = _mm_srai_epi16(_mm_xor_si128(vs, vt), 15);
+    le = _mm_cmpgt_epi16(vt, _mm_xor_si128(_mm_and_si128(vs, sn), ones));
+    le = _mm_xor_si128(le, ones); /* VT <= ~(VS & sn) */
+    ge = _mm_cmpgt_epi16(vt, _mm_or_si128(vs, sn));
+    ge = _mm_xor_si128(ge, ones); /* (VS | sn) >= VT */
+    vd = merge_mask(merge_mask(sn, le, ge), _mm_xor_si128(vt, sn), vs);
+
+    *(v16 *)VACC_L = vd;
+    *(v16 *)RSP_STATE.cf_ne = zeros;
+    *(v16 *)RSP_STATE.cf_co = zeros;
+    *(v16 *)RSP_STATE.cf_clip = ge;
+    *(v16 *)RSP_STATE.cf_comp = le;
+    *(v16 *)RSP_STATE.cf_vce = zeros;
+    return (vd);
+}
+#endif
+
 VECTOR_OPERATION VLT(v16 vs, v16 vt)
 {
     ALIGNED i16 VD[N];
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     ALIGNED i16 VS[N], VT[N];
 
     *(v16 *)VS = vs;
@@ -359,12 +443,12 @@ VECTOR_OPERATION VLT(v16 vs, v16 vt)
     VT = vt;
 #endif
     do_lt(VD, VS, VT);
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     COMPILER_FENCE();
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(RSP_STATE.V_result, VD);
     return;
 #endif
 }
@@ -372,7 +456,7 @@ VECTOR_OPERATION VLT(v16 vs, v16 vt)
 VECTOR_OPERATION VEQ(v16 vs, v16 vt)
 {
     ALIGNED i16 VD[N];
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     ALIGNED i16 VS[N], VT[N];
 
     *(v16 *)VS = vs;
@@ -384,12 +468,12 @@ VECTOR_OPERATION VEQ(v16 vs, v16 vt)
     VT = vt;
 #endif
     do_eq(VD, VS, VT);
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     COMPILER_FENCE();
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(RSP_STATE.V_result, VD);
     return;
 #endif
 }
@@ -397,7 +481,7 @@ VECTOR_OPERATION VEQ(v16 vs, v16 vt)
 VECTOR_OPERATION VNE(v16 vs, v16 vt)
 {
     ALIGNED i16 VD[N];
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     ALIGNED i16 VS[N], VT[N];
 
     *(v16 *)VS = vs;
@@ -409,12 +493,12 @@ VECTOR_OPERATION VNE(v16 vs, v16 vt)
     VT = vt;
 #endif
     do_ne(VD, VS, VT);
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     COMPILER_FENCE();
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(RSP_STATE.V_result, VD);
     return;
 #endif
 }
@@ -422,7 +506,7 @@ VECTOR_OPERATION VNE(v16 vs, v16 vt)
 VECTOR_OPERATION VGE(v16 vs, v16 vt)
 {
     ALIGNED i16 VD[N];
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     ALIGNED i16 VS[N], VT[N];
 
     *(v16 *)VS = vs;
@@ -434,87 +518,87 @@ VECTOR_OPERATION VGE(v16 vs, v16 vt)
     VT = vt;
 #endif
     do_ge(VD, VS, VT);
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     COMPILER_FENCE();
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(RSP_STATE.V_result, VD);
     return;
 #endif
 }
 
 VECTOR_OPERATION VCL(v16 vs, v16 vt)
 {
-    ALIGNED i16 VD[N];
 #ifdef ARCH_MIN_SSE2
-    ALIGNED i16 VS[N], VT[N];
+    return clip_low(vs, vt, merge_SSE2);
+#elif defined(ARCH_VECTOR_EXTENSIONS)
+    ALIGNED i16 VD[N], VS[N], VT[N];
 
     *(v16 *)VS = vs;
     *(v16 *)VT = vt;
+    do_cl(VD, VS, VT);
+    COMPILER_FENCE();
+    vs = *(v16 *)VD;
+    return (vs);
 #else
+    ALIGNED i16 VD[N];
     v16 VS, VT;
 
     VS = vs;
     VT = vt;
-#endif
     do_cl(VD, VS, VT);
-#ifdef ARCH_MIN_SSE2
-    COMPILER_FENCE();
-    vs = *(v16 *)VD;
-    return (vs);
-#else
-    vector_copy(V_result, VD);
+    vector_copy(RSP_STATE.V_result, VD);
     return;
 #endif
 }
 
 VECTOR_OPERATION VCH(v16 vs, v16 vt)
 {
-    ALIGNED i16 VD[N];
 #ifdef ARCH_MIN_SSE2
-    ALIGNED i16 VS[N], VT[N];
+    return clip_high(vs, vt, merge_SSE2);
+#elif defined(ARCH_VECTOR_EXTENSIONS)
+    ALIGNED i16 VD[N], VS[N], VT[N];
 
     *(v16 *)VS = vs;
     *(v16 *)VT = vt;
+    do_ch(VD, VS, VT);
+    COMPILER_FENCE();
+    vs = *(v16 *)VD;
+    return (vs);
 #else
+    ALIGNED i16 VD[N];
     v16 VS, VT;
 
     VS = vs;
     VT = vt;
-#endif
     do_ch(VD, VS, VT);
-#ifdef ARCH_MIN_SSE2
-    COMPILER_FENCE();
-    vs = *(v16 *)VD;
-    return (vs);
-#else
-    vector_copy(V_result, VD);
+    vector_copy(RSP_STATE.V_result, VD);
     return;
 #endif
 }
 
 VECTOR_OPERATION VCR(v16 vs, v16 vt)
 {
-    ALIGNED i16 VD[N];
 #ifdef ARCH_MIN_SSE2
-    ALIGNED i16 VS[N], VT[N];
+    return clip_reverse(vs, vt, merge_SSE2);
+#elif defined(ARCH_VECTOR_EXTENSIONS)
+    ALIGNED i16 VD[N], VS[N], VT[N];
 
     *(v16 *)VS = vs;
     *(v16 *)VT = vt;
+    do_cr(VD, VS, VT);
+    COMPILER_FENCE();
+    vs = *(v16 *)VD;
+    return (vs);
 #else
+    ALIGNED i16 VD[N];
     v16 VS, VT;
 
     VS = vs;
     VT = vt;
-#endif
     do_cr(VD, VS, VT);
-#ifdef ARCH_MIN_SSE2
-    COMPILER_FENCE();
-    vs = *(v16 *)VD;
-    return (vs);
-#else
-    vector_copy(V_result, VD);
+    vector_copy(RSP_STATE.V_result, VD);
     return;
 #endif
 }
@@ -522,7 +606,7 @@ VECTOR_OPERATION VCR(v16 vs, v16 vt)
 VECTOR_OPERATION VMRG(v16 vs, v16 vt)
 {
     ALIGNED i16 VD[N];
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     ALIGNED i16 VS[N], VT[N];
 
     *(v16 *)VS = vs;
@@ -534,12 +618,162 @@ VECTOR_OPERATION VMRG(v16 vs, v16 vt)
     VT = vt;
 #endif
     do_mrg(VD, VS, VT);
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     COMPILER_FENCE();
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(RSP_STATE.V_result, VD);
+    return;
+#endif
+}
+
+#ifdef HAVE_SIMD_DISPATCH
+/*
+ * SSE4.1 `pblendvb' is the whole of `merge' in one instruction.
+ */
+static TARGET_SSE4_1 v16 merge_SSE4_1(v16 cmp, v16 pass, v16 fail)
+{
+    return _mm_blendv_epi8(fail, pass, cmp);
+}
+
+static TARGET_SSE4_1 void clear_VCO_and_clip(void)
+{
+    const v16 zeros = _mm_setzero_si128();
+
+    *(v16 *)RSP_STATE.cf_ne = zeros;
+    *(v16 *)RSP_STATE.cf_co = zeros;
+    *(v16 *)RSP_STATE.cf_clip = zeros;
     return;
+}
+
+TARGET_SSE4_1 v16 VLT_SSE4_1(v16 vs, v16 vt)
+{
+    v16 eq, comp;
+
+    eq = _mm_cmpeq_epi16(vs, vt);
+    eq = _mm_and_si128(eq,
+        _mm_and_si128(*(v16 *)RSP_STATE.cf_ne, *(v16 *)RSP_STATE.cf_co));
+    comp = _mm_or_si128(_mm_cmplt_epi16(vs, vt), eq);
+
+    *(v16 *)VACC_L = _mm_blendv_epi8(vt, vs, comp);
+    *(v16 *)RSP_STATE.cf_comp = comp;
+    clear_VCO_and_clip();
+    return *(v16 *)VACC_L;
+}
+
+TARGET_SSE4_1 v16 VGE_SSE4_1(v16 vs, v16 vt)
+{
+    v16 eq, comp;
+
+    eq = _mm_cmpeq_epi16(vs, vt);
+    eq = _mm_andnot_si128(
+        _mm_and_si128(*(v16 *)RSP_STATE.cf_ne, *(v16 *)RSP_STATE.cf_co), eq
+    );
+    comp = _mm_or_si128(_mm_cmpgt_epi16(vs, vt), eq);
+
+    *(v16 *)VACC_L = _mm_blendv_epi8(vt, vs, comp);
+    *(v16 *)RSP_STATE.cf_comp = comp;
+    clear_VCO_and_clip();
+    return *(v16 *)VACC_L;
+}
+
+TARGET_SSE4_1 v16 VMRG_SSE4_1(v16 vs, v16 vt)
+{
+    *(v16 *)VACC_L = _mm_blendv_epi8(vt, vs, *(v16 *)RSP_STATE.cf_comp);
+    return *(v16 *)VACC_L;
+}
+
+TARGET_SSE4_1 v16 VCL_SSE4_1(v16 vs, v16 vt)
+{
+    return clip_low(vs, vt, merge_SSE4_1);
+}
+
+TARGET_SSE4_1 v16 VCH_SSE4_1(v16 vs, v16 vt)
+{
+    return clip_high(vs, vt, merge_SSE4_1);
+}
+
+TARGET_SSE4_1 v16 VCR_SSE4_1(v16 vs, v16 vt)
+{
+    return clip_reverse(vs, vt, merge_SSE4_1);
+}
 #endif
+
+/*
+ * VLT or VGE, then a VMRG on the $vcc it just made, as one fused idiom:  The
+ * compare result stays in a register for the merge.
+ */
+void VCMP_VMRG(const u32 * IW, unsigned int count)
+{
+    const u32 compare = IW[0], select = IW[count - 1];
+#ifdef ARCH_MIN_SSE2
+    v16 vs, vt;
+    v16 eq, comp, ne_co;
+
+    vs = *(v16 *)RSP_STATE.VR[IW_VS(compare)];
+    vt = broadcast(*(v16 *)RSP_STATE.VR[IW_VT(compare)], IW_E(compare));
+    ne_co = _mm_and_si128(*(v16 *)RSP_STATE.cf_ne, *(v16 *)RSP_STATE.cf_co);
+    eq = _mm_cmpeq_epi16(vs, vt);
+    if (compare % 64 == 040) { /* VLT */
+        eq = _mm_and_si128(eq, ne_co);
+        comp = _mm_or_si128(_mm_cmplt_epi16(vs, vt), eq);
+    } else { /* VGE */
+        eq = _mm_andnot_si128(ne_co, eq);
+        comp = _mm_or_si128(_mm_cmpgt_epi16(vs, vt), eq);
+    }
+    *(v16 *)RSP_STATE.VR[IW_VD(compare)] = merge_SSE2(comp, vs, vt);
+
+    vs = *(v16 *)RSP_STATE.VR[IW_VS(select)];
+    vt = broadcast(*(v16 *)RSP_STATE.VR[IW_VT(select)], IW_E(select));
+    vs = merge_SSE2(comp, vs, vt);
+    *(v16 *)VACC_L = vs;
+    *(v16 *)RSP_STATE.VR[IW_VD(select)] = vs;
+
+    *(v16 *)RSP_STATE.cf_comp = comp;
+    vt = _mm_setzero_si128();
+    *(v16 *)RSP_STATE.cf_ne = vt;
+    *(v16 *)RSP_STATE.cf_co = vt;
+    *(v16 *)RSP_STATE.cf_clip = vt;
+#elif defined(ARCH_VECTOR_EXTENSIONS)
+    v16 vs, vt;
+    v16 eq, comp, ne_co;
+
+    vs = *(v16 *)RSP_STATE.VR[IW_VS(compare)];
+    vt = broadcast(*(v16 *)RSP_STATE.VR[IW_VT(compare)], IW_E(compare));
+    ne_co = *(v16 *)RSP_STATE.cf_ne & *(v16 *)RSP_STATE.cf_co;
+    eq = (vs == vt);
+    if (compare % 64 == 040) /* VLT */
+        comp = (vs < vt) | (eq & ne_co);
+    else /* VGE */
+        comp = (vs > vt) | (eq & ~ne_co);
+    *(v16 *)RSP_STATE.VR[IW_VD(compare)] = (vs & comp) | (vt & ~comp);
+
+    vs = *(v16 *)RSP_STATE.VR[IW_VS(select)];
+    vt = broadcast(*(v16 *)RSP_STATE.VR[IW_VT(select)], IW_E(select));
+    vs = (vs & comp) | (vt & ~comp);
+    *(v16 *)VACC_L = vs;
+    *(v16 *)RSP_STATE.VR[IW_VD(select)] = vs;
+
+    *(v16 *)RSP_STATE.cf_comp = comp;
+    vector_wipe(vt);
+    *(v16 *)RSP_STATE.cf_ne = vt;
+    *(v16 *)RSP_STATE.cf_co = vt;
+    *(v16 *)RSP_STATE.cf_clip = vt;
+#else
+    ALIGNED i16 VD[N];
+
+    if (compare % 64 == 040)
+        do_lt(VD, RSP_STATE.VR[IW_VS(compare)],
+            broadcast(RSP_STATE.VR[IW_VT(compare)], IW_E(compare)));
+    else
+        do_ge(VD, RSP_STATE.VR[IW_VS(compare)],
+            broadcast(RSP_STATE.VR[IW_VT(compare)], IW_E(compare)));
+    vector_copy(RSP_STATE.VR[IW_VD(compare)], VD);
+
+    do_mrg(VD, RSP_STATE.VR[IW_VS(select)],
+        broadcast(RSP_STATE.VR[IW_VT(select)], IW_E(select)));
+    vector_copy(RSP_STATE.VR[IW_VD(select)], VD);
+#endif
+    return;
 }
@@ -35,4 +35,25 @@ VECTOR_EXTERN
 VECTOR_EXTERN
     VMRG   (v16 vs, v16 vt);
 
+/*
+ * VLT or VGE followed by VMRG, fused (see `p_C2_fused')
+ */
+extern void VCMP_VMRG(const u32 * IW, unsigned int count);
+
+#ifdef HAVE_SIMD_DISPATCH
+extern v16 VLT_SSE4_1(v16 vs, v16 vt);
+extern v16 VGE_SSE4_1(v16 vs, v16 vt);
+extern v16 VCL_SSE4_1(v16 vs, v16 vt);
+extern v16 VCH_SSE4_1(v16 vs, v16 vt);
+extern v16 VCR_SSE4_1(v16 vs, v16 vt);
+extern v16 VMRG_SSE4_1(v16 vs, v16 vt);
+
+extern const p_C2_entry VLT_SSE4_1_entries[1 << 4];
+extern const p_C2_entry VGE_SSE4_1_entries[1 << 4];
+extern const p_C2_entry VCL_SSE4_1_entries[1 << 4];
+extern const p_C2_entry VCH_SSE4_1_entries[1 << 4];
+extern const p_C2_entry VCR_SSE4_1_entries[1 << 4];
+extern const p_C2_entry VMRG_SSE4_1_entries[1 << 4];
+#endif
+
 #endif
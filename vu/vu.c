@@ -24,32 +24,15 @@
 #include "pack.h"
 #endif
 
-ALIGNED i16 VR[32][N << VR_STATIC_WRAPAROUND];
-ALIGNED i16 VACC[3][N];
-#ifndef ARCH_MIN_SSE2
-ALIGNED i16 V_result[N];
-#endif
-
-/*
- * These normally should have type `int` because they are Boolean T/F arrays.
- * However, since SSE2 uses 128-bit XMM's, and Win32 `int` storage is 32-bit,
- * we have the problem of 32*8 > 128 bits, so we use `short` to reduce packs.
- */
-ALIGNED i16 cf_ne[N]; /* $vco:  high "NOTEQUAL" */
-ALIGNED i16 cf_co[N]; /* $vco:  low "carry/borrow in/out" */
-ALIGNED i16 cf_clip[N]; /* $vcc:  high (clip tests:  VCL, VCH, VCR) */
-ALIGNED i16 cf_comp[N]; /* $vcc:  low (VEQ, VNE, VLT, VGE, VCL, VCH, VCR) */
-ALIGNED i16 cf_vce[N]; /* $vce:  vector compare extension register */
-
 VECTOR_OPERATION res_V(v16 vs, v16 vt)
 {
     vt = vs; /* unused */
     message("C2\nRESERVED"); /* uncertain how to handle reserved, untested */
-#ifdef ARCH_MIN_SSE2
-    vs = _mm_setzero_si128();
+#ifdef HAVE_VECTOR_VALUES
+    vector_wipe(vs);
     return (vt = vs); /* -Wunused-but-set-parameter */
 #else
-    vector_wipe(V_result);
+    vector_wipe(RSP_STATE.V_result);
     if (vt == vs)
         return; /* -Wunused-but-set-parameter */
     return;
@@ -58,7 +41,7 @@ VECTOR_OPERATION res_V(v16 vs, v16 vt)
 VECTOR_OPERATION res_M(v16 vs, v16 vt)
 { /* Ultra64 OS did have these, so one could implement this ext. */
     message("VMUL IQ");
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
     vs = res_V(vs, vt);
     return (vs);
 #else
@@ -84,28 +67,241 @@ VECTOR_OPERATION (*COP2_C2[8 * 8])(v16, v16) = {
     res_V  ,res_V  ,res_V  ,res_V  ,res_V  ,res_V  ,res_V  ,res_V  , /* 111 */
 }; /* 000     001     010     011     100     101     110     111 */
 
+/*
+ * The element selector on $vt is applied to it at compile time:  One entry
+ * point for each of the 16 selectors of each vector operation, so that the
+ * interpreter makes a single call per vector op with nothing left to decode
+ * (except `inst_word' for the few ops reading their own operand fields).
+ */
+#ifdef HAVE_VECTOR_VALUES
+#define C2_ENTRY(kernel, e) \
+static void kernel##_##e(unsigned int vd, unsigned int vs, unsigned int vt) \
+{ \
+    *(v16 *)RSP_STATE.VR[vd] = kernel( \
+        *(v16 *)RSP_STATE.VR[vs], broadcast(*(v16 *)RSP_STATE.VR[vt], e)); \
+}
+#else
+#define C2_ENTRY(kernel, e) \
+static void kernel##_##e(unsigned int vd, unsigned int vs, unsigned int vt) \
+{ \
+    kernel(RSP_STATE.VR[vs], broadcast(RSP_STATE.VR[vt], e)); \
+    vector_copy(RSP_STATE.VR[vd], RSP_STATE.V_result); \
+}
+#endif
+
+#define C2_ENTRIES(kernel) \
+    C2_ENTRY(kernel, 0)  C2_ENTRY(kernel, 1)  C2_ENTRY(kernel, 2) \
+    C2_ENTRY(kernel, 3)  C2_ENTRY(kernel, 4)  C2_ENTRY(kernel, 5) \
+    C2_ENTRY(kernel, 6)  C2_ENTRY(kernel, 7)  C2_ENTRY(kernel, 8) \
+    C2_ENTRY(kernel, 9)  C2_ENTRY(kernel, 10) C2_ENTRY(kernel, 11) \
+    C2_ENTRY(kernel, 12) C2_ENTRY(kernel, 13) C2_ENTRY(kernel, 14) \
+    C2_ENTRY(kernel, 15)
+
+/*
+ * `kernel' is expanded before pasting, since the op names may be macros.
+ */
+#define C2_ROW(kernel)  C2_NAMES(kernel)
+#define C2_NAMES(kernel) { \
+    kernel##_0,  kernel##_1,  kernel##_2,  kernel##_3, \
+    kernel##_4,  kernel##_5,  kernel##_6,  kernel##_7, \
+    kernel##_8,  kernel##_9,  kernel##_10, kernel##_11, \
+    kernel##_12, kernel##_13, kernel##_14, kernel##_15, }
+
+/*
+ * The reserved ops do not look at their operands, so one entry does.
+ */
+#define C2_ANY(kernel)  C2_NAME(kernel)
+#define C2_NAME(kernel) { \
+    kernel##_0, kernel##_0, kernel##_0, kernel##_0, \
+    kernel##_0, kernel##_0, kernel##_0, kernel##_0, \
+    kernel##_0, kernel##_0, kernel##_0, kernel##_0, \
+    kernel##_0, kernel##_0, kernel##_0, kernel##_0, }
+
+C2_ENTRY(res_V, 0)
+C2_ENTRY(res_M, 0)
+C2_ENTRIES(VMULF)
+C2_ENTRIES(VMULU)
+C2_ENTRIES(VMUDL)
+C2_ENTRIES(VMUDM)
+C2_ENTRIES(VMUDN)
+C2_ENTRIES(VMUDH)
+C2_ENTRIES(VMACF)
+C2_ENTRIES(VMACU)
+C2_ENTRIES(VMADL)
+C2_ENTRIES(VMADM)
+C2_ENTRIES(VMADN)
+C2_ENTRIES(VMADH)
+C2_ENTRIES(VADD)
+C2_ENTRIES(VSUB)
+C2_ENTRIES(VABS)
+C2_ENTRIES(VADDC)
+C2_ENTRIES(VSUBC)
+C2_ENTRIES(VSAW)
+C2_ENTRIES(VLT)
+C2_ENTRIES(VEQ)
+C2_ENTRIES(VNE)
+C2_ENTRIES(VGE)
+C2_ENTRIES(VCL)
+C2_ENTRIES(VCH)
+C2_ENTRIES(VCR)
+C2_ENTRIES(VMRG)
+C2_ENTRIES(VAND)
+C2_ENTRIES(VNAND)
+C2_ENTRIES(VOR)
+C2_ENTRIES(VNOR)
+C2_ENTRIES(VXOR)
+C2_ENTRIES(VNXOR)
+C2_ENTRIES(VRCP)
+C2_ENTRIES(VRCPL)
+C2_ENTRIES(VRCPH)
+C2_ENTRIES(VMOV)
+C2_ENTRIES(VRSQ)
+C2_ENTRIES(VRSQL)
+C2_ENTRIES(VRSQH)
+C2_ENTRIES(VNOP)
+
+p_C2_entry COP2_C2_entries[8 * 8][1 << 4] = {
+    C2_ROW(VMULF), C2_ROW(VMULU), C2_ANY(res_M), C2_ANY(res_M),
+    C2_ROW(VMUDL), C2_ROW(VMUDM), C2_ROW(VMUDN), C2_ROW(VMUDH), /* 000 */
+    C2_ROW(VMACF), C2_ROW(VMACU), C2_ANY(res_M), C2_ANY(res_M),
+    C2_ROW(VMADL), C2_ROW(VMADM), C2_ROW(VMADN), C2_ROW(VMADH), /* 001 */
+    C2_ROW(VADD), C2_ROW(VSUB), C2_ANY(res_V), C2_ROW(VABS),
+    C2_ROW(VADDC), C2_ROW(VSUBC), C2_ANY(res_V), C2_ANY(res_V), /* 010 */
+    C2_ANY(res_V), C2_ANY(res_V), C2_ANY(res_V), C2_ANY(res_V),
+    C2_ANY(res_V), C2_ROW(VSAW), C2_ANY(res_V), C2_ANY(res_V), /* 011 */
+    C2_ROW(VLT), C2_ROW(VEQ), C2_ROW(VNE), C2_ROW(VGE),
+    C2_ROW(VCL), C2_ROW(VCH), C2_ROW(VCR), C2_ROW(VMRG), /* 100 */
+    C2_ROW(VAND), C2_ROW(VNAND), C2_ROW(VOR), C2_ROW(VNOR),
+    C2_ROW(VXOR), C2_ROW(VNXOR), C2_ANY(res_V), C2_ANY(res_V), /* 101 */
+    C2_ROW(VRCP), C2_ROW(VRCPL), C2_ROW(VRCPH), C2_ROW(VMOV),
+    C2_ROW(VRSQ), C2_ROW(VRSQL), C2_ROW(VRSQH), C2_ROW(VNOP), /* 110 */
+    C2_ANY(res_V), C2_ANY(res_V), C2_ANY(res_V), C2_ANY(res_V),
+    C2_ANY(res_V), C2_ANY(res_V), C2_ANY(res_V), C2_ANY(res_V), /* 111 */
+};
+
+#define L       VU_ACC_L
+#define HM      VU_ACC_HM
+#define CO      VU_VCO
+#define CC      VU_VCC
+#define CE      VU_VCE
+#define ALL     VU_STATE
+const unsigned char C2_reads[8 * 8] = {
+    0         ,0         ,ALL       ,ALL       ,0         ,0         ,0         ,0         , /* 000 */
+    L|HM      ,L|HM      ,ALL       ,ALL       ,L|HM      ,L|HM      ,L|HM      ,L|HM      , /* 001 */
+    CO        ,CO        ,ALL       ,0         ,0         ,0         ,ALL       ,ALL       , /* 010 */
+    ALL       ,ALL       ,ALL       ,ALL       ,ALL       ,L|HM      ,ALL       ,ALL       , /* 011 */
+    CO        ,CO        ,CO        ,CO        ,CO|CC|CE  ,0         ,0         ,CC        , /* 100 */
+    0         ,0         ,0         ,0         ,0         ,0         ,ALL       ,ALL       , /* 101 */
+    0         ,0         ,0         ,0         ,0         ,0         ,0         ,0         , /* 110 */
+    ALL       ,ALL       ,ALL       ,ALL       ,ALL       ,ALL       ,ALL       ,ALL       , /* 111 */
+};
+const unsigned char C2_writes[8 * 8] = {
+    L|HM      ,L|HM      ,0         ,0         ,L|HM      ,L|HM      ,L|HM      ,L|HM      , /* 000 */
+    L|HM      ,L|HM      ,0         ,0         ,L|HM      ,L|HM      ,L|HM      ,L|HM      , /* 001 */
+    L|CO      ,L|CO      ,0         ,L         ,L|CO      ,L|CO      ,0         ,0         , /* 010 */
+    0         ,0         ,0         ,0         ,0         ,0         ,0         ,0         , /* 011 */
+    L|CO|CC   ,L|CO|CC   ,L|CO|CC   ,L|CO|CC   ,L|CO|CC|CE,L|CO|CC|CE,L|CO|CC|CE,L         , /* 100 */
+    L         ,L         ,L         ,L         ,L         ,L         ,0         ,0         , /* 101 */
+    L         ,L         ,L         ,L         ,L         ,L         ,L         ,0         , /* 110 */
+    0         ,0         ,0         ,0         ,0         ,0         ,0         ,0         , /* 111 */
+};
+#undef L
+#undef HM
+#undef CO
+#undef CC
+#undef CE
+#undef ALL
+
+/*
+ * 000 to 021 of `COP2_C2_entries', for when `C2_writes' are all dead
+ */
+#ifdef HAVE_RESULT_ONLY_MULTIPLIES
+C2_ENTRIES(VMULF_R)
+C2_ENTRIES(VMULU_R)
+C2_ENTRIES(VMUDL_R)
+C2_ENTRIES(VMUDM_R)
+C2_ENTRIES(VMUDN_R)
+C2_ENTRIES(VMUDH_R)
+C2_ENTRIES(VMACF_R)
+C2_ENTRIES(VMACU_R)
+C2_ENTRIES(VMADL_R)
+C2_ENTRIES(VMADM_R)
+C2_ENTRIES(VMADN_R)
+C2_ENTRIES(VMADH_R)
+#else
+#define VMULF_R VMULF
+#define VMULU_R VMULU
+#define VMUDL_R VMUDL
+#define VMUDM_R VMUDM
+#define VMUDN_R VMUDN
+#define VMUDH_R VMUDH
+#define VMACF_R VMACF
+#define VMACU_R VMACU
+#define VMADL_R VMADL
+#define VMADM_R VMADM
+#define VMADN_R VMADN
+#define VMADH_R VMADH
+#endif
+#ifdef ARCH_MIN_SSE2
+C2_ENTRIES(VADD_R)
+C2_ENTRIES(VSUB_R)
+#else
+#define VADD_R  VADD
+#define VSUB_R  VSUB
+#endif
+
+p_C2_entry COP2_C2_results[022][1 << 4] = {
+    C2_ROW(VMULF_R), C2_ROW(VMULU_R), C2_ANY(res_M), C2_ANY(res_M),
+    C2_ROW(VMUDL_R), C2_ROW(VMUDM_R), C2_ROW(VMUDN_R), C2_ROW(VMUDH_R), /* 000 */
+    C2_ROW(VMACF_R), C2_ROW(VMACU_R), C2_ANY(res_M), C2_ANY(res_M),
+    C2_ROW(VMADL_R), C2_ROW(VMADM_R), C2_ROW(VMADN_R), C2_ROW(VMADH_R), /* 001 */
+    C2_ROW(VADD_R), C2_ROW(VSUB_R), /* 010 */
+};
+
+#ifdef HAVE_SIMD_DISPATCH
+C2_ENTRIES(VLT_SSE4_1)
+C2_ENTRIES(VGE_SSE4_1)
+C2_ENTRIES(VCL_SSE4_1)
+C2_ENTRIES(VCH_SSE4_1)
+C2_ENTRIES(VCR_SSE4_1)
+C2_ENTRIES(VMRG_SSE4_1)
+
+const p_C2_entry VLT_SSE4_1_entries[1 << 4]  = C2_ROW(VLT_SSE4_1);
+const p_C2_entry VGE_SSE4_1_entries[1 << 4]  = C2_ROW(VGE_SSE4_1);
+const p_C2_entry VCL_SSE4_1_entries[1 << 4]  = C2_ROW(VCL_SSE4_1);
+const p_C2_entry VCH_SSE4_1_entries[1 << 4]  = C2_ROW(VCH_SSE4_1);
+const p_C2_entry VCR_SSE4_1_entries[1 << 4]  = C2_ROW(VCR_SSE4_1);
+const p_C2_entry VMRG_SSE4_1_entries[1 << 4] = C2_ROW(VMRG_SSE4_1);
+
+C2_ENTRIES(VADDC_AVX2)
+C2_ENTRIES(VSUBC_AVX2)
+
+const p_C2_entry VADDC_AVX2_entries[1 << 4]  = C2_ROW(VADDC_AVX2);
+const p_C2_entry VSUBC_AVX2_entries[1 << 4]  = C2_ROW(VSUBC_AVX2);
+#endif
+
 #ifndef ARCH_MIN_SSE2
 u16 get_VCO(void)
 {
     register u16 vco;
 
     vco = 0x0000
-      | (cf_ne[0xF % 8] << 0xF)
-      | (cf_ne[0xE % 8] << 0xE)
-      | (cf_ne[0xD % 8] << 0xD)
-      | (cf_ne[0xC % 8] << 0xC)
-      | (cf_ne[0xB % 8] << 0xB)
-      | (cf_ne[0xA % 8] << 0xA)
-      | (cf_ne[0x9 % 8] << 0x9)
-      | (cf_ne[0x8 % 8] << 0x8)
-      | (cf_co[0x7 % 8] << 0x7)
-      | (cf_co[0x6 % 8] << 0x6)
-      | (cf_co[0x5 % 8] << 0x5)
-      | (cf_co[0x4 % 8] << 0x4)
-      | (cf_co[0x3 % 8] << 0x3)
-      | (cf_co[0x2 % 8] << 0x2)
-      | (cf_co[0x1 % 8] << 0x1)
-      | (cf_co[0x0 % 8] << 0x0);
+      | (RSP_STATE.cf_ne[0xF % 8] & (1 << 0xF))
+      | (RSP_STATE.cf_ne[0xE % 8] & (1 << 0xE))
+      | (RSP_STATE.cf_ne[0xD % 8] & (1 << 0xD))
+      | (RSP_STATE.cf_ne[0xC % 8] & (1 << 0xC))
+      | (RSP_STATE.cf_ne[0xB % 8] & (1 << 0xB))
+      | (RSP_STATE.cf_ne[0xA % 8] & (1 << 0xA))
+      | (RSP_STATE.cf_ne[0x9 % 8] & (1 << 0x9))
+      | (RSP_STATE.cf_ne[0x8 % 8] & (1 << 0x8))
+      | (RSP_STATE.cf_co[0x7 % 8] & (1 << 0x7))
+      | (RSP_STATE.cf_co[0x6 % 8] & (1 << 0x6))
+      | (RSP_STATE.cf_co[0x5 % 8] & (1 << 0x5))
+      | (RSP_STATE.cf_co[0x4 % 8] & (1 << 0x4))
+      | (RSP_STATE.cf_co[0x3 % 8] & (1 << 0x3))
+      | (RSP_STATE.cf_co[0x2 % 8] & (1 << 0x2))
+      | (RSP_STATE.cf_co[0x1 % 8] & (1 << 0x1))
+      | (RSP_STATE.cf_co[0x0 % 8] & (1 << 0x0));
     return (vco); /* Big endian becomes little. */
 }
 u16 get_VCC(void)
@@ -113,22 +309,22 @@ u16 get_VCC(void)
     register u16 vcc;
 
     vcc = 0x0000
-      | (cf_clip[0xF % 8] << 0xF)
-      | (cf_clip[0xE % 8] << 0xE)
-      | (cf_clip[0xD % 8] << 0xD)
-      | (cf_clip[0xC % 8] << 0xC)
-      | (cf_clip[0xB % 8] << 0xB)
-      | (cf_clip[0xA % 8] << 0xA)
-      | (cf_clip[0x9 % 8] << 0x9)
-      | (cf_clip[0x8 % 8] << 0x8)
-      | (cf_comp[0x7 % 8] << 0x7)
-      | (cf_comp[0x6 % 8] << 0x6)
-      | (cf_comp[0x5 % 8] << 0x5)
-      | (cf_comp[0x4 % 8] << 0x4)
-      | (cf_comp[0x3 % 8] << 0x3)
-      | (cf_comp[0x2 % 8] << 0x2)
-      | (cf_comp[0x1 % 8] << 0x1)
-      | (cf_comp[0x0 % 8] << 0x0);
+      | (RSP_STATE.cf_clip[0xF % 8] & (1 << 0xF))
+      | (RSP_STATE.cf_clip[0xE % 8] & (1 << 0xE))
+      | (RSP_STATE.cf_clip[0xD % 8] & (1 << 0xD))
+      | (RSP_STATE.cf_clip[0xC % 8] & (1 << 0xC))
+      | (RSP_STATE.cf_clip[0xB % 8] & (1 << 0xB))
+      | (RSP_STATE.cf_clip[0xA % 8] & (1 << 0xA))
+      | (RSP_STATE.cf_clip[0x9 % 8] & (1 << 0x9))
+      | (RSP_STATE.cf_clip[0x8 % 8] & (1 << 0x8))
+      | (RSP_STATE.cf_comp[0x7 % 8] & (1 << 0x7))
+      | (RSP_STATE.cf_comp[0x6 % 8] & (1 << 0x6))
+      | (RSP_STATE.cf_comp[0x5 % 8] & (1 << 0x5))
+      | (RSP_STATE.cf_comp[0x4 % 8] & (1 << 0x4))
+      | (RSP_STATE.cf_comp[0x3 % 8] & (1 << 0x3))
+      | (RSP_STATE.cf_comp[0x2 % 8] & (1 << 0x2))
+      | (RSP_STATE.cf_comp[0x1 % 8] & (1 << 0x1))
+      | (RSP_STATE.cf_comp[0x0 % 8] & (1 << 0x0));
     return (vcc); /* Big endian becomes little. */
 }
 u8 get_VCE(void)
@@ -137,14 +333,14 @@ u8 get_VCE(void)
     register u8 vce;
 
     result = 0x00
-      | (cf_vce[0x7] << 0x7)
-      | (cf_vce[0x6] << 0x6)
-      | (cf_vce[0x5] << 0x5)
-      | (cf_vce[0x4] << 0x4)
-      | (cf_vce[0x3] << 0x3)
-      | (cf_vce[0x2] << 0x2)
-      | (cf_vce[0x1] << 0x1)
-      | (cf_vce[0x0] << 0x0)
+      | (RSP_STATE.cf_vce[0x7] & (1 << 0x7))
+      | (RSP_STATE.cf_vce[0x6] & (1 << 0x6))
+      | (RSP_STATE.cf_vce[0x5] & (1 << 0x5))
+      | (RSP_STATE.cf_vce[0x4] & (1 << 0x4))
+      | (RSP_STATE.cf_vce[0x3] & (1 << 0x3))
+      | (RSP_STATE.cf_vce[0x2] & (1 << 0x2))
+      | (RSP_STATE.cf_vce[0x1] & (1 << 0x1))
+      | (RSP_STATE.cf_vce[0x0] & (1 << 0x0))
     ;
     vce = (u8)(result & 0xFF);
     return (vce); /* Big endian becomes little. */
@@ -155,16 +351,10 @@ u16 get_VCO(void)
     v16 xmm, hi, lo;
     register u16 vco;
 
-    hi = _mm_load_si128((v16 *)cf_ne);
-    lo = _mm_load_si128((v16 *)cf_co);
+    hi = _mm_load_si128((v16 *)RSP_STATE.cf_ne);
+    lo = _mm_load_si128((v16 *)RSP_STATE.cf_co);
 
-/*
- * Rotate Boolean storage from LSB to MSB.
- */
-    hi = _mm_slli_epi16(hi, 15);
-    lo = _mm_slli_epi16(lo, 15);
-
-    xmm = _mm_packs_epi16(lo, hi); /* Decompress INT16 Booleans to INT8 ones. */
+    xmm = _mm_packs_epi16(lo, hi); /* Narrow INT16 lane masks to INT8 ones. */
     vco = _mm_movemask_epi8(xmm) & 0x0000FFFF; /* PMOVMSKB combines each MSB. */
     return (vco);
 }
@@ -173,16 +363,10 @@ u16 get_VCC(void)
     v16 xmm, hi, lo;
     register u16 vcc;
 
-    hi = _mm_load_si128((v16 *)cf_clip);
-    lo = _mm_load_si128((v16 *)cf_comp);
+    hi = _mm_load_si128((v16 *)RSP_STATE.cf_clip);
+    lo = _mm_load_si128((v16 *)RSP_STATE.cf_comp);
 
-/*
- * Rotate Boolean storage from LSB to MSB.
- */
-    hi = _mm_slli_epi16(hi, 15);
-    lo = _mm_slli_epi16(lo, 15);
-
-    xmm = _mm_packs_epi16(lo, hi); /* Decompress INT16 Booleans to INT8 ones. */
+    xmm = _mm_packs_epi16(lo, hi); /* Narrow INT16 lane masks to INT8 ones. */
     vcc = _mm_movemask_epi8(xmm) & 0x0000FFFF; /* PMOVMSKB combines each MSB. */
     return (vcc);
 }
@@ -192,11 +376,9 @@ u8 get_VCE(void)
     register u8 vce;
 
     hi = _mm_setzero_si128();
-    lo = _mm_load_si128((v16 *)cf_vce);
+    lo = _mm_load_si128((v16 *)RSP_STATE.cf_vce);
 
-    lo = _mm_slli_epi16(lo, 15); /* Rotate Boolean storage from LSB to MSB. */
-
-    xmm = _mm_packs_epi16(lo, hi); /* Decompress INT16 Booleans to INT8 ones. */
+    xmm = _mm_packs_epi16(lo, hi); /* Narrow INT16 lane masks to INT8 ones. */
     vce = _mm_movemask_epi8(xmm) & 0x000000FF; /* PMOVMSKB combines each MSB. */
     return (vce);
 }
@@ -204,16 +386,16 @@ u8 get_VCE(void)
 
 /*
  * CTC2 resources
- * not sure how to vectorize going the other direction into SSE2
  */
+#ifndef ARCH_MIN_SSE2
 void set_VCO(u16 vco)
 {
     register unsigned int i;
 
     for (i = 0; i < N; i++)
-        cf_co[i] = (vco >> (i + 0x0)) & 1;
+        RSP_STATE.cf_co[i] = -((vco >> (i + 0x0)) & 1);
     for (i = 0; i < N; i++)
-        cf_ne[i] = (vco >> (i + 0x8)) & 1;
+        RSP_STATE.cf_ne[i] = -((vco >> (i + 0x8)) & 1);
     return; /* Little endian becomes big. */
 }
 void set_VCC(u16 vcc)
@@ -221,9 +403,9 @@ void set_VCC(u16 vcc)
     register unsigned int i;
 
     for (i = 0; i < N; i++)
-        cf_comp[i] = (vcc >> (i + 0x0)) & 1;
+        RSP_STATE.cf_comp[i] = -((vcc >> (i + 0x0)) & 1);
     for (i = 0; i < N; i++)
-        cf_clip[i] = (vcc >> (i + 0x8)) & 1;
+        RSP_STATE.cf_clip[i] = -((vcc >> (i + 0x8)) & 1);
     return; /* Little endian becomes big. */
 }
 void set_VCE(u8 vce)
@@ -231,6 +413,39 @@ void set_VCE(u8 vce)
     register unsigned int i;
 
     for (i = 0; i < N; i++)
-        cf_vce[i] = (vce >> i) & 1;
+        RSP_STATE.cf_vce[i] = -((vce >> i) & 1);
     return; /* Little endian becomes big. */
 }
+#else
+/*
+ * Spread the low 8 bits of `bits' out to one lane mask per bit:  Each lane
+ * tests its own bit, at the same time.
+ */
+static INLINE v16 expand_flags(unsigned int bits)
+{
+    v16 lanes, xmm;
+
+    lanes = _mm_setr_epi16(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80);
+    xmm = _mm_set1_epi16((i16)(bits & 0xFF));
+    xmm = _mm_and_si128(xmm, lanes);
+    return _mm_cmpeq_epi16(xmm, lanes);
+}
+
+void set_VCO(u16 vco)
+{
+    *(v16 *)RSP_STATE.cf_co = expand_flags(vco >> 0x0);
+    *(v16 *)RSP_STATE.cf_ne = expand_flags(vco >> 0x8);
+    return; /* Little endian becomes big. */
+}
+void set_VCC(u16 vcc)
+{
+    *(v16 *)RSP_STATE.cf_comp = expand_flags(vcc >> 0x0);
+    *(v16 *)RSP_STATE.cf_clip = expand_flags(vcc >> 0x8);
+    return; /* Little endian becomes big. */
+}
+void set_VCE(u8 vce)
+{
+    *(v16 *)RSP_STATE.cf_vce = expand_flags(vce);
+    return; /* Little endian becomes big. */
+}
+#endif
@@ -17,60 +17,43 @@
 
 #if defined(ARCH_MIN_SSE2) && !defined(SSE2NEON)
 #include <emmintrin.h>
-#endif
-
-#include "../my_types.h"
-
-#define N       8
-/* N:  number of processor elements in SIMD processor */
 
 /*
- * Illegal, unaligned LWC2 operations on the RSP may write past the terminal
- * byte of a vector, while SWC2 operations may have to wrap around stores
- * from the end to the start of a vector.  Both of these risk out-of-bounds
- * memory access, but by doubling the number of bytes allocated (shift left)
- * per each vector register, we could stabilize and probably optimize this.
+ * SSE2 compares 16-bit elements as signed only, but with the sign bits of
+ * both sides flipped, that gives the unsigned order.  (SSE2NEON has it.)
  */
-#if 0
-#define VR_STATIC_WRAPAROUND    0
-#else
-#define VR_STATIC_WRAPAROUND    1
+#define _mm_cmplt_epu16(a, b)   _mm_cmplt_epi16( \
+    _mm_xor_si128((a), _mm_set1_epi16(-32768)), \
+    _mm_xor_si128((b), _mm_set1_epi16(-32768)))
 #endif
 
 /*
- * We are going to need this for vector operations doing scalar things.
- * The divides and VSAW need bit-wise information from the instruction word.
+ * On x86, SSE2 is only the baseline:  kernels for newer extensions (SSSE3,
+ * SSE4.1, AVX2) are compiled in next to the SSE2 ones and picked when the RSP
+ * is initiated, by what the CPU turns out to support (see `simd.h').
  */
-extern u32 inst_word;
-
-/*
- * RSP virtual registers (of vector unit)
- * The most important are the 32 general-purpose vector registers.
- * The correct way to accurately store these is using big-endian vectors.
- *
- * For ?WC2 we may need to do byte-precision access just as directly.
- * This is amended by using the `VU_S` and `VU_B` macros defined in `rsp.h`.
- */
-ALIGNED extern i16 VR[32][N << VR_STATIC_WRAPAROUND];
-
-/*
- * The RSP accumulator is a vector of 3 48-bit integers.  Nearly all of the
- * vector operations access it, but it's for multiply-accumulate operations.
- *
- * Access dimensions would be VACC[8][3] but are inverted for SIMD benefits.
- */
-ALIGNED extern i16 VACC[3][N];
+#if defined(ARCH_MIN_SSE2) && !defined(SSE2NEON) && !defined(__ARM_NEON__)
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define HAVE_SIMD_DISPATCH
+#include <tmmintrin.h>
+#include <smmintrin.h>
+#include <immintrin.h>
+#endif
+#endif
 
-/*
- * When compiling without SSE2, we need to use a pointer to a destination
- * vector instead of an XMM register in the return slot of the function.
- * The vector "result" register will be emulated to serve this pointer
- * as a shared global rather than the return slot of a function call.
- */
-#ifndef ARCH_MIN_SSE2
-ALIGNED extern i16 V_result[N];
+#if defined(HAVE_SIMD_DISPATCH) && defined(__GNUC__)
+#define TARGET_SSSE3    __attribute__((target("ssse3")))
+#define TARGET_SSE4_1   __attribute__((target("sse4.1")))
+#define TARGET_AVX2     __attribute__((target("avx2")))
+#else
+#define TARGET_SSSE3
+#define TARGET_SSE4_1
+#define TARGET_AVX2
 #endif
 
+#include "../context.h"
+#include "../diag.h"
+
 /*
  * accumulator-indexing macros
  */
@@ -78,31 +61,200 @@ ALIGNED extern i16 V_result[N];
 #define MD      01
 #define LO      02
 
-#define VACC_L      (VACC[LO])
-#define VACC_M      (VACC[MD])
-#define VACC_H      (VACC[HI])
+#define VACC_L      (RSP_STATE.VACC[LO])
+#define VACC_M      (RSP_STATE.VACC[MD])
+#define VACC_H      (RSP_STATE.VACC[HI])
 
 #define ACC_L(i)    (VACC_L)[i]
 #define ACC_M(i)    (VACC_M)[i]
 #define ACC_H(i)    (VACC_H)[i]
 
-#ifdef ARCH_MIN_SSE2
+/*
+ * Define this to keep the upper 32 bits of the accumulator (VACC_H:VACC_M)
+ * as one signed 32-bit integer per element, in the place of those planes,
+ * so that VMAC* and VMAD* need only one carry (out of VACC_L) and a 32-bit
+ * add, and the clamps are computed from the sum.  VACC_M and VACC_H are then
+ * not valid as they are:  `VACC_plane' makes either of them when asked to.
+ *
+ * The multiply-accumulates themselves are a little faster this way, but the
+ * recompiler only knows how to emit the planar ones, so it is not default.
+ */
+#if (0) && defined(ARCH_MIN_SSE2)
+#define WIDE_ACCUMULATOR
+#endif
+
+#ifdef WIDE_ACCUMULATOR
+#define VACC_W      ((pi32)RSP_STATE.VACC[HI]) /* [N], over VACC_H and VACC_M */
+#endif
+
+/*
+ * Without SSE2, GCC and Clang still have 128-bit vectors of their own, in
+ * the generic vector extension to C, which they lower to whatever SIMD the
+ * target has (NEON, AltiVec, or SSE2 where `ARCH_MIN_SSE2' was not asked
+ * for).  The kernels then return their results by value, as the SSE2 ones
+ * do, instead of through `V_result'.  Define NO_VECTOR_EXTENSIONS to build
+ * the plain C path anyway.
+ */
+#if !defined(ARCH_MIN_SSE2) && !defined(NO_VECTOR_EXTENSIONS)
+#if defined(__GNUC__) || defined(__clang__)
+#define ARCH_VECTOR_EXTENSIONS
+#endif
+#endif
+
+#if defined(ARCH_MIN_SSE2) || defined(ARCH_VECTOR_EXTENSIONS)
+#define HAVE_VECTOR_VALUES
+#endif
+
+#if defined(ARCH_MIN_SSE2)
 typedef __m128i v16;
+#elif defined(ARCH_VECTOR_EXTENSIONS)
+typedef i16 v16 __attribute__((vector_size(16), __may_alias__));
 #else
 typedef pi16 v16;
 #endif
 
-#ifdef ARCH_MIN_SSE2
+#ifdef HAVE_VECTOR_VALUES
 #define VECTOR_OPERATION    v16
 #else
 #define VECTOR_OPERATION    void
 #endif
 #define VECTOR_EXTERN       extern VECTOR_OPERATION
 
-NOINLINE extern void message(const char* body);
+#ifdef WIDE_ACCUMULATOR
+extern v16 VACC_plane(unsigned int plane);
+#endif
+
+/*
+ * `vt' with the element selector `e' applied:  broadcasts of its quarters,
+ * halves or one element (or `vt' itself for the vector selectors 0 and 1).
+ * For a constant `e' this is just the one shuffle.
+ */
+#ifdef ARCH_MIN_SSE2
+#ifdef __ARM_NEON__
+#define HALVES(v, i)    (v16)vcombine_s16( \
+    vdup_lane_s16(vget_low_s16((int16x8_t)(v)), i), \
+    vdup_lane_s16(vget_high_s16((int16x8_t)(v)), i))
+#define WHOLE_LO(v, i)  (v16)vdupq_lane_s16(vget_low_s16((int16x8_t)(v)), i)
+#define WHOLE_HI(v, i)  (v16)vdupq_lane_s16(vget_high_s16((int16x8_t)(v)), i)
+#else
+#define QUARTERS(v, i)  _mm_shufflehi_epi16( \
+    _mm_shufflelo_epi16(v, _MM_SHUFFLE(2 + i, 2 + i, i, i)), \
+    _MM_SHUFFLE(2 + i, 2 + i, i, i))
+#define HALVES(v, i)    _mm_shufflehi_epi16( \
+    _mm_shufflelo_epi16(v, _MM_SHUFFLE(i, i, i, i)), _MM_SHUFFLE(i, i, i, i))
+#define WHOLE_LO(v, i)  _mm_shuffle_epi32( \
+    _mm_shufflelo_epi16(v, _MM_SHUFFLE(i, i, i, i)), _MM_SHUFFLE(0, 0, 0, 0))
+#define WHOLE_HI(v, i)  _mm_shuffle_epi32( \
+    _mm_shufflehi_epi16(v, _MM_SHUFFLE(i, i, i, i)), _MM_SHUFFLE(2, 2, 2, 2))
+#endif
+
+static INLINE v16 broadcast(v16 vt, const unsigned int e)
+{
+#ifdef __ARM_NEON__
+    uint32x4_t pairs;
+
+#endif
+    switch (e) {
+#ifdef __ARM_NEON__
+    case 0x2:
+        pairs = vshlq_n_u32((uint32x4_t)vt, 16);
+        return (v16)vorrq_u32(pairs, vshrq_n_u32(pairs, 16));
+    case 0x3:
+        pairs = vshrq_n_u32((uint32x4_t)vt, 16);
+        return (v16)vorrq_u32(pairs, vshlq_n_u32(pairs, 16));
+#else
+    case 0x2:  return QUARTERS(vt, 0);
+    case 0x3:  return QUARTERS(vt, 1);
+#endif
+    case 0x4:  return HALVES(vt, 0);
+    case 0x5:  return HALVES(vt, 1);
+    case 0x6:  return HALVES(vt, 2);
+    case 0x7:  return HALVES(vt, 3);
+    case 0x8:  return WHOLE_LO(vt, 0);
+    case 0x9:  return WHOLE_LO(vt, 1);
+    case 0xA:  return WHOLE_LO(vt, 2);
+    case 0xB:  return WHOLE_LO(vt, 3);
+    case 0xC:  return WHOLE_HI(vt, 0);
+    case 0xD:  return WHOLE_HI(vt, 1);
+    case 0xE:  return WHOLE_HI(vt, 2);
+    case 0xF:  return WHOLE_HI(vt, 3);
+    }
+    return (vt);
+}
+#elif defined(ARCH_VECTOR_EXTENSIONS)
+static INLINE v16 broadcast(v16 vt, const unsigned int e)
+{
+    v16 vd;
+    register unsigned int i;
+
+    if (e < 0x2)
+        return (vt);
+    for (i = 0; i < N; i++)
+        vd[i] = vt[
+            (e < 0x4) ? (i & 0xE) + (e & 0x1) :
+            (e < 0x8) ? (i & 0xC) + (e & 0x3) : (e & 0x7)
+        ];
+    return (vd); /* For a constant `e', one shuffle of the target's own. */
+}
+#else
+static INLINE pi16 broadcast(pi16 vt, const unsigned int e)
+{
+    register unsigned int i;
+
+    if (e < 0x2)
+        return (vt);
+    for (i = 0; i < N; i++)
+        RSP_STATE.shuffle_temporary[i] = vt[
+            (e < 0x4) ? (i & 0xE) + (e & 0x1) :
+            (e < 0x8) ? (i & 0xC) + (e & 0x3) : (e & 0x7)
+        ];
+    return (RSP_STATE.shuffle_temporary);
+}
+#endif
 
 VECTOR_EXTERN (*COP2_C2[8*7 + 8])(v16, v16);
 
+/*
+ * VR[vd] = COP2_C2[func](VR[vs], VR[vt] with the element modifier applied),
+ * one entry point for every (func, element) pair
+ */
+typedef void(*p_C2_entry)(unsigned int vd, unsigned int vs, unsigned int vt);
+extern p_C2_entry COP2_C2_entries[8*7 + 8][1 << 4];
+
+/*
+ * the accumulator and flag state each op reads or fully writes, by func
+ *
+ * `predecode_IMEM' uses these to find ops none of whose writes are read
+ * (before they are written again), and sends those through the result-only
+ * entries of `COP2_C2_results' (VMUL* through VMADH, VADD and VSUB).
+ */
+#define VU_ACC_L    0x01
+#define VU_ACC_HM   0x02 /* VACC_H and VACC_M, always written together */
+#define VU_VCO      0x04
+#define VU_VCC      0x08
+#define VU_VCE      0x10
+#define VU_STATE    (VU_ACC_L | VU_ACC_HM | VU_VCO | VU_VCC | VU_VCE)
+
+extern const unsigned char C2_reads[8*7 + 8];
+extern const unsigned char C2_writes[8*7 + 8];
+extern p_C2_entry COP2_C2_results[022][1 << 4];
+
+/*
+ * a run of `count' vector ops which micro-codes use together (the idioms are
+ * found by `predecode_IMEM'), done in one call:  The state left behind must
+ * be just what doing them one at a time leaves.  `IW' holds the instruction
+ * words, which the fused kernels decode for themselves.
+ */
+typedef void(*p_C2_fused)(const u32 * IW, unsigned int count);
+
+/*
+ * operand fields of a COP2 computational op's instruction word
+ */
+#define IW_VD(word)     (((word) >>  6) % (1 << 5))
+#define IW_VS(word)     (((word) >> 11) % (1 << 5))
+#define IW_VT(word)     (((word) >> 16) % (1 << 5))
+#define IW_E(word)      (((word) >> 21) % (1 << 4))
+
 #ifdef ARCH_MIN_SSE2
 
 #define vector_copy(vd, vs) { \
@@ -132,6 +284,32 @@ VECTOR_EXTERN (*COP2_C2[8*7 + 8])(v16, v16);
 #define vector_cmpgt(vd, vs) { \
     *(v16 *)&(vd) = _mm_cmpgt_epi16(*(v16 *)&(vd), *(v16 *)&(vs)); }
 
+#elif defined(ARCH_VECTOR_EXTENSIONS)
+
+#define vector_copy(vd, vs) { \
+    *(v16 *)(vd) = *(v16 *)(vs); }
+#define vector_wipe(vd) { \
+    *(v16 *)&(vd) ^= *(v16 *)&(vd); }
+#define vector_fill(vd) { \
+    *(v16 *)&(vd) = (*(v16 *)&(vd) == *(v16 *)&(vd)); }
+
+#define vector_and(vd, vs) { \
+    *(v16 *)&(vd) &= *(v16 *)&(vs); }
+#define vector_or(vd, vs) { \
+    *(v16 *)&(vd) |= *(v16 *)&(vs); }
+#define vector_xor(vd, vs) { \
+    *(v16 *)&(vd) ^= *(v16 *)&(vs); }
+
+/*
+ * Vector compares give lane masks (0 or ~0), the same as PCMPEQW and PCMPGTW.
+ */
+#define vector_cmplt(vd, vs) { \
+    *(v16 *)&(vd) = (*(v16 *)&(vd) <  *(v16 *)&(vs)); }
+#define vector_cmpeq(vd, vs) { \
+    *(v16 *)&(vd) = (*(v16 *)&(vd) == *(v16 *)&(vs)); }
+#define vector_cmpgt(vd, vs) { \
+    *(v16 *)&(vd) = (*(v16 *)&(vd) >  *(v16 *)&(vs)); }
+
 #else
 
 #define vector_copy(vd, vs) { \
@@ -197,33 +375,33 @@ VECTOR_EXTERN (*COP2_C2[8*7 + 8])(v16, v16);
 
 #define vector_cmplt(vd, vs) { \
     (vd)[0] = ((vd)[0] < (vs)[0]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[1] < (vs)[1]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[2] < (vs)[2]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[3] < (vs)[3]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[4] < (vs)[4]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[5] < (vs)[5]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[6] < (vs)[6]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[7] < (vs)[7]) ? ~0x0000 :  0x0000; \
+    (vd)[1] = ((vd)[1] < (vs)[1]) ? ~0x0000 :  0x0000; \
+    (vd)[2] = ((vd)[2] < (vs)[2]) ? ~0x0000 :  0x0000; \
+    (vd)[3] = ((vd)[3] < (vs)[3]) ? ~0x0000 :  0x0000; \
+    (vd)[4] = ((vd)[4] < (vs)[4]) ? ~0x0000 :  0x0000; \
+    (vd)[5] = ((vd)[5] < (vs)[5]) ? ~0x0000 :  0x0000; \
+    (vd)[6] = ((vd)[6] < (vs)[6]) ? ~0x0000 :  0x0000; \
+    (vd)[7] = ((vd)[7] < (vs)[7]) ? ~0x0000 :  0x0000; \
 }
 #define vector_cmpeq(vd, vs) { \
     (vd)[0] = ((vd)[0] == (vs)[0]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[1] == (vs)[1]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[2] == (vs)[2]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[3] == (vs)[3]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[4] == (vs)[4]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[5] == (vs)[5]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[6] == (vs)[6]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[7] == (vs)[7]) ? ~0x0000 :  0x0000; \
+    (vd)[1] = ((vd)[1] == (vs)[1]) ? ~0x0000 :  0x0000; \
+    (vd)[2] = ((vd)[2] == (vs)[2]) ? ~0x0000 :  0x0000; \
+    (vd)[3] = ((vd)[3] == (vs)[3]) ? ~0x0000 :  0x0000; \
+    (vd)[4] = ((vd)[4] == (vs)[4]) ? ~0x0000 :  0x0000; \
+    (vd)[5] = ((vd)[5] == (vs)[5]) ? ~0x0000 :  0x0000; \
+    (vd)[6] = ((vd)[6] == (vs)[6]) ? ~0x0000 :  0x0000; \
+    (vd)[7] = ((vd)[7] == (vs)[7]) ? ~0x0000 :  0x0000; \
 }
 #define vector_cmpgt(vd, vs) { \
     (vd)[0] = ((vd)[0] > (vs)[0]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[1] > (vs)[1]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[2] > (vs)[2]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[3] > (vs)[3]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[4] > (vs)[4]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[5] > (vs)[5]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[6] > (vs)[6]) ? ~0x0000 :  0x0000; \
-    (vd)[0] = ((vd)[7] > (vs)[7]) ? ~0x0000 :  0x0000; \
+    (vd)[1] = ((vd)[1] > (vs)[1]) ? ~0x0000 :  0x0000; \
+    (vd)[2] = ((vd)[2] > (vs)[2]) ? ~0x0000 :  0x0000; \
+    (vd)[3] = ((vd)[3] > (vs)[3]) ? ~0x0000 :  0x0000; \
+    (vd)[4] = ((vd)[4] > (vs)[4]) ? ~0x0000 :  0x0000; \
+    (vd)[5] = ((vd)[5] > (vs)[5]) ? ~0x0000 :  0x0000; \
+    (vd)[6] = ((vd)[6] > (vs)[6]) ? ~0x0000 :  0x0000; \
+    (vd)[7] = ((vd)[7] > (vs)[7]) ? ~0x0000 :  0x0000; \
 }
 
 #endif
@@ -242,12 +420,6 @@ extern u16 VCO;
 extern u16 VCC;
 extern u8 VCE;
 
-ALIGNED extern i16 cf_ne[N];
-ALIGNED extern i16 cf_co[N];
-ALIGNED extern i16 cf_clip[N];
-ALIGNED extern i16 cf_comp[N];
-ALIGNED extern i16 cf_vce[N];
-
 extern u16 get_VCO(void);
 extern u16 get_VCC(void);
 extern u8 get_VCE(void);